@@ -0,0 +1,166 @@
+#pragma once
+
+// Portable entry points of the distribution pipeline in plugin.cpp.
+// The SKSE plugin and the headless driver (headless_driver.cpp) both run the pipeline
+// through these, so the stages and their order are the same in and out of the game.
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct PipelinePaths {
+    fs::path dataPath;
+    fs::path sksePluginsPath;
+    fs::path logFilePath;
+    fs::path logDoctorPath;
+    fs::path logClustersPath;
+    fs::path logSmartCleaningPath;
+    fs::path logHelperPath;
+    fs::path logMetricsPath;
+    fs::path logMetricsHistoryPath;
+    fs::path configIniPath;
+    fs::path frameworkTablePath;
+    fs::path jsonOutputPath;
+    fs::path backupJsonPath;
+    fs::path analysisDir;
+    fs::path bodySlidePresetsPath;
+    fs::path presetCatalogCachePath;
+    fs::path inputFingerprintPath;
+};
+
+// How the preset catalog reads SliderPresets XMLs that are not in its cache.
+enum class ReadBackend {
+    Auto,     // Batched where the platform has an asynchronous backend, mapped otherwise
+    Batched,  // Bounded queue of asynchronous reads: io_uring on Linux, a completion port on Windows
+    Mapped,   // One read-only memory mapping per file
+};
+
+struct ConfigSettings {
+    int backupValue = 1;
+    bool modeUBE = true;
+    bool presetsSmartCleaning = false;
+    int suggestionAutoApplyConfidence = 0;  // Percent; 0 = only log suggestions for missing presets
+    bool blacklistedPresetsSmartCleaningFromRandomDistribution = false;
+    bool blacklistedPresetsSmartCleaningFromAll = false;
+    bool outfitsForceReSmartCleaning = false;
+    bool backgroundProcessing = false;
+    bool skipUnchangedRuns = true;
+    int workerThreads = 0;  // 0 = one per hardware thread, capped; 1 = everything on the calling thread
+    int startupBudgetMs = 0;  // 0 = no budget; otherwise report stages past it run after the main menu
+    ReadBackend readBackend = ReadBackend::Auto;
+    bool watchMode = false;
+    int watchDebounceMs = 500;  // Quiet time after the last change before a live update runs
+    bool presetClusters = false;       // Read every SetSlider and write the near-duplicate preset clusters log
+    double clusterMaxDistance = 25.0;  // Euclidean, in slider percentage points
+};
+
+// One entry per pipeline stage. I/O figures come from the thread-local counters of the thread
+// the stage ran on ("pipeline" for the kDataLoaded pipeline, "prescan" for the early prescan).
+struct StageMetric {
+    std::string name;
+    std::string thread;
+    double wallMs = 0.0;
+    std::uint64_t bytesRead = 0;
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t filesOpened = 0;
+};
+
+struct DistributionOutcome {
+    bool success = false;
+    std::string consoleMessage;
+};
+
+// Game layout: <game>/Data, SKSE/Plugins for the JSON and INI, My Games/.../SKSE for the logs.
+PipelinePaths BuildPipelinePaths(const std::string& documentsPath, const std::string& gamePath);
+
+// Explicit layout: every other path (companion logs, backup folder, caches) is derived from these four.
+PipelinePaths BuildExplicitPipelinePaths(const fs::path& dataPath, const fs::path& jsonPath, const fs::path& iniPath,
+                                         const fs::path& logPath);
+
+void CreateDirectoryIfNotExists(const fs::path& path);
+void WriteLogHeader(std::ostream& logFile);
+ConfigSettings ReadConfigFromIni(const fs::path& iniPath, std::ostream& logFile);
+
+void StartEarlyPreScan(const PipelinePaths& paths);
+void MarkDataLoaded();
+
+// Runs the report stages that Startup_Budget_Ms pushed out of startup, appending their output to
+// the main log. Call only once the pipeline has closed the main log; does nothing if none were deferred.
+void RunDeferredStages(std::vector<StageMetric>* stageMetrics = nullptr);
+
+// Builds the preset catalog of <dataPath>/CalienteTools/BodySlide/SliderPresets without the cache
+// on the given number of workers. The digest covers every entry and the extraction log, so runs
+// with different thread counts must agree on it.
+struct CatalogBenchResult {
+    size_t presets = 0;
+    size_t filesOpened = 0;
+    std::uint64_t digest = 0;
+};
+
+CatalogBenchResult BenchBuildPresetCatalog(const fs::path& dataPath, int workerThreads,
+                                           ReadBackend readBackend = ReadBackend::Auto);
+
+// Builds the catalog with sliders (no cache) and clusters it; exhaustive compares every pair instead
+// of the LSH candidates, as a reference for recall. The digest covers cluster membership only.
+struct ClusterBenchResult {
+    size_t presets = 0;
+    size_t sliderNames = 0;
+    size_t clusters = 0;
+    size_t clusteredPresets = 0;
+    size_t distanceChecks = 0;
+    double clusterMs = 0.0;
+    std::uint64_t digest = 0;
+};
+
+ClusterBenchResult BenchClusterPresets(const fs::path& dataPath, int workerThreads, double maxDistance,
+                                       bool exhaustive);
+
+// One <Preset> element as the catalog records it.
+struct SliderPresetRecord {
+    std::string name;
+    std::string set;
+    std::vector<std::string> groups;
+    bool extracted = false;
+};
+
+// Runs the catalog's XML tokenizer over a file already in memory (raw bytes, BOM allowed).
+std::vector<SliderPresetRecord> BenchTokenizeSliderPresets(const std::string& xml, const std::string& filename);
+
+// Builds the Smart Cleaning preset map from (filename, internal name) pairs, one XML per pair and an
+// empty internal name for a failed extraction, then resolves every reference with FindPresetMatch.
+// matchLevels holds 1-6 per reference, or 0 if it was not found. mapBytes is the heap the map and
+// its new interned names took (0 where the runtime cannot report heap use). The references that were
+// not found are then run through the typo suggestion index.
+struct PresetLookupBenchResult {
+    double buildMs = 0.0;
+    double lookupMs = 0.0;
+    std::uint64_t mapBytes = 0;
+    size_t internedNames = 0;
+    double suggestionBuildMs = 0.0;
+    double suggestionMs = 0.0;
+    size_t suggestionQueries = 0;
+    size_t suggested = 0;  // Queries with at least one suggestion
+    std::vector<int> matchLevels;
+    std::vector<std::string> resolvedNames;
+};
+
+PresetLookupBenchResult BenchPresetLookup(const std::vector<std::pair<std::string, std::string>>& presets,
+                                          const std::vector<std::string>& references);
+
+DistributionOutcome RunDistributionPipelineGuarded(const PipelinePaths& paths, const ConfigSettings& config,
+                                                   std::ostream& logFile, bool ranInBackground,
+                                                   std::vector<StageMetric>* stageMetrics = nullptr);
+
+// Watch mode: once the pipeline has run, watches SliderPresets and the Data folder's
+// OBodyNG_PDA_*.ini files on a background thread. Changes are debounced, only the changed files are
+// re-read, and only the stages that depend on them run again before the JSON is recommitted. Each
+// update is appended to the main log and reported through onUpdate (called on the watch thread).
+// Call after the main log is closed.
+void StartWatchMode(const PipelinePaths& paths, const ConfigSettings& config,
+                    std::function<void(const DistributionOutcome&)> onUpdate = nullptr);
+void StopWatchMode();
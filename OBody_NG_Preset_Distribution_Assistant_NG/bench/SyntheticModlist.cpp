@@ -0,0 +1,365 @@
+#include "SyntheticModlist.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const std::vector<std::string> kAdjectives = {"Curvy",  "Athletic", "Petite", "Thicc", "Slim",    "Nordic",
+                                              "Elven",  "Vampire",  "Amazon", "Soft",  "Toned",   "Royal",
+                                              "Shadow", "Daedric",  "Hearth", "Frost", "Ebony",   "Sunlit"};
+
+const std::vector<std::string> kNouns = {"Body",  "Figure", "Shape",   "Build", "Form",    "Frame",
+                                         "Curve", "Muse",   "Goddess", "Huntress", "Maiden", "Warrior"};
+
+const std::vector<std::string> kSliders = {
+    "Breasts",         "BreastsSmall",    "BreastsSH",       "BreastsFantasy", "BreastCleavage", "BreastFlatness",
+    "BreastGravity2",  "BreastHeight",    "BreastPerkiness", "BreastWidth",    "NippleSize",     "NippleLength",
+    "AreolaSize",      "Butt",            "ButtSmall",       "ButtShape2",     "ButtClassic",    "AppleCheeks",
+    "Hips",            "HipBone",         "HipForward",      "HipUpperWidth",  "Waist",          "WideWaistLine",
+    "ChubbyWaist",     "Belly",           "BigBelly",        "Thighs",         "ThighInnerGap",  "SlimThighs",
+    "Legs",            "KneeHeight",      "CalfSize",        "Arms",           "ShoulderWidth",  "ShoulderSmooth",
+    "Back",            "BackArch",        "NeckSeam",        "Ankles"};
+
+// 12.5% of XMLs carry a second <Preset> block, as some packs ship variants in one file.
+constexpr unsigned kMultiPresetModulo = 8;
+
+std::string PresetNameFor(size_t index, std::mt19937& rng) {
+    std::ostringstream name;
+    name << kAdjectives[rng() % kAdjectives.size()] << " " << kNouns[rng() % kNouns.size()] << " " << index;
+    return name.str();
+}
+
+void WriteFileOrThrow(const fs::path& path, const std::string& content) {
+    std::ofstream file(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("Could not write " + path.string());
+    file << content;
+}
+
+void AppendPresetBlock(std::ostringstream& xml, const std::string& name, const std::vector<std::string>& groups,
+                       std::mt19937& rng) {
+    xml << "    <Preset name=\"" << name << "\" set=\"CBBE Body SMP (3BBB)\">\n";
+    for (const auto& group : groups) {
+        xml << "        <Group name=\"" << group << "\"/>\n";
+    }
+    for (const auto& slider : kSliders) {
+        xml << "        <SetSlider name=\"" << slider << "\" size=\"small\" value=\""
+            << static_cast<int>(rng() % 201) - 100 << "\"/>\n";
+        xml << "        <SetSlider name=\"" << slider << "\" size=\"big\" value=\""
+            << static_cast<int>(rng() % 201) - 100 << "\"/>\n";
+    }
+    xml << "    </Preset>\n";
+}
+
+// Category mix per ten files: 4 CBBE/3BA, 2 UBE, 1 UBE+3BA conflict, 1 UBE+CBBE conflict with
+// "UBE" in the name, 1 CustomPreset, 1 without groups.
+std::vector<std::string> GenerateSliderPresets(const fs::path& folder, size_t count, std::mt19937& rng) {
+    fs::create_directories(folder);
+    std::vector<std::string> presetNames;
+    presetNames.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        std::string name = PresetNameFor(i, rng);
+        std::vector<std::string> groups;
+        std::string filename = name;
+
+        switch (i % 10) {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+                groups = {"CBBE", "3BA"};
+                break;
+            case 4:
+            case 5:
+                name += " UBE";
+                groups = {"UBE"};
+                break;
+            case 6:
+                groups = {"UBE", "3BA Outfits"};
+                break;
+            case 7:
+                name += " UBE";
+                groups = {"UBE", "CBBE Bodies"};
+                break;
+            case 8:
+                name = "CustomPreset";
+                groups = {"CBBE"};
+                break;
+            default:
+                break;
+        }
+
+        std::ostringstream xml;
+        xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<SliderPresets>\n";
+        AppendPresetBlock(xml, name, groups, rng);
+        if (i % kMultiPresetModulo == 0) {
+            AppendPresetBlock(xml, name + " Variant", groups, rng);
+        }
+        xml << "</SliderPresets>\n";
+
+        WriteFileOrThrow(folder / (filename + ".xml"), xml.str());
+        presetNames.push_back(name == "CustomPreset" ? filename : name);
+    }
+
+    return presetNames;
+}
+
+const std::vector<std::string> kRuleKeys = {"npc",           "factionFemale",   "factionMale", "npcPluginFemale",
+                                            "npcPluginMale", "raceFemale",      "raceMale"};
+
+// Every counter form the rule parser understands, including the implicit one (no third field).
+const std::vector<std::string> kRuleModes = {"", "x", "x-", "x*", "-", "*", "1", "0"};
+
+void GenerateRuleFiles(const fs::path& dataPath, size_t fileCount, size_t rulesPerFile,
+                       const std::vector<std::string>& presetNames, std::mt19937& rng) {
+    for (size_t f = 0; f < fileCount; ++f) {
+        std::ostringstream ini;
+        ini << "; Synthetic rule file " << f << "\n";
+
+        for (size_t r = 0; r < rulesPerFile; ++r) {
+            const std::string& key = kRuleKeys[rng() % kRuleKeys.size()];
+            const std::string& mode = kRuleModes[(f + r) % kRuleModes.size()];
+
+            std::string target;
+            if (key == "npc") {
+                target = "BenchNPC_" + std::to_string(rng() % 5000);
+            } else if (key.rfind("faction", 0) == 0) {
+                target = "BenchFaction_" + std::to_string(rng() % 300);
+            } else if (key.rfind("race", 0) == 0) {
+                target = "BenchRace_" + std::to_string(rng() % 40);
+            } else {
+                target = "BenchMod_" + std::to_string(rng() % 800) + ".esp";
+            }
+
+            ini << key << " = " << target << "|";
+            size_t presetCount = 1 + rng() % 4;
+            for (size_t p = 0; p < presetCount; ++p) {
+                if (p > 0) ini << ", ";
+                // About one reference in ten points at a preset that is not installed
+                if (rng() % 10 == 0) {
+                    ini << "Missing Preset " << rng() % 1000;
+                } else {
+                    ini << presetNames[rng() % presetNames.size()];
+                }
+            }
+            if (!mode.empty()) ini << "|" << mode;
+            ini << "\n";
+        }
+
+        char filename[64];
+        std::snprintf(filename, sizeof(filename), "OBodyNG_PDA_Bench_%04zu.ini", f);
+        WriteFileOrThrow(dataPath / filename, ini.str());
+    }
+}
+
+void AppendPresetArray(std::ostringstream& json, const std::vector<std::string>& presets, const char* indent) {
+    json << "[\n";
+    for (size_t i = 0; i < presets.size(); ++i) {
+        json << indent << "    \"" << presets[i] << "\"" << (i + 1 < presets.size() ? ",\n" : "\n");
+    }
+    json << indent << "]";
+}
+
+std::vector<std::string> PickPresets(const std::vector<std::string>& presetNames, size_t count, std::mt19937& rng) {
+    std::vector<std::string> picked;
+    for (size_t i = 0; i < count; ++i) {
+        picked.push_back(rng() % 12 == 0 ? "Uninstalled Preset " + std::to_string(rng() % 2000)
+                                         : presetNames[rng() % presetNames.size()]);
+    }
+    return picked;
+}
+
+// OBody JSON with every section the assistant reads; "npc" is grown until the target size.
+void GenerateOBodyJson(const fs::path& path, size_t targetBytes, const std::vector<std::string>& presetNames,
+                       std::mt19937& rng) {
+    std::ostringstream json;
+    json << "{\n";
+    json << "    \"npcFormID\": {\n        \"Skyrim.esm\": {\n            \"00013BA2\": ";
+    AppendPresetArray(json, PickPresets(presetNames, 2, rng), "            ");
+    json << "\n        }\n    },\n";
+
+    json << "    \"npc\": {\n";
+    size_t npc = 0;
+    while (static_cast<size_t>(json.tellp()) < targetBytes || npc < 4) {
+        if (npc > 0) json << ",\n";
+        json << "        \"BenchNPC_" << npc << "\": ";
+        AppendPresetArray(json, PickPresets(presetNames, 1 + rng() % 3, rng), "        ");
+        ++npc;
+    }
+    json << "\n    },\n";
+
+    const std::vector<std::pair<std::string, std::string>> objectSections = {
+        {"factionFemale", "BenchFaction_"}, {"factionMale", "BenchFaction_"},  {"npcPluginFemale", "BenchMod_"},
+        {"npcPluginMale", "BenchMod_"},     {"raceFemale", "BenchRace_"},      {"raceMale", "BenchRace_"}};
+
+    // Small targets get short fixed sections so "npc" still makes up most of the file
+    const size_t sectionEntries = targetBytes < 64 * 1024 ? 3 : 20;
+    for (const auto& [section, prefix] : objectSections) {
+        json << "    \"" << section << "\": {\n";
+        for (size_t i = 0; i < sectionEntries; ++i) {
+            json << "        \"" << prefix << i << (prefix == "BenchMod_" ? ".esp" : "") << "\": ";
+            AppendPresetArray(json, PickPresets(presetNames, 1 + rng() % 4, rng), "        ");
+            json << (i + 1 < sectionEntries ? ",\n" : "\n");
+        }
+        json << "    },\n";
+    }
+
+    json << "    \"blacklistedNpcs\": [\n        \"Saffi\",\n        \"Lydia\"\n    ],\n";
+    json << "    \"blacklistedNpcsFormID\": {\n        \"Skyrim.esm\": [\n            \"0001A6D7\"\n        ]\n    },\n";
+    json << "    \"blacklistedNpcsPluginFemale\": [\n        \"BenchMod_1.esp\"\n    ],\n";
+    json << "    \"blacklistedNpcsPluginMale\": [\n        \"BenchMod_2.esp\"\n    ],\n";
+    json << "    \"blacklistedRacesFemale\": [\n        \"ElderRace\"\n    ],\n";
+    json << "    \"blacklistedRacesMale\": [\n        \"ElderRace\"\n    ],\n";
+    json << "    \"blacklistedOutfitsFromORefitFormID\": {\n        \"Skyrim.esm\": [\n            \"0001A6D7\"\n"
+            "        ]\n    },\n";
+    json << "    \"blacklistedOutfitsFromORefit\": [\n        \"Bench Outfit\"\n    ],\n";
+    json << "    \"blacklistedOutfitsFromORefitPlugin\": [\n        \"BenchMod_3.esp\"\n    ],\n";
+    json << "    \"outfitsForceRefitFormID\": {\n        \"Skyrim.esm\": [\n            \"0001A6D7\"\n        ]\n    },\n";
+    json << "    \"outfitsForceRefit\": [\n        \"Bench Outfit\"\n    ],\n";
+    json << "    \"blacklistedPresetsFromRandomDistribution\": ";
+    AppendPresetArray(json, PickPresets(presetNames, sectionEntries, rng), "    ");
+    json << ",\n";
+    json << "    \"blacklistedPresetsShowInOBodyMenu\": true\n";
+    json << "}\n";
+
+    WriteFileOrThrow(path, json.str());
+}
+
+std::string ConfigIniContent() {
+    return "[Original backup]\n"
+           "Backup = true\n"
+           "\n"
+           "[blacklistedPresetsShowInOBodyMenu]\n"
+           "ModeUBE = true\n"
+           "\n"
+           "[Presets_Smart_Cleaning]\n"
+           "Smart_Cleaning = true\n"
+           "\n"
+           "[blacklistedPresets_Smart_Cleaning_FromRandomDistribution]\n"
+           "Smart_Cleaning = true\n"
+           "\n"
+           "[blacklistedPresets_Smart_Cleaning_FromAll]\n"
+           "Smart_Cleaning = false\n"
+           "\n"
+           "[outfitsForceRe_Smart_Cleaning]\n"
+           "Smart_Cleaning = true\n"
+           "\n"
+           "[Performance]\n"
+           "Background_Processing = false\n"
+           "Skip_Unchanged_Runs = false\n"
+           "Worker_Threads = 0\n";
+}
+
+std::string SpecSignature(const SyntheticModlistSpec& spec) {
+    std::ostringstream signature;
+    signature << "xml=" << spec.xmlFiles << " ini=" << spec.ruleFiles << " rules=" << spec.rulesPerFile
+              << " json=" << spec.jsonBytes << " seed=" << spec.seed << " format=3";
+    return signature.str();
+}
+
+// Pristine/ holds the JSON, the config INI and rules/OBodyNG_PDA_*.ini; the pipeline rewrites
+// all of them (JSON output, INI rule counters), so they are copied back before each run.
+void CopyRuleFiles(const fs::path& from, const fs::path& to) {
+    fs::create_directories(to);
+    for (const auto& entry : fs::directory_iterator(from)) {
+        std::string filename = entry.path().filename().string();
+        if (filename.rfind("OBodyNG_PDA_", 0) == 0) {
+            fs::copy_file(entry.path(), to / filename, fs::copy_options::overwrite_existing);
+        }
+    }
+}
+
+void SavePristineCopy(const SyntheticModlist& modlist) {
+    fs::create_directories(modlist.pristinePath);
+    fs::copy_file(modlist.jsonPath, modlist.pristinePath / modlist.jsonPath.filename(),
+                  fs::copy_options::overwrite_existing);
+    fs::copy_file(modlist.iniPath, modlist.pristinePath / modlist.iniPath.filename(),
+                  fs::copy_options::overwrite_existing);
+    CopyRuleFiles(modlist.dataPath, modlist.pristinePath / "rules");
+}
+
+}  // namespace
+
+std::vector<SyntheticModlistSpec> StandardScenarios() {
+    std::vector<SyntheticModlistSpec> scenarios(3);
+
+    scenarios[0].name = "small";
+    scenarios[0].xmlFiles = 1000;
+    scenarios[0].ruleFiles = 100;
+    scenarios[0].jsonBytes = 10 * 1024;
+
+    scenarios[1].name = "medium";
+    scenarios[1].xmlFiles = 10000;
+    scenarios[1].ruleFiles = 250;
+    scenarios[1].jsonBytes = 5 * 1024 * 1024;
+
+    scenarios[2].name = "large";
+    scenarios[2].xmlFiles = 50000;
+    scenarios[2].ruleFiles = 500;
+    scenarios[2].jsonBytes = 50 * 1024 * 1024;
+
+    return scenarios;
+}
+
+SyntheticModlist PrepareSyntheticModlist(const fs::path& root, const SyntheticModlistSpec& spec, bool regenerate) {
+    SyntheticModlist modlist;
+    modlist.root = root / spec.name;
+    modlist.dataPath = modlist.root / "Data";
+    modlist.jsonPath = modlist.dataPath / "SKSE" / "Plugins" / "OBody_presetDistributionConfig.json";
+    modlist.iniPath = modlist.dataPath / "SKSE" / "Plugins" / "OBody_NG_Preset_Distribution_Assistant_NG.ini";
+    modlist.logPath = modlist.root / "Logs" / "OBody_NG_Preset_Distribution_Assistant-NG.log";
+    modlist.pristinePath = modlist.root / "Pristine";
+
+    fs::path signaturePath = modlist.root / "modlist.spec";
+    fs::path namesPath = modlist.root / "preset_names.txt";
+    std::string signature = SpecSignature(spec);
+
+    if (!regenerate && fs::exists(signaturePath) && fs::exists(namesPath)) {
+        std::ifstream signatureFile(signaturePath);
+        std::string existing;
+        std::getline(signatureFile, existing);
+        if (existing == signature) {
+            std::ifstream namesFile(namesPath);
+            std::string name;
+            while (std::getline(namesFile, name)) modlist.presetNames.push_back(name);
+            return modlist;
+        }
+    }
+
+    std::error_code ec;
+    fs::remove_all(modlist.root, ec);
+    fs::create_directories(modlist.jsonPath.parent_path());
+    fs::create_directories(modlist.logPath.parent_path());
+
+    std::mt19937 rng(spec.seed);
+    modlist.presetNames =
+        GenerateSliderPresets(modlist.dataPath / "CalienteTools" / "BodySlide" / "SliderPresets", spec.xmlFiles, rng);
+    GenerateRuleFiles(modlist.dataPath, spec.ruleFiles, spec.rulesPerFile, modlist.presetNames, rng);
+    GenerateOBodyJson(modlist.jsonPath, spec.jsonBytes, modlist.presetNames, rng);
+    WriteFileOrThrow(modlist.iniPath, ConfigIniContent());
+
+    SavePristineCopy(modlist);
+
+    std::ostringstream names;
+    for (const auto& name : modlist.presetNames) names << name << "\n";
+    WriteFileOrThrow(namesPath, names.str());
+    WriteFileOrThrow(signaturePath, signature + "\n");
+
+    return modlist;
+}
+
+void ResetSyntheticModlist(const SyntheticModlist& modlist) {
+    fs::copy_file(modlist.pristinePath / modlist.jsonPath.filename(), modlist.jsonPath,
+                  fs::copy_options::overwrite_existing);
+    fs::copy_file(modlist.pristinePath / modlist.iniPath.filename(), modlist.iniPath,
+                  fs::copy_options::overwrite_existing);
+    CopyRuleFiles(modlist.pristinePath / "rules", modlist.dataPath);
+
+    std::error_code ec;
+    fs::remove_all(modlist.jsonPath.parent_path() / "Backup_OBody_DPA", ec);
+    fs::remove(modlist.iniPath.parent_path() / (modlist.iniPath.stem().string() + "_Frameworks.ini"), ec);
+}
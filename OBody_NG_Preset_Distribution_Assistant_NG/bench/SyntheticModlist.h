@@ -0,0 +1,42 @@
+#pragma once
+
+// Deterministic synthetic modlist for the benchmarks: a Data folder with SliderPresets XMLs,
+// OBodyNG_PDA_*.ini rule files, the OBody JSON and the assistant's own INI, laid out exactly
+// like a game install so the pipeline runs unmodified against it.
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct SyntheticModlistSpec {
+    std::string name;
+    size_t xmlFiles = 1000;
+    size_t ruleFiles = 100;
+    size_t rulesPerFile = 30;
+    size_t jsonBytes = 10 * 1024;
+    std::uint32_t seed = 20240501;
+};
+
+struct SyntheticModlist {
+    fs::path root;
+    fs::path dataPath;
+    fs::path jsonPath;
+    fs::path iniPath;
+    fs::path logPath;
+    fs::path pristinePath;  // Copies of every file the pipeline rewrites
+    std::vector<std::string> presetNames;
+};
+
+// The standard benchmark scenarios: 1k / 10k / 50k XMLs and 10 KB / 5 MB / 50 MB JSON.
+std::vector<SyntheticModlistSpec> StandardScenarios();
+
+// Generates the modlist under root/<spec.name> unless a complete copy with the same spec is
+// already there. The generated files depend only on the spec.
+SyntheticModlist PrepareSyntheticModlist(const fs::path& root, const SyntheticModlistSpec& spec, bool regenerate);
+
+// Restores the JSON and INIs from the pristine copies and removes Backup_OBody_DPA and the
+// framework table, so every run starts from the same inputs with a cold preset catalog.
+void ResetSyntheticModlist(const SyntheticModlist& modlist);
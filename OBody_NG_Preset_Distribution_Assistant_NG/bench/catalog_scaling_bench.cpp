@@ -0,0 +1,134 @@
+// Thread-scaling benchmark for the preset catalog: builds the catalog of a generated
+// SliderPresets folder (20k XMLs by default) without the cache on 1..N workers, and checks
+// that every thread count produces the same entries and the same extraction log.
+//
+//   obody_pda_catalog_bench --xml 20000 --max-threads 8 --iterations 3
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PipelineCore.h"
+#include "SyntheticModlist.h"
+
+namespace {
+
+struct ScalingOptions {
+    fs::path workDir = fs::temp_directory_path() / "obody_pda_bench";
+    size_t xmlFiles = 20000;
+    int maxThreads = 0;  // 0 = hardware threads, capped like Worker_Threads = 0
+    int iterations = 3;
+    bool regenerate = false;
+};
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "  --xml <n>            XMLs in the generated folder (default 20000)" << std::endl;
+    std::cerr << "  --max-threads <n>    highest worker count to time (default: hardware, max 8)" << std::endl;
+    std::cerr << "  --iterations <n>     runs per thread count (default 3)" << std::endl;
+    std::cerr << "  --work <dir>         where the folder is generated" << std::endl;
+    std::cerr << "  --regenerate         rebuild the folder even if present" << std::endl;
+}
+
+bool ParseArguments(int argc, char* argv[], ScalingOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--regenerate") {
+            options.regenerate = true;
+        } else if (arg == "--xml" && hasValue) {
+            options.xmlFiles = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--max-threads" && hasValue) {
+            options.maxThreads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && hasValue) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--work" && hasValue) {
+            options.workDir = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    ScalingOptions options;
+    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    int maxThreads = options.maxThreads;
+    if (maxThreads == 0) {
+        maxThreads = static_cast<int>(std::min(8u, std::max(1u, std::thread::hardware_concurrency())));
+    }
+
+    SyntheticModlistSpec spec;
+    spec.name = "catalog_" + std::to_string(options.xmlFiles);
+    spec.xmlFiles = options.xmlFiles;
+    spec.ruleFiles = 0;
+    spec.jsonBytes = 10 * 1024;
+
+    SyntheticModlist modlist;
+    try {
+        modlist = PrepareSyntheticModlist(options.workDir, spec, options.regenerate);
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+
+    std::cout << "Preset catalog scaling: " << options.xmlFiles << " XMLs, " << options.iterations
+              << " iteration(s) per thread count" << std::endl;
+    std::cout << std::left << std::setw(10) << "threads" << std::right << std::setw(14) << "median ms"
+              << std::setw(10) << "speedup" << std::setw(10) << "presets" << std::endl;
+
+    double singleThreadMs = 0.0;
+    std::uint64_t referenceDigest = 0;
+    bool deterministic = true;
+
+    for (int threads = 1; threads <= maxThreads; ++threads) {
+        std::vector<double> samples;
+        CatalogBenchResult result;
+
+        for (int iteration = 0; iteration < options.iterations; ++iteration) {
+            auto start = std::chrono::steady_clock::now();
+            result = BenchBuildPresetCatalog(modlist.dataPath, threads);
+            samples.push_back(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+            if (threads == 1 && iteration == 0) {
+                referenceDigest = result.digest;
+            } else if (result.digest != referenceDigest) {
+                deterministic = false;
+                std::cerr << "MISMATCH: " << threads << " thread(s) produced a different catalog or log" << std::endl;
+            }
+        }
+
+        std::sort(samples.begin(), samples.end());
+        double median = samples[samples.size() / 2];
+        if (threads == 1) singleThreadMs = median;
+
+        std::cout << std::left << std::setw(10) << threads << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << median << std::setprecision(2) << std::setw(9)
+                  << (median > 0.0 ? singleThreadMs / median : 0.0) << "x" << std::setw(10) << result.presets
+                  << std::endl;
+    }
+
+    std::cout << (deterministic ? "OK: identical catalog and log at every thread count"
+                                : "FAILED: output depends on the thread count")
+              << std::endl;
+    return deterministic ? 0 : 1;
+}
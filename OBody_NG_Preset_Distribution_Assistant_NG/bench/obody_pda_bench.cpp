@@ -0,0 +1,315 @@
+// End-to-end benchmark: runs the full distribution pipeline against synthetic modlists
+// (bench/SyntheticModlist.cpp) and reports the median wall time of every stage and of the
+// whole run. Baselines are plain CSV (scenario,stage,median_ms) so they can be checked in
+// next to the code and compared on every run.
+//
+//   obody_pda_bench --scenario small --iterations 5 --write-baseline bench/baseline.csv
+//   obody_pda_bench --scenario all --baseline bench/baseline.csv --tolerance 0.15
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "PipelineCore.h"
+#include "SyntheticModlist.h"
+
+namespace {
+
+struct BenchOptions {
+    std::string scenario = "small";
+    fs::path workDir = fs::temp_directory_path() / "obody_pda_bench";
+    int iterations = 3;
+    bool regenerate = false;
+    fs::path baselinePath;
+    fs::path writeBaselinePath;
+    double tolerance = 0.10;
+    SyntheticModlistSpec custom;
+    bool hasCustom = false;
+    int workerThreads = -1;  // -1 = keep Worker_Threads from the generated INI
+    int startupBudgetMs = -1;  // -1 = keep Startup_Budget_Ms from the generated INI
+};
+
+// Regressions below this are timer noise on the small scenario, whatever the tolerance.
+constexpr double kRegressionFloorMs = 1.0;
+
+const char* const kTotalStage = "total";
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "  --scenario <small|medium|large|all|custom>  (default small)" << std::endl;
+    std::cerr << "  --xml <n> --ini <n> --json-kb <n>           sizes for --scenario custom" << std::endl;
+    std::cerr << "  --work <dir>                                where modlists are generated" << std::endl;
+    std::cerr << "  --iterations <n>                            runs per scenario (default 3)" << std::endl;
+    std::cerr << "  --regenerate                                rebuild modlists even if present" << std::endl;
+    std::cerr << "  --threads <n>                               override Worker_Threads (0 = automatic)" << std::endl;
+    std::cerr << "  --startup-budget <ms>                       override Startup_Budget_Ms (0 = no budget)" << std::endl;
+    std::cerr << "  --baseline <csv>                            compare medians, exit 1 on regression" << std::endl;
+    std::cerr << "  --write-baseline <csv>                      store medians as the new baseline" << std::endl;
+    std::cerr << "  --tolerance <fraction>                      allowed slowdown (default 0.10)" << std::endl;
+}
+
+double Median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+}
+
+// Stages are keyed "thread/name" so the prescan and pipeline stages stay distinct.
+std::string StageKey(const StageMetric& metric) { return metric.thread + "/" + metric.name; }
+
+struct ScenarioResult {
+    std::string scenario;
+    std::vector<std::string> stageOrder;
+    std::map<std::string, double> medianMs;
+    bool allSucceeded = true;
+};
+
+ScenarioResult RunScenario(const SyntheticModlistSpec& spec, const BenchOptions& options) {
+    ScenarioResult result;
+    result.scenario = spec.name;
+
+    auto generateStart = std::chrono::steady_clock::now();
+    SyntheticModlist modlist = PrepareSyntheticModlist(options.workDir, spec, options.regenerate);
+    double generateMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generateStart).count();
+
+    std::uintmax_t jsonKb = fs::file_size(modlist.pristinePath / modlist.jsonPath.filename()) / 1024;
+    std::cout << "== " << spec.name << ": " << spec.xmlFiles << " XMLs, " << spec.ruleFiles << " rule INIs, " << jsonKb
+              << " KB JSON (ready in " << std::fixed << std::setprecision(0) << generateMs << " ms)" << std::endl;
+
+    PipelinePaths paths =
+        BuildExplicitPipelinePaths(modlist.dataPath, modlist.jsonPath, modlist.iniPath, modlist.logPath);
+    std::map<std::string, std::vector<double>> samples;
+
+    for (int iteration = 0; iteration < options.iterations; ++iteration) {
+        ResetSyntheticModlist(modlist);
+
+        // StartEarlyPreScan is one-shot per process, so the prescan runs inline here; its stages
+        // are still timed individually and reported under "prescan/".
+        std::ofstream logFile(paths.logFilePath, std::ios::out | std::ios::trunc);
+        MarkDataLoaded();
+        WriteLogHeader(logFile);
+        ConfigSettings config = ReadConfigFromIni(paths.configIniPath, logFile);
+        if (options.workerThreads >= 0) config.workerThreads = options.workerThreads;
+        if (options.startupBudgetMs >= 0) config.startupBudgetMs = options.startupBudgetMs;
+
+        std::vector<StageMetric> stages;
+        auto runStart = std::chrono::steady_clock::now();
+        DistributionOutcome outcome = RunDistributionPipelineGuarded(paths, config, logFile, false, &stages);
+        double totalMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+        logFile.close();
+
+        // Startup_Budget_Ms stages run after the timed startup, as they would after the main menu
+        std::vector<StageMetric> deferredStages;
+        RunDeferredStages(&deferredStages);
+        stages.insert(stages.end(), deferredStages.begin(), deferredStages.end());
+
+        if (!outcome.success) {
+            result.allSucceeded = false;
+            std::cerr << "  iteration " << iteration + 1 << " FAILED: " << outcome.consoleMessage << " (see "
+                      << paths.logFilePath.string() << ")" << std::endl;
+        }
+
+        for (const auto& stage : stages) {
+            std::string key = StageKey(stage);
+            if (!samples.count(key)) result.stageOrder.push_back(key);
+            samples[key].push_back(stage.wallMs);
+        }
+        samples[kTotalStage].push_back(totalMs);
+
+        std::cout << "  iteration " << iteration + 1 << ": " << std::setprecision(1) << totalMs << " ms" << std::endl;
+    }
+
+    result.stageOrder.push_back(kTotalStage);
+    for (const auto& [key, values] : samples) {
+        result.medianMs[key] = Median(values);
+    }
+    return result;
+}
+
+void PrintScenario(const ScenarioResult& result) {
+    std::cout << "  " << std::left << std::setw(32) << "stage" << std::right << std::setw(12) << "median ms"
+              << std::endl;
+    for (const auto& key : result.stageOrder) {
+        std::cout << "  " << std::left << std::setw(32) << key << std::right << std::setw(12) << std::fixed
+                  << std::setprecision(2) << result.medianMs.at(key) << std::endl;
+    }
+}
+
+std::map<std::string, double> ReadBaseline(const fs::path& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);  // header
+
+    while (std::getline(file, line)) {
+        std::stringstream fields(line);
+        std::string scenario, stage, value;
+        if (std::getline(fields, scenario, ',') && std::getline(fields, stage, ',') && std::getline(fields, value)) {
+            baseline[scenario + "," + stage] = std::strtod(value.c_str(), nullptr);
+        }
+    }
+    return baseline;
+}
+
+// Rewrites only the scenarios that were run; other rows of an existing baseline are kept.
+bool WriteBaseline(const fs::path& path, const std::vector<ScenarioResult>& results) {
+    std::map<std::string, double> rows = fs::exists(path) ? ReadBaseline(path) : std::map<std::string, double>{};
+    for (const auto& result : results) {
+        for (auto it = rows.begin(); it != rows.end();) {
+            it = it->first.rfind(result.scenario + ",", 0) == 0 ? rows.erase(it) : std::next(it);
+        }
+        for (const auto& [stage, ms] : result.medianMs) {
+            rows[result.scenario + "," + stage] = ms;
+        }
+    }
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file << "scenario,stage,median_ms" << std::endl;
+    for (const auto& [key, ms] : rows) {
+        file << key << "," << std::fixed << std::setprecision(3) << ms << std::endl;
+    }
+    return true;
+}
+
+int CompareWithBaseline(const std::vector<ScenarioResult>& results, const fs::path& path, double tolerance) {
+    if (!fs::exists(path)) {
+        std::cerr << "Baseline not found: " << path.string() << std::endl;
+        return 2;
+    }
+
+    std::map<std::string, double> baseline = ReadBaseline(path);
+    int regressions = 0;
+
+    std::cout << std::endl << "== Baseline comparison (tolerance " << std::setprecision(0) << tolerance * 100 << "%)"
+              << std::endl;
+    for (const auto& result : results) {
+        for (const auto& key : result.stageOrder) {
+            auto it = baseline.find(result.scenario + "," + key);
+            if (it == baseline.end()) continue;
+
+            double current = result.medianMs.at(key);
+            double limit = it->second * (1.0 + tolerance);
+            bool regressed = current > limit && current - it->second > kRegressionFloorMs;
+            if (regressed) ++regressions;
+
+            std::cout << "  " << (regressed ? "REGRESSION " : "ok         ") << std::left << std::setw(8)
+                      << result.scenario << std::setw(32) << key << std::right << std::setprecision(2)
+                      << std::setw(10) << it->second << " -> " << std::setw(10) << current << " ms" << std::endl;
+        }
+    }
+
+    std::cout << (regressions ? "FAILED: " : "OK: ") << regressions << " stage(s) regressed" << std::endl;
+    return regressions ? 1 : 0;
+}
+
+bool ParseArguments(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--regenerate") {
+            options.regenerate = true;
+        } else if (arg == "--scenario" && hasValue) {
+            options.scenario = argv[++i];
+        } else if (arg == "--work" && hasValue) {
+            options.workDir = argv[++i];
+        } else if (arg == "--iterations" && hasValue) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--baseline" && hasValue) {
+            options.baselinePath = argv[++i];
+        } else if (arg == "--write-baseline" && hasValue) {
+            options.writeBaselinePath = argv[++i];
+        } else if (arg == "--threads" && hasValue) {
+            options.workerThreads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--startup-budget" && hasValue) {
+            options.startupBudgetMs = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--tolerance" && hasValue) {
+            options.tolerance = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--xml" && hasValue) {
+            options.custom.xmlFiles = std::strtoul(argv[++i], nullptr, 10);
+            options.hasCustom = true;
+        } else if (arg == "--ini" && hasValue) {
+            options.custom.ruleFiles = std::strtoul(argv[++i], nullptr, 10);
+            options.hasCustom = true;
+        } else if (arg == "--json-kb" && hasValue) {
+            options.custom.jsonBytes = std::strtoul(argv[++i], nullptr, 10) * 1024;
+            options.hasCustom = true;
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<SyntheticModlistSpec> specs;
+    if (options.scenario == "custom" || options.hasCustom) {
+        options.custom.name = "custom";
+        specs.push_back(options.custom);
+    } else {
+        for (const auto& spec : StandardScenarios()) {
+            if (options.scenario == "all" || options.scenario == spec.name) specs.push_back(spec);
+        }
+    }
+    if (specs.empty()) {
+        std::cerr << "Unknown scenario: " << options.scenario << std::endl;
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<ScenarioResult> results;
+    bool allSucceeded = true;
+
+    try {
+        for (const auto& spec : specs) {
+            results.push_back(RunScenario(spec, options));
+            PrintScenario(results.back());
+            allSucceeded = allSucceeded && results.back().allSucceeded;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+
+    if (!allSucceeded) {
+        std::cerr << "Pipeline failed on at least one run - timings are not comparable" << std::endl;
+        return 1;
+    }
+
+    if (!options.writeBaselinePath.empty()) {
+        if (!WriteBaseline(options.writeBaselinePath, results)) {
+            std::cerr << "Could not write baseline: " << options.writeBaselinePath.string() << std::endl;
+            return 2;
+        }
+        std::cout << "Baseline written to " << options.writeBaselinePath.string() << std::endl;
+    }
+
+    if (!options.baselinePath.empty()) {
+        return CompareWithBaseline(results, options.baselinePath, options.tolerance);
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Near-duplicate preset clustering benchmark: generates a SliderPresets folder (10k presets by
+// default) in which every fifth preset is a lightly edited copy of an earlier one, then clusters it
+// with the LSH buckets and with an exhaustive all-pairs comparison. Both must find the planted
+// copies; the exhaustive pass is the reference for what LSH may miss.
+//
+//   obody_pda_cluster_bench --presets 10000 --max-distance 25 --threads 1
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "PipelineCore.h"
+
+namespace {
+
+struct ClusterOptions {
+    fs::path workDir = fs::temp_directory_path() / "obody_pda_bench";
+    size_t presets = 10000;
+    double maxDistance = 25.0;
+    int threads = 1;
+    bool regenerate = false;
+    bool skipExhaustive = false;
+};
+
+const std::vector<std::string> kBodySliders = {
+    "Breasts",      "BreastsSmall",  "BreastsNewSH", "BreastCleavage", "BreastsFantasy", "BreastGravity2",
+    "BreastHeight", "BreastWidth",   "NippleSize",   "NippleLength",   "AreolaSize",     "Butt",
+    "ButtSmall",    "ButtShape2",    "BigButt",      "ChubbyButt",     "AppleCheeks",    "RoundAss",
+    "Hips",         "HipBone",       "HipUpperWidth", "Waist",         "WideWaistLine",  "ChubbyWaist",
+    "Belly",        "BigBelly",      "Thighs",       "ChubbyLegs",     "Legs",           "KneeHeight",
+    "CalfSize",     "Arms",          "ChubbyArms",   "ShoulderWidth",  "ShoulderSmooth", "ShoulderTweak",
+    "Back",         "BackArch",      "NavelEven",    "PushUp",         "SlimThighs",     "SpreadButt"};
+
+// Every fifth preset copies an earlier original and moves three sliders by up to 8 points, which
+// stays well inside the default distance; the originals are uniform over -100..100 and far apart.
+void GenerateClusterPresets(const fs::path& folder, size_t count) {
+    fs::create_directories(folder);
+    std::mt19937 rng(20240612);
+    std::vector<std::vector<int>> originals;
+
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<int> values(kBodySliders.size() * 2);
+        bool copy = i % 5 == 4 && !originals.empty();
+        if (copy) {
+            values = originals[rng() % originals.size()];
+            for (int edit = 0; edit < 3; ++edit) {
+                int& value = values[rng() % values.size()];
+                value += static_cast<int>(rng() % 17) - 8;
+            }
+        } else {
+            for (auto& value : values) value = static_cast<int>(rng() % 201) - 100;
+            originals.push_back(values);
+        }
+
+        std::string name = "Cluster Preset " + std::to_string(i);
+        std::ostringstream xml;
+        xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<SliderPresets>\n";
+        xml << "    <Preset name=\"" << name << "\" set=\"CBBE Body SMP (3BBB)\">\n";
+        xml << "        <Group name=\"CBBE\"/>\n        <Group name=\"3BA\"/>\n";
+        for (size_t s = 0; s < kBodySliders.size(); ++s) {
+            xml << "        <SetSlider name=\"" << kBodySliders[s] << "\" size=\"small\" value=\"" << values[s * 2]
+                << "\"/>\n";
+            xml << "        <SetSlider name=\"" << kBodySliders[s] << "\" size=\"big\" value=\"" << values[s * 2 + 1]
+                << "\"/>\n";
+        }
+        xml << "    </Preset>\n</SliderPresets>\n";
+
+        std::ofstream file(folder / (name + ".xml"), std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("Could not write " + (folder / (name + ".xml")).string());
+        file << xml.str();
+    }
+}
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "  --presets <n>         presets in the generated folder (default 10000)" << std::endl;
+    std::cerr << "  --max-distance <d>    Cluster_Max_Distance (default 25)" << std::endl;
+    std::cerr << "  --threads <n>         worker threads (default 1)" << std::endl;
+    std::cerr << "  --work <dir>          where the folder is generated" << std::endl;
+    std::cerr << "  --regenerate          rebuild the folder even if present" << std::endl;
+    std::cerr << "  --skip-exhaustive     only run the LSH pass" << std::endl;
+}
+
+bool ParseArguments(int argc, char* argv[], ClusterOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--regenerate") {
+            options.regenerate = true;
+        } else if (arg == "--skip-exhaustive") {
+            options.skipExhaustive = true;
+        } else if (arg == "--presets" && hasValue) {
+            options.presets = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--max-distance" && hasValue) {
+            options.maxDistance = std::atof(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--work" && hasValue) {
+            options.workDir = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void PrintRow(const char* label, const ClusterBenchResult& result) {
+    std::cout << std::left << std::setw(12) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << result.clusterMs << std::setw(10) << result.clusters << std::setw(12)
+              << result.clusteredPresets << std::setw(16) << result.distanceChecks << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    ClusterOptions options;
+    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    fs::path dataPath = options.workDir / ("clusters_" + std::to_string(options.presets)) / "Data";
+    fs::path folder = dataPath / "CalienteTools" / "BodySlide" / "SliderPresets";
+    try {
+        if (options.regenerate || !fs::exists(folder)) {
+            std::error_code ec;
+            fs::remove_all(folder, ec);
+            GenerateClusterPresets(folder, options.presets);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+
+    size_t planted = options.presets / 5;
+    std::cout << "Preset clusters: " << options.presets << " presets (" << planted << " planted near-copies), "
+              << "max distance " << options.maxDistance << ", " << options.threads << " thread(s)" << std::endl;
+    std::cout << std::left << std::setw(12) << "pass" << std::right << std::setw(12) << "cluster ms" << std::setw(10)
+              << "clusters" << std::setw(12) << "presets" << std::setw(16) << "dist. checks" << std::endl;
+
+    ClusterBenchResult lsh = BenchClusterPresets(dataPath, options.threads, options.maxDistance, false);
+    PrintRow("lsh", lsh);
+    if (options.skipExhaustive) return 0;
+
+    ClusterBenchResult exhaustive = BenchClusterPresets(dataPath, options.threads, options.maxDistance, true);
+    PrintRow("exhaustive", exhaustive);
+
+    std::cout << "LSH recall: " << lsh.clusteredPresets << " of " << exhaustive.clusteredPresets
+              << " clustered presets, speedup " << std::setprecision(1)
+              << (lsh.clusterMs > 0.0 ? exhaustive.clusterMs / lsh.clusterMs : 0.0) << "x" << std::endl;
+    bool identical = lsh.digest == exhaustive.digest;
+    std::cout << (identical ? "OK: LSH found the same clusters as the exhaustive pass"
+                            : "NOTE: LSH clusters differ from the exhaustive pass")
+              << std::endl;
+    return 0;
+}
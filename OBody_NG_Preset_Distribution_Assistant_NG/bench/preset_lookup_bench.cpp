@@ -0,0 +1,298 @@
+// Smart Cleaning preset lookup benchmark: FindPresetMatch through the interned key index against
+// the previous lookup (kept here verbatim in behavior as the reference): four string-keyed std::map
+// and std::set containers, with a level 3 that re-normalized every preset name for each reference.
+// The reference is far too slow for the full reference list, so it runs on the first
+// --reference-sample references; both must agree on every one of them. Map sizes are heap growth.
+//
+//   obody_pda_lookup_bench --presets 50000 --references 200000 --reference-sample 1000
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PipelineCore.h"
+
+// Defined in plugin.cpp
+std::uint64_t HeapBytesInUse();
+std::string DecodeHtmlEntities(const std::string& str);
+std::string NormalizePresetNameFlexible(const std::string& name);
+std::string ToLowerCase(const std::string& str);
+std::string Trim(const std::string& str);
+
+namespace {
+
+// ===== PREVIOUS LOOKUP =====
+
+struct LegacyPresetMap {
+    std::map<std::string, std::string> exactMap;
+    std::map<std::string, std::string> normalizedMap;
+    std::map<std::string, std::string> filenameToInternalMap;
+    std::set<std::string> allValidNames;
+};
+
+LegacyPresetMap BuildLegacyPresetMap(const std::vector<std::pair<std::string, std::string>>& presets) {
+    LegacyPresetMap map;
+    for (const auto& [filename, internalName] : presets) {
+        std::string presetNameToUse = internalName.empty() ? filename : internalName;
+        if (!internalName.empty()) map.filenameToInternalMap.emplace(filename, internalName);
+
+        map.exactMap[presetNameToUse] = presetNameToUse;
+        map.allValidNames.insert(presetNameToUse);
+        map.allValidNames.insert(filename);
+
+        std::string normalized = NormalizePresetNameFlexible(presetNameToUse);
+        if (!normalized.empty()) map.normalizedMap.emplace(normalized, presetNameToUse);
+        std::string normalizedFilename = NormalizePresetNameFlexible(filename);
+        if (!normalizedFilename.empty()) map.normalizedMap.emplace(normalizedFilename, presetNameToUse);
+    }
+    return map;
+}
+
+std::pair<int, std::string> LegacyFindPresetMatch(const std::string& jsonPresetName, const LegacyPresetMap& map) {
+    if (jsonPresetName.empty()) return {0, ""};
+
+    std::string cleanPresetName = jsonPresetName;
+    if (cleanPresetName[0] == '!') cleanPresetName = cleanPresetName.substr(1);
+
+    auto exactIt = map.exactMap.find(cleanPresetName);
+    if (exactIt != map.exactMap.end()) return {1, exactIt->second};
+
+    std::string decodedCleanName = DecodeHtmlEntities(cleanPresetName);
+    if (decodedCleanName != cleanPresetName) {
+        auto decodedIt = map.exactMap.find(decodedCleanName);
+        if (decodedIt != map.exactMap.end()) return {2, decodedIt->second};
+    }
+
+    std::string normalizedJsonName = NormalizePresetNameFlexible(cleanPresetName);
+    for (const auto& [xmlName, actualName] : map.exactMap) {
+        if (normalizedJsonName == NormalizePresetNameFlexible(xmlName)) return {3, actualName};
+    }
+
+    if (map.allValidNames.count(cleanPresetName)) {
+        auto filenameIt = map.filenameToInternalMap.find(cleanPresetName);
+        return {4, filenameIt != map.filenameToInternalMap.end() ? filenameIt->second : cleanPresetName};
+    }
+
+    if (!normalizedJsonName.empty()) {
+        auto normalizedIt = map.normalizedMap.find(normalizedJsonName);
+        if (normalizedIt != map.normalizedMap.end()) return {5, normalizedIt->second};
+    }
+
+    std::string noSpaces = cleanPresetName;
+    noSpaces.erase(std::remove(noSpaces.begin(), noSpaces.end(), ' '), noSpaces.end());
+    for (const auto& variation : {cleanPresetName, Trim(cleanPresetName), noSpaces, ToLowerCase(cleanPresetName)}) {
+        if (map.allValidNames.count(variation)) return {6, variation};
+    }
+    return {0, ""};
+}
+
+// ===== GENERATED NAMES =====
+
+struct LookupOptions {
+    size_t presets = 50000;
+    size_t references = 200000;
+    size_t referenceSample = 1000;
+};
+
+const std::vector<std::string> kStyles = {"Curvy", "Athletic", "Petite", "Thicc", "Toned", "Slim", "Amazon", "Busty"};
+const std::vector<std::string> kSubjects = {"Nord", "Elf", "Maiden", "Huntress", "Warrior", "Mage", "Noble", "Wench"};
+
+// Internal names are "<Style> <Subject> <n>", some with " & " and some as "<Style>_<Subject>_<n>".
+// A third of the files are named differently from their preset ("CBBE - ..."), and 2% failed
+// extraction.
+std::vector<std::pair<std::string, std::string>> GeneratePresets(size_t count, std::mt19937& rng) {
+    std::vector<std::pair<std::string, std::string>> presets;
+    presets.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const char* separator = i % 10 == 3 ? " & " : (i % 10 == 7 ? "_" : " ");
+        std::string name = kStyles[rng() % kStyles.size()];
+        name += separator + kSubjects[rng() % kSubjects.size()];
+        name += (i % 10 == 7 ? "_" : " ") + std::to_string(i);
+
+        std::string filename = i % 3 == 0 ? "CBBE - " + name : name;
+        presets.emplace_back(filename, i % 50 == 0 ? std::string() : name);
+    }
+    return presets;
+}
+
+// References spread over every lookup level: names as written, entity-encoded, re-cased and
+// hyphenated, filenames, lower-cased filenames, underscore names with a stray space, and misses,
+// half of them names with two adjacent characters swapped.
+std::vector<std::string> GenerateReferences(const std::vector<std::pair<std::string, std::string>>& presets,
+                                            size_t count, std::mt19937& rng) {
+    std::vector<std::string> references;
+    references.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const auto& [filename, internalName] = presets[rng() % presets.size()];
+        const std::string& name = internalName.empty() ? filename : internalName;
+        std::string reference;
+        switch (rng() % 10) {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+                reference = name;
+                break;
+            case 4: {
+                reference = name;
+                size_t amp = reference.find('&');
+                if (amp != std::string::npos) reference.replace(amp, 1, "&amp;");
+                break;
+            }
+            case 5: {
+                reference = ToLowerCase(name);
+                std::replace(reference.begin(), reference.end(), ' ', '-');
+                break;
+            }
+            case 6:
+                reference = filename;
+                break;
+            case 7:
+                reference = ToLowerCase(filename);
+                break;
+            case 8: {
+                reference = name;
+                size_t underscore = reference.rfind('_');
+                if (underscore != std::string::npos) reference.insert(underscore + 1, " ");
+                break;
+            }
+            default:
+                if (i % 2 == 0 && name.size() > 1) {
+                    reference = name;
+                    size_t at = rng() % (reference.size() - 1);
+                    std::swap(reference[at], reference[at + 1]);
+                } else {
+                    reference = "Missing Preset " + std::to_string(i);
+                }
+                break;
+        }
+        if (i % 7 == 0) reference = "!" + reference;
+        references.push_back(std::move(reference));
+    }
+    return references;
+}
+
+std::string FormatMegabytes(std::uint64_t bytes) {
+    if (bytes == 0) return "n/a";
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(1) << bytes / (1024.0 * 1024.0) << " MB";
+    return text.str();
+}
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "  --presets <n>            installed presets (default 50000)" << std::endl;
+    std::cerr << "  --references <n>         referenced preset names to resolve (default 200000)" << std::endl;
+    std::cerr << "  --reference-sample <n>   references also resolved by the previous lookup (default 1000)"
+              << std::endl;
+}
+
+bool ParseArguments(int argc, char* argv[], LookupOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--presets" && hasValue) {
+            options.presets = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--references" && hasValue) {
+            options.references = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--reference-sample" && hasValue) {
+            options.referenceSample = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    LookupOptions options;
+    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    std::mt19937 rng(20240618);
+    auto presets = GeneratePresets(options.presets, rng);
+    auto references = GenerateReferences(presets, options.references, rng);
+    size_t sample = std::min(options.referenceSample, references.size());
+
+    std::cout << "Preset lookup: " << presets.size() << " presets, " << references.size() << " references"
+              << std::endl;
+
+    PresetLookupBenchResult indexed = BenchPresetLookup(presets, references);
+
+    std::vector<size_t> perLevel(7, 0);
+    for (int level : indexed.matchLevels) perLevel[level]++;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Indexed:   build " << indexed.buildMs << " ms, lookup " << indexed.lookupMs << " ms ("
+              << std::setprecision(3)
+              << (references.empty() ? 0.0 : indexed.lookupMs * 1000.0 / references.size()) << " us/reference)"
+              << std::endl;
+    std::cout << "Indexed:   map " << FormatMegabytes(indexed.mapBytes) << " (" << indexed.internedNames
+              << " interned names)" << std::endl;
+    std::cout << "Levels:   ";
+    for (size_t level = 1; level < perLevel.size(); ++level) std::cout << " L" << level << "=" << perLevel[level];
+    std::cout << " not found=" << perLevel[0] << std::endl;
+    std::cout << std::setprecision(1) << "Suggest:   index " << indexed.suggestionBuildMs << " ms, "
+              << indexed.suggested << " of " << indexed.suggestionQueries << " misses suggested in "
+              << indexed.suggestionMs << " ms (" << std::setprecision(3)
+              << (indexed.suggestionQueries ? indexed.suggestionMs * 1000.0 / indexed.suggestionQueries : 0.0)
+              << " us/query)" << std::endl;
+
+    if (sample == 0) return 0;
+
+    std::uint64_t heapBefore = HeapBytesInUse();
+    auto startTime = std::chrono::steady_clock::now();
+    LegacyPresetMap legacyMap = BuildLegacyPresetMap(presets);
+    auto builtTime = std::chrono::steady_clock::now();
+    std::uint64_t heapAfter = HeapBytesInUse();
+    size_t mismatches = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        auto [level, name] = LegacyFindPresetMatch(references[i], legacyMap);
+        if (level != indexed.matchLevels[i] || name != indexed.resolvedNames[i]) {
+            if (mismatches < 5) {
+                std::cout << "MISMATCH '" << references[i] << "': previous L" << level << " '" << name
+                          << "', indexed L" << indexed.matchLevels[i] << " '" << indexed.resolvedNames[i] << "'"
+                          << std::endl;
+            }
+            mismatches++;
+        }
+    }
+    auto finishTime = std::chrono::steady_clock::now();
+
+    double legacyBuildMs = std::chrono::duration<double, std::milli>(builtTime - startTime).count();
+    double legacyPerReferenceUs = std::chrono::duration<double, std::micro>(finishTime - builtTime).count() / sample;
+    double legacyLookupMs = legacyPerReferenceUs * references.size() / 1000.0;
+    std::cout << std::setprecision(1) << "Previous:  build " << legacyBuildMs << " ms, lookup " << legacyLookupMs
+              << " ms projected from " << sample << " references (" << legacyPerReferenceUs << " us/reference)"
+              << std::endl;
+    std::cout << "Previous:  map " << FormatMegabytes(heapAfter > heapBefore ? heapAfter - heapBefore : 0) << std::endl;
+    std::cout << "Lookup speedup: "
+              << (indexed.lookupMs > 0.0 ? legacyLookupMs / indexed.lookupMs : 0.0) << "x" << std::endl;
+
+    if (mismatches > 0) {
+        std::cout << "FAIL: " << mismatches << " of " << sample << " sampled references resolved differently"
+                  << std::endl;
+        return 1;
+    }
+    std::cout << "OK: all " << sample << " sampled references resolved identically" << std::endl;
+    return 0;
+}
@@ -0,0 +1,269 @@
+// Preset XML parsing benchmark: the catalog's single-pass tokenizer against the previous
+// two-function path (ReadFileWithEncoding's normalized copy, then ExtractPresetInfoFromXml and
+// AnalyzeXmlGroups over it), kept here verbatim in behavior as the reference. Files are loaded
+// into memory first, so only parsing is timed.
+//
+//   obody_pda_tokenizer_bench --xml 20000 --iterations 5
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "PipelineCore.h"
+#include "SyntheticModlist.h"
+
+// Defined in plugin.cpp
+std::string DecodeHtmlEntities(const std::string& str);
+std::string Trim(const std::string& str);
+
+namespace {
+
+// ===== LEGACY TWO-FUNCTION PATH =====
+
+std::string LegacyNormalize(const std::string& raw) {
+    std::string content = raw;
+    if (content.size() >= 3 && static_cast<unsigned char>(content[0]) == 0xEF &&
+        static_cast<unsigned char>(content[1]) == 0xBB && static_cast<unsigned char>(content[2]) == 0xBF) {
+        content = content.substr(3);
+    }
+
+    std::string cleaned;
+    cleaned.reserve(content.size());
+    for (size_t i = 0; i < content.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(content[i]);
+        if (c >= 128 && (c & 0xF0) == 0xE0 && i + 2 < content.size()) {
+            unsigned char c2 = static_cast<unsigned char>(content[i + 1]);
+            unsigned char c3 = static_cast<unsigned char>(content[i + 2]);
+            if ((c2 & 0xC0) == 0x80 && (c3 & 0xC0) == 0x80) {
+                int codepoint = ((c & 0x0F) << 12) | ((c2 & 0x3F) << 6) | (c3 & 0x3F);
+                if (codepoint == 0x2018 || codepoint == 0x2019) {
+                    cleaned += '\'';
+                    i += 2;
+                    continue;
+                } else if (codepoint == 0x201C || codepoint == 0x201D) {
+                    cleaned += '"';
+                    i += 2;
+                    continue;
+                } else if (codepoint == 0x2014) {
+                    cleaned += '-';
+                    i += 2;
+                    continue;
+                }
+            }
+        }
+        cleaned += static_cast<char>(c);
+    }
+    return cleaned;
+}
+
+bool LegacyExtractName(const std::string& content, const std::string& filename, std::string& name) {
+    size_t presetPos = content.find("<Preset");
+    if (presetPos == std::string::npos) presetPos = content.find("<preset");
+    if (presetPos == std::string::npos) return false;
+
+    size_t namePos = content.find("name=", presetPos);
+    if (namePos == std::string::npos) return false;
+
+    size_t quoteStart = namePos + 5;
+    while (quoteStart < content.length() && (content[quoteStart] == ' ' || content[quoteStart] == '\t')) {
+        quoteStart++;
+    }
+    if (quoteStart >= content.length()) return false;
+
+    char quoteChar = content[quoteStart];
+    if (quoteChar != '"' && quoteChar != '\'') return false;
+
+    size_t nameEnd = content.find(quoteChar, quoteStart + 1);
+    if (nameEnd == std::string::npos) return false;
+
+    name = DecodeHtmlEntities(content.substr(quoteStart + 1, nameEnd - quoteStart - 1));
+    size_t truncatePos = name.find_first_of(";,");
+    if (truncatePos != std::string::npos) name = Trim(name.substr(0, truncatePos));
+    if (name == "CustomPreset") name = filename;
+    return true;
+}
+
+std::vector<std::string> LegacyGroups(const std::string& content) {
+    std::vector<std::string> groupNames;
+    std::string lowerContent = content;
+    std::transform(lowerContent.begin(), lowerContent.end(), lowerContent.begin(), ::tolower);
+
+    size_t pos = 0;
+    while (pos < lowerContent.length()) {
+        size_t groupStart = lowerContent.find("<group name=", pos);
+        if (groupStart == std::string::npos) break;
+        size_t nameStart = lowerContent.find_first_of("\"'", groupStart);
+        if (nameStart == std::string::npos) break;
+        char quoteChar = lowerContent[nameStart];
+        size_t nameEnd = lowerContent.find(quoteChar, nameStart + 1);
+        if (nameEnd == std::string::npos) break;
+        groupNames.push_back(content.substr(nameStart + 1, nameEnd - nameStart - 1));
+        pos = nameEnd + 1;
+    }
+    return groupNames;
+}
+
+struct LegacyResult {
+    bool extracted = false;
+    std::string name;
+    std::vector<std::string> groups;
+};
+
+LegacyResult LegacyParse(const std::string& raw, const std::string& filename) {
+    LegacyResult result;
+    std::string content = LegacyNormalize(raw);
+    if (content.empty()) return result;
+    result.extracted = LegacyExtractName(content, filename, result.name);
+    result.groups = LegacyGroups(content);
+    return result;
+}
+
+// ===== BENCHMARK =====
+
+struct TokenizerOptions {
+    fs::path workDir = fs::temp_directory_path() / "obody_pda_bench";
+    size_t xmlFiles = 20000;
+    int iterations = 5;
+    bool regenerate = false;
+};
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "  --xml <n>            XMLs in the generated folder (default 20000)" << std::endl;
+    std::cerr << "  --iterations <n>     passes per parser (default 5)" << std::endl;
+    std::cerr << "  --work <dir>         where the folder is generated" << std::endl;
+    std::cerr << "  --regenerate         rebuild the folder even if present" << std::endl;
+}
+
+bool ParseArguments(int argc, char* argv[], TokenizerOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--regenerate") {
+            options.regenerate = true;
+        } else if (arg == "--xml" && hasValue) {
+            options.xmlFiles = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--iterations" && hasValue) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--work" && hasValue) {
+            options.workDir = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+struct LoadedXml {
+    std::string stem;
+    std::string bytes;
+};
+
+template <typename Pass>
+double MedianPassMs(int iterations, Pass pass) {
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        pass();
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    TokenizerOptions options;
+    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    SyntheticModlistSpec spec;
+    spec.name = "catalog_" + std::to_string(options.xmlFiles);
+    spec.xmlFiles = options.xmlFiles;
+    spec.ruleFiles = 0;
+    spec.jsonBytes = 10 * 1024;
+
+    std::vector<LoadedXml> files;
+    std::uint64_t totalBytes = 0;
+    try {
+        SyntheticModlist modlist = PrepareSyntheticModlist(options.workDir, spec, options.regenerate);
+        fs::path folder = modlist.dataPath / "CalienteTools" / "BodySlide" / "SliderPresets";
+        for (const auto& entry : fs::directory_iterator(folder)) {
+            if (entry.path().extension() != ".xml") continue;
+            std::ifstream file(entry.path(), std::ios::binary);
+            LoadedXml loaded;
+            loaded.stem = entry.path().stem().string();
+            loaded.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            totalBytes += loaded.bytes.size();
+            files.push_back(std::move(loaded));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+    std::sort(files.begin(), files.end(), [](const LoadedXml& a, const LoadedXml& b) { return a.stem < b.stem; });
+
+    // Legacy sees only the first preset's name but every group in the file, so agreement
+    // means: same first name, and the same groups once the tokenizer's per-preset lists are joined.
+    size_t legacyPresets = 0;
+    size_t tokenizerPresets = 0;
+    size_t mismatches = 0;
+    for (const auto& file : files) {
+        LegacyResult legacy = LegacyParse(file.bytes, file.stem);
+        std::vector<SliderPresetRecord> records = BenchTokenizeSliderPresets(file.bytes, file.stem);
+        legacyPresets++;
+        tokenizerPresets += records.size();
+
+        std::vector<std::string> joinedGroups;
+        for (const auto& record : records) {
+            joinedGroups.insert(joinedGroups.end(), record.groups.begin(), record.groups.end());
+        }
+        bool sameName = legacy.extracted == records[0].extracted && (!legacy.extracted || legacy.name == records[0].name);
+        if (!sameName || legacy.groups != joinedGroups) {
+            if (mismatches < 10) std::cerr << "MISMATCH: " << file.stem << ".xml" << std::endl;
+            mismatches++;
+        }
+    }
+
+    // Keeps the optimizer from dropping the parse results
+    volatile size_t sink = 0;
+    double legacyMs = MedianPassMs(options.iterations, [&]() {
+        for (const auto& file : files) sink = sink + LegacyParse(file.bytes, file.stem).groups.size();
+    });
+    double tokenizerMs = MedianPassMs(options.iterations, [&]() {
+        for (const auto& file : files) sink = sink + BenchTokenizeSliderPresets(file.bytes, file.stem).size();
+    });
+
+    double megabytes = static_cast<double>(totalBytes) / (1024.0 * 1024.0);
+    std::cout << "Preset XML parsing: " << files.size() << " files, " << std::fixed << std::setprecision(1) << megabytes
+              << " MB, median of " << options.iterations << " pass(es)" << std::endl;
+    std::cout << std::left << std::setw(28) << "parser" << std::right << std::setw(12) << "ms" << std::setw(12)
+              << "MB/s" << std::setw(10) << "presets" << std::endl;
+    std::cout << std::left << std::setw(28) << "legacy (copy+extract+groups)" << std::right << std::setw(12)
+              << legacyMs << std::setw(12) << (legacyMs > 0.0 ? megabytes * 1000.0 / legacyMs : 0.0) << std::setw(10)
+              << legacyPresets << std::endl;
+    std::cout << std::left << std::setw(28) << "tokenizer (single pass)" << std::right << std::setw(12)
+              << tokenizerMs << std::setw(12) << (tokenizerMs > 0.0 ? megabytes * 1000.0 / tokenizerMs : 0.0)
+              << std::setw(10) << tokenizerPresets << std::endl;
+    std::cout << std::setprecision(2) << "speedup: " << (tokenizerMs > 0.0 ? legacyMs / tokenizerMs : 0.0) << "x"
+              << std::endl;
+
+    std::cout << (mismatches ? "FAILED: " : "OK: ") << mismatches << " file(s) where the parsers disagree"
+              << std::endl;
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+// Read backend benchmark for the preset catalog: builds the catalog of a generated SliderPresets
+// folder (20k XMLs by default) without the cache, once with memory-mapped reads and once with the
+// batched asynchronous backend, on a warm page cache and on a cold one. Cold passes evict every
+// XML from the page cache first (posix_fadvise DONTNEED, which needs no privileges on Linux), and
+// both backends must produce the same catalog.
+//
+//   obody_pda_read_bench --xml 20000 --iterations 3 --threads 1
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "PipelineCore.h"
+#include "SyntheticModlist.h"
+
+namespace {
+
+struct ReadOptions {
+    fs::path workDir = fs::temp_directory_path() / "obody_pda_bench";
+    size_t xmlFiles = 20000;
+    int threads = 1;
+    int iterations = 3;
+    bool regenerate = false;
+};
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "  --xml <n>            XMLs in the generated folder (default 20000)" << std::endl;
+    std::cerr << "  --threads <n>        catalog worker threads (default 1)" << std::endl;
+    std::cerr << "  --iterations <n>     runs per backend and cache state (default 3)" << std::endl;
+    std::cerr << "  --work <dir>         where the folder is generated" << std::endl;
+    std::cerr << "  --regenerate         rebuild the folder even if present" << std::endl;
+}
+
+bool ParseArguments(int argc, char* argv[], ReadOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--regenerate") {
+            options.regenerate = true;
+        } else if (arg == "--xml" && hasValue) {
+            options.xmlFiles = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && hasValue) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--work" && hasValue) {
+            options.workDir = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Drops the folder's XMLs from the page cache. Returns false where that is not possible, in which
+// case the cold rows are skipped.
+bool EvictFromPageCache(const fs::path& folder) {
+#if defined(_WIN32)
+    (void)folder;
+    return false;
+#else
+    bool evicted = true;
+    for (const auto& entry : fs::directory_iterator(folder)) {
+        int fd = ::open(entry.path().c_str(), O_RDONLY);
+        if (fd < 0) continue;
+        ::fdatasync(fd);
+        if (::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) != 0) evicted = false;
+        ::close(fd);
+    }
+    return evicted;
+#endif
+}
+
+const char* BackendLabel(ReadBackend backend) { return backend == ReadBackend::Batched ? "batched" : "mapped"; }
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    ReadOptions options;
+    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h")) {
+        PrintUsage(argv[0]);
+        return 0;
+    }
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 2;
+    }
+
+    SyntheticModlistSpec spec;
+    spec.name = "catalog_" + std::to_string(options.xmlFiles);
+    spec.xmlFiles = options.xmlFiles;
+    spec.ruleFiles = 0;
+    spec.jsonBytes = 10 * 1024;
+
+    SyntheticModlist modlist;
+    try {
+        modlist = PrepareSyntheticModlist(options.workDir, spec, options.regenerate);
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 2;
+    }
+    fs::path folder = modlist.dataPath / "CalienteTools" / "BodySlide" / "SliderPresets";
+
+    std::cout << "Preset XML reads: " << options.xmlFiles << " XMLs, " << options.threads << " thread(s), median of "
+              << options.iterations << " run(s)" << std::endl;
+    std::cout << std::left << std::setw(10) << "cache" << std::setw(10) << "backend" << std::right << std::setw(14)
+              << "median ms" << std::setw(10) << "presets" << std::endl;
+
+    std::uint64_t referenceDigest = 0;
+    bool haveReference = false;
+    bool consistent = true;
+
+    for (bool cold : {false, true}) {
+        if (cold && !EvictFromPageCache(folder)) {
+            std::cout << "cold      (page cache eviction unavailable, skipped)" << std::endl;
+            continue;
+        }
+
+        for (ReadBackend backend : {ReadBackend::Mapped, ReadBackend::Batched}) {
+            std::vector<double> samples;
+            CatalogBenchResult result;
+
+            // Warm rows get one untimed pass so the first backend does not pay for the other's misses
+            if (!cold) BenchBuildPresetCatalog(modlist.dataPath, options.threads, backend);
+
+            for (int iteration = 0; iteration < options.iterations; ++iteration) {
+                if (cold) EvictFromPageCache(folder);
+                auto start = std::chrono::steady_clock::now();
+                result = BenchBuildPresetCatalog(modlist.dataPath, options.threads, backend);
+                samples.push_back(
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+                if (!haveReference) {
+                    referenceDigest = result.digest;
+                    haveReference = true;
+                } else if (result.digest != referenceDigest) {
+                    consistent = false;
+                    std::cerr << "MISMATCH: " << BackendLabel(backend) << " backend produced a different catalog"
+                              << std::endl;
+                }
+            }
+
+            std::sort(samples.begin(), samples.end());
+            std::cout << std::left << std::setw(10) << (cold ? "cold" : "warm") << std::setw(10)
+                      << BackendLabel(backend) << std::right << std::fixed << std::setprecision(1) << std::setw(14)
+                      << samples[samples.size() / 2] << std::setw(10) << result.presets << std::endl;
+        }
+    }
+
+    std::cout << (consistent ? "OK: identical catalog from every backend"
+                             : "FAILED: the catalog depends on the read backend")
+              << std::endl;
+    return consistent ? 0 : 1;
+}
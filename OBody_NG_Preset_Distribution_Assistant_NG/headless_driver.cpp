@@ -0,0 +1,119 @@
+// Headless driver: runs the kDataLoaded distribution pipeline outside the game against an
+// explicit Data folder, OBody JSON, config INI and log path. Used for profiling and
+// sanitizer runs on snapshots of real modlists.
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+#include "PipelineCore.h"
+
+namespace {
+
+void PrintUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --data <Data folder> --json <OBody_presetDistributionConfig.json>"
+              << " --ini <OBody_NG_Preset_Distribution_Assistant_NG.ini> --log <main log file>"
+              << " [--watch <seconds>]" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "OBodyNG_PDA_*.ini rules and CalienteTools/BodySlide/SliderPresets are read from --data." << std::endl;
+    std::cerr << "The Doctor, Smart Cleaning, Helper and metrics logs are written next to --log;" << std::endl;
+    std::cerr << "Backup_OBody_DPA is created next to --json, exactly as in the game." << std::endl;
+    std::cerr << "--watch keeps applying SliderPresets and rule file changes for that long (0 = until" << std::endl;
+    std::cerr << "interrupted), as Watch_Mode does in the game." << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::map<std::string, std::string> options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage(argv[0]);
+            return 0;
+        }
+        if ((arg == "--data" || arg == "--json" || arg == "--ini" || arg == "--log" || arg == "--watch") &&
+            i + 1 < argc) {
+            options[arg] = argv[++i];
+        } else {
+            std::cerr << "Unknown or incomplete argument: " << arg << std::endl;
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    for (const char* required : {"--data", "--json", "--ini", "--log"}) {
+        if (!options.count(required)) {
+            std::cerr << "Missing required argument: " << required << std::endl;
+            PrintUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    PipelinePaths paths =
+        BuildExplicitPipelinePaths(options["--data"], options["--json"], options["--ini"], options["--log"]);
+
+    if (!fs::is_directory(paths.dataPath)) {
+        std::cerr << "Data folder not found: " << paths.dataPath.string() << std::endl;
+        return 2;
+    }
+
+    // Same sequence as SKSEPlugin_Load followed by kDataLoaded
+    StartEarlyPreScan(paths);
+
+    CreateDirectoryIfNotExists(paths.sksePluginsPath);
+    CreateDirectoryIfNotExists(paths.logFilePath.parent_path());
+
+    std::ofstream logFile(paths.logFilePath, std::ios::out | std::ios::trunc);
+    if (!logFile.is_open()) {
+        std::cerr << "Could not open log file: " << paths.logFilePath.string() << std::endl;
+        return 2;
+    }
+
+    MarkDataLoaded();
+    WriteLogHeader(logFile);
+
+    logFile << "Reading configuration..." << std::endl;
+    logFile << "----------------------------------------------------" << std::endl;
+    ConfigSettings config = ReadConfigFromIni(paths.configIniPath, logFile);
+
+    if (config.backgroundProcessing) {
+        logFile << std::endl;
+        logFile << "Background_Processing is ignored by the headless driver - running synchronously." << std::endl;
+    }
+
+    // Watch_Mode is ignored here as well: watching is opt-in with --watch, so scripted runs still exit
+    bool watch = options.count("--watch") > 0;
+    config.watchMode = watch;
+
+    DistributionOutcome outcome = RunDistributionPipelineGuarded(paths, config, logFile, false);
+    logFile.close();
+
+    // There is no main menu here: stages deferred by Startup_Budget_Ms run as soon as the log is closed
+    RunDeferredStages();
+
+    std::cout << outcome.consoleMessage << std::endl;
+
+    if (watch) {
+        long seconds = std::strtol(options["--watch"].c_str(), nullptr, 10);
+        StartWatchMode(paths, config, [](const DistributionOutcome& update) {
+            std::cout << "Watch update: " << update.consoleMessage << std::endl;
+        });
+        std::cout << "Watching for changes "
+                  << (seconds > 0 ? "for " + std::to_string(seconds) + " s" : std::string("until interrupted")) << "..."
+                  << std::endl;
+        if (seconds > 0) {
+            std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        } else {
+            while (true) std::this_thread::sleep_for(std::chrono::hours(1));
+        }
+        StopWatchMode();
+    }
+
+    return outcome.success ? 0 : 1;
+}
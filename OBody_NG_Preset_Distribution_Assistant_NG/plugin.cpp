@@ -1,27 +1,80 @@
+#ifndef OBODY_PDA_HEADLESS
 #include <RE/Skyrim.h>
 #include <REL/Relocation.h>
 #include <SKSE/SKSE.h>
+#endif
+#ifdef _WIN32
 #include <shlobj.h>
 #include <windows.h>
 #include <knownfolders.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <dirent.h>
+#if defined(__linux__)
+#include <malloc.h>
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+#endif
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define OBODY_PDA_IO_URING 1
+#endif
+#endif
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OBODY_PDA_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define OBODY_PDA_NEON 1
+#endif
+
+#include "PipelineCore.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <chrono>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <ctime>
+#include <deque>
+#include <exception>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <set>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
-namespace fs = std::filesystem;
-
 // ===== VERSION =====
 static constexpr const char* PLUGIN_VERSION = "2.2.5";
 
@@ -86,6 +139,7 @@ bool StartsWith(const std::string& str, const std::string& prefix) {
 
 // ===== IMPROVED MULTIIDIOMA SUPPORT FUNCTIONS =====
 
+#ifdef _WIN32
 std::string SafeWideStringToString(const std::wstring& wstr) {
     if (wstr.empty()) return std::string();
     
@@ -300,6 +354,7 @@ std::string GetGamePath() {
         return "";
     }
 }
+#endif
 
 void CreateDirectoryIfNotExists(const fs::path& path) {
     try {
@@ -310,73 +365,136 @@ void CreateDirectoryIfNotExists(const fs::path& path) {
     }
 }
 
+std::tm LocalTime(std::time_t time) {
+    std::tm result{};
+#ifdef _WIN32
+    localtime_s(&result, &time);
+#else
+    localtime_r(&time, &result);
+#endif
+    return result;
+}
+
+// Process-wide count of files opened for reading, reported in the run summary.
+std::atomic<size_t> g_filesOpened{0};
+
+// I/O counters for the metrics report. The thread-local copy lets a stage measured on one
+// thread ignore I/O done concurrently by the early prescan on another.
+struct IoCounters {
+    std::uint64_t bytesRead = 0;
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t filesOpened = 0;
+};
+
+std::atomic<std::uint64_t> g_bytesRead{0};
+std::atomic<std::uint64_t> g_bytesWritten{0};
+thread_local IoCounters t_ioCounters;
+
+void RecordFileOpened() {
+    g_filesOpened++;
+    t_ioCounters.filesOpened++;
+}
+
+void RecordBytesRead(std::uint64_t bytes) {
+    g_bytesRead += bytes;
+    t_ioCounters.bytesRead += bytes;
+}
+
+void RecordBytesWritten(std::uint64_t bytes) {
+    g_bytesWritten += bytes;
+    t_ioCounters.bytesWritten += bytes;
+}
+
+// Call before close(): the put position is the number of bytes written to a fresh file.
+void RecordStreamWritten(std::ostream& stream) {
+    auto position = stream.tellp();
+    if (position > 0) RecordBytesWritten(static_cast<std::uint64_t>(position));
+}
+
+void RecordFileCopied(const fs::path& copiedPath) {
+    std::error_code ec;
+    auto size = fs::file_size(copiedPath, ec);
+    if (!ec) RecordBytesWritten(static_cast<std::uint64_t>(size));
+}
+
+// Copies [data, data + size) to out, folding curly quotes and em dashes to ASCII.
+void AppendNormalizedText(std::string& out, const char* data, size_t size) {
+    out.reserve(out.size() + size);
+
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+
+        if (c < 128) {
+            out += c;
+        }
+        else {
+            if ((c & 0xE0) == 0xC0 && i + 1 < size) {
+                unsigned char c2 = static_cast<unsigned char>(data[i + 1]);
+                if ((c2 & 0xC0) == 0x80) {
+                    int codepoint = ((c & 0x1F) << 6) | (c2 & 0x3F);
+                    if (codepoint == 0x2018 || codepoint == 0x2019) {
+                        out += '\'';
+                        i += 1;
+                        continue;
+                    }
+                }
+            }
+            else if ((c & 0xF0) == 0xE0 && i + 2 < size) {
+                unsigned char c2 = static_cast<unsigned char>(data[i + 1]);
+                unsigned char c3 = static_cast<unsigned char>(data[i + 2]);
+                if ((c2 & 0xC0) == 0x80 && (c3 & 0xC0) == 0x80) {
+                    int codepoint = ((c & 0x0F) << 12) | ((c2 & 0x3F) << 6) | (c3 & 0x3F);
+
+                    if (codepoint == 0x2018 || codepoint == 0x2019) {
+                        out += '\'';
+                        i += 2;
+                        continue;
+                    }
+                    else if (codepoint == 0x201C || codepoint == 0x201D) {
+                        out += '"';
+                        i += 2;
+                        continue;
+                    }
+                    else if (codepoint == 0x2014) {
+                        out += '-';
+                        i += 2;
+                        continue;
+                    }
+                }
+            }
+
+            out += c;
+        }
+    }
+}
+
+size_t Utf8BomLength(const char* data, size_t size) {
+    if (size >= 3 &&
+        static_cast<unsigned char>(data[0]) == 0xEF &&
+        static_cast<unsigned char>(data[1]) == 0xBB &&
+        static_cast<unsigned char>(data[2]) == 0xBF) {
+        return 3;
+    }
+    return 0;
+}
+
 std::string ReadFileWithEncoding(const fs::path& filepath) {
     try {
         std::ifstream file(filepath, std::ios::binary);
         if (!file.is_open()) {
             return "";
         }
+        RecordFileOpened();
 
         std::string content((std::istreambuf_iterator<char>(file)),
                            std::istreambuf_iterator<char>());
         file.close();
+        RecordBytesRead(content.size());
 
-        if (content.size() >= 3 &&
-            static_cast<unsigned char>(content[0]) == 0xEF &&
-            static_cast<unsigned char>(content[1]) == 0xBB &&
-            static_cast<unsigned char>(content[2]) == 0xBF) {
-            content = content.substr(3);
-        }
+        size_t bom = Utf8BomLength(content.data(), content.size());
 
         std::string cleaned;
-        cleaned.reserve(content.size());
-        
-        for (size_t i = 0; i < content.size(); ++i) {
-            unsigned char c = static_cast<unsigned char>(content[i]);
-            
-            if (c < 128) {
-                cleaned += c;
-            }
-            else {
-                if ((c & 0xE0) == 0xC0 && i + 1 < content.size()) {
-                    unsigned char c2 = static_cast<unsigned char>(content[i + 1]);
-                    if ((c2 & 0xC0) == 0x80) {
-                        int codepoint = ((c & 0x1F) << 6) | (c2 & 0x3F);
-                        if (codepoint == 0x2018 || codepoint == 0x2019) {
-                            cleaned += '\'';
-                            i += 1;
-                            continue;
-                        }
-                    }
-                }
-                else if ((c & 0xF0) == 0xE0 && i + 2 < content.size()) {
-                    unsigned char c2 = static_cast<unsigned char>(content[i + 1]);
-                    unsigned char c3 = static_cast<unsigned char>(content[i + 2]);
-                    if ((c2 & 0xC0) == 0x80 && (c3 & 0xC0) == 0x80) {
-                        int codepoint = ((c & 0x0F) << 12) | ((c2 & 0x3F) << 6) | (c3 & 0x3F);
-                        
-                        if (codepoint == 0x2018 || codepoint == 0x2019) {
-                            cleaned += '\'';
-                            i += 2;
-                            continue;
-                        }
-                        else if (codepoint == 0x201C || codepoint == 0x201D) {
-                            cleaned += '"';
-                            i += 2;
-                            continue;
-                        }
-                        else if (codepoint == 0x2014) {
-                            cleaned += '-';
-                            i += 2;
-                            continue;
-                        }
-                    }
-                }
-                
-                cleaned += c;
-            }
-        }
-
+        AppendNormalizedText(cleaned, content.data() + bom, content.size() - bom);
         return cleaned;
 
     } catch (const std::exception& e) {
@@ -413,7 +531,7 @@ std::vector<std::string> Split(const std::string& str, char delimiter) {
     return tokens;
 }
 
-std::string EscapeJson(const std::string& str) {
+std::string EscapeJson(std::string_view str) {
     std::string result;
     result.reserve(str.length() * 1.3);
 
@@ -564,2519 +682,6678 @@ std::string DecodeHtmlEntities(const std::string& str) {
     return result;
 }
 
-// ===== IMPROVED XML PRESET EXTRACTION =====
-
-struct XmlPresetInfo {
-    std::string internalName;
-    std::string filename;
-    bool extractionSuccessful;
-};
-
-XmlPresetInfo ExtractPresetInfoFromXml(const fs::path& xmlPath, std::ofstream& logFile) {
-    XmlPresetInfo info;
-    info.extractionSuccessful = false;
-    
-    try {
-        info.filename = xmlPath.stem().string();
-    } catch (...) {
-        try {
-            auto u8name = xmlPath.stem().u8string();
-            info.filename = std::string(u8name.begin(), u8name.end());
-        } catch (...) {
-            info.filename = "unknown";
-            logFile << "  [ERROR] Could not read filename from path" << std::endl;
-            return info;
-        }
-    }
-    
-    try {
-        if (!fs::exists(xmlPath)) {
-            return info;
-        }
-        
-        std::string content = ReadFileWithEncoding(xmlPath);
-        if (content.empty()) {
-            return info;
-        }
-        
-        size_t presetPos = content.find("<Preset");
-        if (presetPos == std::string::npos) {
-            presetPos = content.find("<preset");
-        }
-        
-        if (presetPos == std::string::npos) {
-            return info;
+// ===== MEMORY-MAPPED PRESET READS =====
+
+// Read-only mapping of a whole file, so presets are tokenized in place without copying them
+// into a string first.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // An empty file opens successfully with Size() == 0.
+    bool Open(const fs::path& path) {
+        Close();
+#ifdef _WIN32
+        file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file_, &fileSize)) {
+            Close();
+            return false;
         }
-        
-        size_t namePos = content.find("name=", presetPos);
-        if (namePos == std::string::npos) {
-            return info;
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+        if (size_ == 0) return true;
+
+        mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) {
+            Close();
+            return false;
         }
-        
-        size_t quoteStart = namePos + 5;
-        
-        while (quoteStart < content.length() && 
-               (content[quoteStart] == ' ' || content[quoteStart] == '\t')) {
-            quoteStart++;
+        data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
         }
-        
-        if (quoteStart >= content.length()) {
-            return info;
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ == 0) {
+            ::close(fd);
+            return true;
         }
-        
-        char quoteChar = content[quoteStart];
-        if (quoteChar != '"' && quoteChar != '\'') {
-            return info;
+
+        void* view = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view != MAP_FAILED) data_ = static_cast<const char*>(view);
+#endif
+        if (!data_) {
+            Close();
+            return false;
         }
-        
-        size_t nameStart = quoteStart + 1;
-        size_t nameEnd = content.find(quoteChar, nameStart);
-        
-        if (nameEnd == std::string::npos) {
-            return info;
+        return true;
+    }
+
+    void Close() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const char* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+};
+
+// Sizes of the preset XMLs read for parsing (mapped or batched) and the bytes actually scanned,
+// reported side by side in the run metrics. Scanning stopped at the first <SetSlider> once, but
+// the content hash, the slider dictionary and later <Preset> elements after any slider block
+// need the whole file, so the two are equal today; both stay so the metrics history keeps its
+// columns and shows it if a bounded scan returns.
+std::atomic<std::uint64_t> g_xmlBytesMapped{0};
+std::atomic<std::uint64_t> g_xmlBytesTouched{0};
+
+// ===== BATCHED ASYNCHRONOUS READS =====
+
+// Cold SliderPresets folders are thousands of 5-20 KB files, where a synchronous open/read/close
+// per file leaves the disk idle between requests. ReadFilesBatched keeps a bounded number of
+// reads in flight and hands each buffer to the caller as it completes, so parsing overlaps I/O.
+
+struct BatchedReadFile {
+    fs::path path;
+    std::uintmax_t sizeHint = 0;  // From the directory scan; the file may have changed since
+};
+
+static constexpr size_t BATCHED_READ_QUEUE_DEPTH = 32;
+static constexpr size_t BATCHED_READ_DEFAULT_BUFFER = 64 * 1024;
+
+#ifdef OBODY_PDA_IO_URING
+
+// Minimal io_uring over the raw syscalls (no liburing): one submission and one completion ring,
+// used by one thread at a time.
+class IoUring {
+public:
+    IoUring() = default;
+    ~IoUring() {
+        if (sqes_) ::munmap(sqes_, sqesSize_);
+        if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+        if (sqRing_) ::munmap(sqRing_, sqRingSize_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    bool Init(unsigned entries) {
+        io_uring_params params{};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) return false;
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        sqRing_ = MapRing(sqRingSize_, IORING_OFF_SQ_RING);
+        if (!sqRing_) return false;
+        cqRing_ = singleMmap ? sqRing_ : MapRing(cqRingSize_, IORING_OFF_CQ_RING);
+        if (!cqRing_) return false;
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(MapRing(sqesSize_, IORING_OFF_SQES));
+        if (!sqes_) return false;
+
+        char* sq = static_cast<char*>(sqRing_);
+        char* cq = static_cast<char*>(cqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    unsigned Entries() const { return sqEntries_; }
+
+    // Zeroed entry queued for the next Submit, or nullptr if the submission ring is full.
+    io_uring_sqe* NextSqe() {
+        unsigned tail = *sqTail_;
+        if (tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_) return nullptr;
+        unsigned index = tail & sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        queued_++;
+        return sqe;
+    }
+
+    // Submits everything queued and waits until at least waitFor completions are available.
+    // Returns 0 or the errno of the failure; EAGAIN and EBUSY are transient (kernel short of
+    // memory, completion ring full) and clear once the caller reaps completions.
+    int Submit(unsigned waitFor) { return Enter(queued_, waitFor); }
+
+    // Waits for a completion without submitting anything queued.
+    int Wait(unsigned waitFor) { return Enter(0, waitFor); }
+
+    // Entries queued but not yet taken by the kernel.
+    unsigned Queued() const { return queued_; }
+
+    // Drops queued entries the kernel has not taken, so a later Submit cannot start them.
+    void DiscardQueued() {
+        __atomic_store_n(sqTail_, *sqTail_ - queued_, __ATOMIC_RELEASE);
+        queued_ = 0;
+    }
+
+    bool HasCompletion() const { return *cqHead_ != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE); }
+
+    bool PopCompletion(io_uring_cqe& completion) {
+        unsigned head = *cqHead_;
+        if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) return false;
+        completion = cqes_[head & cqMask_];
+        __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    int Enter(unsigned toSubmit, unsigned waitFor) {
+        while (true) {
+            long submitted = ::syscall(__NR_io_uring_enter, fd_, toSubmit, waitFor,
+                                       waitFor ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (submitted >= 0) {
+                queued_ -= static_cast<unsigned>(submitted);
+                return 0;
+            }
+            if (errno != EINTR) return errno;
         }
-        
-        info.internalName = content.substr(nameStart, nameEnd - nameStart);
-        
-        info.internalName = DecodeHtmlEntities(info.internalName);
+    }
+
+    void* MapRing(size_t size, off_t offset) {
+        void* ring = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return ring == MAP_FAILED ? nullptr : ring;
+    }
 
-// === MODIFICACIÓN 1: Truncar nombres en ';' o ',' ===
-size_t semicolonPos = info.internalName.find(';');
-size_t commaPos = info.internalName.find(',');
-size_t truncatePos = std::string::npos;
+    int fd_ = -1;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqesSize_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqEntries_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned queued_ = 0;
+};
 
-if (semicolonPos != std::string::npos && commaPos != std::string::npos) {
-    truncatePos = std::min(semicolonPos, commaPos);
-} else if (semicolonPos != std::string::npos) {
-    truncatePos = semicolonPos;
-} else if (commaPos != std::string::npos) {
-    truncatePos = commaPos;
+// Set once io_uring_setup fails (old kernel, seccomp), so later batches go straight to sync reads.
+std::atomic<bool> g_ioUringUnavailable{false};
+
+// One ring per thread, created on first use and kept for the life of the thread.
+IoUring* ThreadIoUring() {
+    thread_local std::unique_ptr<IoUring> ring;
+    thread_local bool failed = false;
+    if (failed || g_ioUringUnavailable) return nullptr;
+    if (ring) return ring.get();
+
+    auto created = std::make_unique<IoUring>();
+    if (!created->Init(static_cast<unsigned>(BATCHED_READ_QUEUE_DEPTH))) {
+        failed = true;
+        g_ioUringUnavailable = true;
+        return nullptr;
+    }
+    ring = std::move(created);
+    return ring.get();
 }
 
-if (truncatePos != std::string::npos) {
-    info.internalName = info.internalName.substr(0, truncatePos);
-    info.internalName = Trim(info.internalName); // Remove trailing spaces
+#endif
+
+const char* BatchedReadBackendName() {
+#if defined(_WIN32)
+    return "overlapped I/O on a completion port";
+#elif defined(OBODY_PDA_IO_URING)
+    return g_ioUringUnavailable ? "synchronous reads (io_uring unavailable)" : "io_uring";
+#else
+    return "synchronous reads";
+#endif
 }
 
-// === MODIFICACIÓN 2: Reemplazar 'CustomPreset' con filename ===
-if (info.internalName == "CustomPreset") {
-    info.internalName = info.filename;
-    logFile << "INFO: Replaced generic 'CustomPreset' with filename: "
-            << info.filename << std::endl;
+bool BatchedReadsAvailable() {
+#if defined(_WIN32)
+    return true;
+#elif defined(OBODY_PDA_IO_URING)
+    return ThreadIoUring() != nullptr;
+#else
+    return false;
+#endif
 }
 
-        info.filename = DecodeHtmlEntities(info.filename);
-        
-        info.extractionSuccessful = true;
-        return info;
-        
-    } catch (...) {
-        return info;
-    }
+// Auto prefers the batched path only where a real asynchronous backend exists; elsewhere the
+// mapped reads are as fast and skip the copy.
+bool UseBatchedReads(ReadBackend backend) {
+    return backend == ReadBackend::Batched || (backend == ReadBackend::Auto && BatchedReadsAvailable());
 }
 
-std::string ExtractPresetNameFromXml(const fs::path& xmlPath, std::ofstream& logFile) {
-    XmlPresetInfo info = ExtractPresetInfoFromXml(xmlPath, logFile);
-    
-    if (info.extractionSuccessful && !info.internalName.empty()) {
-        return info.internalName;
+const char* ReadBackendDescription(ReadBackend backend) {
+    return UseBatchedReads(backend) ? BatchedReadBackendName() : "memory mapping";
+}
+
+// Whole-file read with the standard library, for platforms without a batched backend and for
+// files the batched path could not open asynchronously.
+bool ReadWholeFileSync(const fs::path& path, std::uintmax_t sizeHint, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    RecordFileOpened();
+
+    data.clear();
+    data.reserve(static_cast<size_t>(sizeHint));
+    char buffer[65536];
+    while (file) {
+        file.read(buffer, sizeof(buffer));
+        std::streamsize got = file.gcount();
+        if (got <= 0) break;
+        data.append(buffer, static_cast<size_t>(got));
     }
-    
-    return info.filename;
+    RecordBytesRead(data.size());
+    return !file.bad();
 }
 
-struct ParsedRule {
-    std::string key;
-    std::string plugin;
-    std::vector<std::string> presets;
-    std::string extra;
-    int applyCount = -1;
-};
+// Reads every file whole with up to queueDepth reads in flight and calls onFile(index, data, ok)
+// on the calling thread as each completes, in completion order. onFile may move data out. It must
+// not throw: exceptions are swallowed so that buffers the kernel still writes into stay alive.
+void ReadFilesBatched(const std::vector<BatchedReadFile>& files, size_t queueDepth,
+                      const std::function<void(size_t index, std::string& data, bool ok)>& onFile) {
+    auto deliver = [&](size_t index, std::string& data, bool ok) {
+        try {
+            onFile(index, data, ok);
+        } catch (...) {
+        }
+    };
+    queueDepth = std::max<size_t>(1, std::min(queueDepth, files.size()));
+
+#if defined(OBODY_PDA_IO_URING)
+    IoUring* ring = files.empty() ? nullptr : ThreadIoUring();
+    if (ring) {
+        queueDepth = std::min<size_t>(queueDepth, ring->Entries());
+
+        // Each slot has at most one operation in flight: user_data is slot * 2 + (0 open, 1 read)
+        struct Slot {
+            size_t file = 0;
+            std::string path;
+            std::string data;
+            int fd = -1;
+            size_t offset = 0;
+        };
+        std::vector<Slot> slots(queueDepth);
+        std::vector<char> delivered(files.size(), 0);
+        size_t nextFile = 0;
+        size_t inFlight = 0;
+
+        auto startRead = [&](size_t slotIndex) {
+            Slot& slot = slots[slotIndex];
+            if (slot.offset == slot.data.size()) slot.data.resize(std::max<size_t>(slot.data.size() * 2, 4096));
+            io_uring_sqe* sqe = ring->NextSqe();
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = slot.fd;
+            sqe->addr = reinterpret_cast<std::uint64_t>(slot.data.data() + slot.offset);
+            sqe->len = static_cast<std::uint32_t>(slot.data.size() - slot.offset);
+            sqe->off = slot.offset;
+            sqe->user_data = slotIndex * 2 + 1;
+        };
 
-ParsedRule ParseRuleLine(const std::string& key, const std::string& value) {
-    ParsedRule rule;
-    rule.key = key;
+        auto startNext = [&](size_t slotIndex) {
+            if (nextFile >= files.size()) return;
+            Slot& slot = slots[slotIndex];
+            slot.file = nextFile++;
+            slot.path = files[slot.file].path.string();
+            slot.fd = -1;
+            slot.offset = 0;
+            // One byte past the expected size, so an unchanged file ends on its first short read
+            size_t hint = static_cast<size_t>(files[slot.file].sizeHint);
+            slot.data.assign(hint ? hint + 1 : BATCHED_READ_DEFAULT_BUFFER, '\0');
+
+            io_uring_sqe* sqe = ring->NextSqe();
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<std::uint64_t>(slot.path.c_str());
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            sqe->user_data = slotIndex * 2;
+            inFlight++;
+        };
 
-    std::vector<std::string> parts = Split(value, '|');
-    if (parts.size() >= 2) {
-        rule.plugin = Trim(parts[0]);
-        rule.presets = Split(parts[1], ',');
+        auto finish = [&](size_t slotIndex, bool ok) {
+            Slot& slot = slots[slotIndex];
+            if (slot.fd >= 0) ::close(slot.fd);
+            slot.fd = -1;
+            slot.data.resize(ok ? slot.offset : 0);
+            if (ok) RecordBytesRead(slot.offset);
+            inFlight--;
+            delivered[slot.file] = 1;
+            deliver(slot.file, slot.data, ok);
+            startNext(slotIndex);
+        };
 
-        if (parts.size() >= 3) {
-            rule.extra = Trim(parts[2]);
-            if (rule.extra.empty()) {
-                rule.applyCount = -1;
-            } else if (rule.extra == "x" || rule.extra == "X") {
-                rule.applyCount = -1;
-            } else if (rule.extra == "x-" || rule.extra == "X-") {
-                rule.applyCount = -4;
-            } else if (rule.extra == "x*" || rule.extra == "X*") {
-                rule.applyCount = -5;
-            } else if (rule.extra == "-") {
-                rule.applyCount = -2;
-            } else if (rule.extra == "*") {
-                rule.applyCount = -3;
-            } else {
-                try {
-                    rule.applyCount = std::stoi(rule.extra);
-                    if (rule.applyCount != 0 && rule.applyCount != 1) {
-                        rule.applyCount = 0;
+        for (size_t i = 0; i < queueDepth; ++i) startNext(i);
+
+        io_uring_cqe completion{};
+        int error = 0;
+        while (inFlight > 0) {
+            error = ring->Submit(1);
+            if (error == EAGAIN || error == EBUSY) {
+                // Reap what has completed and submit again; with nothing ready, wait for an
+                // operation the kernel already holds, or yield if it holds none yet
+                error = 0;
+                if (!ring->HasCompletion()) {
+                    if (inFlight > ring->Queued()) {
+                        error = ring->Wait(1);
+                        if (error == EAGAIN || error == EBUSY) error = 0;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            if (error != 0) break;
+
+            while (ring->PopCompletion(completion)) {
+                size_t slotIndex = static_cast<size_t>(completion.user_data / 2);
+                bool isRead = (completion.user_data & 1) != 0;
+                Slot& slot = slots[slotIndex];
+
+                if (!isRead) {
+                    // Kernels without IORING_OP_OPENAT answer -EINVAL: open synchronously instead
+                    slot.fd = completion.res >= 0 ? completion.res
+                              : completion.res == -EINVAL ? ::open(slot.path.c_str(), O_RDONLY | O_CLOEXEC)
+                                                          : -1;
+                    if (slot.fd < 0) {
+                        finish(slotIndex, false);
+                        continue;
+                    }
+                    RecordFileOpened();
+                    startRead(slotIndex);
+                } else if (completion.res < 0) {
+                    finish(slotIndex, false);
+                } else {
+                    // Regular files only read short at end of file
+                    size_t got = static_cast<size_t>(completion.res);
+                    size_t requested = slot.data.size() - slot.offset;
+                    slot.offset += got;
+                    if (got == 0 || got < requested) {
+                        finish(slotIndex, true);
+                    } else {
+                        startRead(slotIndex);
                     }
-                } catch (...) {
-                    rule.applyCount = 0;
                 }
             }
-        } else {
-            rule.applyCount = -1;
         }
-    }
 
-    return rule;
-}
-
-struct OrderedPluginData {
-    std::vector<std::pair<std::string, std::vector<std::string>>> orderedData;
+        if (inFlight == 0) return;
 
-    void addPreset(const std::string& plugin, const std::string& preset) {
-        auto it = std::find_if(orderedData.begin(), orderedData.end(),
-                               [&plugin](const auto& pair) { return pair.first == plugin; });
-        if (it == orderedData.end()) {
-            orderedData.emplace_back(plugin, std::vector<std::string>{preset});
-            orderedData.back().second.reserve(20);
-        } else {
-            auto& presets = it->second;
-            if (std::find(presets.begin(), presets.end(), preset) == presets.end()) {
-                presets.push_back(preset);
+        // io_uring_enter failed for good. Entries still queued never reached the kernel, but the
+        // ones it took may still write into the slot buffers, so reap every one of them before
+        // the slots go away, then finish the undelivered files synchronously
+        inFlight -= ring->Queued();
+        ring->DiscardQueued();
+        while (inFlight > 0) {
+            while (inFlight > 0 && ring->PopCompletion(completion)) {
+                bool isOpen = (completion.user_data & 1) == 0;
+                if (isOpen && completion.res >= 0) ::close(completion.res);
+                inFlight--;
             }
+            if (inFlight == 0) break;
+            int waitError = ring->Wait(1);
+            if (waitError != 0 && waitError != EAGAIN && waitError != EBUSY) {
+                // The ring cannot even be waited on: keep the buffers alive for good and stop
+                // using io_uring rather than risk the kernel writing into freed memory
+                g_ioUringUnavailable = true;
+                static_cast<void>(new std::vector<Slot>(std::move(slots)));
+                break;
+            }
+        }
+
+        std::string data;
+        for (auto& slot : slots) {
+            if (slot.fd >= 0) ::close(slot.fd);
+            slot.fd = -1;
         }
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (delivered[i]) continue;
+            bool ok = ReadWholeFileSync(files[i].path, files[i].sizeHint, data);
+            deliver(i, data, ok);
+        }
+        return;
     }
+#elif defined(_WIN32)
+    if (!files.empty()) {
+        HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+        if (port) {
+            struct Slot {
+                OVERLAPPED overlapped{};
+                size_t file = 0;
+                HANDLE handle = INVALID_HANDLE_VALUE;
+                std::string data;
+            };
+            std::vector<Slot> slots(queueDepth);
+            std::vector<char> delivered(files.size(), 0);
+            size_t nextFile = 0;
+            size_t inFlight = 0;
+
+            auto finish = [&](Slot& slot, bool ok) {
+                delivered[slot.file] = 1;
+                deliver(slot.file, slot.data, ok);
+            };
 
-    void removePreset(const std::string& plugin, const std::string& preset) {
-        auto it = std::find_if(orderedData.begin(), orderedData.end(),
-                               [&plugin](const auto& pair) { return pair.first == plugin; });
-        if (it != orderedData.end()) {
-            auto& presets = it->second;
-            auto presetIt = std::find_if(presets.begin(), presets.end(), [&preset](const std::string& p) {
-                std::string strippedP = p;
-                if (!strippedP.empty() && strippedP[0] == '!') {
-                    strippedP = strippedP.substr(1);
+            // Opening is synchronous on Windows; only the reads are overlapped
+            std::function<void(size_t)> startNext = [&](size_t slotIndex) {
+                while (nextFile < files.size()) {
+                    Slot& slot = slots[slotIndex];
+                    slot.file = nextFile++;
+                    slot.handle = CreateFileW(files[slot.file].path.c_str(), GENERIC_READ,
+                                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                              OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN,
+                                              nullptr);
+                    LARGE_INTEGER fileSize{};
+                    bool ok = slot.handle != INVALID_HANDLE_VALUE && GetFileSizeEx(slot.handle, &fileSize) &&
+                              fileSize.QuadPart < 0x7FFFFFFF &&
+                              CreateIoCompletionPort(slot.handle, port, static_cast<ULONG_PTR>(slotIndex), 0);
+                    if (ok) {
+                        RecordFileOpened();
+                        slot.data.assign(static_cast<size_t>(fileSize.QuadPart), '\0');
+                        if (slot.data.empty()) {
+                            CloseHandle(slot.handle);
+                            slot.handle = INVALID_HANDLE_VALUE;
+                            finish(slot, true);
+                            continue;
+                        }
+                        slot.overlapped = OVERLAPPED{};
+                        if (ReadFile(slot.handle, slot.data.data(), static_cast<DWORD>(slot.data.size()), nullptr,
+                                     &slot.overlapped) ||
+                            GetLastError() == ERROR_IO_PENDING) {
+                            inFlight++;
+                            return;
+                        }
+                    }
+                    if (slot.handle != INVALID_HANDLE_VALUE) CloseHandle(slot.handle);
+                    slot.handle = INVALID_HANDLE_VALUE;
+                    slot.data.clear();
+                    finish(slot, false);
+                }
+            };
+
+            for (size_t i = 0; i < queueDepth; ++i) startNext(i);
+
+            while (inFlight > 0) {
+                DWORD bytes = 0;
+                ULONG_PTR key = 0;
+                LPOVERLAPPED overlapped = nullptr;
+                BOOL ok = GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, INFINITE);
+                if (!overlapped) break;  // The port itself failed
+
+                Slot& slot = slots[static_cast<size_t>(key)];
+                inFlight--;
+                CloseHandle(slot.handle);
+                slot.handle = INVALID_HANDLE_VALUE;
+                slot.data.resize(ok ? bytes : 0);
+                if (ok) RecordBytesRead(bytes);
+                finish(slot, ok != FALSE);
+                startNext(static_cast<size_t>(key));
+            }
+
+            if (inFlight > 0) {
+                // The port failed with reads still in flight, which write into the slot buffers and
+                // OVERLAPPEDs: cancel them and reap every completion before the slots go away
+                for (auto& slot : slots) {
+                    if (slot.handle != INVALID_HANDLE_VALUE) CancelIoEx(slot.handle, nullptr);
                 }
-                std::string strippedTarget = preset;
-                if (!strippedTarget.empty() && strippedTarget[0] == '!') {
-                    strippedTarget = strippedTarget.substr(1);
+                while (inFlight > 0) {
+                    DWORD bytes = 0;
+                    ULONG_PTR key = 0;
+                    LPOVERLAPPED overlapped = nullptr;
+                    GetQueuedCompletionStatus(port, &bytes, &key, &overlapped, INFINITE);
+                    if (!overlapped) break;
+                    Slot& slot = slots[static_cast<size_t>(key)];
+                    CloseHandle(slot.handle);
+                    slot.handle = INVALID_HANDLE_VALUE;
+                    inFlight--;
                 }
-                return strippedP == strippedTarget;
-            });
-            if (presetIt != presets.end()) {
-                presets.erase(presetIt);
-                if (presets.empty()) {
-                    orderedData.erase(it);
+                for (auto& slot : slots) {
+                    if (slot.handle != INVALID_HANDLE_VALUE) CloseHandle(slot.handle);
+                    slot.handle = INVALID_HANDLE_VALUE;
                 }
+                if (inFlight > 0) {
+                    // The port cannot even be drained: keep the buffers alive for good rather than
+                    // risk the kernel writing into freed memory
+                    static_cast<void>(new std::vector<Slot>(std::move(slots)));
+                }
+            }
+            CloseHandle(port);
+
+            // Files the port never delivered, in flight or not yet started, are read synchronously
+            std::string data;
+            for (size_t i = 0; i < files.size(); ++i) {
+                if (delivered[i]) continue;
+                bool ok = ReadWholeFileSync(files[i].path, files[i].sizeHint, data);
+                deliver(i, data, ok);
             }
+            return;
         }
     }
+#endif
 
-    void removePlugin(const std::string& plugin) {
-        auto it = std::find_if(orderedData.begin(), orderedData.end(),
-                               [&plugin](const auto& pair) { return pair.first == plugin; });
-        if (it != orderedData.end()) {
-            orderedData.erase(it);
-        }
+    std::string data;
+    for (size_t i = 0; i < files.size(); ++i) {
+        bool ok = ReadWholeFileSync(files[i].path, files[i].sizeHint, data);
+        deliver(i, data, ok);
     }
+}
 
-    bool hasPlugin(const std::string& plugin) const {
-        return std::any_of(orderedData.begin(), orderedData.end(),
-                           [&plugin](const auto& pair) { return pair.first == plugin; });
-    }
+// ===== BODY FRAMEWORK TABLE =====
 
-    size_t getPluginCount() const { return orderedData.size(); }
+// Which body framework a BodySlide <Group> name belongs to comes from a table file next to the
+// plugin INI, so new frameworks need no code change. Every pattern of every framework is
+// compiled into one case-insensitive Aho-Corasick automaton and each group name is classified
+// in a single pass, whatever the number of patterns.
+enum class FrameworkRole { UBE, Conflict, Info };
 
-    size_t getTotalPresetCount() const {
-        size_t count = 0;
-        for (const auto& [plugin, presets] : orderedData) {
-            count += presets.size();
-        }
-        return count;
-    }
+struct FrameworkDefinition {
+    std::string name;
+    FrameworkRole role = FrameworkRole::Info;
+    std::vector<std::string> patterns;
 };
 
-struct ConfigSettings {
-    int backupValue = 1;
-    bool modeUBE = true;
-    bool presetsSmartCleaning = false;
-    bool blacklistedPresetsSmartCleaningFromRandomDistribution = false;
-    bool blacklistedPresetsSmartCleaningFromAll = false;
-    bool outfitsForceReSmartCleaning = false;
+// Anchors are compiled as sentinel bytes that MatchFrameworks puts around every name.
+static constexpr unsigned char FRAMEWORK_ANCHOR_START = 0x02;
+static constexpr unsigned char FRAMEWORK_ANCHOR_END = 0x03;
+
+struct FrameworkClassifier {
+    std::vector<FrameworkDefinition> frameworks;
+    std::vector<std::array<std::int32_t, 256>> transitions;  // Complete DFA: failure links folded in
+    std::vector<std::vector<std::uint16_t>> outputs;  // Frameworks matched on entering each state
+    size_t patternCount = 0;
 };
 
-ConfigSettings ReadConfigFromIni(const fs::path& iniPath, std::ofstream& logFile) {
-    ConfigSettings settings;
-    
-    try {
-        if (!fs::exists(iniPath)) {
-            logFile << "Creating config INI at: " << iniPath.string() << std::endl;
-            std::ofstream createIni(iniPath, std::ios::out | std::ios::trunc);
-            if (createIni.is_open()) {
-                createIni << "[Original backup]" << std::endl;
-                createIni << "Backup = 1" << std::endl;
-                createIni << std::endl;
-                createIni << "[blacklistedPresetsShowInOBodyMenu]" << std::endl;
-                createIni << "ModeUBE = true" << std::endl;
-                createIni << std::endl;
-                createIni << "[Presets_Smart_Cleaning]" << std::endl;
-                createIni << "Smart_Cleaning = false" << std::endl;
-                createIni << std::endl;
-                createIni << "[blacklistedPresets_Smart_Cleaning_FromRandomDistribution]" << std::endl;
-                createIni << "Smart_Cleaning = false" << std::endl;
-                createIni << std::endl;
-                createIni << "[blacklistedPresets_Smart_Cleaning_FromAll]" << std::endl;
-                createIni << "Smart_Cleaning = false" << std::endl;
-                createIni << std::endl;
-                createIni << "[outfitsForceRe_Smart_Cleaning]" << std::endl;
-                createIni << "Smart_Cleaning = false" << std::endl;
-                createIni.close();
-                logFile << "SUCCESS: Config INI created with default values" << std::endl;
-                settings.backupValue = 1;
-                settings.modeUBE = true;
-                settings.presetsSmartCleaning = false;
-                settings.blacklistedPresetsSmartCleaningFromRandomDistribution = false;
-                settings.blacklistedPresetsSmartCleaningFromAll = false;
-                settings.outfitsForceReSmartCleaning = false;
-                return settings;
-            } else {
-                logFile << "ERROR: Could not create config INI file" << std::endl;
-                return settings;
+const char* const DEFAULT_FRAMEWORK_TABLE =
+    "; Body frameworks recognized in BodySlide <Group> names. Edit freely; delete this file to\n"
+    "; get the defaults back.\n"
+    ";\n"
+    ";   Name = role : pattern | pattern ...\n"
+    ";\n"
+    "; role      ube       a matching group marks the preset as UBE\n"
+    ";           conflict  a body that conflicts with UBE; UBE presets with it are reported\n"
+    ";           info      recognized only\n"
+    "; pattern   matched case-insensitively anywhere in the group name. A leading ^ anchors it\n"
+    ";           to the start of the name and a trailing $ to the end, so ^ube$ is the whole name.\n"
+    "\n"
+    "[Frameworks]\n"
+    "UBE = ube : ^ube$\n"
+    "3BA = conflict : 3ba\n"
+    "3BBB = conflict : 3bbb\n"
+    "CBBE = conflict : cbbe\n"
+    "BHUNP = info : bhunp\n"
+    "HIMBO = info : himbo\n"
+    "SOS = info : ^sos | schlong\n";
+
+FrameworkClassifier BuildFrameworkClassifier(std::vector<FrameworkDefinition> frameworks) {
+    FrameworkClassifier classifier;
+    classifier.frameworks = std::move(frameworks);
+
+    std::array<std::int32_t, 256> empty;
+    empty.fill(-1);
+    classifier.transitions.push_back(empty);
+    classifier.outputs.emplace_back();
+
+    // Trie of every pattern
+    for (size_t id = 0; id < classifier.frameworks.size(); ++id) {
+        for (const auto& pattern : classifier.frameworks[id].patterns) {
+            std::int32_t state = 0;
+            for (unsigned char c : pattern) {
+                std::int32_t& next = classifier.transitions[state][c];
+                if (next < 0) {
+                    next = static_cast<std::int32_t>(classifier.transitions.size());
+                    classifier.transitions.push_back(empty);
+                    classifier.outputs.emplace_back();
+                }
+                state = classifier.transitions[state][c];
             }
+            auto& output = classifier.outputs[state];
+            if (std::find(output.begin(), output.end(), id) == output.end()) {
+                output.push_back(static_cast<std::uint16_t>(id));
+            }
+            classifier.patternCount++;
         }
+    }
 
-        std::string content = ReadFileWithEncoding(iniPath);
-        if (content.empty()) {
-            logFile << "ERROR: Could not read config INI file" << std::endl;
-            return settings;
+    // Breadth-first: fill missing transitions from the failure state and inherit its outputs
+    std::vector<std::int32_t> failure(classifier.transitions.size(), 0);
+    std::deque<std::int32_t> queue;
+    for (int c = 0; c < 256; ++c) {
+        std::int32_t& next = classifier.transitions[0][c];
+        if (next < 0) {
+            next = 0;
+        } else {
+            failure[next] = 0;
+            queue.push_back(next);
         }
+    }
 
-        std::stringstream ss(content);
-        std::string line;
-        std::string currentSection;
-
-        while (std::getline(ss, line)) {
-            std::string trimmedLine = Trim(line);
+    while (!queue.empty()) {
+        std::int32_t state = queue.front();
+        queue.pop_front();
 
-            if (trimmedLine.empty() || trimmedLine[0] == ';' || trimmedLine[0] == '#') {
-                continue;
-            }
+        for (std::uint16_t id : classifier.outputs[failure[state]]) {
+            auto& output = classifier.outputs[state];
+            if (std::find(output.begin(), output.end(), id) == output.end()) output.push_back(id);
+        }
 
-            if (trimmedLine[0] == '[' && trimmedLine.back() == ']') {
-                currentSection = trimmedLine.substr(1, trimmedLine.length() - 2);
-                continue;
+        for (int c = 0; c < 256; ++c) {
+            std::int32_t& next = classifier.transitions[state][c];
+            if (next < 0) {
+                next = classifier.transitions[failure[state]][c];
+            } else {
+                failure[next] = classifier.transitions[failure[state]][c];
+                queue.push_back(next);
             }
+        }
+    }
 
-            size_t equalPos = trimmedLine.find('=');
-            if (equalPos != std::string::npos) {
-                std::string key = Trim(trimmedLine.substr(0, equalPos));
-                std::string value = Trim(trimmedLine.substr(equalPos + 1));
+    return classifier;
+}
 
-                if (currentSection == "Original backup" && key == "Backup") {
-                    if (value == "true" || value == "True" || value == "TRUE") {
-                        settings.backupValue = 2;
-                        logFile << "Read config: Backup = true (always backup mode)" << std::endl;
-                    } else {
-                        try {
-                            settings.backupValue = std::stoi(value);
-                            logFile << "Read config: Backup = " << settings.backupValue << std::endl;
-                        } catch (...) {
-                            logFile << "Warning: Invalid Backup value, using default (1)" << std::endl;
-                            settings.backupValue = 1;
-                        }
-                    }
-                } else if (currentSection == "blacklistedPresetsShowInOBodyMenu" && key == "ModeUBE") {
-                    if (value == "true" || value == "True" || value == "TRUE") {
-                        settings.modeUBE = true;
-                        logFile << "Read config: ModeUBE = true" << std::endl;
-                    } else if (value == "false" || value == "False" || value == "FALSE") {
-                        settings.modeUBE = false;
-                        logFile << "Read config: ModeUBE = false" << std::endl;
-                    } else {
-                        logFile << "Warning: Invalid ModeUBE value, using default (true)" << std::endl;
-                        settings.modeUBE = true;
-                    }
-                } else if (currentSection == "Presets_Smart_Cleaning" && key == "Smart_Cleaning") {
-                    if (value == "true" || value == "True" || value == "TRUE") {
-                        settings.presetsSmartCleaning = true;
-                        logFile << "Read config: Presets_Smart_Cleaning = true" << std::endl;
-                    } else if (value == "false" || value == "False" || value == "FALSE") {
-                        settings.presetsSmartCleaning = false;
-                        logFile << "Read config: Presets_Smart_Cleaning = false" << std::endl;
-                    } else {
-                        logFile << "Warning: Invalid Presets_Smart_Cleaning value, using default (false)" << std::endl;
-                        settings.presetsSmartCleaning = false;
-                    }
-                } else if (currentSection == "blacklistedPresets_Smart_Cleaning_FromRandomDistribution" && key == "Smart_Cleaning") {
-                    if (value == "true" || value == "True" || value == "TRUE") {
-                        settings.blacklistedPresetsSmartCleaningFromRandomDistribution = true;
-                        logFile << "Read config: blacklistedPresets_Smart_Cleaning_FromRandomDistribution = true" << std::endl;
-                    } else if (value == "false" || value == "False" || value == "FALSE") {
-                        settings.blacklistedPresetsSmartCleaningFromRandomDistribution = false;
-                        logFile << "Read config: blacklistedPresets_Smart_Cleaning_FromRandomDistribution = false" << std::endl;
-                    } else {
-                        logFile << "Warning: Invalid blacklistedPresets_Smart_Cleaning_FromRandomDistribution value, using default (false)" << std::endl;
-                        settings.blacklistedPresetsSmartCleaningFromRandomDistribution = false;
-                    }
-                } else if (currentSection == "blacklistedPresets_Smart_Cleaning_FromAll" && key == "Smart_Cleaning") {
-                    if (value == "true" || value == "True" || value == "TRUE") {
-                        settings.blacklistedPresetsSmartCleaningFromAll = true;
-                        logFile << "Read config: blacklistedPresets_Smart_Cleaning_FromAll = true" << std::endl;
-                    } else if (value == "false" || value == "False" || value == "FALSE") {
-                        settings.blacklistedPresetsSmartCleaningFromAll = false;
-                        logFile << "Read config: blacklistedPresets_Smart_Cleaning_FromAll = false" << std::endl;
-                    } else {
-                        logFile << "Warning: Invalid blacklistedPresets_Smart_Cleaning_FromAll value, using default (false)" << std::endl;
-                        settings.blacklistedPresetsSmartCleaningFromAll = false;
-                    }
-                } else if (currentSection == "outfitsForceRe_Smart_Cleaning" && key == "Smart_Cleaning") {
-                    if (value == "true" || value == "True" || value == "TRUE") {
-                        settings.outfitsForceReSmartCleaning = true;
-                        logFile << "Read config: outfitsForceRe_Smart_Cleaning = true" << std::endl;
-                    } else if (value == "false" || value == "False" || value == "FALSE") {
-                        settings.outfitsForceReSmartCleaning = false;
-                        logFile << "Read config: outfitsForceRe_Smart_Cleaning = false" << std::endl;
-                    } else {
-                        logFile << "Warning: Invalid outfitsForceRe_Smart_Cleaning value, using default (false)" << std::endl;
-                        settings.outfitsForceReSmartCleaning = false;
-                    }
-                }
-            }
+// Appends to matched the frameworks with a pattern in name, each once, in table order.
+void MatchFrameworks(const FrameworkClassifier& classifier, const std::string& name,
+                     std::vector<std::uint16_t>& matched) {
+    matched.clear();
+    auto step = [&](std::int32_t& state, unsigned char c) {
+        state = classifier.transitions[state][c];
+        for (std::uint16_t id : classifier.outputs[state]) {
+            if (std::find(matched.begin(), matched.end(), id) == matched.end()) matched.push_back(id);
         }
+    };
 
-        return settings;
-        
-    } catch (const std::exception& e) {
-        logFile << "ERROR in ReadConfigFromIni: " << e.what() << std::endl;
-        return settings;
-    } catch (...) {
-        logFile << "ERROR in ReadConfigFromIni: Unknown exception" << std::endl;
-        return settings;
-    }
+    std::int32_t state = 0;
+    step(state, FRAMEWORK_ANCHOR_START);
+    for (char c : name) step(state, static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(c))));
+    step(state, FRAMEWORK_ANCHOR_END);
+
+    std::sort(matched.begin(), matched.end());
 }
 
-void UpdateBackupConfigInIni(const fs::path& iniPath, std::ofstream& logFile, int originalValue) {
-    try {
-        if (!fs::exists(iniPath)) {
-            logFile << "ERROR: Config INI file does not exist for update" << std::endl;
-            return;
+// Parses the table format documented in DEFAULT_FRAMEWORK_TABLE. Bad lines are logged and skipped.
+std::vector<FrameworkDefinition> ParseFrameworkTable(const std::string& content, std::ostream& logFile) {
+    std::vector<FrameworkDefinition> frameworks;
+    std::istringstream stream(content);
+    std::string line;
+    std::string currentSection;
+    int lineNumber = 0;
+
+    while (std::getline(stream, line)) {
+        lineNumber++;
+        std::string trimmedLine = Trim(line);
+        if (trimmedLine.empty() || trimmedLine[0] == ';' || trimmedLine[0] == '#') continue;
+
+        if (trimmedLine.front() == '[' && trimmedLine.back() == ']') {
+            currentSection = trimmedLine.substr(1, trimmedLine.length() - 2);
+            continue;
+        }
+        if (currentSection != "Frameworks") continue;
+
+        size_t equalPos = trimmedLine.find('=');
+        size_t colonPos = trimmedLine.find(':', equalPos == std::string::npos ? 0 : equalPos);
+        if (equalPos == std::string::npos || colonPos == std::string::npos) {
+            logFile << "  Warning: Framework table line " << lineNumber << " is not 'Name = role : patterns'"
+                    << std::endl;
+            continue;
+        }
+
+        FrameworkDefinition framework;
+        framework.name = Trim(trimmedLine.substr(0, equalPos));
+        std::string role = ToLowerCase(Trim(trimmedLine.substr(equalPos + 1, colonPos - equalPos - 1)));
+        if (role == "ube") {
+            framework.role = FrameworkRole::UBE;
+        } else if (role == "conflict") {
+            framework.role = FrameworkRole::Conflict;
+        } else if (role == "info") {
+            framework.role = FrameworkRole::Info;
+        } else {
+            logFile << "  Warning: Unknown framework role '" << role << "' on line " << lineNumber << std::endl;
+            continue;
         }
 
-        if (originalValue == 2) {
-            logFile << "INFO: Backup = true detected, INI will not be updated (always backup mode)" << std::endl;
-            return;
+        for (const auto& rawPattern : Split(trimmedLine.substr(colonPos + 1), '|')) {
+            std::string pattern = ToLowerCase(rawPattern);
+            bool anchorStart = !pattern.empty() && pattern.front() == '^';
+            bool anchorEnd = pattern.size() > (anchorStart ? 1u : 0u) && pattern.back() == '$';
+            pattern = pattern.substr(anchorStart ? 1 : 0, pattern.size() - (anchorStart ? 1 : 0) - (anchorEnd ? 1 : 0));
+            if (pattern.empty() && !anchorStart && !anchorEnd) continue;
+            if (anchorStart) pattern.insert(pattern.begin(), static_cast<char>(FRAMEWORK_ANCHOR_START));
+            if (anchorEnd) pattern.push_back(static_cast<char>(FRAMEWORK_ANCHOR_END));
+            framework.patterns.push_back(std::move(pattern));
         }
 
-        std::string content = ReadFileWithEncoding(iniPath);
-        if (content.empty()) {
-            logFile << "ERROR: Could not read config INI file for update" << std::endl;
-            return;
+        if (framework.name.empty() || framework.patterns.empty()) {
+            logFile << "  Warning: Framework table line " << lineNumber << " has no name or no patterns" << std::endl;
+            continue;
         }
+        if (frameworks.size() >= 65535) break;
+        frameworks.push_back(std::move(framework));
+    }
 
-        std::stringstream ss(content);
-        std::vector<std::string> lines;
-        std::string line;
-        std::string currentSection;
-        bool backupValueUpdated = false;
-        lines.reserve(100);
+    return frameworks;
+}
 
-        while (std::getline(ss, line)) {
-            std::string trimmedLine = Trim(line);
+const FrameworkClassifier& DefaultFrameworkClassifier() {
+    static const FrameworkClassifier classifier = [] {
+        std::ostringstream discardedLog;
+        return BuildFrameworkClassifier(ParseFrameworkTable(DEFAULT_FRAMEWORK_TABLE, discardedLog));
+    }();
+    return classifier;
+}
 
-            if (trimmedLine[0] == '[' && trimmedLine.back() == ']') {
-                currentSection = trimmedLine.substr(1, trimmedLine.length() - 2);
-                lines.push_back(line);
-                continue;
+// Loads the table, writing the default one first if there is none. Falls back to the built-in
+// defaults if the file cannot be read.
+FrameworkClassifier LoadFrameworkTable(const fs::path& tablePath, std::ostream& logFile) {
+    try {
+        if (!fs::exists(tablePath)) {
+            std::ofstream createTable(tablePath, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (createTable.is_open()) {
+                createTable << DEFAULT_FRAMEWORK_TABLE;
+                RecordStreamWritten(createTable);
+                createTable.close();
+                logFile << "Created default framework table: " << tablePath.string() << std::endl;
+            } else {
+                logFile << "WARNING: Could not create framework table, using built-in defaults: "
+                        << tablePath.string() << std::endl;
             }
+            return DefaultFrameworkClassifier();
+        }
 
-            if (currentSection == "Original backup") {
-                size_t equalPos = trimmedLine.find('=');
-                if (equalPos != std::string::npos) {
-                    std::string key = Trim(trimmedLine.substr(0, equalPos));
-                    if (key == "Backup") {
-                        lines.push_back("Backup = 0");
-                        backupValueUpdated = true;
-                        continue;
-                    }
-                }
-            }
+        std::string content = ReadFileWithEncoding(tablePath);
+        FrameworkClassifier classifier = BuildFrameworkClassifier(ParseFrameworkTable(content, logFile));
+        logFile << "Framework table: " << classifier.frameworks.size() << " frameworks, " << classifier.patternCount
+                << " patterns from " << tablePath.filename().string() << std::endl;
+        return classifier;
 
-            lines.push_back(line);
-        }
+    } catch (const std::exception& e) {
+        logFile << "WARNING: Could not load framework table, using built-in defaults: " << e.what() << std::endl;
+    } catch (...) {
+        logFile << "WARNING: Could not load framework table, using built-in defaults" << std::endl;
+    }
+    return DefaultFrameworkClassifier();
+}
 
-        if (!backupValueUpdated) {
-            logFile << "Warning: Backup value not found in INI during update" << std::endl;
-            return;
-        }
+// ===== IMPROVED XML PRESET EXTRACTION =====
 
-        std::ofstream outFile(iniPath, std::ios::out | std::ios::trunc);
-        if (!outFile.is_open()) {
-            logFile << "ERROR: Could not open config INI file for writing" << std::endl;
-            return;
+struct XmlPresetInfo {
+    std::string internalName;
+    std::string filename;
+    std::string setName;
+    bool extractionSuccessful;
+};
+
+struct XmlAnalysisResult {
+    bool hasUBE = false;
+    bool hasConflictingGroups = false;
+    std::vector<std::string> conflictingGroupsFound;
+    std::vector<std::string> groupNames;
+    std::vector<std::string> frameworks;  // Every framework recognized in groupNames, in table order
+};
+
+// ===== INTERNED NAMES =====
+
+// Plugin and preset names are interned once per process into an append-only arena; the JSON
+// section model and the preset lookup hold 32-bit ids, compare them as integers and turn them
+// back into text only for logs and the JSON writer. Intern and Find take the pool's lock;
+// NameView does not, because a name never moves once stored and its id is only handed out after.
+using NameId = std::uint32_t;
+const NameId NO_NAME = 0xFFFFFFFFu;
+
+std::uint32_t HashName(std::string_view name) {
+    std::uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+class NamePool {
+public:
+    NameId Intern(std::string_view name) {
+        std::uint32_t hash = HashName(name);
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            NameId id = FindLocked(name, hash);
+            if (id != NO_NAME) return id;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        NameId id = FindLocked(name, hash);
+        if (id != NO_NAME) return id;
+        if (count_ >= SEGMENT_SIZE * MAX_SEGMENTS) throw std::length_error("name pool is full");
+
+        id = static_cast<NameId>(count_);
+        auto& segment = segments_[id >> SEGMENT_BITS];
+        if (!segment) segment.reset(new std::string_view[SEGMENT_SIZE]);
+        segment[id & (SEGMENT_SIZE - 1)] = Store(name);
+        count_++;
+
+        if (count_ * 2 > table_.size()) {
+            Rehash(std::max<size_t>(1024, table_.size() * 2));
+        } else {
+            Place(hash, id);
         }
+        return id;
+    }
 
-        for (const auto& outputLine : lines) {
-            outFile << outputLine << std::endl;
+    // NO_NAME if the name was never interned, which also means no table can hold it
+    NameId Find(std::string_view name) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return FindLocked(name, HashName(name));
+    }
+
+    std::string_view View(NameId id) const {
+        if (id == NO_NAME) return std::string_view();
+        return segments_[id >> SEGMENT_BITS][id & (SEGMENT_SIZE - 1)];
+    }
+
+    size_t Size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return count_;
+    }
+
+    size_t MemoryBytes() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        size_t segments = (count_ + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+        return arenaBytes_ + table_.capacity() * sizeof(Slot) + segments * SEGMENT_SIZE * sizeof(std::string_view);
+    }
+
+private:
+    struct Slot {
+        std::uint32_t hash = 0;
+        NameId id = NO_NAME;
+    };
+
+    static constexpr size_t SEGMENT_BITS = 14;
+    static constexpr size_t SEGMENT_SIZE = size_t(1) << SEGMENT_BITS;
+    static constexpr size_t MAX_SEGMENTS = 4096;
+    static constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+    NameId FindLocked(std::string_view name, std::uint32_t hash) const {
+        if (table_.empty()) return NO_NAME;
+        size_t mask = table_.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& slot = table_[i];
+            if (slot.id == NO_NAME) return NO_NAME;
+            if (slot.hash == hash && View(slot.id) == name) return slot.id;
         }
+    }
 
-        outFile.close();
-        if (outFile.fail()) {
-            logFile << "ERROR: Failed to write config INI file" << std::endl;
-        } else {
-            logFile << "SUCCESS: Config updated (Backup = 0)" << std::endl;
+    void Place(std::uint32_t hash, NameId id) {
+        size_t mask = table_.size() - 1;
+        size_t i = hash & mask;
+        while (table_[i].id != NO_NAME) i = (i + 1) & mask;
+        table_[i] = Slot{hash, id};
+    }
+
+    void Rehash(size_t capacity) {
+        table_.assign(capacity, Slot());
+        for (size_t id = 0; id < count_; ++id) {
+            Place(HashName(View(static_cast<NameId>(id))), static_cast<NameId>(id));
         }
+    }
 
-    } catch (const std::exception& e) {
-        logFile << "ERROR in UpdateBackupConfigInIni: " << e.what() << std::endl;
-    } catch (...) {
-        logFile << "ERROR in UpdateBackupConfigInIni: Unknown exception" << std::endl;
+    std::string_view Store(std::string_view name) {
+        if (name.empty()) return std::string_view();
+        if (blocks_.empty() || blockUsed_ + name.size() > blockCapacity_) {
+            blockCapacity_ = std::max(ARENA_BLOCK_SIZE, name.size());
+            blocks_.emplace_back(new char[blockCapacity_]);
+            blockUsed_ = 0;
+            arenaBytes_ += blockCapacity_;
+        }
+        char* text = blocks_.back().get() + blockUsed_;
+        std::memcpy(text, name.data(), name.size());
+        blockUsed_ += name.size();
+        return std::string_view(text, name.size());
     }
-}
-// ===== SMART CLEANING FUNCTIONS WITH INTELLIGENT PRESET MATCHING =====
 
-struct PresetMatchResult {
-    bool found = false;
-    std::string actualPresetName = "";
-    int matchLevel = 0;
+    mutable std::shared_mutex mutex_;
+    std::vector<Slot> table_;
+    std::array<std::unique_ptr<std::string_view[]>, MAX_SEGMENTS> segments_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t blockUsed_ = 0;
+    size_t blockCapacity_ = 0;
+    size_t arenaBytes_ = 0;
+    size_t count_ = 0;
 };
 
-struct PresetMapData {
-    std::map<std::string, std::string> exactMap;
-    std::map<std::string, std::string> normalizedMap;
-    std::map<std::string, std::string> filenameToInternalMap;
-    std::set<std::string> allValidNames;
-};
+NamePool& InternedNames() {
+    static NamePool pool;
+    return pool;
+}
 
-PresetMapData BuildPresetNameMap(const fs::path& bodySlidePresetsPath, std::ofstream& logFile) {
-    PresetMapData presetData;
-    
-    try {
-        if (!fs::exists(bodySlidePresetsPath)) {
-            logFile << "WARNING: BodySlide presets folder not found for building preset map" << std::endl;
-            return presetData;
+NameId InternName(std::string_view name) {
+    return InternedNames().Intern(name);
+}
+
+NameId FindName(std::string_view name) {
+    return InternedNames().Find(name);
+}
+
+std::string_view NameView(NameId id) {
+    return InternedNames().View(id);
+}
+
+std::string NameString(NameId id) {
+    return std::string(NameView(id));
+}
+
+// Open-addressing NameId -> uint32 table with linear probing, kept at most half full. Ids are
+// dense, so a multiplicative hash spreads them well.
+class FlatIdMap {
+public:
+    const std::uint32_t* Find(NameId key) const {
+        if (slots_.empty()) return nullptr;
+        size_t mask = slots_.size() - 1;
+        for (size_t i = Bucket(key, mask);; i = (i + 1) & mask) {
+            if (slots_[i].key == key) return &slots_[i].value;
+            if (slots_[i].key == NO_NAME) return nullptr;
         }
-        
-        int totalXmlFiles = 0;
-        int successfulExtractions = 0;
-        int usingFilenameAsFallback = 0;
-        int filenameFailed = 0;
-        
-        for (const auto& entry : fs::directory_iterator(bodySlidePresetsPath)) {
-            try {
-                if (entry.is_regular_file()) {
-                    std::string filename;
-                    try {
-                        auto u8name = entry.path().filename().u8string();
-                        filename = std::string(u8name.begin(), u8name.end());
-                    } catch (...) {
-                        try {
-                            filename = entry.path().filename().string();
-                        } catch (...) {
-                            filenameFailed++;
-                            logFile << "  [ERROR] Could not read filename for entry" << std::endl;
-                            continue;
-                        }
-                    }
-                    
-                    if (EndsWith(filename, ".xml")) {
-                        totalXmlFiles++;
-                        
-                        try {
-                            XmlPresetInfo info = ExtractPresetInfoFromXml(entry.path(), logFile);
-                            
-                            std::string presetNameToUse;
-                            
-                            if (info.extractionSuccessful && !info.internalName.empty()) {
-                                presetNameToUse = info.internalName;
-                                successfulExtractions++;
-                                
-                                presetData.filenameToInternalMap[info.filename] = info.internalName;
-                                
-                                if (info.filename != info.internalName) {
-                                    logFile << "  [MAPPING] File: " << info.filename 
-                                            << " -> Internal: " << info.internalName << std::endl;
-                                }
-                                
-                            } else {
-                                presetNameToUse = info.filename;
-                                usingFilenameAsFallback++;
-                                logFile << "  [WARNING] Failed to extract from: " << filename << std::endl;
-                            }
-                            
-                            presetData.exactMap[presetNameToUse] = presetNameToUse;
-                            presetData.allValidNames.insert(presetNameToUse);
-                            
-                            presetData.allValidNames.insert(info.filename);
-                            
-                            std::string normalized = NormalizePresetNameFlexible(presetNameToUse);
-                            if (!normalized.empty()) {
-                                if (presetData.normalizedMap.find(normalized) == presetData.normalizedMap.end()) {
-                                    presetData.normalizedMap[normalized] = presetNameToUse;
-                                }
-                            }
-                            
-                            std::string normalizedFilename = NormalizePresetNameFlexible(info.filename);
-                            if (!normalizedFilename.empty()) {
-                                if (presetData.normalizedMap.find(normalizedFilename) == presetData.normalizedMap.end()) {
-                                    presetData.normalizedMap[normalizedFilename] = presetNameToUse;
-                                }
-                            }
-                        } catch (const std::exception& e) {
-                            logFile << "  [ERROR] Exception processing " << filename << ": " << e.what() << std::endl;
-                        } catch (...) {
-                            logFile << "  [ERROR] Unknown exception processing " << filename << std::endl;
-                        }
-                    }
-                }
-            } catch (const std::exception& e) {
-                logFile << "  [ERROR] Exception in directory iteration: " << e.what() << std::endl;
-                continue;
-            } catch (...) {
-                logFile << "  [ERROR] Unknown exception in directory iteration" << std::endl;
-                continue;
-            }
+    }
+
+    // Returns the value already stored for key, or stores value
+    std::pair<std::uint32_t, bool> Insert(NameId key, std::uint32_t value) {
+        if ((size_ + 1) * 2 > slots_.size()) Rehash(std::max<size_t>(64, slots_.size() * 2));
+        size_t mask = slots_.size() - 1;
+        size_t i = Bucket(key, mask);
+        for (; slots_[i].key != NO_NAME; i = (i + 1) & mask) {
+            if (slots_[i].key == key) return {slots_[i].value, false};
+        }
+        slots_[i] = Slot{key, value};
+        size_++;
+        return {value, true};
+    }
+
+    void Reserve(size_t count) {
+        size_t capacity = 64;
+        while (capacity < count * 2) capacity *= 2;
+        if (capacity > slots_.size()) Rehash(capacity);
+    }
+
+    size_t Size() const { return size_; }
+    size_t MemoryBytes() const { return slots_.capacity() * sizeof(Slot); }
+
+private:
+    struct Slot {
+        NameId key = NO_NAME;
+        std::uint32_t value = 0;
+    };
+
+    static size_t Bucket(NameId key, size_t mask) { return (key * 0x9E3779B1u) & mask; }
+
+    void Rehash(size_t capacity) {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(capacity, Slot());
+        size_t mask = capacity - 1;
+        for (const Slot& slot : old) {
+            if (slot.key == NO_NAME) continue;
+            size_t i = Bucket(slot.key, mask);
+            while (slots_[i].key != NO_NAME) i = (i + 1) & mask;
+            slots_[i] = slot;
         }
-        
-        logFile << std::endl;
-        logFile << "Smart Cleaning: Preset Map Building Summary" << std::endl;
-        logFile << "  Total XML files found: " << totalXmlFiles << std::endl;
-        logFile << "  Successful name extractions: " << successfulExtractions << std::endl;
-        logFile << "  Failed extractions (using filename): " << usingFilenameAsFallback << std::endl;
-        logFile << "  Filename read failures: " << filenameFailed << std::endl;
-        logFile << "  Total unique presets in map: " << presetData.exactMap.size() << std::endl;
-        logFile << "  Total valid names (including filenames): " << presetData.allValidNames.size() << std::endl;
-        logFile << std::endl;
-        
-    } catch (const std::exception& e) {
-        logFile << "ERROR in BuildPresetNameMap: " << e.what() << std::endl;
-    } catch (...) {
-        logFile << "ERROR in BuildPresetNameMap: Unknown exception" << std::endl;
     }
-    
-    return presetData;
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+};
+
+// Slider names seen across the whole catalog, interned once so every preset stores small ids.
+// Ids follow first sight, which depends on thread timing; the clustering stage reorders them by
+// name before building vectors, so nothing downstream depends on the raw ids.
+class SliderDictionary {
+public:
+    std::uint32_t Intern(const std::string& name) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = ids_.find(name);
+            if (it != ids_.end()) return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto inserted = ids_.emplace(name, static_cast<std::uint32_t>(names_.size()));
+        if (inserted.second) names_.push_back(name);
+        return inserted.first->second;
+    }
+
+    std::string Name(std::uint32_t id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return id < names_.size() ? names_[id] : std::string();
+    }
+
+    std::vector<std::string> Names() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return names_;
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::uint32_t> ids_;
+    std::vector<std::string> names_;
+};
+
+// One slider of a preset: BodySlide stores a value for the lowest ("small") and the highest
+// ("big") weight. A size that is not set stays 0.
+struct PresetSlider {
+    std::uint32_t id = 0;
+    float small = 0.0f;
+    float big = 0.0f;
+};
+
+// Shape metrics: weighted sums of the sliders that drive each body measure, at weight 0 (small)
+// and 100 (big). 1.0 is roughly the main slider at 100%; negative weights are sliders that shrink
+// the measure. Presets that set none of these sliders are left unmeasured.
+enum ShapeMetric : size_t { SHAPE_BUST, SHAPE_WAIST, SHAPE_HIPS, SHAPE_BUTT, SHAPE_METRIC_COUNT };
+
+const char* const SHAPE_METRIC_NAMES[SHAPE_METRIC_COUNT] = {"bust", "waist", "hips", "butt"};
+
+struct ShapeSliderWeight {
+    const char* slider;
+    ShapeMetric metric;
+    float weight;
+};
+
+// CBBE / 3BA / BHUNP slider names, which UBE and most derived bodies keep
+const ShapeSliderWeight SHAPE_SLIDER_WEIGHTS[] = {
+    {"Breasts", SHAPE_BUST, 1.0f},           {"BreastsNewSH", SHAPE_BUST, 0.5f},
+    {"BreastsFantasy", SHAPE_BUST, 0.5f},    {"DoubleMelon", SHAPE_BUST, 0.5f},
+    {"BreastsSmall", SHAPE_BUST, -0.5f},     {"Waist", SHAPE_WAIST, 1.0f},
+    {"WideWaistLine", SHAPE_WAIST, 0.5f},    {"ChubbyWaist", SHAPE_WAIST, 0.5f},
+    {"Hips", SHAPE_HIPS, 1.0f},              {"HipBone", SHAPE_HIPS, 0.5f},
+    {"HipUpperWidth", SHAPE_HIPS, 0.5f},     {"Butt", SHAPE_BUTT, 1.0f},
+    {"BigButt", SHAPE_BUTT, 0.5f},           {"ChubbyButt", SHAPE_BUTT, 0.5f},
+    {"AppleCheeks", SHAPE_BUTT, 0.25f},      {"RoundAss", SHAPE_BUTT, 0.25f},
+    {"ButtSmall", SHAPE_BUTT, -0.5f},
+};
+
+static constexpr size_t SHAPE_SLIDER_COUNT = sizeof(SHAPE_SLIDER_WEIGHTS) / sizeof(SHAPE_SLIDER_WEIGHTS[0]);
+
+// Index into SHAPE_SLIDER_WEIGHTS, or SHAPE_SLIDER_COUNT if the slider feeds no metric.
+size_t ShapeSliderIndex(std::string_view slider) {
+    static const std::unordered_map<std::string_view, size_t> index = []() {
+        std::unordered_map<std::string_view, size_t> built;
+        for (size_t i = 0; i < SHAPE_SLIDER_COUNT; ++i) built.emplace(SHAPE_SLIDER_WEIGHTS[i].slider, i);
+        return built;
+    }();
+    auto it = index.find(slider);
+    return it == index.end() ? SHAPE_SLIDER_COUNT : it->second;
 }
 
-PresetMatchResult FindPresetMatch(const std::string& jsonPresetName, 
-                                   const PresetMapData& presetData,
-                                   std::ofstream& logFile) {
-    PresetMatchResult result;
-    
-    if (jsonPresetName.empty()) {
-        return result;
+struct ShapeMetrics {
+    bool measured = false;
+    std::array<float, SHAPE_METRIC_COUNT> small{};
+    std::array<float, SHAPE_METRIC_COUNT> big{};
+};
+
+// Raw values of the shape sliders of one preset while it is tokenized; a repeated SetSlider
+// overrides the earlier one, as in BodySlide.
+struct ShapeSliderValues {
+    bool any = false;
+    std::array<float, SHAPE_SLIDER_COUNT> small{};
+    std::array<float, SHAPE_SLIDER_COUNT> big{};
+
+    ShapeMetrics Metrics() const {
+        ShapeMetrics metrics;
+        metrics.measured = any;
+        for (size_t i = 0; i < SHAPE_SLIDER_COUNT; ++i) {
+            const ShapeSliderWeight& weight = SHAPE_SLIDER_WEIGHTS[i];
+            metrics.small[weight.metric] += weight.weight * small[i] / 100.0f;
+            metrics.big[weight.metric] += weight.weight * big[i] / 100.0f;
+        }
+        return metrics;
     }
-    
-    std::string cleanPresetName = jsonPresetName;
-    if (!cleanPresetName.empty() && cleanPresetName[0] == '!') {
-        cleanPresetName = cleanPresetName.substr(1);
+};
+
+// One <Preset> element of a SliderPresets XML. BodySlide allows several per file.
+struct XmlPreset {
+    XmlPresetInfo info;
+    XmlAnalysisResult analysis;
+    ShapeMetrics shape;
+    std::vector<PresetSlider> sliders;  // Only filled when the catalog reads sliders (Preset_Clusters)
+};
+
+XmlAnalysisResult ClassifyXmlGroups(const std::vector<std::string>& groupNames,
+                                    const FrameworkClassifier& frameworks) {
+    XmlAnalysisResult result;
+    result.groupNames = groupNames;
+
+    std::vector<std::uint16_t> matched;
+    std::vector<std::uint16_t> presetFrameworks;
+    for (const auto& groupName : groupNames) {
+        MatchFrameworks(frameworks, groupName, matched);
+
+        bool conflicting = false;
+        for (std::uint16_t id : matched) {
+            FrameworkRole role = frameworks.frameworks[id].role;
+            if (role == FrameworkRole::UBE) result.hasUBE = true;
+            if (role == FrameworkRole::Conflict) conflicting = true;
+            if (std::find(presetFrameworks.begin(), presetFrameworks.end(), id) == presetFrameworks.end()) {
+                presetFrameworks.push_back(id);
+            }
+        }
+
+        if (conflicting) {
+            result.hasConflictingGroups = true;
+            if (std::find(result.conflictingGroupsFound.begin(), result.conflictingGroupsFound.end(), groupName) ==
+                result.conflictingGroupsFound.end()) {
+                result.conflictingGroupsFound.push_back(groupName);
+            }
+        }
     }
-    
-    auto exactIt = presetData.exactMap.find(cleanPresetName);
-    if (exactIt != presetData.exactMap.end()) {
-        result.found = true;
-        result.actualPresetName = exactIt->second;
-        result.matchLevel = 1;
-        return result;
+
+    std::sort(presetFrameworks.begin(), presetFrameworks.end());
+    for (std::uint16_t id : presetFrameworks) result.frameworks.push_back(frameworks.frameworks[id].name);
+    return result;
+}
+
+// Byte length of the character at data[pos] and the ASCII it reads as: curly quotes and em
+// dashes fold exactly as in AppendNormalizedText, anything else is a single raw byte.
+size_t NormalizedCharAt(const char* data, size_t size, size_t pos, char& out) {
+    unsigned char c = static_cast<unsigned char>(data[pos]);
+    if ((c & 0xF0) == 0xE0 && pos + 2 < size) {
+        unsigned char c2 = static_cast<unsigned char>(data[pos + 1]);
+        unsigned char c3 = static_cast<unsigned char>(data[pos + 2]);
+        if ((c2 & 0xC0) == 0x80 && (c3 & 0xC0) == 0x80) {
+            int codepoint = ((c & 0x0F) << 12) | ((c2 & 0x3F) << 6) | (c3 & 0x3F);
+            if (codepoint == 0x2018 || codepoint == 0x2019) {
+                out = '\'';
+                return 3;
+            } else if (codepoint == 0x201C || codepoint == 0x201D) {
+                out = '"';
+                return 3;
+            } else if (codepoint == 0x2014) {
+                out = '-';
+                return 3;
+            }
+        }
     }
-    
-    std::string decodedCleanName = DecodeHtmlEntities(cleanPresetName);
-    if (decodedCleanName != cleanPresetName) {
-        auto decodedIt = presetData.exactMap.find(decodedCleanName);
-        if (decodedIt != presetData.exactMap.end()) {
-            result.found = true;
-            result.actualPresetName = decodedIt->second;
-            result.matchLevel = 2;
-            logFile << "    [INFO] Matched with HTML entity decoding: " 
-                    << cleanPresetName << " -> " << decodedCleanName << std::endl;
-            return result;
+    out = static_cast<char>(c);
+    return 1;
+}
+
+// Reads the quoted value whose opening quote is at data[pos], folding punctuation and decoding
+// the five XML entities as it copies. On success pos is just past the closing quote.
+bool ReadQuotedValue(const char* data, size_t size, size_t& pos, std::string& value) {
+    static const struct {
+        const char* entity;
+        size_t length;
+        char decoded;
+    } entities[] = {{"&amp;", 5, '&'}, {"&apos;", 6, '\''}, {"&quot;", 6, '"'}, {"&lt;", 4, '<'}, {"&gt;", 4, '>'}};
+
+    char quoteChar = 0;
+    size_t cursor = pos + NormalizedCharAt(data, size, pos, quoteChar);
+    if (quoteChar != '"' && quoteChar != '\'') return false;
+
+    value.clear();
+    while (cursor < size) {
+        char c = 0;
+        size_t length = NormalizedCharAt(data, size, cursor, c);
+        if (c == quoteChar) {
+            pos = cursor + length;
+            return true;
+        }
+
+        bool decoded = false;
+        if (c == '&') {
+            for (const auto& e : entities) {
+                if (size - cursor >= e.length && std::memcmp(data + cursor, e.entity, e.length) == 0) {
+                    value += e.decoded;
+                    cursor += e.length;
+                    decoded = true;
+                    break;
+                }
+            }
+        }
+        if (!decoded) {
+            value += c;
+            cursor += length;
         }
     }
-    
-    std::string normalizedJsonName = NormalizePresetNameFlexible(cleanPresetName);
-    for (const auto& [xmlName, actualName] : presetData.exactMap) {
-        std::string normalizedXmlName = NormalizePresetNameFlexible(xmlName);
-        if (normalizedJsonName == normalizedXmlName) {
-            result.found = true;
-            result.actualPresetName = actualName;
-            result.matchLevel = 3;
-            logFile << "    [INFO] Matched with normalization: " 
-                    << cleanPresetName << " -> " << actualName << std::endl;
-            return result;
+    return false;
+}
+
+bool IsXmlSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+// True if the tag starting at data[pos] (just past '<') is lowerName, ignoring case.
+bool TagNameIs(const char* data, size_t size, size_t pos, const char* lowerName, size_t nameLength) {
+    if (size - pos <= nameLength) return false;
+    for (size_t i = 0; i < nameLength; ++i) {
+        if (std::tolower(static_cast<unsigned char>(data[pos + i])) != lowerName[i]) return false;
+    }
+    char next = data[pos + nameLength];
+    return IsXmlSpace(next) || next == '>' || next == '/';
+}
+
+// Reads the attributes of a tag from pos up to its closing '>', calling onAttribute(name, value)
+// with the lowercased name and decoded value of each quoted one. On return pos is past the tag.
+template <typename OnAttribute>
+void ForEachTagAttribute(const char* data, size_t size, size_t& pos, OnAttribute&& onAttribute) {
+    std::string attribute;
+    std::string value;
+
+    while (pos < size) {
+        while (pos < size && IsXmlSpace(data[pos])) pos++;
+        if (pos >= size) return;
+        if (data[pos] == '>') {
+            pos++;
+            return;
+        }
+        if (data[pos] == '/') {
+            pos++;
+            continue;
         }
+
+        attribute.clear();
+        while (pos < size && data[pos] != '=' && data[pos] != '>' && data[pos] != '/' && !IsXmlSpace(data[pos])) {
+            attribute += static_cast<char>(std::tolower(static_cast<unsigned char>(data[pos])));
+            pos++;
+        }
+        while (pos < size && IsXmlSpace(data[pos])) pos++;
+        if (pos >= size || data[pos] != '=') continue;
+        pos++;
+        while (pos < size && IsXmlSpace(data[pos])) pos++;
+        if (pos >= size) return;
+
+        size_t valueStart = pos;
+        if (!ReadQuotedValue(data, size, pos, value)) {
+            // Unquoted or unterminated: skip the token and keep nothing
+            pos = valueStart;
+            while (pos < size && data[pos] != '>' && !IsXmlSpace(data[pos])) pos++;
+            continue;
+        }
+        onAttribute(attribute, value);
     }
-    
-    if (presetData.allValidNames.find(cleanPresetName) != presetData.allValidNames.end()) {
-        auto filenameIt = presetData.filenameToInternalMap.find(cleanPresetName);
-        if (filenameIt != presetData.filenameToInternalMap.end()) {
-            result.found = true;
-            result.actualPresetName = filenameIt->second;
-            result.matchLevel = 4;
-            return result;
-        } else {
-            result.found = true;
-            result.actualPresetName = cleanPresetName;
-            result.matchLevel = 4;
-            return result;
+}
+
+// Keeps the quoted values of name= and set=.
+void ReadPresetTagAttributes(const char* data, size_t size, size_t& pos, std::string* name, bool& hasName,
+                             std::string* set) {
+    ForEachTagAttribute(data, size, pos, [&](const std::string& attribute, const std::string& value) {
+        if (attribute == "name" && name) {
+            *name = value;
+            hasName = true;
+        } else if (attribute == "set" && set) {
+            *set = value;
+        }
+    });
+}
+
+// Fast path for the tags a preset has dozens of: reads the next attribute without copying or
+// decoding. False if it needs the general reader (unquoted, entities, non-ASCII) or the tag ended.
+bool NextPlainAttribute(const char* data, size_t size, size_t& pos, std::string_view& attribute,
+                        std::string_view& value) {
+    while (pos < size && (IsXmlSpace(data[pos]) || data[pos] == '/')) pos++;
+    if (pos >= size || data[pos] == '>') return false;
+
+    size_t nameStart = pos;
+    while (pos < size && ((data[pos] | 0x20) >= 'a' && (data[pos] | 0x20) <= 'z')) pos++;
+    attribute = std::string_view(data + nameStart, pos - nameStart);
+    while (pos < size && IsXmlSpace(data[pos])) pos++;
+    if (attribute.empty() || pos + 1 >= size || data[pos] != '=') return false;
+    pos++;
+    while (pos < size && IsXmlSpace(data[pos])) pos++;
+    if (pos >= size || (data[pos] != '"' && data[pos] != '\'')) return false;
+
+    const char* close = static_cast<const char*>(std::memchr(data + pos + 1, data[pos], size - pos - 1));
+    if (!close) return false;
+    value = std::string_view(data + pos + 1, static_cast<size_t>(close - data) - pos - 1);
+    for (char c : value) {
+        if (c == '&' || static_cast<unsigned char>(c) >= 0x80) return false;
+    }
+    pos = static_cast<size_t>(close - data) + 1;
+    return true;
+}
+
+bool EqualsIgnoreCase(std::string_view text, std::string_view lower) {
+    if (text.size() != lower.size()) return false;
+    for (size_t i = 0; i < lower.size(); ++i) {
+        char c = text[i];
+        if ((c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c) != lower[i]) return false;
+    }
+    return true;
+}
+
+// <SetSlider name="..." size="small|big" value="...">, starting just past the tag name. wanted
+// decides from the slider name whether the rest is needed; if not, the tag is skipped unread.
+// False if the slider is skipped or lacks one of the attributes or a numeric value (BodySlide
+// cannot read it either). On return pos is past the tag.
+template <typename Wanted>
+bool ReadSetSliderTag(const char* data, size_t size, size_t& pos, std::string& name, bool& big, float& number,
+                      Wanted&& wanted) {
+    bool hasName = false;
+    bool isWanted = true;
+    bool hasSize = false;
+    bool hasValue = false;
+    auto takeSize = [&](std::string_view value) {
+        while (!value.empty() && IsXmlSpace(value.front())) value.remove_prefix(1);
+        while (!value.empty() && IsXmlSpace(value.back())) value.remove_suffix(1);
+        hasSize = EqualsIgnoreCase(value, "big") || EqualsIgnoreCase(value, "small");
+        big = EqualsIgnoreCase(value, "big");
+    };
+    auto takeValue = [&](std::string_view value) {
+        // Slider values are nearly always short integers, which a float holds exactly
+        size_t digits = value.size() - (!value.empty() && value[0] == '-');
+        if (digits > 0 && digits <= 7) {
+            long integer = 0;
+            bool plainInteger = true;
+            for (size_t i = value.size() - digits; i < value.size() && plainInteger; ++i) {
+                plainInteger = value[i] >= '0' && value[i] <= '9';
+                integer = integer * 10 + (value[i] - '0');
+            }
+            if (plainInteger) {
+                number = static_cast<float>(value[0] == '-' ? -integer : integer);
+                hasValue = true;
+                return;
+            }
+        }
+        char buffer[64];
+        if (value.size() >= sizeof(buffer)) return;
+        std::memcpy(buffer, value.data(), value.size());
+        buffer[value.size()] = '\0';
+        char* end = nullptr;
+        number = std::strtof(buffer, &end);
+        hasValue = end != buffer && std::isfinite(number);
+    };
+
+    size_t tagStart = pos;
+
+    // BodySlide writes name= first: an unwanted slider is then skipped after one lookup
+    size_t probe = pos;
+    while (probe < size && IsXmlSpace(data[probe])) probe++;
+    if (size - probe > 6 && std::memcmp(data + probe, "name=\"", 6) == 0) {
+        const char* close = static_cast<const char*>(std::memchr(data + probe + 6, '"', size - probe - 6));
+        if (close && !wanted(std::string_view(data + probe + 6, static_cast<size_t>(close - data) - probe - 6))) {
+            close = static_cast<const char*>(std::memchr(close, '>', size - static_cast<size_t>(close - data)));
+            pos = close ? static_cast<size_t>(close - data) + 1 : size;
+            return false;
         }
     }
-    
-    std::string normalized = NormalizePresetNameFlexible(cleanPresetName);
-    if (!normalized.empty()) {
-        auto normalizedIt = presetData.normalizedMap.find(normalized);
-        if (normalizedIt != presetData.normalizedMap.end()) {
-            result.found = true;
-            result.actualPresetName = normalizedIt->second;
-            result.matchLevel = 5;
-            return result;
+
+    std::string_view attribute;
+    std::string_view value;
+    while (NextPlainAttribute(data, size, pos, attribute, value)) {
+        if (EqualsIgnoreCase(attribute, "name")) {
+            hasName = true;
+            isWanted = wanted(value);
+            if (!isWanted) break;
+            name.assign(value.data(), value.size());
+        } else if (EqualsIgnoreCase(attribute, "size")) {
+            takeSize(value);
+        } else if (EqualsIgnoreCase(attribute, "value")) {
+            takeValue(value);
         }
     }
-    
-    std::vector<std::string> variations;
-    variations.push_back(cleanPresetName);
-    
-    variations.push_back(Trim(cleanPresetName));
-    
-    std::string noSpaces = cleanPresetName;
-    noSpaces.erase(std::remove(noSpaces.begin(), noSpaces.end(), ' '), noSpaces.end());
-    variations.push_back(noSpaces);
-    
-    std::string lowerCase = ToLowerCase(cleanPresetName);
-    variations.push_back(lowerCase);
-    
-    for (const auto& variation : variations) {
-        if (presetData.allValidNames.find(variation) != presetData.allValidNames.end()) {
-            result.found = true;
-            result.actualPresetName = variation;
-            result.matchLevel = 6;
-            return result;
+    if (pos < size && data[pos] != '>') {
+        if (!isWanted) {
+            const char* close = static_cast<const char*>(std::memchr(data + pos, '>', size - pos));
+            pos = close ? static_cast<size_t>(close - data) + 1 : size;
+            return false;
         }
+        // Something the fast path does not handle: read the whole tag again the general way
+        pos = tagStart;
+        hasName = hasSize = hasValue = false;
+        ForEachTagAttribute(data, size, pos, [&](const std::string& attr, const std::string& text) {
+            if (attr == "name") {
+                name = text;
+                hasName = true;
+                isWanted = wanted(std::string_view(name));
+            } else if (attr == "size") {
+                takeSize(text);
+            } else if (attr == "value") {
+                takeValue(text);
+            }
+        });
+        return hasName && isWanted && hasSize && hasValue;
     }
-    
-    return result;
+    if (pos < size) pos++;
+    return hasName && isWanted && hasSize && hasValue;
 }
 
-void PerformSmartCleaning(std::map<std::string, OrderedPluginData>& processedData,
-                          const ConfigSettings& config,
-                          const fs::path& bodySlidePresetsPath,
-                          std::ofstream& logFile,
-                          std::vector<std::string>& missingPresetsFromIni) {
-    
-    bool anyCleaningEnabled = config.presetsSmartCleaning || 
-                              config.blacklistedPresetsSmartCleaningFromRandomDistribution ||
-                              config.blacklistedPresetsSmartCleaningFromAll ||
-                              config.outfitsForceReSmartCleaning;
-    
-    if (!anyCleaningEnabled) {
-        logFile << "Smart Cleaning: All cleaning options disabled in configuration" << std::endl;
-        return;
+void MergePresetSlider(std::vector<PresetSlider>& sliders, std::uint32_t id, bool big, float number) {
+    // small and big of a slider are almost always adjacent
+    auto slider = !sliders.empty() && sliders.back().id == id
+                      ? sliders.end() - 1
+                      : std::find_if(sliders.begin(), sliders.end(), [id](const PresetSlider& s) { return s.id == id; });
+    if (slider == sliders.end()) {
+        sliders.push_back(PresetSlider{id, 0.0f, 0.0f});
+        slider = sliders.end() - 1;
     }
-    
-    logFile << std::endl;
-    logFile << "Performing Smart Cleaning with Intelligent Preset Matching..." << std::endl;
-    logFile << "----------------------------------------------------" << std::endl;
-    
-    PresetMapData presetData = BuildPresetNameMap(bodySlidePresetsPath, logFile);
-    
-    if (presetData.exactMap.empty()) {
-        logFile << "Smart Cleaning: No presets found in BodySlide folder, skipping cleaning" << std::endl;
-        return;
+    (big ? slider->big : slider->small) = number;
+}
+
+// Applies the catalog's naming rules to a decoded name= value.
+void FinishPresetInfo(XmlPresetInfo& info, std::ostream& logFile) {
+    // === MODIFICACIÓN 1: Truncar nombres en ';' o ',' ===
+    size_t truncatePos = info.internalName.find_first_of(";,");
+    if (truncatePos != std::string::npos) {
+        info.internalName = info.internalName.substr(0, truncatePos);
+        info.internalName = Trim(info.internalName);  // Remove trailing spaces
     }
-    
-    int totalPresetsRemoved = 0;
-    int totalPresetsKept = 0;
-    int totalPresetsCorrected = 0;
-    std::set<std::string> removedPresets;
-    std::map<std::string, std::string> correctedPresets;
-    
-    if (config.presetsSmartCleaning) {
-        logFile << "Cleaning regular presets (npcFormID, npc, faction, raceFemale, raceMale, etc)..." << std::endl;
-        
-        const std::vector<std::string> keysToClean = {
-            "npcFormID", "npc", "factionFemale", "factionMale",
-            "npcPluginFemale", "npcPluginMale", "raceFemale", "raceMale"
-        };
-        
-        for (const auto& key : keysToClean) {
-            auto& data = processedData[key];
-            std::vector<std::pair<std::string, std::vector<std::string>>> cleanedData;
-            
-            for (auto& [plugin, presets] : data.orderedData) {
-                std::vector<std::string> cleanedPresets;
-                
-                for (const auto& preset : presets) {
-                    std::string cleanPreset = preset;
-                    bool hasExclamation = false;
-                    
-                    if (!cleanPreset.empty() && cleanPreset[0] == '!') {
-                        cleanPreset = cleanPreset.substr(1);
-                        hasExclamation = true;
-                    }
-                    
-                    PresetMatchResult matchResult = FindPresetMatch(cleanPreset, presetData, logFile);
-                    
-                    if (matchResult.found) {
-                        std::string finalPresetName = matchResult.actualPresetName;
-                        
-                        if (hasExclamation && (finalPresetName.empty() || finalPresetName[0] != '!')) {
-                            finalPresetName = "!" + finalPresetName;
-                        }
-                        
-                        cleanedPresets.push_back(finalPresetName);
-                        totalPresetsKept++;
-                        
-                        if (preset != finalPresetName) {
-                            totalPresetsCorrected++;
-                            correctedPresets[preset] = finalPresetName;
-                            logFile << "  Corrected in " << key << "/" << plugin << ": \"" 
-                                    << preset << "\" -> \"" << finalPresetName << "\" (Level " 
-                                    << matchResult.matchLevel << " match)" << std::endl;
-                        }
-                    } else {
-                        removedPresets.insert(cleanPreset);
-                        totalPresetsRemoved++;
-                        logFile << "  Removed from " << key << "/" << plugin << ": " << cleanPreset << std::endl;
-                        
-                        if (std::find(missingPresetsFromIni.begin(), missingPresetsFromIni.end(), cleanPreset) == missingPresetsFromIni.end()) {
-                            missingPresetsFromIni.push_back(cleanPreset);
-                        }
-                    }
-                }
-                
-                if (!cleanedPresets.empty()) {
-                    cleanedData.emplace_back(plugin, cleanedPresets);
+
+    // === MODIFICACIÓN 2: Reemplazar 'CustomPreset' con filename ===
+    if (info.internalName == "CustomPreset") {
+        info.internalName = info.filename;
+        logFile << "INFO: Replaced generic 'CustomPreset' with filename: " << info.filename << std::endl;
+    }
+
+    info.filename = DecodeHtmlEntities(info.filename);
+    info.extractionSuccessful = true;
+}
+
+// Single forward pass over a SliderPresets XML (BOM allowed) that yields every <Preset> with its
+// name, set, <Group> names and shape metrics; the full slider list is only kept when sliderNames is
+// given. A file without any <Preset> still yields one unsuccessful entry, so it falls back to its
+// filename like before; <Group> tags ahead of the first <Preset> are credited to it.
+std::vector<XmlPreset> TokenizeSliderPresets(const char* data, size_t size, const std::string& filename,
+                                             const FrameworkClassifier& frameworks, std::ostream& logFile,
+                                             SliderDictionary* sliderNames = nullptr) {
+    std::vector<XmlPreset> presets;
+    std::vector<std::vector<std::string>> presetGroups;
+    std::vector<ShapeSliderValues> presetShapes;
+    std::vector<std::string> leadingGroups;
+
+    try {
+        std::string_view view(data, size);
+        size_t pos = Utf8BomLength(data, size);
+        std::string groupName;
+        std::string sliderName;
+
+        while (pos < size) {
+            size_t open = view.find('<', pos);
+            if (open == std::string_view::npos) break;
+            pos = open + 1;
+
+            if (view.compare(pos, 3, "!--") == 0) {
+                size_t close = view.find("-->", pos + 3);
+                pos = close == std::string_view::npos ? size : close + 3;
+            } else if (TagNameIs(data, size, pos, "preset", 6)) {
+                pos += 6;
+                XmlPreset preset;
+                preset.info.filename = filename;
+                preset.info.extractionSuccessful = false;
+                bool hasName = false;
+                ReadPresetTagAttributes(data, size, pos, &preset.info.internalName, hasName, &preset.info.setName);
+                if (hasName) FinishPresetInfo(preset.info, logFile);
+                presets.push_back(std::move(preset));
+                presetGroups.emplace_back();
+                presetShapes.emplace_back();
+            } else if (TagNameIs(data, size, pos, "group", 5)) {
+                pos += 5;
+                bool hasName = false;
+                ReadPresetTagAttributes(data, size, pos, &groupName, hasName, nullptr);
+                if (hasName) (presetGroups.empty() ? leadingGroups : presetGroups.back()).push_back(groupName);
+            } else if (!presets.empty() && TagNameIs(data, size, pos, "setslider", 9)) {
+                pos += 9;
+                bool big = false;
+                float number = 0.0f;
+                size_t shapeIndex = SHAPE_SLIDER_COUNT;
+                auto wanted = [&](std::string_view slider) {
+                    shapeIndex = ShapeSliderIndex(slider);
+                    return sliderNames || shapeIndex < SHAPE_SLIDER_COUNT;
+                };
+                if (!ReadSetSliderTag(data, size, pos, sliderName, big, number, wanted)) continue;
+
+                if (shapeIndex < SHAPE_SLIDER_COUNT) {
+                    ShapeSliderValues& shape = presetShapes.back();
+                    (big ? shape.big : shape.small)[shapeIndex] = number;
+                    shape.any = true;
                 }
+                if (sliderNames) MergePresetSlider(presets.back().sliders, sliderNames->Intern(sliderName), big, number);
             }
-            
-            data.orderedData = cleanedData;
         }
+
+    } catch (...) {
+        logFile << "ERROR tokenizing XML presets in " << filename << std::endl;
     }
-    
-    if (config.blacklistedPresetsSmartCleaningFromRandomDistribution) {
-        logFile << "Cleaning blacklistedPresetsFromRandomDistribution..." << std::endl;
-        
-        auto& data = processedData["blacklistedPresetsFromRandomDistribution"];
-        std::vector<std::pair<std::string, std::vector<std::string>>> cleanedData;
-        
-        for (auto& [plugin, presets] : data.orderedData) {
-            std::vector<std::string> cleanedPresets;
-            
-            for (const auto& preset : presets) {
-                std::string cleanPreset = preset;
-                bool hasExclamation = false;
-                
-                if (!cleanPreset.empty() && cleanPreset[0] == '!') {
-                    cleanPreset = cleanPreset.substr(1);
-                    hasExclamation = true;
-                }
-                
-                bool isProtected = false;
-                for (const auto& protectedPreset : PROTECTED_FROM_CLEANING) {
-                    if (cleanPreset == protectedPreset) {
-                        isProtected = true;
-                        break;
-                    }
-                }
-                
-                if (isProtected) {
-                    cleanedPresets.push_back(preset);
-                    totalPresetsKept++;
-                    logFile << "  Protected preset kept in blacklistedPresetsFromRandomDistribution: " << cleanPreset << std::endl;
-                } else {
-                    PresetMatchResult matchResult = FindPresetMatch(cleanPreset, presetData, logFile);
-                    
-                    if (matchResult.found) {
-                        std::string finalPresetName = matchResult.actualPresetName;
-                        
-                        if (hasExclamation && (finalPresetName.empty() || finalPresetName[0] != '!')) {
-                            finalPresetName = "!" + finalPresetName;
-                        }
-                        
-                        cleanedPresets.push_back(finalPresetName);
-                        totalPresetsKept++;
-                        
-                        if (preset != finalPresetName) {
-                            totalPresetsCorrected++;
-                            correctedPresets[preset] = finalPresetName;
-                            logFile << "  Corrected in blacklistedPresetsFromRandomDistribution: \"" 
-                                    << preset << "\" -> \"" << finalPresetName << "\" (Level " 
-                                    << matchResult.matchLevel << " match)" << std::endl;
-                        }
-                    } else {
-                        removedPresets.insert(cleanPreset);
-                        totalPresetsRemoved++;
-                        logFile << "  Removed from blacklistedPresetsFromRandomDistribution: " << cleanPreset << std::endl;
-                        
-                        if (std::find(missingPresetsFromIni.begin(), missingPresetsFromIni.end(), cleanPreset) == missingPresetsFromIni.end()) {
-                            missingPresetsFromIni.push_back(cleanPreset);
-                        }
-                    }
-                }
-            }
-            
-            if (!cleanedPresets.empty()) {
-                cleanedData.emplace_back(plugin, cleanedPresets);
-            }
-        }
-        
-        data.orderedData = cleanedData;
-    }
-    
-    if (config.blacklistedPresetsSmartCleaningFromAll) {
-        logFile << "Cleaning other blacklisted sections..." << std::endl;
-        
-        const std::vector<std::string> blacklistKeysToClean = {
-            "blacklistedNpcs", "blacklistedNpcsFormID", "blacklistedNpcsPluginFemale", 
-            "blacklistedNpcsPluginMale", "blacklistedRacesFemale", "blacklistedRacesMale",
-            "blacklistedOutfitsFromORefitFormID", "blacklistedOutfitsFromORefit",
-            "blacklistedOutfitsFromORefitPlugin"
-        };
-        
-        for (const auto& key : blacklistKeysToClean) {
-            auto& data = processedData[key];
-            std::vector<std::pair<std::string, std::vector<std::string>>> cleanedData;
-            
-            for (auto& [plugin, presets] : data.orderedData) {
-                std::vector<std::string> cleanedPresets;
-                
-                for (const auto& preset : presets) {
-                    std::string cleanPreset = preset;
-                    bool hasExclamation = false;
-                    
-                    if (!cleanPreset.empty() && cleanPreset[0] == '!') {
-                        cleanPreset = cleanPreset.substr(1);
-                        hasExclamation = true;
-                    }
-                    
-                    bool isProtected = false;
-                    for (const auto& protectedPreset : PROTECTED_FROM_CLEANING) {
-                        if (cleanPreset == protectedPreset) {
-                            isProtected = true;
-                            break;
-                        }
-                    }
-                    
-                    if (isProtected) {
-                        cleanedPresets.push_back(preset);
-                        totalPresetsKept++;
-                        logFile << "  Protected preset kept in " << key << ": " << cleanPreset << std::endl;
-                    } else {
-                        PresetMatchResult matchResult = FindPresetMatch(cleanPreset, presetData, logFile);
-                        
-                        if (matchResult.found) {
-                            std::string finalPresetName = matchResult.actualPresetName;
-                            
-                            if (hasExclamation && (finalPresetName.empty() || finalPresetName[0] != '!')) {
-                                finalPresetName = "!" + finalPresetName;
-                            }
-                            
-                            cleanedPresets.push_back(finalPresetName);
-                            totalPresetsKept++;
-                            
-                            if (preset != finalPresetName) {
-                                totalPresetsCorrected++;
-                                correctedPresets[preset] = finalPresetName;
-                                logFile << "  Corrected in " << key << ": \"" 
-                                        << preset << "\" -> \"" << finalPresetName << "\" (Level " 
-                                        << matchResult.matchLevel << " match)" << std::endl;
-                            }
-                        } else {
-                            removedPresets.insert(cleanPreset);
-                            totalPresetsRemoved++;
-                            logFile << "  Removed from " << key << ": " << cleanPreset << std::endl;
-                            
-                            if (std::find(missingPresetsFromIni.begin(), missingPresetsFromIni.end(), cleanPreset) == missingPresetsFromIni.end()) {
-                                missingPresetsFromIni.push_back(cleanPreset);
-                            }
-                        }
-                    }
-                }
-                
-                if (!cleanedPresets.empty()) {
-                    cleanedData.emplace_back(plugin, cleanedPresets);
-                }
-            }
-            
-            data.orderedData = cleanedData;
-        }
+
+    if (presets.empty()) {
+        XmlPreset fallback;
+        fallback.info.filename = filename;
+        fallback.info.extractionSuccessful = false;
+        presets.push_back(std::move(fallback));
+        presetGroups.push_back(std::move(leadingGroups));
+    } else if (!leadingGroups.empty()) {
+        presetGroups[0].insert(presetGroups[0].begin(), leadingGroups.begin(), leadingGroups.end());
     }
-    
-    if (config.outfitsForceReSmartCleaning) {
-        logFile << "Cleaning outfitsForceRefit sections..." << std::endl;
-        
-        const std::vector<std::string> outfitKeysToClean = {
-            "outfitsForceRefitFormID", "outfitsForceRefit"
-        };
-        
-        for (const auto& key : outfitKeysToClean) {
-            auto& data = processedData[key];
-            std::vector<std::pair<std::string, std::vector<std::string>>> cleanedData;
-            
-            for (auto& [plugin, presets] : data.orderedData) {
-                std::vector<std::string> cleanedPresets;
-                
-                for (const auto& preset : presets) {
-                    std::string cleanPreset = preset;
-                    bool hasExclamation = false;
-                    
-                    if (!cleanPreset.empty() && cleanPreset[0] == '!') {
-                        cleanPreset = cleanPreset.substr(1);
-                        hasExclamation = true;
-                    }
-                    
-                    PresetMatchResult matchResult = FindPresetMatch(cleanPreset, presetData, logFile);
-                    
-                    if (matchResult.found) {
-                        std::string finalPresetName = matchResult.actualPresetName;
-                        
-                        if (hasExclamation && (finalPresetName.empty() || finalPresetName[0] != '!')) {
-                            finalPresetName = "!" + finalPresetName;
-                        }
-                        
-                        cleanedPresets.push_back(finalPresetName);
-                        totalPresetsKept++;
-                        
-                        if (preset != finalPresetName) {
-                            totalPresetsCorrected++;
-                            correctedPresets[preset] = finalPresetName;
-                            logFile << "  Corrected in " << key << ": \"" 
-                                    << preset << "\" -> \"" << finalPresetName << "\" (Level " 
-                                    << matchResult.matchLevel << " match)" << std::endl;
-                        }
-                    } else {
-                        removedPresets.insert(cleanPreset);
-                        totalPresetsRemoved++;
-                        logFile << "  Removed from " << key << ": " << cleanPreset << std::endl;
-                        
-                        if (std::find(missingPresetsFromIni.begin(), missingPresetsFromIni.end(), cleanPreset) == missingPresetsFromIni.end()) {
-                            missingPresetsFromIni.push_back(cleanPreset);
-                        }
-                    }
-                }
-                
-                if (!cleanedPresets.empty()) {
-                    cleanedData.emplace_back(plugin, cleanedPresets);
-                }
-            }
-            
-            data.orderedData = cleanedData;
-        }
+
+    for (size_t i = 0; i < presets.size(); ++i) {
+        presets[i].analysis = ClassifyXmlGroups(presetGroups[i], frameworks);
+        if (i < presetShapes.size()) presets[i].shape = presetShapes[i].Metrics();
     }
-    
-    logFile << std::endl;
-    logFile << "Smart Cleaning Summary:" << std::endl;
-    logFile << "  Total presets removed: " << totalPresetsRemoved << std::endl;
-    logFile << "  Total presets kept: " << totalPresetsKept << std::endl;
-    logFile << "  Total presets corrected: " << totalPresetsCorrected << std::endl;
-    logFile << "  Unique presets removed: " << removedPresets.size() << std::endl;
-    
-    if (!missingPresetsFromIni.empty()) {
-        logFile << std::endl;
-        logFile << "WARNING: The following presets were referenced but not found in BodySlide folder:" << std::endl;
-        logFile << "These may have been added by INI rules. Please verify if they need to be downloaded:" << std::endl;
-        for (const auto& missingPreset : missingPresetsFromIni) {
-            logFile << "  - " << missingPreset << std::endl;
-        }
-        logFile << std::endl;
-        logFile << "You can search for these presets on Nexus Mods or other modding sites." << std::endl;
+    return presets;
+}
+
+static constexpr std::uint64_t PRESET_HASH_MULTIPLIER = 0xBF58476D1CE4E5B9ULL;
+
+// Whitespace-insensitive content hash for duplicate detection. A run of whitespace counts as one
+// space, and vanishes entirely next to a tag boundary or at either end, so re-indented and
+// CRLF/LF-converted copies hash alike. 0 means "no content" and is never returned otherwise.
+std::uint64_t HashPresetContent(const char* data, size_t size) {
+    std::uint64_t hash = 0x9E3779B97F4A7C15ULL;
+    std::uint64_t word = 0;
+    unsigned filled = 0;
+    std::uint64_t length = 0;
+
+    auto mix = [&hash](std::uint64_t value) {
+        hash ^= value;
+        hash *= PRESET_HASH_MULTIPLIER;
+        hash ^= hash >> 31;
+    };
+    auto emit = [&](unsigned char c) {
+        word |= static_cast<std::uint64_t>(c) << (filled * 8);
+        length++;
+        if (++filled == 8) {
+            mix(word);
+            word = 0;
+            filled = 0;
+        }
+    };
+
+    size_t pos = Utf8BomLength(data, size);
+    if (pos >= size) return 0;
+
+    unsigned char previous = '>';  // Leading whitespace is dropped
+    bool pendingSpace = false;
+    for (; pos < size; ++pos) {
+        unsigned char c = static_cast<unsigned char>(data[pos]);
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            pendingSpace = true;
+            continue;
+        }
+        if (pendingSpace && previous != '>' && c != '<') emit(' ');
+        pendingSpace = false;
+        emit(c);
+        previous = c;
     }
-    
-    logFile << std::endl;
+    if (length == 0) return 0;
+    mix(word);
+    mix(length);
+
+    // splitmix64 finalizer, so near-identical files land far apart
+    hash ^= hash >> 30;
+    hash *= PRESET_HASH_MULTIPLIER;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBULL;
+    hash ^= hash >> 31;
+    return hash ? hash : 1;
 }
 
-// ===== JSON VALIDATION FUNCTIONS =====
+// Maps the file and tokenizes it in place. opened is false when the file could not be mapped;
+// readable is also false when it has nothing past the BOM, so the catalog does not cache the result.
+std::vector<XmlPreset> ReadSliderPresets(const fs::path& filepath, const std::string& filename,
+                                         const FrameworkClassifier& frameworks, std::ostream& logFile, bool& opened,
+                                         bool& readable, std::uint64_t& contentHash,
+                                         SliderDictionary* sliderNames = nullptr) {
+    MappedFile mapped;
+    opened = false;
+    readable = false;
+    contentHash = 0;
+    if (!mapped.Open(filepath)) return TokenizeSliderPresets(nullptr, 0, filename, frameworks, logFile);
+    RecordFileOpened();
+    opened = true;
+
+    size_t size = mapped.Size();
+    readable = size > Utf8BomLength(mapped.Data(), size);
+
+    RecordBytesRead(size);
+    g_xmlBytesMapped += size;
+    g_xmlBytesTouched += size;
+    contentHash = HashPresetContent(mapped.Data(), size);
+    return TokenizeSliderPresets(mapped.Data(), size, filename, frameworks, logFile, sliderNames);
+}
 
-bool PerformSimpleJsonIntegrityCheck(const fs::path& jsonPath, std::ofstream& logFile) {
-    try {
-        logFile << "Performing SIMPLE JSON integrity check at startup..." << std::endl;
-        logFile << "----------------------------------------------------" << std::endl;
+// ===== WORKER POOL =====
 
-        if (!fs::exists(jsonPath)) {
-            logFile << "ERROR: JSON file does not exist at: " << jsonPath.string() << std::endl;
-            return false;
-        }
+// Automatic sizing leaves room for the game's own threads while the prescan overlaps loading.
+static constexpr size_t MAX_AUTOMATIC_WORKER_THREADS = 8;
+static constexpr size_t MAX_WORKER_THREADS = 64;
 
-        auto fileSize = fs::file_size(jsonPath);
-        if (fileSize < 10) {
-            logFile << "ERROR: JSON file is too small (" << fileSize << " bytes)" << std::endl;
-            return false;
+size_t ResolveWorkerThreads(int configured) {
+    if (configured > 0) return std::min(static_cast<size_t>(configured), MAX_WORKER_THREADS);
+    size_t hardware = std::thread::hardware_concurrency();
+    return std::clamp<size_t>(hardware, 1, MAX_AUTOMATIC_WORKER_THREADS);
+}
+
+// Work-stealing pool: each worker owns a deque, pops its own newest task and steals the oldest
+// task of another worker when it runs dry. Tasks submitted from a worker stay on its deque.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t workerCount) {
+        for (size_t i = 0; i < workerCount; ++i) {
+            queues_.push_back(std::make_unique<WorkQueue>());
+        }
+        for (size_t i = 0; i < workerCount; ++i) {
+            workers_.emplace_back([this, i]() { WorkerLoop(i); });
         }
+    }
 
-        std::string content = ReadFileWithEncoding(jsonPath);
-        if (content.empty()) {
-            logFile << "ERROR: JSON file is empty after reading" << std::endl;
-            return false;
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
         }
+    }
 
-        logFile << "JSON file size: " << fileSize << " bytes" << std::endl;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
 
-        content = content.substr(content.find_first_not_of(" \t\r\n"));
-        content = content.substr(0, content.find_last_not_of(" \t\r\n") + 1);
+    size_t WorkerCount() const { return workers_.size(); }
 
-        if (content.empty() || content[0] != '{' || content[content.length() - 1] != '}') {
-            logFile << "ERROR: JSON does not start with '{' or end with '}'" << std::endl;
-            return false;
+    void Submit(std::function<void()> task) {
+        size_t target = t_currentPool == this ? t_workerIndex : nextQueue_++ % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+            queues_[target]->tasks.push_back(std::move(task));
         }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            ++queued_;
+        }
+        wake_.notify_one();
+    }
 
-        int braceCount = 0;
-        int bracketCount = 0;
-        int parenCount = 0;
-        bool inString = false;
-        bool escape = false;
-        int line = 1;
-        int col = 1;
-
-        for (size_t i = 0; i < content.length(); i++) {
-            char c = content[i];
-            if (c == '\n') {
-                line++;
-                col = 1;
-                continue;
-            }
-            col++;
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool PopLocal(size_t index, std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        if (queues_[index]->tasks.empty()) return false;
+        task = std::move(queues_[index]->tasks.back());
+        queues_[index]->tasks.pop_back();
+        return true;
+    }
 
-            if (escape) {
-                escape = false;
-                continue;
-            }
+    bool Steal(size_t thief, std::function<void()>& task) {
+        for (size_t offset = 1; offset < queues_.size(); ++offset) {
+            WorkQueue& victim = *queues_[(thief + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty()) continue;
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
 
-            if (c == '\\') {
-                escape = true;
-                continue;
+    void WorkerLoop(size_t index) {
+        t_currentPool = this;
+        t_workerIndex = index;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(wakeMutex_);
+                wake_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+                if (queued_ == 0) return;
+                // Claiming under the lock guarantees a queued task exists for every claim
+                --queued_;
             }
 
-            if (c == '"') {
-                inString = !inString;
-                continue;
+            std::function<void()> task;
+            while (!PopLocal(index, task) && !Steal(index, task)) {
+                std::this_thread::yield();
             }
 
-            if (!inString) {
-                switch (c) {
-                    case '{':
-                        braceCount++;
-                        break;
-                    case '}':
-                        braceCount--;
-                        if (braceCount < 0) {
-                            logFile << "ERROR: Unbalanced closing brace '}' at line " << line << ", column " << col
-                                    << std::endl;
-                            return false;
-                        }
-                        break;
-                    case '[':
-                        bracketCount++;
-                        break;
-                    case ']':
-                        bracketCount--;
-                        if (bracketCount < 0) {
-                            logFile << "ERROR: Unbalanced closing bracket ']' at line " << line << ", column " << col
-                                    << std::endl;
-                            return false;
-                        }
-                        break;
-                    case '(':
-                        parenCount++;
-                        break;
-                    case ')':
-                        parenCount--;
-                        if (parenCount < 0) {
-                            logFile << "ERROR: Unbalanced closing parenthesis ')' at line " << line << ", column "
-                                    << col << std::endl;
-                            return false;
-                        }
-                        break;
-                }
+            try {
+                task();
+            } catch (...) {
             }
         }
+    }
 
-        if (braceCount != 0) {
-            logFile << "ERROR: Unbalanced braces (missing " << (braceCount > 0 ? "closing" : "opening")
-                    << " braces: " << abs(braceCount) << ")" << std::endl;
-            return false;
-        }
+    static thread_local ThreadPool* t_currentPool;
+    static thread_local size_t t_workerIndex;
 
-        if (bracketCount != 0) {
-            logFile << "ERROR: Unbalanced brackets (missing " << (bracketCount > 0 ? "closing" : "opening")
-                    << " brackets: " << abs(bracketCount) << ")" << std::endl;
-            return false;
-        }
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    size_t queued_ = 0;
+    bool stopping_ = false;
+    std::atomic<size_t> nextQueue_{0};
+};
 
-        if (parenCount != 0) {
-            logFile << "ERROR: Unbalanced parentheses (missing " << (parenCount > 0 ? "closing" : "opening")
-                    << " parentheses: " << abs(parenCount) << ")" << std::endl;
-            return false;
+thread_local ThreadPool* ThreadPool::t_currentPool = nullptr;
+thread_local size_t ThreadPool::t_workerIndex = 0;
+
+// One pool per distinct size, shared by the prescan and the pipeline and never destroyed:
+// joining threads from static destructors inside a DLL can deadlock at game exit.
+// Returns nullptr for a single thread, which TaskGraph runs inline on the caller.
+ThreadPool* AcquireWorkerPool(size_t threads) {
+    if (threads <= 1) return nullptr;
+
+    static std::mutex poolsMutex;
+    static std::map<size_t, ThreadPool*> pools;
+
+    std::lock_guard<std::mutex> lock(poolsMutex);
+    ThreadPool*& pool = pools[threads];
+    if (!pool) pool = new ThreadPool(threads);
+    return pool;
+}
+
+// Runs body(chunk, begin, end) over [0, count) in fixed chunks. The calling thread works too, so
+// this is safe from inside a pool task; helpers that only start after the last chunk was claimed
+// return without touching body. I/O done by helpers is added to the caller's thread counters,
+// so the caller's stage metrics still cover the whole job. The first exception thrown by body is
+// rethrown on the calling thread once every chunk has finished.
+void ParallelForChunks(ThreadPool* pool, size_t count, size_t chunkSize,
+                       const std::function<void(size_t, size_t, size_t)>& body) {
+    size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    if (!pool || chunkCount <= 1) {
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            body(chunk, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
         }
+        return;
+    }
 
-        const std::vector<std::string> expectedKeys = {
-            "npcFormID",       "npc",           "factionFemale", "factionMale",
-            "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+    struct SharedState {
+        std::atomic<size_t> nextChunk{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t chunksDone = 0;
+        IoCounters helperIo;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<SharedState>();
+    const auto* bodyPtr = &body;
+
+    auto drain = [state, bodyPtr, count, chunkSize, chunkCount](bool helper) {
+        while (true) {
+            size_t chunk = state->nextChunk++;
+            if (chunk >= chunkCount) return;
+
+            IoCounters before = t_ioCounters;
+            std::exception_ptr error;
+            try {
+                (*bodyPtr)(chunk, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+            } catch (...) {
+                error = std::current_exception();
+            }
 
-        int foundKeys = 0;
-        for (const auto& key : expectedKeys) {
-            if (content.find("\"" + key + "\"") != std::string::npos) {
-                foundKeys++;
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (error && !state->error) state->error = error;
+            if (helper) {
+                state->helperIo.filesOpened += t_ioCounters.filesOpened - before.filesOpened;
+                state->helperIo.bytesRead += t_ioCounters.bytesRead - before.bytesRead;
+                state->helperIo.bytesWritten += t_ioCounters.bytesWritten - before.bytesWritten;
             }
+            if (++state->chunksDone == chunkCount) state->done.notify_all();
         }
+    };
 
-        if (foundKeys < 6) {
-            logFile << "ERROR: JSON appears to be corrupted or not a valid OBody config file" << std::endl;
-            logFile << " Expected at least 6 OBody keys, found only " << foundKeys << std::endl;
-            return false;
-        }
+    size_t helpers = std::min(pool->WorkerCount(), chunkCount - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        pool->Submit([drain]() { drain(true); });
+    }
+    drain(false);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&]() { return state->chunksDone == chunkCount; });
+    t_ioCounters.filesOpened += state->helperIo.filesOpened;
+    t_ioCounters.bytesRead += state->helperIo.bytesRead;
+    t_ioCounters.bytesWritten += state->helperIo.bytesWritten;
+    if (state->error) std::rethrow_exception(state->error);
+}
 
-        std::string cleanContent = content;
-        bool inStr = false;
-        bool esc = false;
-        for (size_t i = 0; i < cleanContent.length(); i++) {
-            if (esc) {
-                cleanContent[i] = ' ';
-                esc = false;
-                continue;
-            }
+// ===== PRESET CATALOG (ONE ENUMERATION, ONE READ PER XML) =====
+
+// Every stage that needs SliderPresets (Doctor, preset map, Smart Cleaning, Helper, UBE)
+// works from this catalog instead of walking the folder and re-reading the XMLs itself.
+struct PresetCatalogEntry {
+    std::string xmlFilename;
+    fs::path path;
+    std::vector<XmlPreset> presets;  // Never empty: one per <Preset>, or a single unsuccessful one
+    std::uintmax_t size = 0;         // As enumerated, so watch mode can tell real changes from echoes
+    long long mtime = 0;
+    std::uint64_t contentHash = 0;   // HashPresetContent; 0 if the file could not be read
+    bool duplicate = false;          // Same content and presets as an earlier entry in filename order
+};
 
-            if (cleanContent[i] == '\\') {
-                esc = true;
-                cleanContent[i] = ' ';
-                continue;
-            }
+struct PresetCatalog {
+    fs::path folder;
+    bool folderFound = false;
+    bool iterationFailed = false;
+    std::vector<PresetCatalogEntry> entries;
+    std::vector<std::vector<size_t>> duplicateGroups;  // Entry indices, the kept (first) entry leading
+    std::shared_ptr<SliderDictionary> sliderNames;      // Set when the catalog reads sliders
+    int totalScanned = 0;
+    int filenameFailed = 0;
+    size_t xmlFilesOpened = 0;
+    bool cacheEnabled = false;
+    size_t cacheHits = 0;
+    size_t cacheMisses = 0;
+    size_t cacheEvictions = 0;
+};
 
-            if (cleanContent[i] == '"') {
-                inStr = !inStr;
-                cleanContent[i] = ' ';
-                continue;
-            }
+// Big modlists ship the same preset under several filenames. Entries whose content hash and
+// preset names match an earlier entry are marked duplicate: the preset map keeps only their
+// filenames as aliases and the UBE stages skip them. Matching names are required because a
+// CustomPreset or a failed extraction is named after its file, so the copies are not the same preset.
+void GroupDuplicateEntries(PresetCatalog& catalog) {
+    catalog.duplicateGroups.clear();
+    std::unordered_map<std::uint64_t, size_t> groupByHash;
+    std::unordered_map<std::uint64_t, size_t> firstByHash;
+
+    for (size_t i = 0; i < catalog.entries.size(); ++i) {
+        PresetCatalogEntry& entry = catalog.entries[i];
+        entry.duplicate = false;
+        if (entry.contentHash == 0) continue;
+
+        auto first = firstByHash.emplace(entry.contentHash, i);
+        if (first.second) continue;
+
+        const PresetCatalogEntry& kept = catalog.entries[first.first->second];
+        bool samePresets = kept.presets.size() == entry.presets.size();
+        for (size_t p = 0; samePresets && p < entry.presets.size(); ++p) {
+            const XmlPresetInfo& a = kept.presets[p].info;
+            const XmlPresetInfo& b = entry.presets[p].info;
+            samePresets = a.extractionSuccessful && b.extractionSuccessful && a.internalName == b.internalName;
+        }
+        if (!samePresets) continue;
+
+        entry.duplicate = true;
+        auto group = groupByHash.find(entry.contentHash);
+        if (group == groupByHash.end()) {
+            group = groupByHash.emplace(entry.contentHash, catalog.duplicateGroups.size()).first;
+            catalog.duplicateGroups.push_back({first.first->second});
+        }
+        catalog.duplicateGroups[group->second].push_back(i);
+    }
+}
 
-            if (inStr) {
-                cleanContent[i] = ' ';
-            }
-        }
+size_t CountDuplicateEntries(const PresetCatalog& catalog) {
+    size_t count = 0;
+    for (const auto& group : catalog.duplicateGroups) count += group.size() - 1;
+    return count;
+}
 
-        if (cleanContent.find(",,") != std::string::npos) {
-            logFile << "ERROR: Found double comma ',,' in JSON structure" << std::endl;
-            return false;
-        }
+// ===== DIRECTORY ENUMERATION =====
 
-        if (cleanContent.find(",}") != std::string::npos) {
-            logFile << "WARNING: Found comma before closing brace ',}' (may cause issues)" << std::endl;
-        }
+// Data holds thousands of plugins and archives (each one a USVFS lookup under MO2) next to the few
+// OBodyNG_PDA_*.ini files. EnumerateDirectory filters names inside the enumeration loop and takes
+// size and mtime from the enumeration itself: FindFirstFileExW with a prefix*suffix pattern on
+// Windows, getdents64 on Linux, where only names that match are stat'ed. Stamps are FILETIME ticks
+// on Windows and nanoseconds since the Unix epoch elsewhere.
 
-        if (cleanContent.find(",]") != std::string::npos) {
-            logFile << "WARNING: Found comma before closing bracket ',]' (may cause issues)" << std::endl;
-        }
+struct FileStamp {
+    bool exists = false;
+    std::uintmax_t size = 0;
+    long long mtime = 0;
+};
 
-        logFile << "SUCCESS: JSON passed SIMPLE integrity check" << std::endl;
-        logFile << " Found " << foundKeys << " valid OBody keys" << std::endl;
-        logFile << " Braces balanced: " << (braceCount == 0 ? "YES" : "NO") << std::endl;
-        logFile << " Brackets balanced: " << (bracketCount == 0 ? "YES" : "NO") << std::endl;
-        logFile << " Basic structure: VALID" << std::endl;
-        logFile << std::endl;
+struct DirectoryEntry {
+    fs::path path;
+    std::string name;  // UTF-8
+    FileStamp stamp;
+};
 
-        return true;
-    } catch (const std::exception& e) {
-        logFile << "ERROR in PerformSimpleJsonIntegrityCheck: " << e.what() << std::endl;
-        return false;
-    } catch (...) {
-        logFile << "ERROR in PerformSimpleJsonIntegrityCheck: Unknown exception" << std::endl;
-        return false;
-    }
+const size_t DIRECTORY_READ_BUFFER_SIZE = 64 * 1024;
+
+#ifdef _WIN32
+long long FileTimeToStamp(const FILETIME& time) {
+    return static_cast<long long>((static_cast<std::uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime);
 }
 
-bool PerformTripleValidation(const fs::path& jsonPath, const fs::path& backupPath, std::ofstream& logFile) {
-    try {
-        if (!fs::exists(jsonPath)) {
-            logFile << "ERROR: JSON file does not exist for validation: " << jsonPath.string() << std::endl;
-            return false;
-        }
+std::uintmax_t FileSizeFromParts(DWORD high, DWORD low) {
+    return (static_cast<std::uintmax_t>(high) << 32) | low;
+}
+#else
+long long StatToStamp(const struct stat& info) {
+#if defined(__APPLE__)
+    return static_cast<long long>(info.st_mtimespec.tv_sec) * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+    return static_cast<long long>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+}
+#endif
+
+FileStamp StatFile(const fs::path& path) {
+    FileStamp stamp;
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) return stamp;
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) return stamp;
+    stamp.size = FileSizeFromParts(data.nFileSizeHigh, data.nFileSizeLow);
+    stamp.mtime = FileTimeToStamp(data.ftLastWriteTime);
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return stamp;
+    stamp.size = static_cast<std::uintmax_t>(info.st_size);
+    stamp.mtime = StatToStamp(info);
+#endif
+    stamp.exists = true;
+    return stamp;
+}
 
-        auto fileSize = fs::file_size(jsonPath);
-        if (fileSize < 10) {
-            logFile << "ERROR: JSON file is too small (" << fileSize << " bytes)" << std::endl;
-            return false;
-        }
+bool MatchesFilePattern(std::string_view name, std::string_view prefix, std::string_view suffix) {
+    return name.size() >= prefix.size() + suffix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
 
-        std::string content = ReadFileWithEncoding(jsonPath);
-        if (content.empty()) {
-            logFile << "ERROR: JSON file is empty after reading" << std::endl;
-            return false;
-        }
+#ifdef _WIN32
+// Exact UTF-8 for a file name; false for names that are not valid UTF-16 (unpaired surrogates),
+// which SafeWideStringToString would only approximate.
+bool WideFileNameToUtf8(const wchar_t* wideName, std::string& name) {
+    int length = static_cast<int>(std::wstring_view(wideName).size());
+    int needed = WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, wideName, length, nullptr, 0, nullptr, nullptr);
+    if (needed <= 0) return false;
+    name.assign(static_cast<size_t>(needed), '\0');
+    return WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, wideName, length, &name[0], needed, nullptr,
+                               nullptr) == needed;
+}
+#endif
+
+// Regular files of folder named prefix...suffix (case-sensitive, like StartsWith/EndsWith), in
+// enumeration order. enumerated counts every entry the OS returned; on Windows the pattern is
+// applied by the OS, so that is only the entries matching it case-insensitively. unreadableNames
+// counts files skipped because their name has no exact UTF-8 form (Windows only).
+std::vector<DirectoryEntry> EnumerateDirectory(const fs::path& folder, const std::string& prefix,
+                                               const std::string& suffix, std::error_code& error,
+                                               size_t* enumerated = nullptr, size_t* unreadableNames = nullptr) {
+    std::vector<DirectoryEntry> entries;
+    error.clear();
+
+#ifdef _WIN32
+    std::wstring pattern = (folder / fs::u8path(prefix + "*" + suffix)).wstring();
+    WIN32_FIND_DATAW data;
+    HANDLE find = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr,
+                                   FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE) {
+        DWORD code = GetLastError();
+        if (code != ERROR_FILE_NOT_FOUND) error = std::error_code(static_cast<int>(code), std::system_category());
+        return entries;
+    }
 
-        content = Trim(content);
-        if (content.empty() || content[0] != '{' || content[content.length() - 1] != '}') {
-            logFile << "ERROR: JSON file does not have proper structure (missing braces)" << std::endl;
-            return false;
+    do {
+        std::wstring_view wideName(data.cFileName);
+        if (wideName == L"." || wideName == L"..") continue;
+        if (enumerated) ++*enumerated;
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+
+        std::string name;
+        if (!WideFileNameToUtf8(data.cFileName, name)) {
+            if (unreadableNames) ++*unreadableNames;
+            continue;
+        }
+        // The OS pattern also matches 8.3 short names and ignores case, so the exact test stays
+        if (!MatchesFilePattern(name, prefix, suffix)) continue;
+
+        DirectoryEntry entry;
+        entry.path = folder / data.cFileName;
+        entry.name = std::move(name);
+        entry.stamp.exists = true;
+        entry.stamp.size = FileSizeFromParts(data.nFileSizeHigh, data.nFileSizeLow);
+        entry.stamp.mtime = FileTimeToStamp(data.ftLastWriteTime);
+        entries.push_back(std::move(entry));
+    } while (FindNextFileW(find, &data));
+
+    DWORD code = GetLastError();
+    if (code != ERROR_NO_MORE_FILES) error = std::error_code(static_cast<int>(code), std::system_category());
+    FindClose(find);
+#else
+    (void)unreadableNames;  // POSIX names are raw bytes, nothing to convert
+    int directory = open(folder.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directory < 0) {
+        error = std::error_code(errno, std::generic_category());
+        return entries;
+    }
+
+    auto consider = [&](const char* rawName, unsigned char type) {
+        std::string_view name(rawName);
+        if (name == "." || name == "..") return;
+        if (enumerated) ++*enumerated;
+        if (type == DT_DIR || !MatchesFilePattern(name, prefix, suffix)) return;
+
+        // Follows symlinks, as is_regular_file did
+        struct stat info;
+        if (fstatat(directory, rawName, &info, 0) != 0 || !S_ISREG(info.st_mode)) return;
+
+        DirectoryEntry entry;
+        entry.path = folder / std::string(name);
+        entry.name = std::string(name);
+        entry.stamp.exists = true;
+        entry.stamp.size = static_cast<std::uintmax_t>(info.st_size);
+        entry.stamp.mtime = StatToStamp(info);
+        entries.push_back(std::move(entry));
+    };
+
+#if defined(__linux__)
+    struct LinuxDirent64 {
+        std::uint64_t ino;
+        std::int64_t offset;
+        unsigned short length;
+        unsigned char type;
+        char name[1];
+    };
+
+    std::vector<char> buffer(DIRECTORY_READ_BUFFER_SIZE);
+    while (true) {
+        long got = syscall(SYS_getdents64, directory, buffer.data(), buffer.size());
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) {
+            error = std::error_code(errno, std::generic_category());
+            break;
+        }
+        if (got == 0) break;
+        for (long offset = 0; offset < got;) {
+            const auto* record = reinterpret_cast<const LinuxDirent64*>(buffer.data() + offset);
+            offset += record->length;
+            consider(record->name, record->type);
         }
+    }
+    close(directory);
+#else
+    int listing = dup(directory);
+    DIR* stream = listing >= 0 ? fdopendir(listing) : nullptr;
+    if (!stream) {
+        error = std::error_code(errno, std::generic_category());
+        if (listing >= 0) close(listing);
+        close(directory);
+        return entries;
+    }
+    while (const dirent* record = readdir(stream)) consider(record->d_name, record->d_type);
+    closedir(stream);
+    close(directory);
+#endif
+#endif
 
-        int braceCount = 0;
-        int bracketCount = 0;
-        bool inString = false;
-        bool escape = false;
+    return entries;
+}
 
-        for (char c : content) {
-            if (c == '"' && !escape) {
-                inString = !inString;
-            } else if (!inString) {
-                if (c == '{')
-                    braceCount++;
-                else if (c == '}')
-                    braceCount--;
-                else if (c == '[')
-                    bracketCount++;
-                else if (c == ']')
-                    bracketCount--;
-            }
+// ===== PRESET CATALOG CACHE =====
 
-            escape = (c == '\\' && !escape);
-        }
+// Per-XML results persisted under Backup_OBody_DPA so a warm start does not open any XML.
+// Entries are keyed by the filename relative to SliderPresets and are only trusted while
+// the file size and mtime stamp (see DIRECTORY ENUMERATION) still match. Group names are stored raw and
+// re-classified on load, so changes to the UBE/3BA rules never need a cache bump.
+const char* const PRESET_CATALOG_CACHE_HEADER = "OBODY_PDA_PRESET_CATALOG_CACHE";
+const int PRESET_CATALOG_CACHE_VERSION = 6;
 
-        if (braceCount != 0 || bracketCount != 0) {
-            logFile << "ERROR: JSON has unbalanced braces/brackets (braces: " << braceCount
-                    << ", brackets: " << bracketCount << ")" << std::endl;
-            return false;
-        }
+struct PresetCatalogCacheSlider {
+    std::string name;
+    float small = 0.0f;
+    float big = 0.0f;
+};
 
-        const std::vector<std::string> expectedKeys = {
-            "npcFormID",       "npc",           "factionFemale", "factionMale",
-            "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+struct PresetCatalogCachePreset {
+    bool extractionSuccessful = false;
+    std::string internalName;
+    std::string setName;
+    std::vector<std::string> groupNames;
+    ShapeMetrics shape;
+    std::vector<PresetCatalogCacheSlider> sliders;
+};
 
-        int foundKeys = 0;
-        for (const auto& key : expectedKeys) {
-            if (content.find("\"" + key + "\"") != std::string::npos) {
-                foundKeys++;
-            }
-        }
+struct PresetCatalogCacheEntry {
+    std::uintmax_t size = 0;
+    long long mtime = 0;
+    std::uint64_t contentHash = 0;
+    bool hasSliders = false;  // Read with Preset_Clusters on; without it the sliders were never parsed
+    std::vector<PresetCatalogCachePreset> presets;
+};
 
-        if (foundKeys < 6) {
-            logFile << "ERROR: JSON appears corrupted (missing expected keys, found only " << foundKeys << " out of "
-                    << expectedKeys.size() << ")" << std::endl;
-            return false;
+// Shortest text that reads back as the same float, so cached and freshly read sliders cluster alike.
+std::string FormatCacheFloat(float value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", static_cast<double>(value));
+    return buffer;
+}
+
+std::string EscapeCacheField(const std::string& str) {
+    std::string result;
+    result.reserve(str.length());
+    for (char c : str) {
+        switch (c) {
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\t':
+                result += "\\t";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            case '\r':
+                result += "\\r";
+                break;
+            default:
+                result += c;
         }
+    }
+    return result;
+}
 
-        logFile << "SUCCESS: JSON file passed TRIPLE validation (" << fileSize << " bytes, " << foundKeys
-                << " valid keys found)" << std::endl;
-        return true;
-    } catch (const std::exception& e) {
-        logFile << "ERROR in PerformTripleValidation: " << e.what() << std::endl;
-        return false;
-    } catch (...) {
-        logFile << "ERROR in PerformTripleValidation: Unknown exception" << std::endl;
-        return false;
+std::string UnescapeCacheField(const std::string& str) {
+    std::string result;
+    result.reserve(str.length());
+    for (size_t i = 0; i < str.length(); ++i) {
+        if (str[i] == '\\' && i + 1 < str.length()) {
+            char next = str[++i];
+            if (next == 't')
+                result += '\t';
+            else if (next == 'n')
+                result += '\n';
+            else if (next == 'r')
+                result += '\r';
+            else
+                result += next;
+        } else {
+            result += str[i];
+        }
     }
+    return result;
 }
 
-// ===== BACKUP AND RESTORE FUNCTIONS =====
+// Line format: filename \t size \t mtime \t contentHash (hex) \t presetCount, then for each preset
+// \t success \t internalName \t setName \t groupCount [\t group]... \t metricCount [\t small... \t big...]
+// \t sliderCount [\t name \t small \t big]..., where metricCount is 0 for an unmeasured preset and
+// sliderCount is "-" if the sliders were not read.
+std::unordered_map<std::string, PresetCatalogCacheEntry> LoadPresetCatalogCache(const fs::path& cachePath,
+                                                                                std::ostream& logFile) {
+    std::unordered_map<std::string, PresetCatalogCacheEntry> cache;
 
-bool PerformLiteralJsonBackup(const fs::path& originalJsonPath, const fs::path& backupJsonPath,
-                              std::ofstream& logFile) {
     try {
-        if (!fs::exists(originalJsonPath)) {
-            logFile << "ERROR: Original JSON file does not exist at: " << originalJsonPath.string() << std::endl;
-            return false;
+        if (cachePath.empty() || !fs::exists(cachePath)) return cache;
+
+        std::ifstream file(cachePath, std::ios::binary);
+        if (!file.is_open()) {
+            logFile << "WARNING: Could not open preset catalog cache, rebuilding" << std::endl;
+            return cache;
+        }
+        RecordFileOpened();
+        {
+            std::error_code sizeError;
+            auto cacheSize = fs::file_size(cachePath, sizeError);
+            if (!sizeError) RecordBytesRead(static_cast<std::uint64_t>(cacheSize));
         }
 
-        CreateDirectoryIfNotExists(backupJsonPath.parent_path());
+        std::string line;
+        if (!std::getline(file, line) ||
+            line != std::string(PRESET_CATALOG_CACHE_HEADER) + " v" + std::to_string(PRESET_CATALOG_CACHE_VERSION)) {
+            logFile << "Preset catalog cache version mismatch, rebuilding" << std::endl;
+            return cache;
+        }
+
+        while (std::getline(file, line)) {
+            if (line.empty()) continue;
+
+            std::vector<std::string> fields;
+            size_t start = 0;
+            while (true) {
+                size_t tab = line.find('\t', start);
+                fields.push_back(UnescapeCacheField(line.substr(start, tab - start)));
+                if (tab == std::string::npos) break;
+                start = tab + 1;
+            }
 
-        std::error_code ec;
-        fs::copy_file(originalJsonPath, backupJsonPath, fs::copy_options::overwrite_existing, ec);
+            if (fields.size() < 5) continue;
 
-        if (ec) {
-            logFile << "ERROR: Failed to copy JSON file directly: " << ec.message() << std::endl;
-            return false;
-        }
+            try {
+                PresetCatalogCacheEntry entry;
+                entry.size = static_cast<std::uintmax_t>(std::stoull(fields[1]));
+                entry.mtime = std::stoll(fields[2]);
+                entry.contentHash = std::stoull(fields[3], nullptr, 16);
+
+                size_t presetCount = static_cast<size_t>(std::stoul(fields[4]));
+                size_t field = 5;
+                bool valid = presetCount > 0;
+                for (size_t i = 0; valid && i < presetCount; ++i) {
+                    if (fields.size() < field + 4) {
+                        valid = false;
+                        break;
+                    }
+                    PresetCatalogCachePreset preset;
+                    preset.extractionSuccessful = fields[field] == "1";
+                    preset.internalName = fields[field + 1];
+                    preset.setName = fields[field + 2];
+                    size_t groupCount = static_cast<size_t>(std::stoul(fields[field + 3]));
+                    field += 4;
+                    if (fields.size() < field + groupCount) {
+                        valid = false;
+                        break;
+                    }
+                    preset.groupNames.assign(fields.begin() + field, fields.begin() + field + groupCount);
+                    field += groupCount;
 
-        try {
-            auto originalSize = fs::file_size(originalJsonPath);
-            auto backupSize = fs::file_size(backupJsonPath);
+                    // Metrics from a different metric table are read again
+                    if (fields.size() < field + 1) {
+                        valid = false;
+                        break;
+                    }
+                    size_t metricCount = static_cast<size_t>(std::stoul(fields[field++]));
+                    if ((metricCount != 0 && metricCount != SHAPE_METRIC_COUNT * 2) ||
+                        fields.size() < field + metricCount) {
+                        valid = false;
+                        break;
+                    }
+                    preset.shape.measured = metricCount > 0;
+                    for (size_t m = 0; m < metricCount; ++m) {
+                        float value = std::stof(fields[field++]);
+                        (m < SHAPE_METRIC_COUNT ? preset.shape.small[m] : preset.shape.big[m - SHAPE_METRIC_COUNT]) =
+                            value;
+                    }
 
-            if (originalSize == backupSize && originalSize > 0) {
-                logFile << "SUCCESS: LITERAL JSON backup completed to: " << backupJsonPath.string() << std::endl;
-                logFile << "Backup file size: " << backupSize << " bytes (verified identical to original)" << std::endl;
-                return true;
-            } else {
-                logFile << "ERROR: Backup file size mismatch - Original: " << originalSize << ", Backup: " << backupSize
-                        << std::endl;
-                return false;
-            }
+                    if (fields.size() < field + 1) {
+                        valid = false;
+                        break;
+                    }
+                    bool hasSliders = fields[field] != "-";
+                    if (i > 0 && hasSliders != entry.hasSliders) {
+                        valid = false;
+                        break;
+                    }
+                    entry.hasSliders = hasSliders;
+                    size_t sliderCount = hasSliders ? static_cast<size_t>(std::stoul(fields[field])) : 0;
+                    field++;
+                    if (fields.size() < field + sliderCount * 3) {
+                        valid = false;
+                        break;
+                    }
+                    preset.sliders.reserve(sliderCount);
+                    for (size_t k = 0; k < sliderCount; ++k, field += 3) {
+                        preset.sliders.push_back(
+                            {fields[field], std::stof(fields[field + 1]), std::stof(fields[field + 2])});
+                    }
+                    entry.presets.push_back(std::move(preset));
+                }
+                if (!valid || field != fields.size()) continue;
 
-        } catch (...) {
-            logFile << "SUCCESS: LITERAL JSON backup completed (size verification failed but backup exists)"
-                    << std::endl;
-            return true;
+                cache[fields[0]] = std::move(entry);
+            } catch (...) {
+                continue;
+            }
         }
 
     } catch (const std::exception& e) {
-        logFile << "ERROR in PerformLiteralJsonBackup: " << e.what() << std::endl;
-        return false;
+        logFile << "WARNING: Could not read preset catalog cache: " << e.what() << std::endl;
+        cache.clear();
     } catch (...) {
-        logFile << "ERROR in PerformLiteralJsonBackup: Unknown exception" << std::endl;
-        return false;
+        logFile << "WARNING: Could not read preset catalog cache: Unknown exception" << std::endl;
+        cache.clear();
     }
+
+    return cache;
 }
 
-bool MoveCorruptedJsonToAnalysis(const fs::path& corruptedJsonPath, const fs::path& analysisDir,
-                                 std::ofstream& logFile) {
+bool SavePresetCatalogCache(const fs::path& cachePath,
+                            const std::unordered_map<std::string, PresetCatalogCacheEntry>& cache,
+                            std::ostream& logFile) {
     try {
-        if (!fs::exists(corruptedJsonPath)) {
-            logFile << "WARNING: Corrupted JSON file does not exist for analysis" << std::endl;
-            return false;
-        }
+        CreateDirectoryIfNotExists(cachePath.parent_path());
 
-        CreateDirectoryIfNotExists(analysisDir);
+        fs::path tempPath = cachePath;
+        tempPath.replace_extension(".tmp");
 
-        auto now = std::chrono::system_clock::now();
-        std::time_t time_t = std::chrono::system_clock::to_time_t(now);
-        std::tm tm;
-        localtime_s(&tm, &time_t);
+        std::vector<const std::pair<const std::string, PresetCatalogCacheEntry>*> ordered;
+        ordered.reserve(cache.size());
+        for (const auto& item : cache) ordered.push_back(&item);
+        std::sort(ordered.begin(), ordered.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
 
-        char timestamp[32];
-        strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", &tm);
+        {
+            std::ofstream file(tempPath, std::ios::out | std::ios::trunc | std::ios::binary);
+            if (!file.is_open()) {
+                logFile << "WARNING: Could not write preset catalog cache" << std::endl;
+                return false;
+            }
 
-        fs::path analysisFile =
-            analysisDir / ("OBody_presetDistributionConfig_corrupted_" + std::string(timestamp) + ".json");
+            file << PRESET_CATALOG_CACHE_HEADER << " v" << PRESET_CATALOG_CACHE_VERSION << "\n";
+            for (const auto* item : ordered) {
+                const PresetCatalogCacheEntry& entry = item->second;
+                file << EscapeCacheField(item->first) << '\t' << entry.size << '\t' << entry.mtime << '\t'
+                     << std::hex << entry.contentHash << std::dec << '\t' << entry.presets.size();
+                for (const auto& preset : entry.presets) {
+                    file << '\t' << (preset.extractionSuccessful ? "1" : "0") << '\t'
+                         << EscapeCacheField(preset.internalName) << '\t' << EscapeCacheField(preset.setName) << '\t'
+                         << preset.groupNames.size();
+                    for (const auto& group : preset.groupNames) {
+                        file << '\t' << EscapeCacheField(group);
+                    }
+                    if (preset.shape.measured) {
+                        file << '\t' << SHAPE_METRIC_COUNT * 2;
+                        for (float value : preset.shape.small) file << '\t' << FormatCacheFloat(value);
+                        for (float value : preset.shape.big) file << '\t' << FormatCacheFloat(value);
+                    } else {
+                        file << "\t0";
+                    }
+                    if (!entry.hasSliders) {
+                        file << "\t-";
+                        continue;
+                    }
+                    file << '\t' << preset.sliders.size();
+                    for (const auto& slider : preset.sliders) {
+                        file << '\t' << EscapeCacheField(slider.name) << '\t' << FormatCacheFloat(slider.small) << '\t'
+                             << FormatCacheFloat(slider.big);
+                    }
+                }
+                file << "\n";
+            }
 
-        std::error_code ec;
-        fs::copy_file(corruptedJsonPath, analysisFile, fs::copy_options::overwrite_existing, ec);
+            RecordStreamWritten(file);
+            file.close();
+            if (file.fail()) {
+                logFile << "WARNING: Failed to write preset catalog cache" << std::endl;
+                return false;
+            }
+        }
 
+        std::error_code ec;
+        fs::rename(tempPath, cachePath, ec);
         if (ec) {
-            logFile << "ERROR: Failed to move corrupted JSON to analysis folder: " << ec.message() << std::endl;
+            logFile << "WARNING: Failed to replace preset catalog cache: " << ec.message() << std::endl;
+            fs::remove(tempPath, ec);
             return false;
         }
-
-        logFile << "SUCCESS: Corrupted JSON moved to analysis folder: " << analysisFile.string() << std::endl;
         return true;
+
     } catch (const std::exception& e) {
-        logFile << "ERROR in MoveCorruptedJsonToAnalysis: " << e.what() << std::endl;
+        logFile << "WARNING: Could not save preset catalog cache: " << e.what() << std::endl;
         return false;
     } catch (...) {
-        logFile << "ERROR in MoveCorruptedJsonToAnalysis: Unknown exception" << std::endl;
+        logFile << "WARNING: Could not save preset catalog cache: Unknown exception" << std::endl;
         return false;
     }
 }
 
-bool RestoreJsonFromBackup(const fs::path& backupJsonPath, const fs::path& originalJsonPath,
-                           const fs::path& analysisDir, std::ofstream& logFile) {
-    try {
-        if (!fs::exists(backupJsonPath)) {
-            logFile << "ERROR: Backup JSON file does not exist: " << backupJsonPath.string() << std::endl;
-            return false;
-        }
-
-        if (!PerformTripleValidation(backupJsonPath, fs::path(), logFile)) {
-            logFile << "ERROR: Backup JSON file is also corrupted, cannot restore" << std::endl;
-            return false;
-        }
-
-        logFile << "WARNING: Original JSON appears corrupted, restoring from backup..." << std::endl;
-
-        if (fs::exists(originalJsonPath)) {
-            MoveCorruptedJsonToAnalysis(originalJsonPath, analysisDir, logFile);
-        }
+// Cache misses waiting to be read and parsed, and their results.
+struct PendingXml {
+    PresetCatalogEntry entry;
+    std::string stem;
+    std::uintmax_t size = 0;
+    long long stamp = 0;
+    bool statOk = false;
+};
 
-        std::error_code ec;
-        fs::copy_file(backupJsonPath, originalJsonPath, fs::copy_options::overwrite_existing, ec);
+struct ParsedXml {
+    PresetCatalogEntry entry;
+    std::string log;
+    bool opened = false;
+    bool readable = false;
+};
 
-        if (ec) {
-            logFile << "ERROR: Failed to restore JSON from backup: " << ec.message() << std::endl;
-            return false;
-        }
+// Small enough that idle workers can still steal near the end of a 20k-file folder
+static constexpr size_t XML_PARSE_CHUNK_SIZE = 32;
 
-        if (PerformTripleValidation(originalJsonPath, fs::path(), logFile)) {
-            logFile << "SUCCESS: JSON restored from backup successfully" << std::endl;
-            return true;
-        } else {
-            logFile << "ERROR: Restored JSON is still invalid" << std::endl;
-            return false;
-        }
+// Enumeration and cache lookups are sequential; reading and parsing the misses is spread over the
+// pool. Each chunk fills its own buffer, and results (and their log lines) are merged in filename
+// order, so the catalog and the log never depend on scheduling.
+PresetCatalog BuildPresetCatalog(const fs::path& bodySlidePresetsPath, const fs::path& cachePath,
+                                 const FrameworkClassifier& frameworks, std::ostream& logFile, ThreadPool* pool,
+                                 ReadBackend readBackend, bool readSliders = false) {
+    PresetCatalog catalog;
+    catalog.folder = bodySlidePresetsPath;
+    catalog.cacheEnabled = !cachePath.empty();
+    if (readSliders) catalog.sliderNames = std::make_shared<SliderDictionary>();
+    SliderDictionary* sliderNames = catalog.sliderNames.get();
 
-    } catch (const std::exception& e) {
-        logFile << "ERROR in RestoreJsonFromBackup: " << e.what() << std::endl;
-        return false;
-    } catch (...) {
-        logFile << "ERROR in RestoreJsonFromBackup: Unknown exception" << std::endl;
-        return false;
-    }
-}
-// ===== NEW LOG GENERATION FUNCTIONS =====
+    std::unordered_map<std::string, PresetCatalogCacheEntry> cache;
+    std::unordered_map<std::string, PresetCatalogCacheEntry> updatedCache;
 
-void GenerateDoctorLog(const fs::path& bodySlidePresetsPath, const fs::path& logDoctorPath, std::ofstream& mainLogFile) {
     try {
-        mainLogFile << "Generating Doctor Log..." << std::endl;
-        mainLogFile << "Searching in: " << bodySlidePresetsPath.string() << std::endl;
-
-        std::ofstream doctorLog(logDoctorPath, std::ios::out | std::ios::trunc);
-        if (!doctorLog.is_open()) {
-            mainLogFile << "ERROR: Could not create Doctor Log file" << std::endl;
-            return;
+        if (!fs::exists(bodySlidePresetsPath)) {
+            logFile << "WARNING: BodySlide presets folder not found: " << bodySlidePresetsPath.string() << std::endl;
+            return catalog;
         }
+        catalog.folderFound = true;
 
-        doctorLog << "====================================================" << std::endl;
-        doctorLog << "OBody NG Preset Distribution Assistant NG - Doctor" << std::endl;
-        doctorLog << "====================================================" << std::endl;
-        doctorLog << std::endl;
+        logFile << "Building preset catalog from: " << bodySlidePresetsPath.string() << std::endl;
 
-        if (!fs::exists(bodySlidePresetsPath)) {
-            doctorLog << "ERROR: BodySlide presets folder not found at:" << std::endl;
-            doctorLog << bodySlidePresetsPath.string() << std::endl;
-            mainLogFile << "ERROR: Folder does not exist: " << bodySlidePresetsPath.string() << std::endl;
-            doctorLog.close();
-            return;
+        if (catalog.cacheEnabled) {
+            cache = LoadPresetCatalogCache(cachePath, logFile);
+            updatedCache.reserve(cache.size());
         }
 
-        mainLogFile << "Folder exists, scanning files..." << std::endl;
-
-        std::vector<std::string> xmlFiles;
-        int totalScanned = 0;
-        int totalXmlFound = 0;
-        int filenameFailed = 0;
+        std::vector<PendingXml> pending;
 
         try {
-            for (const auto& entry : fs::directory_iterator(bodySlidePresetsPath)) {
+            std::error_code enumerateError;
+            size_t enumerated = 0;
+            size_t unreadableNames = 0;
+            std::vector<DirectoryEntry> xmlFiles = EnumerateDirectory(bodySlidePresetsPath, "", ".xml", enumerateError,
+                                                                      &enumerated, &unreadableNames);
+            catalog.totalScanned = static_cast<int>(enumerated);
+            catalog.filenameFailed += static_cast<int>(unreadableNames);
+            if (enumerateError) throw fs::filesystem_error("directory enumeration", bodySlidePresetsPath, enumerateError);
+
+            for (auto& entry : xmlFiles) {
                 try {
-                    totalScanned++;
+                    const std::string& filename = entry.name;
 
-                    if (entry.is_regular_file()) {
-                        std::string filename;
+                    std::string stem;
+                    try {
+                        stem = entry.path.stem().string();
+                    } catch (...) {
                         try {
-                            auto u8name = entry.path().filename().u8string();
-                            filename = std::string(u8name.begin(), u8name.end());
+                            auto u8stem = entry.path.stem().u8string();
+                            stem = std::string(u8stem.begin(), u8stem.end());
                         } catch (...) {
-                            try {
-                                filename = entry.path().filename().string();
-                            } catch (...) {
-                                filenameFailed++;
-                                mainLogFile << "ERROR reading filename in Doctor Log generation" << std::endl;
-                                continue;
-                            }
+                            stem = "unknown";
+                            logFile << "  [ERROR] Could not read filename from path" << std::endl;
                         }
+                    }
 
-                        if (EndsWith(filename, ".xml")) {
-                            xmlFiles.push_back(filename);
-                            totalXmlFound++;
+                    PresetCatalogEntry catalogEntry;
+                    catalogEntry.xmlFilename = filename;
+                    catalogEntry.path = entry.path;
+                    catalogEntry.size = entry.stamp.size;
+                    catalogEntry.mtime = entry.stamp.mtime;
+
+                    auto cached = cache.find(filename);
+                    if (catalog.cacheEnabled && cached != cache.end() && cached->second.size == entry.stamp.size &&
+                        cached->second.mtime == entry.stamp.mtime &&
+                        (!readSliders || cached->second.hasSliders)) {
+                        catalog.cacheHits++;
+                        catalogEntry.contentHash = cached->second.contentHash;
+                        for (const auto& cachedPreset : cached->second.presets) {
+                            XmlPreset preset;
+                            preset.info.internalName = cachedPreset.internalName;
+                            preset.info.setName = cachedPreset.setName;
+                            preset.info.filename =
+                                cachedPreset.extractionSuccessful ? DecodeHtmlEntities(stem) : stem;
+                            preset.info.extractionSuccessful = cachedPreset.extractionSuccessful;
+                            preset.analysis = ClassifyXmlGroups(cachedPreset.groupNames, frameworks);
+                            preset.shape = cachedPreset.shape;
+                            if (sliderNames) {
+                                preset.sliders.reserve(cachedPreset.sliders.size());
+                                for (const auto& slider : cachedPreset.sliders) {
+                                    preset.sliders.push_back(
+                                        PresetSlider{sliderNames->Intern(slider.name), slider.small, slider.big});
+                                }
+                            }
+                            catalogEntry.presets.push_back(std::move(preset));
                         }
+                        updatedCache[filename] = std::move(cached->second);
+                        cache.erase(cached);
+
+                        catalog.entries.push_back(std::move(catalogEntry));
+                        continue;
                     }
+
+                    if (cached != cache.end()) cache.erase(cached);
+                    if (catalog.cacheEnabled) catalog.cacheMisses++;
+
+                    PendingXml pendingXml;
+                    pendingXml.entry = std::move(catalogEntry);
+                    pendingXml.stem = std::move(stem);
+                    pendingXml.size = entry.stamp.size;
+                    pendingXml.stamp = entry.stamp.mtime;
+                    pendingXml.statOk = entry.stamp.exists;
+                    pending.push_back(std::move(pendingXml));
+
                 } catch (const std::exception& e) {
-                    mainLogFile << "ERROR reading file entry: " << e.what() << std::endl;
+                    logFile << "  [ERROR] Exception in directory iteration: " << e.what() << std::endl;
                 } catch (...) {
-                    mainLogFile << "ERROR reading file entry: Unknown exception" << std::endl;
+                    logFile << "  [ERROR] Unknown exception in directory iteration" << std::endl;
                 }
             }
         } catch (const std::exception& e) {
-            mainLogFile << "ERROR iterating directory: " << e.what() << std::endl;
-            doctorLog << "ERROR: Could not read directory" << std::endl;
-            doctorLog.close();
-            return;
+            catalog.iterationFailed = true;
+            logFile << "ERROR iterating directory: " << e.what() << std::endl;
+        }
+
+        bool batched = UseBatchedReads(readBackend);
+        std::vector<std::vector<ParsedXml>> chunkResults((pending.size() + XML_PARSE_CHUNK_SIZE - 1) /
+                                                         XML_PARSE_CHUNK_SIZE);
+        ParallelForChunks(pool, pending.size(), XML_PARSE_CHUNK_SIZE, [&](size_t chunk, size_t begin, size_t end) {
+            std::vector<ParsedXml>& buffer = chunkResults[chunk];
+            buffer.resize(end - begin);
+            std::vector<std::ostringstream> fileLogs(end - begin);
+
+            auto parseOne = [&](size_t k, const char* data, size_t size, bool opened) {
+                ParsedXml& parsed = buffer[k];
+                const PendingXml& source = pending[begin + k];
+                std::ostringstream& fileLog = fileLogs[k];
+                parsed.entry = source.entry;
+                try {
+                    parsed.opened = opened;
+                    if (opened) {
+                        parsed.readable = size > Utf8BomLength(data, size);
+                        g_xmlBytesMapped += size;
+                        g_xmlBytesTouched += size;
+                        parsed.entry.contentHash = HashPresetContent(data, size);
+                        parsed.entry.presets =
+                            TokenizeSliderPresets(data, size, source.stem, frameworks, fileLog, sliderNames);
+                    }
+                } catch (const std::exception& e) {
+                    fileLog << "  [ERROR] Exception reading " << parsed.entry.xmlFilename << ": " << e.what()
+                            << std::endl;
+                } catch (...) {
+                    fileLog << "  [ERROR] Unknown exception reading " << parsed.entry.xmlFilename << std::endl;
+                }
+            };
+
+            if (batched) {
+                std::vector<BatchedReadFile> files(end - begin);
+                for (size_t i = begin; i < end; ++i) {
+                    files[i - begin].path = pending[i].entry.path;
+                    files[i - begin].sizeHint = pending[i].statOk ? pending[i].size : 0;
+                }
+                // Completions arrive in any order; each lands in its own slot of the chunk buffer
+                ReadFilesBatched(files, BATCHED_READ_QUEUE_DEPTH, [&](size_t k, std::string& data, bool ok) {
+                    parseOne(k, data.data(), data.size(), ok);
+                });
+            } else {
+                for (size_t i = begin; i < end; ++i) {
+                    ParsedXml& parsed = buffer[i - begin];
+                    parsed.entry = pending[i].entry;
+                    try {
+                        parsed.entry.presets = ReadSliderPresets(parsed.entry.path, pending[i].stem, frameworks,
+                                                                 fileLogs[i - begin], parsed.opened, parsed.readable,
+                                                                 parsed.entry.contentHash, sliderNames);
+                    } catch (const std::exception& e) {
+                        fileLogs[i - begin] << "  [ERROR] Exception reading " << parsed.entry.xmlFilename << ": "
+                                            << e.what() << std::endl;
+                    } catch (...) {
+                        fileLogs[i - begin] << "  [ERROR] Unknown exception reading " << parsed.entry.xmlFilename
+                                            << std::endl;
+                    }
+                }
+            }
+
+            for (size_t k = 0; k < buffer.size(); ++k) {
+                ParsedXml& parsed = buffer[k];
+                if (parsed.entry.presets.empty()) {
+                    parsed.entry.presets =
+                        TokenizeSliderPresets(nullptr, 0, pending[begin + k].stem, frameworks, fileLogs[k]);
+                    parsed.readable = false;
+                }
+                parsed.log = fileLogs[k].str();
+            }
+        });
+
+        // pending is in enumeration order and each chunk preserves it, so index i of the
+        // flattened results is pending[i]
+        size_t pendingIndex = 0;
+        std::vector<std::pair<std::string, size_t>> mergeOrder;
+        std::vector<ParsedXml*> parsedByIndex;
+        parsedByIndex.reserve(pending.size());
+        for (auto& buffer : chunkResults) {
+            for (auto& parsed : buffer) {
+                mergeOrder.emplace_back(parsed.entry.xmlFilename, pendingIndex++);
+                parsedByIndex.push_back(&parsed);
+            }
         }
+        std::sort(mergeOrder.begin(), mergeOrder.end());
+
+        for (const auto& [filename, index] : mergeOrder) {
+            ParsedXml& parsed = *parsedByIndex[index];
+            const PendingXml& source = pending[index];
+            logFile << parsed.log;
+            if (parsed.opened) catalog.xmlFilesOpened++;
+
+            // Unreadable files are left out so they are retried on the next launch
+            if (catalog.cacheEnabled && source.statOk && parsed.readable) {
+                PresetCatalogCacheEntry cacheEntry;
+                cacheEntry.size = source.size;
+                cacheEntry.mtime = source.stamp;
+                cacheEntry.contentHash = parsed.entry.contentHash;
+                cacheEntry.hasSliders = readSliders;
+                for (const auto& preset : parsed.entry.presets) {
+                    PresetCatalogCachePreset cachedPreset;
+                    cachedPreset.extractionSuccessful = preset.info.extractionSuccessful;
+                    cachedPreset.internalName = preset.info.internalName;
+                    cachedPreset.setName = preset.info.setName;
+                    cachedPreset.groupNames = preset.analysis.groupNames;
+                    cachedPreset.shape = preset.shape;
+                    for (const auto& slider : preset.sliders) {
+                        cachedPreset.sliders.push_back({sliderNames->Name(slider.id), slider.small, slider.big});
+                    }
+                    cacheEntry.presets.push_back(std::move(cachedPreset));
+                }
+                updatedCache[filename] = std::move(cacheEntry);
+            }
 
-        mainLogFile << "Total files scanned: " << totalScanned << std::endl;
-        mainLogFile << "Total XML files found: " << totalXmlFound << std::endl;
-        if (filenameFailed > 0) {
-            mainLogFile << "Filename read failures: " << filenameFailed << std::endl;
+            catalog.entries.push_back(std::move(parsed.entry));
         }
 
-        std::sort(xmlFiles.begin(), xmlFiles.end());
+        std::sort(catalog.entries.begin(), catalog.entries.end(),
+                  [](const PresetCatalogEntry& a, const PresetCatalogEntry& b) { return a.xmlFilename < b.xmlFilename; });
 
-        doctorLog << "XML FILES FOUND IN SLIDER PRESETS FOLDER:" << std::endl;
-        doctorLog << "Total files: " << xmlFiles.size() << std::endl;
-        doctorLog << std::endl;
+        logFile << "Preset catalog: " << catalog.entries.size() << " XML files cataloged, "
+                << catalog.xmlFilesOpened << " files opened (" << catalog.totalScanned << " entries enumerated)"
+                << std::endl;
 
-        for (const auto& xmlFile : xmlFiles) {
-            doctorLog << xmlFile << std::endl;
+        GroupDuplicateEntries(catalog);
+        if (!catalog.duplicateGroups.empty()) {
+            logFile << "Duplicate XMLs: " << catalog.duplicateGroups.size() << " groups, "
+                    << CountDuplicateEntries(catalog) << " redundant files (see the Doctor log)" << std::endl;
         }
 
-        doctorLog << std::endl;
-        doctorLog << "====================================================" << std::endl;
+        if (catalog.cacheEnabled) {
+            // Whatever is left in the loaded cache was not matched by any file on disk
+            catalog.cacheEvictions = catalog.iterationFailed ? 0 : cache.size();
+            if (catalog.iterationFailed) {
+                for (auto& item : cache) updatedCache.emplace(item.first, std::move(item.second));
+            }
 
-        doctorLog.close();
+            logFile << "Preset catalog cache: " << catalog.cacheHits << " hits, " << catalog.cacheMisses
+                    << " misses, " << catalog.cacheEvictions << " evictions" << std::endl;
 
-        if (doctorLog.fail()) {
-            mainLogFile << "ERROR: Failed to write Doctor Log file" << std::endl;
-        } else {
-            mainLogFile << "SUCCESS: Doctor Log created with " << xmlFiles.size() << " files" << std::endl;
+            if (catalog.cacheMisses > 0 || catalog.cacheEvictions > 0 || !fs::exists(cachePath)) {
+                if (SavePresetCatalogCache(cachePath, updatedCache, logFile)) {
+                    logFile << "Preset catalog cache updated: " << updatedCache.size() << " entries" << std::endl;
+                }
+            }
         }
+        logFile << std::endl;
 
     } catch (const std::exception& e) {
-        mainLogFile << "CRITICAL ERROR in GenerateDoctorLog: " << e.what() << std::endl;
+        logFile << "ERROR in BuildPresetCatalog: " << e.what() << std::endl;
     } catch (...) {
-        mainLogFile << "CRITICAL ERROR in GenerateDoctorLog: Unknown exception" << std::endl;
+        logFile << "ERROR in BuildPresetCatalog: Unknown exception" << std::endl;
     }
+
+    return catalog;
 }
 
-void GenerateSmartCleaningLog(const PresetMapData& presetData, const fs::path& logSmartCleaningPath, std::ofstream& mainLogFile) {
-    try {
-        mainLogFile << "Generating Smart Cleaning Log with extracted preset names..." << std::endl;
-        
-        std::ofstream smartCleaningLog(logSmartCleaningPath, std::ios::out | std::ios::trunc);
-        if (!smartCleaningLog.is_open()) {
-            mainLogFile << "ERROR: Could not create Smart Cleaning Log file" << std::endl;
-            return;
-        }
-        
-        smartCleaningLog << "====================================================" << std::endl;
-        smartCleaningLog << "Smart Cleaning Preset Reference" << std::endl;
-        smartCleaningLog << "====================================================" << std::endl;
-        smartCleaningLog << std::endl;
-        
-        std::vector<std::string> presetNames;
-        for (const auto& [presetName, _] : presetData.exactMap) {
-            presetNames.push_back(presetName);
-        }
-        
-        std::sort(presetNames.begin(), presetNames.end());
-        
-        smartCleaningLog << "PRESET NAMES EXTRACTED FROM XML FILES (INTERNAL <Preset name=\"...\">):" << std::endl;
-        smartCleaningLog << "Total presets: " << presetNames.size() << std::endl;
-        smartCleaningLog << std::endl;
-        
-        for (const auto& presetName : presetNames) {
-            smartCleaningLog << presetName << std::endl;
-        }
-        
-        smartCleaningLog << std::endl;
-        smartCleaningLog << "----------------------------------------------------" << std::endl;
-        smartCleaningLog << std::endl;
-        
-        smartCleaningLog << "FILENAME TO INTERNAL NAME MAPPING:" << std::endl;
-        smartCleaningLog << "(Shows XML filenames that differ from internal preset names)" << std::endl;
-        smartCleaningLog << std::endl;
-        
-        int mappingCount = 0;
-        for (const auto& [filename, internalName] : presetData.filenameToInternalMap) {
-            if (filename != internalName) {
-                smartCleaningLog << "File: " << filename << ".xml" << std::endl;
-                smartCleaningLog << " -> Internal: " << internalName << std::endl;
-                smartCleaningLog << std::endl;
-                mappingCount++;
+struct ParsedRule {
+    std::string key;
+    std::string plugin;
+    std::vector<std::string> presets;
+    std::string extra;
+    int applyCount = -1;
+};
+
+ParsedRule ParseRuleLine(const std::string& key, const std::string& value) {
+    ParsedRule rule;
+    rule.key = key;
+
+    std::vector<std::string> parts = Split(value, '|');
+    if (parts.size() >= 2) {
+        rule.plugin = Trim(parts[0]);
+        rule.presets = Split(parts[1], ',');
+
+        if (parts.size() >= 3) {
+            rule.extra = Trim(parts[2]);
+            if (rule.extra.empty()) {
+                rule.applyCount = -1;
+            } else if (rule.extra == "x" || rule.extra == "X") {
+                rule.applyCount = -1;
+            } else if (rule.extra == "x-" || rule.extra == "X-") {
+                rule.applyCount = -4;
+            } else if (rule.extra == "x*" || rule.extra == "X*") {
+                rule.applyCount = -5;
+            } else if (rule.extra == "-") {
+                rule.applyCount = -2;
+            } else if (rule.extra == "*") {
+                rule.applyCount = -3;
+            } else {
+                try {
+                    rule.applyCount = std::stoi(rule.extra);
+                    if (rule.applyCount != 0 && rule.applyCount != 1) {
+                        rule.applyCount = 0;
+                    }
+                } catch (...) {
+                    rule.applyCount = 0;
+                }
             }
-        }
-        
-        if (mappingCount == 0) {
-            smartCleaningLog << "All XML filenames match their internal preset names." << std::endl;
-        } else {
-            smartCleaningLog << "Total mappings: " << mappingCount << std::endl;
-        }
-        
-        smartCleaningLog << std::endl;
-        smartCleaningLog << "====================================================" << std::endl;
-        
-        smartCleaningLog.close();
-        
-        if (smartCleaningLog.fail()) {
-            mainLogFile << "ERROR: Failed to write Smart Cleaning Log file" << std::endl;
         } else {
-            mainLogFile << "SUCCESS: Smart Cleaning Log created with " << presetNames.size() << " presets at: " << logSmartCleaningPath.string() << std::endl;
+            rule.applyCount = -1;
         }
-        
-    } catch (const std::exception& e) {
-        mainLogFile << "ERROR in GenerateSmartCleaningLog: " << e.what() << std::endl;
-    } catch (...) {
-        mainLogFile << "ERROR in GenerateSmartCleaningLog: Unknown exception" << std::endl;
     }
+
+    return rule;
 }
 
-void GenerateHelperLog(const PresetMapData& presetData, const fs::path& logHelperPath, std::ofstream& mainLogFile) {
-    try {
-        mainLogFile << "Generating Helper Log with preset list and examples..." << std::endl;
-        
-        std::ofstream helperLog(logHelperPath, std::ios::out | std::ios::trunc);
-        if (!helperLog.is_open()) {
-            mainLogFile << "ERROR: Could not create Helper Log file" << std::endl;
-            return;
+// Plugins and presets are interned names (see INTERNED NAMES); array sections use the "" plugin.
+struct OrderedPluginData {
+    std::vector<std::pair<NameId, std::vector<NameId>>> orderedData;
+
+    void addPreset(NameId plugin, NameId preset) {
+        auto it = std::find_if(orderedData.begin(), orderedData.end(),
+                               [plugin](const auto& pair) { return pair.first == plugin; });
+        if (it == orderedData.end()) {
+            orderedData.emplace_back(plugin, std::vector<NameId>{preset});
+            orderedData.back().second.reserve(20);
+        } else {
+            auto& presets = it->second;
+            if (std::find(presets.begin(), presets.end(), preset) == presets.end()) {
+                presets.push_back(preset);
+            }
         }
-        
-        helperLog << "====================================================" << std::endl;
-        helperLog << "OBody NG Preset Distribution Assistant NG - Helper" << std::endl;
-        helperLog << "====================================================" << std::endl;
-        helperLog << std::endl;
-        
-        helperLog << "This is a complete list of all presets installed in your Skyrim." << std::endl;
-        helperLog << "You can use them to create INI files and manage presets intelligently." << std::endl;
-        helperLog << "It also helps you know if you have certain presets installed or not, making your life much easier." << std::endl;
-        helperLog << std::endl;
-        helperLog << "You can visit the wiki at:" << std::endl;
-        helperLog << "https://john95ac.github.io/website-documents-John95AC/OBody_NG_Preset_Distribution_Assistant_NG/index.html" << std::endl;
-        helperLog << "which includes a rule generator for INI files." << std::endl;
-        helperLog << std::endl;
-        helperLog << "Below are some examples of how to use the INI manager in different cases." << std::endl;
-        helperLog << std::endl;
-        helperLog << std::endl;
+    }
 
-        helperLog << "====================================================" << std::endl;
-        helperLog << "INSTALLED PRESETS LIST (" << presetData.exactMap.size() << " total)" << std::endl;
-        helperLog << "====================================================" << std::endl;
-        helperLog << std::endl;
+    void addPreset(const std::string& plugin, const std::string& preset) {
+        addPreset(InternName(plugin), InternName(preset));
+    }
 
-        // Separate presets into NORMAL and UBE categories
-        std::vector<std::string> normalPresets;
-        std::vector<std::string> ubePresets;
+    // Matches with one leading '!' ignored on both sides
+    void removePreset(const std::string& plugin, const std::string& preset) {
+        NameId pluginId = FindName(plugin);
+        auto it = std::find_if(orderedData.begin(), orderedData.end(),
+                               [pluginId](const auto& pair) { return pair.first == pluginId; });
+        if (pluginId == NO_NAME || it == orderedData.end()) return;
 
-        for (const auto& [presetName, _] : presetData.exactMap) {
-            // Check if preset name contains "UBE" (case-insensitive)
-            std::string lowerName = presetName;
-            std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(),
-                          [](unsigned char c) { return std::tolower(c); });
+        std::string target = !preset.empty() && preset[0] == '!' ? preset.substr(1) : preset;
+        NameId plain = target.empty() || target[0] != '!' ? FindName(target) : NO_NAME;
+        NameId negated = FindName("!" + target);
 
-            if (lowerName.find("ube") != std::string::npos) {
-                ubePresets.push_back(presetName);
-            } else {
-                normalPresets.push_back(presetName);
+        auto& presets = it->second;
+        auto presetIt = std::find_if(presets.begin(), presets.end(), [&](NameId p) {
+            return p != NO_NAME && (p == plain || p == negated);
+        });
+        if (presetIt != presets.end()) {
+            presets.erase(presetIt);
+            if (presets.empty()) {
+                orderedData.erase(it);
             }
         }
+    }
 
-        // Sort both lists alphabetically
-        std::sort(normalPresets.begin(), normalPresets.end());
-        std::sort(ubePresets.begin(), ubePresets.end());
-
-        // Write NORMAL presets
-        helperLog << "NORMAL PRESETS (CBBE/3BA/BHUNP/etc.) - " << normalPresets.size() << " total" << std::endl;
-        helperLog << std::endl;
-
-        for (const auto& preset : normalPresets) {
-            helperLog << preset << std::endl;
+    void removePlugin(const std::string& plugin) {
+        NameId pluginId = FindName(plugin);
+        auto it = std::find_if(orderedData.begin(), orderedData.end(),
+                               [pluginId](const auto& pair) { return pair.first == pluginId; });
+        if (pluginId != NO_NAME && it != orderedData.end()) {
+            orderedData.erase(it);
         }
+    }
 
-        // Write UBE presets section (only if UBE presets exist)
-        if (!ubePresets.empty()) {
-            helperLog << std::endl;
-            helperLog << "UBE PRESETS - " << ubePresets.size() << " total" << std::endl;
-            helperLog << std::endl;
+    bool hasPlugin(const std::string& plugin) const {
+        NameId pluginId = FindName(plugin);
+        return pluginId != NO_NAME && std::any_of(orderedData.begin(), orderedData.end(),
+                                                  [pluginId](const auto& pair) { return pair.first == pluginId; });
+    }
 
-            for (const auto& preset : ubePresets) {
-                helperLog << preset << std::endl;
-            }
+    size_t getPluginCount() const { return orderedData.size(); }
+
+    size_t getTotalPresetCount() const {
+        size_t count = 0;
+        for (const auto& [plugin, presets] : orderedData) {
+            count += presets.size();
         }
-        
-        helperLog << std::endl;
-        helperLog << "----------------------------------------------------" << std::endl;
-        helperLog << std::endl;
-        
-        helperLog << ";OBody_Preset_Distribution_Assistant-NG rules to create an INI" << std::endl;
-        helperLog << ";Don't be scared, check the web or review the examples below" << std::endl;
-        helperLog << std::endl;
-        helperLog << ";OBodyNG_PDA_(mod_name).ini - This is the INI structure" << std::endl;
-        helperLog << ";You can use the mod examples entirely or create your own INI, but you must respect the naming convention" << std::endl;
-        helperLog << ";Example: OBodyNG_PDA_MyMod.ini or OBodyNG_PDA_Custom_Bodies.ini" << std::endl;
-        helperLog << std::endl;
-        helperLog << ";Code design examples: Very similar to SPID but shorter and simpler." << std::endl;
-        helperLog << std::endl;
-        helperLog << "; npcFormID = xx0001|Preset,...|x, 1, 0, -, *, empty             FormID" << std::endl;
-        helperLog << "; npc = EditorID|Preset,...|x, 1, 0, -, *, empty                 EditorID name like 000Rabbit_NPC or Serana" << std::endl;
-        helperLog << "; factionFemale = Faction|Preset,...|x, 1, 0, -, *, empty        Faction name like ImperialFaction or KhajiitFaction" << std::endl;
-        helperLog << "; factionMale = Faction|Preset,...|x, 1, 0, -, *, empty" << std::endl;
-        helperLog << "; npcPluginFemale = Plugin.esp|Preset,...|x, 1, 0, -, *, empty   The name of the ESP with defined bodies" << std::endl;
-        helperLog << "; npcPluginMale = Plugin.esp|Preset,...|x, 1, 0, -, *, empty" << std::endl;
-        helperLog << "; raceFemale = Race|Preset,...|x, 1, 0, -, *, empty              Works with NordRace, OrcRace, etc., and custom races" << std::endl;
-        helperLog << "; raceMale = Race|Preset,...|x, 1, 0, -, *, empty" << std::endl;
-        helperLog << std::endl;
-        helperLog << "----------------------------------------------------" << std::endl;
-        helperLog << "EXAMPLE 1: Assigning presets to NPCs via plugin" << std::endl;
-        helperLog << "----------------------------------------------------" << std::endl;
-        helperLog << std::endl;
-        
-        if (normalPresets.size() >= 2) {
-            std::vector<std::string> randomPresets;
-            std::random_device rd;
-            std::mt19937 gen(rd());
+        return count;
+    }
+};
 
-            if (normalPresets.size() <= 5) {
-                randomPresets = normalPresets;
+ConfigSettings ReadConfigFromIni(const fs::path& iniPath, std::ostream& logFile) {
+    ConfigSettings settings;
+    
+    try {
+        if (!fs::exists(iniPath)) {
+            logFile << "Creating config INI at: " << iniPath.string() << std::endl;
+            std::ofstream createIni(iniPath, std::ios::out | std::ios::trunc);
+            if (createIni.is_open()) {
+                createIni << "[Original backup]" << std::endl;
+                createIni << "Backup = 1" << std::endl;
+                createIni << std::endl;
+                createIni << "[blacklistedPresetsShowInOBodyMenu]" << std::endl;
+                createIni << "ModeUBE = true" << std::endl;
+                createIni << std::endl;
+                createIni << "[Presets_Smart_Cleaning]" << std::endl;
+                createIni << "Smart_Cleaning = false" << std::endl;
+                createIni << "Suggestion_Auto_Apply_Confidence = 0" << std::endl;
+                createIni << std::endl;
+                createIni << "[blacklistedPresets_Smart_Cleaning_FromRandomDistribution]" << std::endl;
+                createIni << "Smart_Cleaning = false" << std::endl;
+                createIni << std::endl;
+                createIni << "[blacklistedPresets_Smart_Cleaning_FromAll]" << std::endl;
+                createIni << "Smart_Cleaning = false" << std::endl;
+                createIni << std::endl;
+                createIni << "[outfitsForceRe_Smart_Cleaning]" << std::endl;
+                createIni << "Smart_Cleaning = false" << std::endl;
+                createIni << std::endl;
+                createIni << "[Performance]" << std::endl;
+                createIni << "Background_Processing = false" << std::endl;
+                createIni << "Skip_Unchanged_Runs = true" << std::endl;
+                createIni << "Worker_Threads = 0" << std::endl;
+                createIni << "Startup_Budget_Ms = 0" << std::endl;
+                createIni << "Read_Backend = auto" << std::endl;
+                createIni << std::endl;
+                createIni << "[Live_Updates]" << std::endl;
+                createIni << "Watch_Mode = false" << std::endl;
+                createIni << "Watch_Debounce_Ms = 500" << std::endl;
+                createIni << std::endl;
+                createIni << "[Preset_Clusters]" << std::endl;
+                createIni << "Preset_Clusters = false" << std::endl;
+                createIni << "Cluster_Max_Distance = 25" << std::endl;
+                RecordStreamWritten(createIni);
+                createIni.close();
+                logFile << "SUCCESS: Config INI created with default values" << std::endl;
+                settings.backupValue = 1;
+                settings.modeUBE = true;
+                settings.presetsSmartCleaning = false;
+                settings.blacklistedPresetsSmartCleaningFromRandomDistribution = false;
+                settings.blacklistedPresetsSmartCleaningFromAll = false;
+                settings.outfitsForceReSmartCleaning = false;
+                settings.backgroundProcessing = false;
+                settings.skipUnchangedRuns = true;
+                settings.workerThreads = 0;
+                settings.startupBudgetMs = 0;
+                return settings;
             } else {
-                std::sample(normalPresets.begin(), normalPresets.end(), std::back_inserter(randomPresets),
-                           std::min(static_cast<size_t>(5), normalPresets.size()), gen);
+                logFile << "ERROR: Could not create config INI file" << std::endl;
+                return settings;
             }
-            
-            helperLog << ";YurianaWench example" << std::endl;
-            helperLog << "npcPluginFemale = YurianaWench.esp|";
-            for (size_t i = 0; i < randomPresets.size() && i < 2; i++) {
-                if (i > 0) helperLog << ",";
-                helperLog << randomPresets[i];
+        }
+
+        std::string content = ReadFileWithEncoding(iniPath);
+        if (content.empty()) {
+            logFile << "ERROR: Could not read config INI file" << std::endl;
+            return settings;
+        }
+
+        std::stringstream ss(content);
+        std::string line;
+        std::string currentSection;
+
+        while (std::getline(ss, line)) {
+            std::string trimmedLine = Trim(line);
+
+            if (trimmedLine.empty() || trimmedLine[0] == ';' || trimmedLine[0] == '#') {
+                continue;
             }
-            helperLog << "|" << std::endl;
-            helperLog << std::endl;
-            
-            helperLog << ";Immersive Wenches example" << std::endl;
-            helperLog << "npcPluginFemale = Immersive Wenches.esp|";
-            for (size_t i = 0; i < randomPresets.size() && i < 2; i++) {
-                if (i > 0) helperLog << ",";
-                helperLog << randomPresets[i];
+
+            if (trimmedLine[0] == '[' && trimmedLine.back() == ']') {
+                currentSection = trimmedLine.substr(1, trimmedLine.length() - 2);
+                continue;
             }
-            helperLog << "|" << std::endl;
-            helperLog << std::endl;
-            
-            helperLog << "These two examples assign bodies to all NPCs in those plugins." << std::endl;
-            helperLog << "You can use 1 or multiple presets - OBody will randomly choose among them for assignment." << std::endl;
-            helperLog << std::endl;
-            helperLog << "Note: The elements at the end are only for advanced users who want sequences." << std::endl;
-            helperLog << "It's not necessary to apply anything - in fact, it's highly recommended to leave it empty." << std::endl;
-            helperLog << std::endl;
-            
-            helperLog << "----------------------------------------------------" << std::endl;
-            helperLog << "EXAMPLE 2: Assigning presets to entire races" << std::endl;
-            helperLog << "----------------------------------------------------" << std::endl;
-            helperLog << std::endl;
-            
-            helperLog << "Another very useful example is assigning a set of body presets to complete races." << std::endl;
-            helperLog << "Here's an example with your presets (minimum 5 random selections per race):" << std::endl;
-            helperLog << std::endl;
-            
-            const std::vector<std::string> races = {
-                "NordRace", "ImperialRace", "BretonRace", "RedguardRace", "DarkElfRace",
-                "HighElfRace", "WoodElfRace", "OrcRace", "KhajiitRace", "ArgonianRace", "ElderRace"
-            };
-            
-            for (const auto& race : races) {
-                std::vector<std::string> raceRandomPresets;
 
-                if (normalPresets.size() <= 5) {
-                    raceRandomPresets = normalPresets;
-                } else {
-                    std::sample(normalPresets.begin(), normalPresets.end(), std::back_inserter(raceRandomPresets),
-                               std::min(static_cast<size_t>(5), normalPresets.size()), gen);
-                }
-                
-                helperLog << ";" << race << std::endl;
-                helperLog << "raceFemale = " << race << "|";
-                
-                for (size_t i = 0; i < raceRandomPresets.size(); i++) {
-                    if (i > 0) helperLog << ",";
-                    helperLog << raceRandomPresets[i];
-                }
-                
-                helperLog << "|" << std::endl;
-                helperLog << std::endl;
+            size_t equalPos = trimmedLine.find('=');
+            if (equalPos != std::string::npos) {
+                std::string key = Trim(trimmedLine.substr(0, equalPos));
+                std::string value = Trim(trimmedLine.substr(equalPos + 1));
+
+                if (currentSection == "Original backup" && key == "Backup") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.backupValue = 2;
+                        logFile << "Read config: Backup = true (always backup mode)" << std::endl;
+                    } else {
+                        try {
+                            settings.backupValue = std::stoi(value);
+                            logFile << "Read config: Backup = " << settings.backupValue << std::endl;
+                        } catch (...) {
+                            logFile << "Warning: Invalid Backup value, using default (1)" << std::endl;
+                            settings.backupValue = 1;
+                        }
+                    }
+                } else if (currentSection == "blacklistedPresetsShowInOBodyMenu" && key == "ModeUBE") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.modeUBE = true;
+                        logFile << "Read config: ModeUBE = true" << std::endl;
+                    } else if (value == "false" || value == "False" || value == "FALSE") {
+                        settings.modeUBE = false;
+                        logFile << "Read config: ModeUBE = false" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid ModeUBE value, using default (true)" << std::endl;
+                        settings.modeUBE = true;
+                    }
+                } else if (currentSection == "Presets_Smart_Cleaning" && key == "Smart_Cleaning") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.presetsSmartCleaning = true;
+                        logFile << "Read config: Presets_Smart_Cleaning = true" << std::endl;
+                    } else if (value == "false" || value == "False" || value == "FALSE") {
+                        settings.presetsSmartCleaning = false;
+                        logFile << "Read config: Presets_Smart_Cleaning = false" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Presets_Smart_Cleaning value, using default (false)" << std::endl;
+                        settings.presetsSmartCleaning = false;
+                    }
+                } else if (currentSection == "Presets_Smart_Cleaning" && key == "Suggestion_Auto_Apply_Confidence") {
+                    int confidence = -1;
+                    try {
+                        confidence = std::stoi(value);
+                    } catch (...) {
+                    }
+                    if (confidence >= 0 && confidence <= 100) {
+                        settings.suggestionAutoApplyConfidence = confidence;
+                        logFile << "Read config: Suggestion_Auto_Apply_Confidence = " << confidence
+                                << (confidence == 0 ? " (suggestions are only logged)" : "") << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Suggestion_Auto_Apply_Confidence value, using default (0 = off)" << std::endl;
+                        settings.suggestionAutoApplyConfidence = 0;
+                    }
+                } else if (currentSection == "blacklistedPresets_Smart_Cleaning_FromRandomDistribution" && key == "Smart_Cleaning") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.blacklistedPresetsSmartCleaningFromRandomDistribution = true;
+                        logFile << "Read config: blacklistedPresets_Smart_Cleaning_FromRandomDistribution = true" << std::endl;
+                    } else if (value == "false" || value == "False" || value == "FALSE") {
+                        settings.blacklistedPresetsSmartCleaningFromRandomDistribution = false;
+                        logFile << "Read config: blacklistedPresets_Smart_Cleaning_FromRandomDistribution = false" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid blacklistedPresets_Smart_Cleaning_FromRandomDistribution value, using default (false)" << std::endl;
+                        settings.blacklistedPresetsSmartCleaningFromRandomDistribution = false;
+                    }
+                } else if (currentSection == "blacklistedPresets_Smart_Cleaning_FromAll" && key == "Smart_Cleaning") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.blacklistedPresetsSmartCleaningFromAll = true;
+                        logFile << "Read config: blacklistedPresets_Smart_Cleaning_FromAll = true" << std::endl;
+                    } else if (value == "false" || value == "False" || value == "FALSE") {
+                        settings.blacklistedPresetsSmartCleaningFromAll = false;
+                        logFile << "Read config: blacklistedPresets_Smart_Cleaning_FromAll = false" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid blacklistedPresets_Smart_Cleaning_FromAll value, using default (false)" << std::endl;
+                        settings.blacklistedPresetsSmartCleaningFromAll = false;
+                    }
+                } else if (currentSection == "outfitsForceRe_Smart_Cleaning" && key == "Smart_Cleaning") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.outfitsForceReSmartCleaning = true;
+                        logFile << "Read config: outfitsForceRe_Smart_Cleaning = true" << std::endl;
+                    } else if (value == "false" || value == "False" || value == "FALSE") {
+                        settings.outfitsForceReSmartCleaning = false;
+                        logFile << "Read config: outfitsForceRe_Smart_Cleaning = false" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid outfitsForceRe_Smart_Cleaning value, using default (false)" << std::endl;
+                        settings.outfitsForceReSmartCleaning = false;
+                    }
+                } else if (currentSection == "Performance" && key == "Background_Processing") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.backgroundProcessing = true;
+                        logFile << "Read config: Background_Processing = true" << std::endl;
+                    } else if (value == "false" || value == "False" || value == "FALSE") {
+                        settings.backgroundProcessing = false;
+                        logFile << "Read config: Background_Processing = false" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Background_Processing value, using default (false)" << std::endl;
+                        settings.backgroundProcessing = false;
+                    }
+                } else if (currentSection == "Performance" && key == "Skip_Unchanged_Runs") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.skipUnchangedRuns = true;
+                        logFile << "Read config: Skip_Unchanged_Runs = true" << std::endl;
+                    } else if (value == "false" || value == "False" || value == "FALSE") {
+                        settings.skipUnchangedRuns = false;
+                        logFile << "Read config: Skip_Unchanged_Runs = false" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Skip_Unchanged_Runs value, using default (true)" << std::endl;
+                        settings.skipUnchangedRuns = true;
+                    }
+                } else if (currentSection == "Performance" && key == "Worker_Threads") {
+                    int threads = -1;
+                    try {
+                        threads = std::stoi(value);
+                    } catch (...) {
+                    }
+                    if (threads >= 0) {
+                        settings.workerThreads = threads;
+                        logFile << "Read config: Worker_Threads = " << threads
+                                << (threads == 0 ? " (automatic)" : "") << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Worker_Threads value, using default (0 = automatic)" << std::endl;
+                        settings.workerThreads = 0;
+                    }
+                } else if (currentSection == "Performance" && key == "Startup_Budget_Ms") {
+                    int budgetMs = -1;
+                    try {
+                        budgetMs = std::stoi(value);
+                    } catch (...) {
+                    }
+                    if (budgetMs >= 0) {
+                        settings.startupBudgetMs = budgetMs;
+                        logFile << "Read config: Startup_Budget_Ms = " << budgetMs
+                                << (budgetMs == 0 ? " (no budget, nothing deferred)" : "") << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Startup_Budget_Ms value, using default (0 = no budget)" << std::endl;
+                        settings.startupBudgetMs = 0;
+                    }
+                } else if (currentSection == "Performance" && key == "Read_Backend") {
+                    std::string backend = ToLowerCase(value);
+                    if (backend == "auto") {
+                        settings.readBackend = ReadBackend::Auto;
+                        logFile << "Read config: Read_Backend = auto" << std::endl;
+                    } else if (backend == "batched") {
+                        settings.readBackend = ReadBackend::Batched;
+                        logFile << "Read config: Read_Backend = batched" << std::endl;
+                    } else if (backend == "mapped") {
+                        settings.readBackend = ReadBackend::Mapped;
+                        logFile << "Read config: Read_Backend = mapped" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Read_Backend value, using default (auto)" << std::endl;
+                        settings.readBackend = ReadBackend::Auto;
+                    }
+                } else if (currentSection == "Live_Updates" && key == "Watch_Mode") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.watchMode = true;
+                        logFile << "Read config: Watch_Mode = true" << std::endl;
+                    } else if (value == "false" || value == "False" || value == "FALSE") {
+                        settings.watchMode = false;
+                        logFile << "Read config: Watch_Mode = false" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Watch_Mode value, using default (false)" << std::endl;
+                        settings.watchMode = false;
+                    }
+                } else if (currentSection == "Live_Updates" && key == "Watch_Debounce_Ms") {
+                    int debounceMs = -1;
+                    try {
+                        debounceMs = std::stoi(value);
+                    } catch (...) {
+                    }
+                    if (debounceMs >= 0) {
+                        settings.watchDebounceMs = debounceMs;
+                        logFile << "Read config: Watch_Debounce_Ms = " << debounceMs << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Watch_Debounce_Ms value, using default (500)" << std::endl;
+                        settings.watchDebounceMs = 500;
+                    }
+                } else if (currentSection == "Preset_Clusters" && key == "Preset_Clusters") {
+                    if (value == "true" || value == "True" || value == "TRUE") {
+                        settings.presetClusters = true;
+                        logFile << "Read config: Preset_Clusters = true" << std::endl;
+                    } else if (value == "false" || value == "False" || value == "FALSE") {
+                        settings.presetClusters = false;
+                        logFile << "Read config: Preset_Clusters = false" << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Preset_Clusters value, using default (false)" << std::endl;
+                        settings.presetClusters = false;
+                    }
+                } else if (currentSection == "Preset_Clusters" && key == "Cluster_Max_Distance") {
+                    double maxDistance = -1.0;
+                    try {
+                        maxDistance = std::stod(value);
+                    } catch (...) {
+                    }
+                    if (maxDistance >= 0.0 && maxDistance <= 10000.0) {
+                        settings.clusterMaxDistance = maxDistance;
+                        logFile << "Read config: Cluster_Max_Distance = " << maxDistance << std::endl;
+                    } else {
+                        logFile << "Warning: Invalid Cluster_Max_Distance value, using default (25)" << std::endl;
+                        settings.clusterMaxDistance = 25.0;
+                    }
+                }
+            }
+        }
+
+        return settings;
+        
+    } catch (const std::exception& e) {
+        logFile << "ERROR in ReadConfigFromIni: " << e.what() << std::endl;
+        return settings;
+    } catch (...) {
+        logFile << "ERROR in ReadConfigFromIni: Unknown exception" << std::endl;
+        return settings;
+    }
+}
+
+void UpdateBackupConfigInIni(const fs::path& iniPath, std::ostream& logFile, int originalValue) {
+    try {
+        if (!fs::exists(iniPath)) {
+            logFile << "ERROR: Config INI file does not exist for update" << std::endl;
+            return;
+        }
+
+        if (originalValue == 2) {
+            logFile << "INFO: Backup = true detected, INI will not be updated (always backup mode)" << std::endl;
+            return;
+        }
+
+        std::string content = ReadFileWithEncoding(iniPath);
+        if (content.empty()) {
+            logFile << "ERROR: Could not read config INI file for update" << std::endl;
+            return;
+        }
+
+        std::stringstream ss(content);
+        std::vector<std::string> lines;
+        std::string line;
+        std::string currentSection;
+        bool backupValueUpdated = false;
+        lines.reserve(100);
+
+        while (std::getline(ss, line)) {
+            std::string trimmedLine = Trim(line);
+
+            if (trimmedLine[0] == '[' && trimmedLine.back() == ']') {
+                currentSection = trimmedLine.substr(1, trimmedLine.length() - 2);
+                lines.push_back(line);
+                continue;
+            }
+
+            if (currentSection == "Original backup") {
+                size_t equalPos = trimmedLine.find('=');
+                if (equalPos != std::string::npos) {
+                    std::string key = Trim(trimmedLine.substr(0, equalPos));
+                    if (key == "Backup") {
+                        lines.push_back("Backup = 0");
+                        backupValueUpdated = true;
+                        continue;
+                    }
+                }
+            }
+
+            lines.push_back(line);
+        }
+
+        if (!backupValueUpdated) {
+            logFile << "Warning: Backup value not found in INI during update" << std::endl;
+            return;
+        }
+
+        std::ofstream outFile(iniPath, std::ios::out | std::ios::trunc);
+        if (!outFile.is_open()) {
+            logFile << "ERROR: Could not open config INI file for writing" << std::endl;
+            return;
+        }
+
+        for (const auto& outputLine : lines) {
+            outFile << outputLine << std::endl;
+        }
+
+        RecordStreamWritten(outFile);
+        outFile.close();
+        if (outFile.fail()) {
+            logFile << "ERROR: Failed to write config INI file" << std::endl;
+        } else {
+            logFile << "SUCCESS: Config updated (Backup = 0)" << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        logFile << "ERROR in UpdateBackupConfigInIni: " << e.what() << std::endl;
+    } catch (...) {
+        logFile << "ERROR in UpdateBackupConfigInIni: Unknown exception" << std::endl;
+    }
+}
+// ===== PRESET NAME SUGGESTIONS =====
+
+// Symmetric-delete (SymSpell) index over the flexible forms of the installed preset names and XML
+// filenames, for references that fail every FindPresetMatch level. Each form registers the strings
+// left after deleting up to MAX_DISTANCE characters from its first WINDOW characters, and again
+// from its last WINDOW; two names within the distance share such a string on both sides, so a
+// query only walks the side with fewer postings. Deletes are kept as 32-bit hashes in a flat table
+// of posting lists: a collision only adds a candidate. Candidates are first screened by the set of
+// characters they use (one edit changes at most two of its bits), then by the edit distance.
+struct PresetSuggestion {
+    NameId preset = NO_NAME;
+    NameId filename = NO_NAME;  // The XML filename that was close, NO_NAME if the preset name was
+    int distance = 0;
+    int confidence = 0;  // Percent: 100 - 100 * distance / longer flexible form
+};
+
+class PresetSuggestionIndex {
+public:
+    static constexpr int MAX_DISTANCE = 2;
+    static constexpr size_t WINDOW = 7;
+
+    // Takes PresetMapData's sorted lists. Of several names with the same flexible form, the first
+    // preset name (in name order) wins, then the first filename; a filename suggests its preset.
+    void Build(const std::vector<NameId>& presetNames,
+               const std::vector<std::pair<NameId, NameId>>& filenameMappings) {
+        entries_.clear();
+        signatures_.clear();
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> prefixDeletes, suffixDeletes;
+        std::unordered_set<std::string> seenForms;
+        std::vector<std::uint32_t> hashes;
+        auto add = [&](NameId preset, NameId filename) {
+            std::string form = NormalizePresetNameFlexible(NameString(filename != NO_NAME ? filename : preset));
+            if (form.empty() || !seenForms.insert(form).second) return;
+
+            auto entry = static_cast<std::uint32_t>(entries_.size());
+            CollectDeleteHashes(Prefix(form), hashes);
+            for (std::uint32_t hash : hashes) prefixDeletes.emplace_back(hash, entry);
+            CollectDeleteHashes(Suffix(form), hashes);
+            for (std::uint32_t hash : hashes) suffixDeletes.emplace_back(hash, entry);
+            signatures_.push_back(CharacterSignature(form));
+            entries_.push_back({preset, filename, std::move(form)});
+        };
+        for (NameId presetName : presetNames) add(presetName, NO_NAME);
+        for (const auto& [filename, internalName] : filenameMappings) add(internalName, filename);
+        prefixDeletes_.Build(prefixDeletes);
+        suffixDeletes_.Build(suffixDeletes);
+    }
+
+    // Best first: smaller distance, then preset names before filenames, each in name order. Empty
+    // when nothing is within MAX_DISTANCE.
+    std::vector<PresetSuggestion> Suggest(const std::string& name, size_t maxResults) const {
+        std::vector<PresetSuggestion> suggestions;
+        std::string form = NormalizePresetNameFlexible(name);
+        if (form.empty() || entries_.empty()) return suggestions;
+
+        using Range = std::pair<const std::uint32_t*, const std::uint32_t*>;
+        std::vector<std::uint32_t> hashes;
+        auto postings = [&](const DeleteTable& deletes, std::string_view window, std::vector<Range>& ranges) {
+            CollectDeleteHashes(window, hashes);
+            size_t total = 0;
+            for (std::uint32_t hash : hashes) {
+                Range range = deletes.Find(hash);
+                total += static_cast<size_t>(range.second - range.first);
+                if (range.first != range.second) ranges.push_back(range);
+            }
+            return total;
+        };
+        std::vector<Range> prefixRanges, suffixRanges;
+        size_t prefixPostings = postings(prefixDeletes_, Prefix(form), prefixRanges);
+        size_t suffixPostings = postings(suffixDeletes_, Suffix(form), suffixRanges);
+
+        std::vector<std::uint32_t> candidates;
+        candidates.reserve(std::min(prefixPostings, suffixPostings));
+        for (const auto& range : prefixPostings <= suffixPostings ? prefixRanges : suffixRanges) {
+            candidates.insert(candidates.end(), range.first, range.second);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        std::uint64_t signature = CharacterSignature(form);
+        std::vector<int> rows;
+        for (std::uint32_t candidate : candidates) {
+            if (std::bitset<64>(signatures_[candidate] ^ signature).count() > 2 * MAX_DISTANCE) continue;
+            const Entry& entry = entries_[candidate];
+            int distance = EditDistance(form, entry.form, MAX_DISTANCE, rows);
+            if (distance > MAX_DISTANCE) continue;
+            size_t longer = std::max(form.size(), entry.form.size());
+            // Rounded down, so a threshold is never met by rounding
+            int confidence = 100 - static_cast<int>((100 * static_cast<size_t>(distance) + longer - 1) / longer);
+            suggestions.push_back({entry.preset, entry.filename, distance, confidence});
+        }
+        // Candidates are in entry order
+        std::stable_sort(suggestions.begin(), suggestions.end(),
+                         [](const auto& a, const auto& b) { return a.distance < b.distance; });
+        std::unordered_set<NameId> seenPresets;
+        suggestions.erase(std::remove_if(suggestions.begin(), suggestions.end(),
+                                         [&](const auto& s) { return !seenPresets.insert(s.preset).second; }),
+                          suggestions.end());
+        if (suggestions.size() > maxResults) suggestions.resize(maxResults);
+        return suggestions;
+    }
+
+    size_t Size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        NameId preset = NO_NAME;
+        NameId filename = NO_NAME;
+        std::string form;
+    };
+
+    // Delete hash -> the entries that produce it, as one posting array sliced by group
+    struct DeleteTable {
+        FlatIdMap groups;  // Keyed by delete hash rather than NameId
+        std::vector<std::uint32_t> starts;
+        std::vector<std::uint32_t> postings;
+
+        void Build(std::vector<std::pair<std::uint32_t, std::uint32_t>>& deletes) {
+            std::sort(deletes.begin(), deletes.end());
+            groups = FlatIdMap();
+            starts.clear();
+            postings.clear();
+            postings.reserve(deletes.size());
+            for (size_t i = 0; i < deletes.size(); ++i) {
+                if (i == 0 || deletes[i].first != deletes[i - 1].first) {
+                    groups.Insert(TableKey(deletes[i].first), static_cast<std::uint32_t>(starts.size()));
+                    starts.push_back(static_cast<std::uint32_t>(postings.size()));
+                }
+                postings.push_back(deletes[i].second);
+            }
+            starts.push_back(static_cast<std::uint32_t>(postings.size()));
+        }
+
+        std::pair<const std::uint32_t*, const std::uint32_t*> Find(std::uint32_t hash) const {
+            const std::uint32_t* group = groups.Find(TableKey(hash));
+            if (!group) return {nullptr, nullptr};
+            return {postings.data() + starts[*group], postings.data() + starts[*group + 1]};
+        }
+
+        // NO_NAME marks an empty slot, so that one hash shares its neighbour's group
+        static std::uint32_t TableKey(std::uint32_t hash) { return hash == NO_NAME ? NO_NAME - 1 : hash; }
+    };
+
+    // One bit per letter, digit and space; flexible forms hold nothing else
+    static std::uint64_t CharacterSignature(const std::string& form) {
+        std::uint64_t signature = 0;
+        for (char c : form) {
+            unsigned bit = c >= 'a' && c <= 'z' ? c - 'a' : c >= '0' && c <= '9' ? 26 + (c - '0') : 36;
+            signature |= std::uint64_t(1) << bit;
+        }
+        return signature;
+    }
+
+    static std::string_view Prefix(const std::string& form) {
+        return std::string_view(form).substr(0, WINDOW);
+    }
+
+    static std::string_view Suffix(const std::string& form) {
+        return std::string_view(form).substr(form.size() - std::min(form.size(), WINDOW));
+    }
+
+    // The window itself and every string one or two deletes away from it, hashed without building
+    // the strings; deleting either of two equal neighbours gives the same hash, so duplicates go
+    static void CollectDeleteHashes(std::string_view window, std::vector<std::uint32_t>& hashes) {
+        static_assert(MAX_DISTANCE == 2, "CollectDeleteHashes makes up to two deletes");
+        const size_t none = window.size();
+        auto hashSkipping = [&](size_t first, size_t second) {
+            std::uint32_t hash = 2166136261u;
+            for (size_t i = 0; i < window.size(); ++i) {
+                if (i == first || i == second) continue;
+                hash ^= static_cast<unsigned char>(window[i]);
+                hash *= 16777619u;
+            }
+            return hash;
+        };
+
+        hashes.clear();
+        hashes.push_back(hashSkipping(none, none));
+        for (size_t first = 0; first < window.size(); ++first) {
+            hashes.push_back(hashSkipping(first, none));
+            for (size_t second = first + 1; second < window.size(); ++second) {
+                hashes.push_back(hashSkipping(first, second));
+            }
+        }
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    }
+
+    // Optimal string alignment distance (adjacent transpositions count once), or limit + 1 once it
+    // cannot end up within limit. Only the diagonal band of width limit is filled; rows holds the
+    // three rows, reused across calls.
+    static int EditDistance(const std::string& a, const std::string& b, int limit, std::vector<int>& rows) {
+        size_t lengthGap = a.size() > b.size() ? a.size() - b.size() : b.size() - a.size();
+        if (lengthGap > static_cast<size_t>(limit)) return limit + 1;
+
+        const int beyond = limit + 1;
+        const size_t width = b.size() + 1;
+        rows.assign(width * 3, beyond);
+        int* beforePrevious = rows.data();
+        int* previous = beforePrevious + width;
+        int* current = previous + width;
+        for (size_t j = 0; j <= std::min(b.size(), static_cast<size_t>(limit)); ++j) previous[j] = static_cast<int>(j);
+
+        for (size_t i = 1; i <= a.size(); ++i) {
+            size_t first = i > static_cast<size_t>(limit) ? i - limit : 1;
+            size_t last = std::min(b.size(), i + limit);
+            if (first > 1) current[first - 1] = beyond;
+            current[0] = i <= static_cast<size_t>(limit) ? static_cast<int>(i) : beyond;
+            int rowMinimum = current[0];
+            for (size_t j = first; j <= last; ++j) {
+                int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+                int value = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+                if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+                    value = std::min(value, beforePrevious[j - 2] + 1);
+                }
+                current[j] = std::min(value, beyond);
+                rowMinimum = std::min(rowMinimum, current[j]);
+            }
+            if (last < b.size()) current[last + 1] = beyond;
+            if (rowMinimum > limit) return beyond;
+            int* recycled = beforePrevious;
+            beforePrevious = previous;
+            previous = current;
+            current = recycled;
+        }
+        return previous[b.size()];
+    }
+
+    std::vector<Entry> entries_;
+    std::vector<std::uint64_t> signatures_;  // CharacterSignature per entry
+    DeleteTable prefixDeletes_;
+    DeleteTable suffixDeletes_;
+};
+
+// ===== SMART CLEANING FUNCTIONS WITH INTELLIGENT PRESET MATCHING =====
+
+struct PresetMatchResult {
+    bool found = false;
+    std::string actualPresetName = "";
+    int matchLevel = 0;
+};
+
+// What one key means at each FindPresetMatch level. A key is either a name as written or a
+// NormalizePresetNameFlexible form.
+struct PresetLookupKey {
+    bool exact = false;                // Levels 1-2: an installed preset name, resolves to itself
+    bool valid = false;                // Levels 4 and 6: a preset name or XML filename
+    NameId filenameTarget = NO_NAME;   // Level 4: the file's first internal name, NO_NAME = the key itself
+    NameId flexible = NO_NAME;         // Level 3: first preset name (in name order) with this flexible form
+    NameId normalized = NO_NAME;       // Level 5: first preset to register this flexible form
+};
+
+// Every key any FindPresetMatch level accepts, so a lookup is one normalization and a few probes.
+struct PresetLookupIndex {
+    FlatIdMap slots;  // Key name -> index into keys
+    std::vector<PresetLookupKey> keys;
+
+    // The reference is only valid until the next call
+    PresetLookupKey& Key(NameId name) {
+        auto [slot, inserted] = slots.Insert(name, static_cast<std::uint32_t>(keys.size()));
+        if (inserted) keys.emplace_back();
+        return keys[slot];
+    }
+
+    const PresetLookupKey* Find(std::string_view name) const {
+        NameId id = FindName(name);
+        if (id == NO_NAME) return nullptr;
+        const std::uint32_t* slot = slots.Find(id);
+        return slot ? &keys[*slot] : nullptr;
+    }
+};
+
+struct PresetMapData {
+    std::vector<NameId> presetNames;                          // Installed presets, sorted by name
+    std::vector<std::pair<NameId, NameId>> filenameMappings;  // XML filename -> first internal name, by filename
+    size_t validNameCount = 0;                                // Preset names and filenames accepted as written
+    PresetLookupIndex lookup;
+};
+
+PresetMapData BuildPresetNameMap(const PresetCatalog& catalog, std::ostream& logFile) {
+    PresetMapData presetData;
+    PresetLookupIndex& lookup = presetData.lookup;
+
+    auto markValid = [&](NameId name) {
+        PresetLookupKey& key = lookup.Key(name);
+        if (!key.valid) {
+            key.valid = true;
+            presetData.validNameCount++;
+        }
+    };
+    auto mapFilename = [&](NameId filename, NameId internalName) {
+        PresetLookupKey& key = lookup.Key(filename);
+        if (key.filenameTarget == NO_NAME) {
+            key.filenameTarget = internalName;
+            presetData.filenameMappings.emplace_back(filename, internalName);
+        }
+    };
+    auto addNormalized = [&](const std::string& name, NameId target) {
+        std::string normalized = NormalizePresetNameFlexible(name);
+        if (normalized.empty()) return;
+        PresetLookupKey& key = lookup.Key(InternName(normalized));
+        if (key.normalized == NO_NAME) key.normalized = target;
+    };
+    
+    try {
+        if (!catalog.folderFound) {
+            logFile << "WARNING: BodySlide presets folder not found for building preset map" << std::endl;
+            return presetData;
+        }
+        
+        int totalXmlFiles = 0;
+        int successfulExtractions = 0;
+        int usingFilenameAsFallback = 0;
+        int duplicateXmlFiles = 0;
+        lookup.slots.Reserve(catalog.entries.size() * 4);
+        
+        for (const auto& entry : catalog.entries) {
+            totalXmlFiles++;
+
+            // A duplicate has the kept entry's presets already mapped; only its filenames are new
+            if (entry.duplicate) {
+                duplicateXmlFiles++;
+                for (const auto& preset : entry.presets) {
+                    const XmlPresetInfo& info = preset.info;
+                    NameId filename = InternName(info.filename);
+                    NameId internalName = InternName(info.internalName);
+                    mapFilename(filename, internalName);
+                    markValid(filename);
+                    addNormalized(info.filename, internalName);
+                }
+                continue;
+            }
+            
+            for (const auto& preset : entry.presets) {
+                try {
+                    const XmlPresetInfo& info = preset.info;
+                    NameId filename = InternName(info.filename);
+                
+                    std::string presetNameToUse;
+                
+                    if (info.extractionSuccessful && !info.internalName.empty()) {
+                        presetNameToUse = info.internalName;
+                        successfulExtractions++;
+                    
+                        // A file with several presets maps to its first one
+                        mapFilename(filename, InternName(info.internalName));
+                    
+                        if (info.filename != info.internalName) {
+                            logFile << "  [MAPPING] File: " << info.filename 
+                                    << " -> Internal: " << info.internalName << std::endl;
+                        }
+                    
+                    } else {
+                        presetNameToUse = info.filename;
+                        usingFilenameAsFallback++;
+                        logFile << "  [WARNING] Failed to extract from: " << entry.xmlFilename << std::endl;
+                    }
+                
+                    NameId presetName = InternName(presetNameToUse);
+                    PresetLookupKey& key = lookup.Key(presetName);
+                    if (!key.exact) {
+                        key.exact = true;
+                        presetData.presetNames.push_back(presetName);
+                    }
+                    markValid(presetName);
+                    markValid(filename);
+                
+                    addNormalized(presetNameToUse, presetName);
+                    addNormalized(info.filename, presetName);
+                } catch (const std::exception& e) {
+                    logFile << "  [ERROR] Exception processing " << entry.xmlFilename << ": " << e.what() << std::endl;
+                } catch (...) {
+                    logFile << "  [ERROR] Unknown exception processing " << entry.xmlFilename << std::endl;
+                }
+            }
+        }
+
+        auto byName = [](NameId a, NameId b) { return NameView(a) < NameView(b); };
+        std::sort(presetData.presetNames.begin(), presetData.presetNames.end(), byName);
+        std::sort(presetData.filenameMappings.begin(), presetData.filenameMappings.end(),
+                  [&](const auto& a, const auto& b) { return byName(a.first, b.first); });
+
+        // Level 3 resolves to the first preset name in name order, so it is filled after sorting
+        for (NameId presetName : presetData.presetNames) {
+            PresetLookupKey& key = lookup.Key(InternName(NormalizePresetNameFlexible(NameString(presetName))));
+            if (key.flexible == NO_NAME) key.flexible = presetName;
+        }
+        
+        logFile << std::endl;
+        logFile << "Smart Cleaning: Preset Map Building Summary" << std::endl;
+        logFile << "  Total XML files found: " << totalXmlFiles << std::endl;
+        logFile << "  Successful name extractions: " << successfulExtractions << std::endl;
+        logFile << "  Failed extractions (using filename): " << usingFilenameAsFallback << std::endl;
+        logFile << "  Duplicate XML files (filename only): " << duplicateXmlFiles << std::endl;
+        logFile << "  Filename read failures: " << catalog.filenameFailed << std::endl;
+        logFile << "  Total unique presets in map: " << presetData.presetNames.size() << std::endl;
+        logFile << "  Total valid names (including filenames): " << presetData.validNameCount << std::endl;
+        logFile << std::endl;
+        
+    } catch (const std::exception& e) {
+        logFile << "ERROR in BuildPresetNameMap: " << e.what() << std::endl;
+    } catch (...) {
+        logFile << "ERROR in BuildPresetNameMap: Unknown exception" << std::endl;
+    }
+    
+    return presetData;
+}
+
+PresetMatchResult FindPresetMatch(const std::string& jsonPresetName, 
+                                   const PresetMapData& presetData,
+                                   std::ostream& logFile) {
+    PresetMatchResult result;
+    
+    if (jsonPresetName.empty()) {
+        return result;
+    }
+    
+    std::string cleanPresetName = jsonPresetName;
+    if (!cleanPresetName.empty() && cleanPresetName[0] == '!') {
+        cleanPresetName = cleanPresetName.substr(1);
+    }
+    
+    const PresetLookupIndex& index = presetData.lookup;
+    auto probe = [&](const std::string& key) { return index.Find(key); };
+
+    const PresetLookupKey* asWritten = probe(cleanPresetName);
+    if (asWritten && asWritten->exact) {
+        result.found = true;
+        result.actualPresetName = cleanPresetName;
+        result.matchLevel = 1;
+        return result;
+    }
+    
+    if (cleanPresetName.find('&') != std::string::npos) {
+        std::string decodedCleanName = DecodeHtmlEntities(cleanPresetName);
+        const PresetLookupKey* decoded = decodedCleanName != cleanPresetName ? probe(decodedCleanName) : nullptr;
+        if (decoded && decoded->exact) {
+            result.found = true;
+            result.actualPresetName = decodedCleanName;
+            result.matchLevel = 2;
+            logFile << "    [INFO] Matched with HTML entity decoding: " 
+                    << cleanPresetName << " -> " << decodedCleanName << std::endl;
+            return result;
+        }
+    }
+    
+    std::string normalized = NormalizePresetNameFlexible(cleanPresetName);
+    const PresetLookupKey* flexible = probe(normalized);
+    if (flexible && flexible->flexible != NO_NAME) {
+        result.found = true;
+        result.actualPresetName = NameString(flexible->flexible);
+        result.matchLevel = 3;
+        logFile << "    [INFO] Matched with normalization: " 
+                << cleanPresetName << " -> " << result.actualPresetName << std::endl;
+        return result;
+    }
+    
+    if (asWritten && asWritten->valid) {
+        result.found = true;
+        result.actualPresetName =
+            asWritten->filenameTarget != NO_NAME ? NameString(asWritten->filenameTarget) : cleanPresetName;
+        result.matchLevel = 4;
+        return result;
+    }
+    
+    if (!normalized.empty() && flexible && flexible->normalized != NO_NAME) {
+        result.found = true;
+        result.actualPresetName = NameString(flexible->normalized);
+        result.matchLevel = 5;
+        return result;
+    }
+    
+    // The name as written was already tried at level 4
+    std::string noSpaces = cleanPresetName;
+    noSpaces.erase(std::remove(noSpaces.begin(), noSpaces.end(), ' '), noSpaces.end());
+    
+    for (const auto& variation : {Trim(cleanPresetName), noSpaces, ToLowerCase(cleanPresetName)}) {
+        const PresetLookupKey* key = probe(variation);
+        if (key && key->valid) {
+            result.found = true;
+            result.actualPresetName = variation;
+            result.matchLevel = 6;
+            return result;
+        }
+    }
+    
+    return result;
+}
+
+bool SmartCleaningEnabled(const ConfigSettings& config) {
+    return config.presetsSmartCleaning || config.blacklistedPresetsSmartCleaningFromRandomDistribution ||
+           config.blacklistedPresetsSmartCleaningFromAll || config.outfitsForceReSmartCleaning;
+}
+
+// One JSON section Smart Cleaning rewrites
+struct CleaningSection {
+    std::string key;
+    bool locationHasPlugin = false;  // Changes are logged against "key/plugin" rather than "key"
+    bool keepsProtected = false;     // PROTECTED_FROM_CLEANING presets stay as they are
+};
+
+// The enabled options' sections in cleaning order, grouped under the line that introduces them
+std::vector<std::pair<std::string, std::vector<CleaningSection>>> SmartCleaningGroups(const ConfigSettings& config) {
+    std::vector<std::pair<std::string, std::vector<CleaningSection>>> groups;
+    auto addGroup = [&](const char* header, std::vector<std::string> keys, bool locationHasPlugin,
+                        bool keepsProtected) {
+        std::vector<CleaningSection> sections;
+        for (auto& key : keys) sections.push_back({std::move(key), locationHasPlugin, keepsProtected});
+        groups.emplace_back(header, std::move(sections));
+    };
+
+    if (config.presetsSmartCleaning) {
+        addGroup("Cleaning regular presets (npcFormID, npc, faction, raceFemale, raceMale, etc)...",
+                 {"npcFormID", "npc", "factionFemale", "factionMale", "npcPluginFemale", "npcPluginMale", "raceFemale",
+                  "raceMale"},
+                 true, false);
+    }
+    if (config.blacklistedPresetsSmartCleaningFromRandomDistribution) {
+        addGroup("Cleaning blacklistedPresetsFromRandomDistribution...", {"blacklistedPresetsFromRandomDistribution"},
+                 false, true);
+    }
+    if (config.blacklistedPresetsSmartCleaningFromAll) {
+        addGroup("Cleaning other blacklisted sections...",
+                 {"blacklistedNpcs", "blacklistedNpcsFormID", "blacklistedNpcsPluginFemale", "blacklistedNpcsPluginMale",
+                  "blacklistedRacesFemale", "blacklistedRacesMale", "blacklistedOutfitsFromORefitFormID",
+                  "blacklistedOutfitsFromORefit", "blacklistedOutfitsFromORefitPlugin"},
+                 false, true);
+    }
+    if (config.outfitsForceReSmartCleaning) {
+        addGroup("Cleaning outfitsForceRefit sections...", {"outfitsForceRefitFormID", "outfitsForceRefit"}, false,
+                 false);
+    }
+    return groups;
+}
+
+bool IsProtectedFromCleaning(std::string_view preset) {
+    return std::find(PROTECTED_FROM_CLEANING.begin(), PROTECTED_FROM_CLEANING.end(), preset) !=
+           PROTECTED_FROM_CLEANING.end();
+}
+
+// Preset references Smart Cleaning resolved (protected ones excluded) and the distinct names among them
+struct SmartCleaningCounts {
+    size_t references = 0;
+    size_t uniqueNames = 0;
+};
+
+// Every distinct referenced name is resolved once, in parallel, before any section changes; the
+// sections are then rewritten in one sweep from that table. FindPresetMatch's log lines are kept
+// with each result and replayed at every occurrence, so the log reads as if each was matched in turn.
+SmartCleaningCounts PerformSmartCleaning(std::map<std::string, OrderedPluginData>& processedData,
+                                         const ConfigSettings& config,
+                                         const PresetMapData& presetData,
+                                         const PresetSuggestionIndex& suggestionIndex,
+                                         ThreadPool* workerPool,
+                                         std::ostream& logFile,
+                                         std::vector<std::string>& missingPresetsFromIni) {
+    SmartCleaningCounts counts;
+    
+    if (!SmartCleaningEnabled(config)) {
+        logFile << "Smart Cleaning: All cleaning options disabled in configuration" << std::endl;
+        return counts;
+    }
+    
+    logFile << std::endl;
+    logFile << "Performing Smart Cleaning with Intelligent Preset Matching..." << std::endl;
+    logFile << "----------------------------------------------------" << std::endl;
+    
+    if (presetData.presetNames.empty()) {
+        logFile << "Smart Cleaning: No presets found in BodySlide folder, skipping cleaning" << std::endl;
+        return counts;
+    }
+    
+    int totalPresetsRemoved = 0;
+    int totalPresetsKept = 0;
+    int totalPresetsCorrected = 0;
+    int totalSuggestionsApplied = 0;
+    std::set<std::string> removedPresets;
+
+    // Each missing name is looked up once, however many sections reference it
+    std::map<std::string, std::vector<PresetSuggestion>> suggestions;
+    auto suggestionsFor = [&](const std::string& cleanPreset) -> const std::vector<PresetSuggestion>& {
+        auto it = suggestions.find(cleanPreset);
+        if (it == suggestions.end()) {
+            it = suggestions.emplace(cleanPreset, suggestionIndex.Suggest(cleanPreset, 3)).first;
+        }
+        return it->second;
+    };
+
+    // Above Suggestion_Auto_Apply_Confidence, a reference that failed every match level is replaced
+    // by its best suggestion instead of removed, unless another preset is just as close
+    auto applySuggestion = [&](std::string_view preset, const std::string& cleanPreset, bool hasExclamation,
+                               const std::string& location, std::vector<NameId>& cleanedPresets) {
+        if (config.suggestionAutoApplyConfidence <= 0) return false;
+        const auto& candidates = suggestionsFor(cleanPreset);
+        if (candidates.empty() || candidates[0].confidence < config.suggestionAutoApplyConfidence) return false;
+        if (candidates.size() > 1 && candidates[1].distance == candidates[0].distance) return false;
+
+        std::string finalPresetName = (hasExclamation ? "!" : "") + NameString(candidates[0].preset);
+        cleanedPresets.push_back(InternName(finalPresetName));
+        totalPresetsKept++;
+        totalPresetsCorrected++;
+        totalSuggestionsApplied++;
+        logFile << "  Corrected in " << location << ": \"" << preset << "\" -> \"" << finalPresetName
+                << "\" (suggestion" << (candidates[0].filename != NO_NAME ? " via its XML filename" : "")
+                << ", edit distance " << candidates[0].distance << ", confidence "
+                << candidates[0].confidence << "%)" << std::endl;
+        return true;
+    };
+
+    struct Resolution {
+        NameId cleanName = NO_NAME;
+        PresetMatchResult match;
+        NameId resolved = NO_NAME;                 // The matched name as is
+        NameId resolvedWithExclamation = NO_NAME;  // Interned by the sweep at the first "!" reference
+        std::string matchLog;
+    };
+    static constexpr std::uint32_t PROTECTED = 0xFFFFFFFFu;
+
+    // Collect: one resolution slot per distinct clean name, and each occurrence's slot in sweep order
+    auto groups = SmartCleaningGroups(config);
+    std::vector<Resolution> resolutions;
+    FlatIdMap slotByCleanName;
+    FlatIdMap slotByReference[2];  // Raw preset id -> slot, for sections without and with protection
+    std::vector<std::uint32_t> occurrenceSlots;
+    for (const auto& [header, sections] : groups) {
+        for (const auto& section : sections) {
+            for (const auto& [plugin, presets] : processedData[section.key].orderedData) {
+                for (NameId presetId : presets) {
+                    FlatIdMap& known = slotByReference[section.keepsProtected ? 1 : 0];
+                    if (const std::uint32_t* slot = known.Find(presetId)) {
+                        occurrenceSlots.push_back(*slot);
+                        continue;
+                    }
+                    std::string_view cleanPreset = NameView(presetId);
+                    if (!cleanPreset.empty() && cleanPreset[0] == '!') cleanPreset.remove_prefix(1);
+
+                    std::uint32_t slot = PROTECTED;
+                    if (!section.keepsProtected || !IsProtectedFromCleaning(cleanPreset)) {
+                        NameId cleanName = InternName(cleanPreset);
+                        auto [existing, inserted] =
+                            slotByCleanName.Insert(cleanName, static_cast<std::uint32_t>(resolutions.size()));
+                        if (inserted) {
+                            resolutions.emplace_back();
+                            resolutions.back().cleanName = cleanName;
+                        }
+                        slot = existing;
+                    }
+                    known.Insert(presetId, slot);
+                    occurrenceSlots.push_back(slot);
+                }
+            }
+        }
+    }
+
+    // Resolve: each distinct name once, on the worker pool
+    ParallelForChunks(workerPool, resolutions.size(), 256, [&](size_t, size_t begin, size_t end) {
+        std::ostringstream matchLog;
+        for (size_t i = begin; i < end; ++i) {
+            Resolution& resolution = resolutions[i];
+            matchLog.str(std::string());
+            resolution.match = FindPresetMatch(NameString(resolution.cleanName), presetData, matchLog);
+            resolution.matchLog = matchLog.str();
+            if (resolution.match.found) resolution.resolved = InternName(resolution.match.actualPresetName);
+        }
+    });
+
+    // Sweep: rewrite every section from the table
+    size_t nextOccurrence = 0;
+    for (const auto& [header, sections] : groups) {
+        logFile << header << std::endl;
+
+        for (const auto& section : sections) {
+            auto& data = processedData[section.key];
+            std::vector<std::pair<NameId, std::vector<NameId>>> cleanedData;
+            
+            for (auto& [plugin, presets] : data.orderedData) {
+                std::vector<NameId> cleanedPresets;
+                std::string location =
+                    section.locationHasPlugin ? section.key + "/" + std::string(NameView(plugin)) : section.key;
+                
+                for (NameId presetId : presets) {
+                    std::uint32_t slot = occurrenceSlots[nextOccurrence++];
+                    std::string_view preset = NameView(presetId);
+                    bool hasExclamation = !preset.empty() && preset[0] == '!';
+                    std::string_view cleanPreset = hasExclamation ? preset.substr(1) : preset;
+
+                    if (slot == PROTECTED) {
+                        cleanedPresets.push_back(presetId);
+                        totalPresetsKept++;
+                        logFile << "  Protected preset kept in " << section.key << ": " << cleanPreset << std::endl;
+                        continue;
+                    }
+                    
+                    Resolution& resolution = resolutions[slot];
+                    counts.references++;
+                    logFile << resolution.matchLog;
+                    
+                    if (resolution.match.found) {
+                        const std::string& name = resolution.match.actualPresetName;
+                        if (hasExclamation && resolution.resolvedWithExclamation == NO_NAME) {
+                            resolution.resolvedWithExclamation =
+                                !name.empty() && name[0] == '!' ? resolution.resolved : InternName("!" + name);
+                        }
+                        NameId finalPreset = hasExclamation ? resolution.resolvedWithExclamation : resolution.resolved;
+                        cleanedPresets.push_back(finalPreset);
+                        totalPresetsKept++;
+                        
+                        if (presetId != finalPreset) {
+                            totalPresetsCorrected++;
+                            logFile << "  Corrected in " << location << ": \"" << preset << "\" -> \""
+                                    << NameView(finalPreset) << "\" (Level " << resolution.match.matchLevel
+                                    << " match)" << std::endl;
+                        }
+                    } else if (!applySuggestion(preset, std::string(cleanPreset), hasExclamation, location,
+                                                cleanedPresets)) {
+                        totalPresetsRemoved++;
+                        logFile << "  Removed from " << location << ": " << cleanPreset << std::endl;
+                        
+                        if (removedPresets.insert(std::string(cleanPreset)).second &&
+                            std::find(missingPresetsFromIni.begin(), missingPresetsFromIni.end(), cleanPreset) ==
+                                missingPresetsFromIni.end()) {
+                            missingPresetsFromIni.emplace_back(cleanPreset);
+                        }
+                    }
+                }
+                
+                if (!cleanedPresets.empty()) {
+                    cleanedData.emplace_back(plugin, cleanedPresets);
+                }
+            }
+            
+            data.orderedData = cleanedData;
+        }
+    }
+    counts.uniqueNames = resolutions.size();
+    
+    logFile << std::endl;
+    logFile << "Smart Cleaning Summary:" << std::endl;
+    logFile << "  Total presets removed: " << totalPresetsRemoved << std::endl;
+    logFile << "  Total presets kept: " << totalPresetsKept << std::endl;
+    logFile << "  Total presets corrected: " << totalPresetsCorrected << std::endl;
+    logFile << "  Unique presets removed: " << removedPresets.size() << std::endl;
+    if (config.suggestionAutoApplyConfidence > 0) {
+        logFile << "  Presets corrected by suggestion (confidence >= " << config.suggestionAutoApplyConfidence
+                << "%): " << totalSuggestionsApplied << std::endl;
+    }
+    
+    if (!missingPresetsFromIni.empty()) {
+        logFile << std::endl;
+        logFile << "WARNING: The following presets were referenced but not found in BodySlide folder:" << std::endl;
+        logFile << "These may have been added by INI rules. Please verify if they need to be downloaded:" << std::endl;
+        size_t withSuggestions = 0;
+        for (const auto& missingPreset : missingPresetsFromIni) {
+            logFile << "  - " << missingPreset << std::endl;
+            const auto& candidates = suggestionsFor(missingPreset);
+            if (!candidates.empty()) withSuggestions++;
+            for (const auto& candidate : candidates) {
+                logFile << "      did you mean: " << NameView(candidate.preset) << " (";
+                if (candidate.filename != NO_NAME) logFile << "file " << NameView(candidate.filename) << ".xml, ";
+                logFile << "edit distance " << candidate.distance << ", confidence " << candidate.confidence << "%)"
+                        << std::endl;
+            }
+        }
+        logFile << std::endl;
+        logFile << "Close installed presets (within " << PresetSuggestionIndex::MAX_DISTANCE
+                << " edits, ignoring case and punctuation) were found for " << withSuggestions << " of "
+                << missingPresetsFromIni.size() << " missing presets." << std::endl;
+        logFile << "You can search for these presets on Nexus Mods or other modding sites." << std::endl;
+    }
+    
+    logFile << std::endl;
+    return counts;
+}
+
+// ===== JSON VALIDATION FUNCTIONS =====
+
+bool PerformSimpleJsonIntegrityCheck(const fs::path& jsonPath, std::ostream& logFile) {
+    try {
+        logFile << "Performing SIMPLE JSON integrity check at startup..." << std::endl;
+        logFile << "----------------------------------------------------" << std::endl;
+
+        if (!fs::exists(jsonPath)) {
+            logFile << "ERROR: JSON file does not exist at: " << jsonPath.string() << std::endl;
+            return false;
+        }
+
+        auto fileSize = fs::file_size(jsonPath);
+        if (fileSize < 10) {
+            logFile << "ERROR: JSON file is too small (" << fileSize << " bytes)" << std::endl;
+            return false;
+        }
+
+        std::string content = ReadFileWithEncoding(jsonPath);
+        if (content.empty()) {
+            logFile << "ERROR: JSON file is empty after reading" << std::endl;
+            return false;
+        }
+
+        logFile << "JSON file size: " << fileSize << " bytes" << std::endl;
+
+        content = content.substr(content.find_first_not_of(" \t\r\n"));
+        content = content.substr(0, content.find_last_not_of(" \t\r\n") + 1);
+
+        if (content.empty() || content[0] != '{' || content[content.length() - 1] != '}') {
+            logFile << "ERROR: JSON does not start with '{' or end with '}'" << std::endl;
+            return false;
+        }
+
+        int braceCount = 0;
+        int bracketCount = 0;
+        int parenCount = 0;
+        bool inString = false;
+        bool escape = false;
+        int line = 1;
+        int col = 1;
+
+        for (size_t i = 0; i < content.length(); i++) {
+            char c = content[i];
+            if (c == '\n') {
+                line++;
+                col = 1;
+                continue;
+            }
+            col++;
+
+            if (escape) {
+                escape = false;
+                continue;
+            }
+
+            if (c == '\\') {
+                escape = true;
+                continue;
+            }
+
+            if (c == '"') {
+                inString = !inString;
+                continue;
+            }
+
+            if (!inString) {
+                switch (c) {
+                    case '{':
+                        braceCount++;
+                        break;
+                    case '}':
+                        braceCount--;
+                        if (braceCount < 0) {
+                            logFile << "ERROR: Unbalanced closing brace '}' at line " << line << ", column " << col
+                                    << std::endl;
+                            return false;
+                        }
+                        break;
+                    case '[':
+                        bracketCount++;
+                        break;
+                    case ']':
+                        bracketCount--;
+                        if (bracketCount < 0) {
+                            logFile << "ERROR: Unbalanced closing bracket ']' at line " << line << ", column " << col
+                                    << std::endl;
+                            return false;
+                        }
+                        break;
+                    case '(':
+                        parenCount++;
+                        break;
+                    case ')':
+                        parenCount--;
+                        if (parenCount < 0) {
+                            logFile << "ERROR: Unbalanced closing parenthesis ')' at line " << line << ", column "
+                                    << col << std::endl;
+                            return false;
+                        }
+                        break;
+                }
+            }
+        }
+
+        if (braceCount != 0) {
+            logFile << "ERROR: Unbalanced braces (missing " << (braceCount > 0 ? "closing" : "opening")
+                    << " braces: " << abs(braceCount) << ")" << std::endl;
+            return false;
+        }
+
+        if (bracketCount != 0) {
+            logFile << "ERROR: Unbalanced brackets (missing " << (bracketCount > 0 ? "closing" : "opening")
+                    << " brackets: " << abs(bracketCount) << ")" << std::endl;
+            return false;
+        }
+
+        if (parenCount != 0) {
+            logFile << "ERROR: Unbalanced parentheses (missing " << (parenCount > 0 ? "closing" : "opening")
+                    << " parentheses: " << abs(parenCount) << ")" << std::endl;
+            return false;
+        }
+
+        const std::vector<std::string> expectedKeys = {
+            "npcFormID",       "npc",           "factionFemale", "factionMale",
+            "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+
+        int foundKeys = 0;
+        for (const auto& key : expectedKeys) {
+            if (content.find("\"" + key + "\"") != std::string::npos) {
+                foundKeys++;
+            }
+        }
+
+        if (foundKeys < 6) {
+            logFile << "ERROR: JSON appears to be corrupted or not a valid OBody config file" << std::endl;
+            logFile << " Expected at least 6 OBody keys, found only " << foundKeys << std::endl;
+            return false;
+        }
+
+        std::string cleanContent = content;
+        bool inStr = false;
+        bool esc = false;
+        for (size_t i = 0; i < cleanContent.length(); i++) {
+            if (esc) {
+                cleanContent[i] = ' ';
+                esc = false;
+                continue;
+            }
+
+            if (cleanContent[i] == '\\') {
+                esc = true;
+                cleanContent[i] = ' ';
+                continue;
+            }
+
+            if (cleanContent[i] == '"') {
+                inStr = !inStr;
+                cleanContent[i] = ' ';
+                continue;
+            }
+
+            if (inStr) {
+                cleanContent[i] = ' ';
+            }
+        }
+
+        if (cleanContent.find(",,") != std::string::npos) {
+            logFile << "ERROR: Found double comma ',,' in JSON structure" << std::endl;
+            return false;
+        }
+
+        if (cleanContent.find(",}") != std::string::npos) {
+            logFile << "WARNING: Found comma before closing brace ',}' (may cause issues)" << std::endl;
+        }
+
+        if (cleanContent.find(",]") != std::string::npos) {
+            logFile << "WARNING: Found comma before closing bracket ',]' (may cause issues)" << std::endl;
+        }
+
+        logFile << "SUCCESS: JSON passed SIMPLE integrity check" << std::endl;
+        logFile << " Found " << foundKeys << " valid OBody keys" << std::endl;
+        logFile << " Braces balanced: " << (braceCount == 0 ? "YES" : "NO") << std::endl;
+        logFile << " Brackets balanced: " << (bracketCount == 0 ? "YES" : "NO") << std::endl;
+        logFile << " Basic structure: VALID" << std::endl;
+        logFile << std::endl;
+
+        return true;
+    } catch (const std::exception& e) {
+        logFile << "ERROR in PerformSimpleJsonIntegrityCheck: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile << "ERROR in PerformSimpleJsonIntegrityCheck: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+bool PerformTripleValidation(const fs::path& jsonPath, const fs::path& backupPath, std::ostream& logFile) {
+    try {
+        if (!fs::exists(jsonPath)) {
+            logFile << "ERROR: JSON file does not exist for validation: " << jsonPath.string() << std::endl;
+            return false;
+        }
+
+        auto fileSize = fs::file_size(jsonPath);
+        if (fileSize < 10) {
+            logFile << "ERROR: JSON file is too small (" << fileSize << " bytes)" << std::endl;
+            return false;
+        }
+
+        std::string content = ReadFileWithEncoding(jsonPath);
+        if (content.empty()) {
+            logFile << "ERROR: JSON file is empty after reading" << std::endl;
+            return false;
+        }
+
+        content = Trim(content);
+        if (content.empty() || content[0] != '{' || content[content.length() - 1] != '}') {
+            logFile << "ERROR: JSON file does not have proper structure (missing braces)" << std::endl;
+            return false;
+        }
+
+        int braceCount = 0;
+        int bracketCount = 0;
+        bool inString = false;
+        bool escape = false;
+
+        for (char c : content) {
+            if (c == '"' && !escape) {
+                inString = !inString;
+            } else if (!inString) {
+                if (c == '{')
+                    braceCount++;
+                else if (c == '}')
+                    braceCount--;
+                else if (c == '[')
+                    bracketCount++;
+                else if (c == ']')
+                    bracketCount--;
+            }
+
+            escape = (c == '\\' && !escape);
+        }
+
+        if (braceCount != 0 || bracketCount != 0) {
+            logFile << "ERROR: JSON has unbalanced braces/brackets (braces: " << braceCount
+                    << ", brackets: " << bracketCount << ")" << std::endl;
+            return false;
+        }
+
+        const std::vector<std::string> expectedKeys = {
+            "npcFormID",       "npc",           "factionFemale", "factionMale",
+            "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+
+        int foundKeys = 0;
+        for (const auto& key : expectedKeys) {
+            if (content.find("\"" + key + "\"") != std::string::npos) {
+                foundKeys++;
+            }
+        }
+
+        if (foundKeys < 6) {
+            logFile << "ERROR: JSON appears corrupted (missing expected keys, found only " << foundKeys << " out of "
+                    << expectedKeys.size() << ")" << std::endl;
+            return false;
+        }
+
+        logFile << "SUCCESS: JSON file passed TRIPLE validation (" << fileSize << " bytes, " << foundKeys
+                << " valid keys found)" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        logFile << "ERROR in PerformTripleValidation: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile << "ERROR in PerformTripleValidation: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+// ===== BACKUP AND RESTORE FUNCTIONS =====
+
+bool PerformLiteralJsonBackup(const fs::path& originalJsonPath, const fs::path& backupJsonPath,
+                              std::ostream& logFile) {
+    try {
+        if (!fs::exists(originalJsonPath)) {
+            logFile << "ERROR: Original JSON file does not exist at: " << originalJsonPath.string() << std::endl;
+            return false;
+        }
+
+        CreateDirectoryIfNotExists(backupJsonPath.parent_path());
+
+        std::error_code ec;
+        fs::copy_file(originalJsonPath, backupJsonPath, fs::copy_options::overwrite_existing, ec);
+
+        if (ec) {
+            logFile << "ERROR: Failed to copy JSON file directly: " << ec.message() << std::endl;
+            return false;
+        }
+        RecordFileCopied(backupJsonPath);
+
+        try {
+            auto originalSize = fs::file_size(originalJsonPath);
+            auto backupSize = fs::file_size(backupJsonPath);
+
+            if (originalSize == backupSize && originalSize > 0) {
+                logFile << "SUCCESS: LITERAL JSON backup completed to: " << backupJsonPath.string() << std::endl;
+                logFile << "Backup file size: " << backupSize << " bytes (verified identical to original)" << std::endl;
+                return true;
+            } else {
+                logFile << "ERROR: Backup file size mismatch - Original: " << originalSize << ", Backup: " << backupSize
+                        << std::endl;
+                return false;
+            }
+
+        } catch (...) {
+            logFile << "SUCCESS: LITERAL JSON backup completed (size verification failed but backup exists)"
+                    << std::endl;
+            return true;
+        }
+
+    } catch (const std::exception& e) {
+        logFile << "ERROR in PerformLiteralJsonBackup: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile << "ERROR in PerformLiteralJsonBackup: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+bool MoveCorruptedJsonToAnalysis(const fs::path& corruptedJsonPath, const fs::path& analysisDir,
+                                 std::ostream& logFile) {
+    try {
+        if (!fs::exists(corruptedJsonPath)) {
+            logFile << "WARNING: Corrupted JSON file does not exist for analysis" << std::endl;
+            return false;
+        }
+
+        CreateDirectoryIfNotExists(analysisDir);
+
+        auto now = std::chrono::system_clock::now();
+        std::time_t time_t = std::chrono::system_clock::to_time_t(now);
+        std::tm tm = LocalTime(time_t);
+
+        char timestamp[32];
+        strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", &tm);
+
+        fs::path analysisFile =
+            analysisDir / ("OBody_presetDistributionConfig_corrupted_" + std::string(timestamp) + ".json");
+
+        std::error_code ec;
+        fs::copy_file(corruptedJsonPath, analysisFile, fs::copy_options::overwrite_existing, ec);
+
+        if (ec) {
+            logFile << "ERROR: Failed to move corrupted JSON to analysis folder: " << ec.message() << std::endl;
+            return false;
+        }
+        RecordFileCopied(analysisFile);
+
+        logFile << "SUCCESS: Corrupted JSON moved to analysis folder: " << analysisFile.string() << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        logFile << "ERROR in MoveCorruptedJsonToAnalysis: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile << "ERROR in MoveCorruptedJsonToAnalysis: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+bool RestoreJsonFromBackup(const fs::path& backupJsonPath, const fs::path& originalJsonPath,
+                           const fs::path& analysisDir, std::ostream& logFile) {
+    try {
+        if (!fs::exists(backupJsonPath)) {
+            logFile << "ERROR: Backup JSON file does not exist: " << backupJsonPath.string() << std::endl;
+            return false;
+        }
+
+        if (!PerformTripleValidation(backupJsonPath, fs::path(), logFile)) {
+            logFile << "ERROR: Backup JSON file is also corrupted, cannot restore" << std::endl;
+            return false;
+        }
+
+        logFile << "WARNING: Original JSON appears corrupted, restoring from backup..." << std::endl;
+
+        if (fs::exists(originalJsonPath)) {
+            MoveCorruptedJsonToAnalysis(originalJsonPath, analysisDir, logFile);
+        }
+
+        std::error_code ec;
+        fs::copy_file(backupJsonPath, originalJsonPath, fs::copy_options::overwrite_existing, ec);
+
+        if (ec) {
+            logFile << "ERROR: Failed to restore JSON from backup: " << ec.message() << std::endl;
+            return false;
+        }
+        RecordFileCopied(originalJsonPath);
+
+        if (PerformTripleValidation(originalJsonPath, fs::path(), logFile)) {
+            logFile << "SUCCESS: JSON restored from backup successfully" << std::endl;
+            return true;
+        } else {
+            logFile << "ERROR: Restored JSON is still invalid" << std::endl;
+            return false;
+        }
+
+    } catch (const std::exception& e) {
+        logFile << "ERROR in RestoreJsonFromBackup: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile << "ERROR in RestoreJsonFromBackup: Unknown exception" << std::endl;
+        return false;
+    }
+}
+// ===== NEW LOG GENERATION FUNCTIONS =====
+
+void GenerateDoctorLog(const PresetCatalog& catalog, const fs::path& logDoctorPath, std::ostream& mainLogFile) {
+    try {
+        mainLogFile << "Generating Doctor Log..." << std::endl;
+        mainLogFile << "Searching in: " << catalog.folder.string() << std::endl;
+
+        std::ofstream doctorLog(logDoctorPath, std::ios::out | std::ios::trunc);
+        if (!doctorLog.is_open()) {
+            mainLogFile << "ERROR: Could not create Doctor Log file" << std::endl;
+            return;
+        }
+
+        doctorLog << "====================================================" << std::endl;
+        doctorLog << "OBody NG Preset Distribution Assistant NG - Doctor" << std::endl;
+        doctorLog << "====================================================" << std::endl;
+        doctorLog << std::endl;
+
+        if (!catalog.folderFound) {
+            doctorLog << "ERROR: BodySlide presets folder not found at:" << std::endl;
+            doctorLog << catalog.folder.string() << std::endl;
+            mainLogFile << "ERROR: Folder does not exist: " << catalog.folder.string() << std::endl;
+            RecordStreamWritten(doctorLog);
+            doctorLog.close();
+            return;
+        }
+
+        if (catalog.iterationFailed) {
+            doctorLog << "ERROR: Could not read directory" << std::endl;
+            RecordStreamWritten(doctorLog);
+            doctorLog.close();
+            return;
+        }
+
+        mainLogFile << "Total files scanned: " << catalog.totalScanned << std::endl;
+        mainLogFile << "Total XML files found: " << catalog.entries.size() << std::endl;
+        if (!catalog.duplicateGroups.empty()) {
+            mainLogFile << "Duplicate XML files: " << CountDuplicateEntries(catalog) << " in "
+                        << catalog.duplicateGroups.size() << " groups" << std::endl;
+        }
+        if (catalog.filenameFailed > 0) {
+            mainLogFile << "Filename read failures: " << catalog.filenameFailed << std::endl;
+        }
+
+        doctorLog << "XML FILES FOUND IN SLIDER PRESETS FOLDER:" << std::endl;
+        doctorLog << "Total files: " << catalog.entries.size() << std::endl;
+        doctorLog << std::endl;
+
+        for (const auto& entry : catalog.entries) {
+            doctorLog << entry.xmlFilename << std::endl;
+        }
+
+        doctorLog << std::endl;
+        doctorLog << "DUPLICATE XML FILES (identical content, whitespace ignored):" << std::endl;
+        if (catalog.duplicateGroups.empty()) {
+            doctorLog << "None" << std::endl;
+        } else {
+            doctorLog << "Groups: " << catalog.duplicateGroups.size() << ", redundant files: "
+                      << CountDuplicateEntries(catalog) << std::endl;
+            doctorLog << "Only the first file of each group is used for Smart Cleaning and the UBE scan;" << std::endl;
+            doctorLog << "the others can be deleted without changing the distribution." << std::endl;
+            for (const auto& group : catalog.duplicateGroups) {
+                doctorLog << std::endl;
+                doctorLog << "  " << catalog.entries[group[0]].xmlFilename << " (kept)" << std::endl;
+                for (size_t i = 1; i < group.size(); ++i) {
+                    doctorLog << "    " << catalog.entries[group[i]].xmlFilename << std::endl;
+                }
+            }
+        }
+
+        doctorLog << std::endl;
+        doctorLog << "====================================================" << std::endl;
+
+        RecordStreamWritten(doctorLog);
+
+        doctorLog.close();
+
+        if (doctorLog.fail()) {
+            mainLogFile << "ERROR: Failed to write Doctor Log file" << std::endl;
+        } else {
+            mainLogFile << "SUCCESS: Doctor Log created with " << catalog.entries.size() << " files" << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        mainLogFile << "CRITICAL ERROR in GenerateDoctorLog: " << e.what() << std::endl;
+    } catch (...) {
+        mainLogFile << "CRITICAL ERROR in GenerateDoctorLog: Unknown exception" << std::endl;
+    }
+}
+
+void GenerateSmartCleaningLog(const PresetMapData& presetData, const fs::path& logSmartCleaningPath, std::ostream& mainLogFile) {
+    try {
+        mainLogFile << "Generating Smart Cleaning Log with extracted preset names..." << std::endl;
+        
+        std::ofstream smartCleaningLog(logSmartCleaningPath, std::ios::out | std::ios::trunc);
+        if (!smartCleaningLog.is_open()) {
+            mainLogFile << "ERROR: Could not create Smart Cleaning Log file" << std::endl;
+            return;
+        }
+        
+        smartCleaningLog << "====================================================" << std::endl;
+        smartCleaningLog << "Smart Cleaning Preset Reference" << std::endl;
+        smartCleaningLog << "====================================================" << std::endl;
+        smartCleaningLog << std::endl;
+        
+        std::vector<std::string> presetNames;
+        for (NameId presetName : presetData.presetNames) {
+            presetNames.push_back(NameString(presetName));
+        }
+        
+        smartCleaningLog << "PRESET NAMES EXTRACTED FROM XML FILES (INTERNAL <Preset name=\"...\">):" << std::endl;
+        smartCleaningLog << "Total presets: " << presetNames.size() << std::endl;
+        smartCleaningLog << std::endl;
+        
+        for (const auto& presetName : presetNames) {
+            smartCleaningLog << presetName << std::endl;
+        }
+        
+        smartCleaningLog << std::endl;
+        smartCleaningLog << "----------------------------------------------------" << std::endl;
+        smartCleaningLog << std::endl;
+        
+        smartCleaningLog << "FILENAME TO INTERNAL NAME MAPPING:" << std::endl;
+        smartCleaningLog << "(Shows XML filenames that differ from internal preset names)" << std::endl;
+        smartCleaningLog << std::endl;
+        
+        int mappingCount = 0;
+        for (const auto& [filename, internalName] : presetData.filenameMappings) {
+            if (filename != internalName) {
+                smartCleaningLog << "File: " << NameView(filename) << ".xml" << std::endl;
+                smartCleaningLog << " -> Internal: " << NameView(internalName) << std::endl;
+                smartCleaningLog << std::endl;
+                mappingCount++;
+            }
+        }
+        
+        if (mappingCount == 0) {
+            smartCleaningLog << "All XML filenames match their internal preset names." << std::endl;
+        } else {
+            smartCleaningLog << "Total mappings: " << mappingCount << std::endl;
+        }
+        
+        smartCleaningLog << std::endl;
+        smartCleaningLog << "====================================================" << std::endl;
+        
+        RecordStreamWritten(smartCleaningLog);
+        
+        smartCleaningLog.close();
+        
+        if (smartCleaningLog.fail()) {
+            mainLogFile << "ERROR: Failed to write Smart Cleaning Log file" << std::endl;
+        } else {
+            mainLogFile << "SUCCESS: Smart Cleaning Log created with " << presetNames.size() << " presets at: " << logSmartCleaningPath.string() << std::endl;
+        }
+        
+    } catch (const std::exception& e) {
+        mainLogFile << "ERROR in GenerateSmartCleaningLog: " << e.what() << std::endl;
+    } catch (...) {
+        mainLogFile << "ERROR in GenerateSmartCleaningLog: Unknown exception" << std::endl;
+    }
+}
+
+void GenerateHelperLog(const PresetMapData& presetData, const fs::path& logHelperPath, std::ostream& mainLogFile) {
+    try {
+        mainLogFile << "Generating Helper Log with preset list and examples..." << std::endl;
+        
+        std::ofstream helperLog(logHelperPath, std::ios::out | std::ios::trunc);
+        if (!helperLog.is_open()) {
+            mainLogFile << "ERROR: Could not create Helper Log file" << std::endl;
+            return;
+        }
+        
+        helperLog << "====================================================" << std::endl;
+        helperLog << "OBody NG Preset Distribution Assistant NG - Helper" << std::endl;
+        helperLog << "====================================================" << std::endl;
+        helperLog << std::endl;
+        
+        helperLog << "This is a complete list of all presets installed in your Skyrim." << std::endl;
+        helperLog << "You can use them to create INI files and manage presets intelligently." << std::endl;
+        helperLog << "It also helps you know if you have certain presets installed or not, making your life much easier." << std::endl;
+        helperLog << std::endl;
+        helperLog << "You can visit the wiki at:" << std::endl;
+        helperLog << "https://john95ac.github.io/website-documents-John95AC/OBody_NG_Preset_Distribution_Assistant_NG/index.html" << std::endl;
+        helperLog << "which includes a rule generator for INI files." << std::endl;
+        helperLog << std::endl;
+        helperLog << "Below are some examples of how to use the INI manager in different cases." << std::endl;
+        helperLog << std::endl;
+        helperLog << std::endl;
+
+        helperLog << "====================================================" << std::endl;
+        helperLog << "INSTALLED PRESETS LIST (" << presetData.presetNames.size() << " total)" << std::endl;
+        helperLog << "====================================================" << std::endl;
+        helperLog << std::endl;
+
+        // Separate presets into NORMAL and UBE categories
+        std::vector<std::string> normalPresets;
+        std::vector<std::string> ubePresets;
+
+        for (NameId presetId : presetData.presetNames) {
+            std::string presetName = NameString(presetId);
+            // Check if preset name contains "UBE" (case-insensitive)
+            std::string lowerName = presetName;
+            std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(),
+                          [](unsigned char c) { return std::tolower(c); });
+
+            if (lowerName.find("ube") != std::string::npos) {
+                ubePresets.push_back(presetName);
+            } else {
+                normalPresets.push_back(presetName);
+            }
+        }
+
+        // Sort both lists alphabetically
+        std::sort(normalPresets.begin(), normalPresets.end());
+        std::sort(ubePresets.begin(), ubePresets.end());
+
+        // Write NORMAL presets
+        helperLog << "NORMAL PRESETS (CBBE/3BA/BHUNP/etc.) - " << normalPresets.size() << " total" << std::endl;
+        helperLog << std::endl;
+
+        for (const auto& preset : normalPresets) {
+            helperLog << preset << std::endl;
+        }
+
+        // Write UBE presets section (only if UBE presets exist)
+        if (!ubePresets.empty()) {
+            helperLog << std::endl;
+            helperLog << "UBE PRESETS - " << ubePresets.size() << " total" << std::endl;
+            helperLog << std::endl;
+
+            for (const auto& preset : ubePresets) {
+                helperLog << preset << std::endl;
+            }
+        }
+        
+        helperLog << std::endl;
+        helperLog << "----------------------------------------------------" << std::endl;
+        helperLog << std::endl;
+        
+        helperLog << ";OBody_Preset_Distribution_Assistant-NG rules to create an INI" << std::endl;
+        helperLog << ";Don't be scared, check the web or review the examples below" << std::endl;
+        helperLog << std::endl;
+        helperLog << ";OBodyNG_PDA_(mod_name).ini - This is the INI structure" << std::endl;
+        helperLog << ";You can use the mod examples entirely or create your own INI, but you must respect the naming convention" << std::endl;
+        helperLog << ";Example: OBodyNG_PDA_MyMod.ini or OBodyNG_PDA_Custom_Bodies.ini" << std::endl;
+        helperLog << std::endl;
+        helperLog << ";Code design examples: Very similar to SPID but shorter and simpler." << std::endl;
+        helperLog << std::endl;
+        helperLog << "; npcFormID = xx0001|Preset,...|x, 1, 0, -, *, empty             FormID" << std::endl;
+        helperLog << "; npc = EditorID|Preset,...|x, 1, 0, -, *, empty                 EditorID name like 000Rabbit_NPC or Serana" << std::endl;
+        helperLog << "; factionFemale = Faction|Preset,...|x, 1, 0, -, *, empty        Faction name like ImperialFaction or KhajiitFaction" << std::endl;
+        helperLog << "; factionMale = Faction|Preset,...|x, 1, 0, -, *, empty" << std::endl;
+        helperLog << "; npcPluginFemale = Plugin.esp|Preset,...|x, 1, 0, -, *, empty   The name of the ESP with defined bodies" << std::endl;
+        helperLog << "; npcPluginMale = Plugin.esp|Preset,...|x, 1, 0, -, *, empty" << std::endl;
+        helperLog << "; raceFemale = Race|Preset,...|x, 1, 0, -, *, empty              Works with NordRace, OrcRace, etc., and custom races" << std::endl;
+        helperLog << "; raceMale = Race|Preset,...|x, 1, 0, -, *, empty" << std::endl;
+        helperLog << std::endl;
+        helperLog << ";Shape selectors can replace preset names: @hips>0.7, @bust:100>=1.2&waist<0.3, @butt=0.4..0.8" << std::endl;
+        helperLog << ";Metrics are bust, waist, hips and butt; :0 or :100 picks a weight, otherwise both are averaged." << std::endl;
+        helperLog << std::endl;
+        helperLog << "----------------------------------------------------" << std::endl;
+        helperLog << "EXAMPLE 1: Assigning presets to NPCs via plugin" << std::endl;
+        helperLog << "----------------------------------------------------" << std::endl;
+        helperLog << std::endl;
+        
+        if (normalPresets.size() >= 2) {
+            std::vector<std::string> randomPresets;
+            std::random_device rd;
+            std::mt19937 gen(rd());
+
+            if (normalPresets.size() <= 5) {
+                randomPresets = normalPresets;
+            } else {
+                std::sample(normalPresets.begin(), normalPresets.end(), std::back_inserter(randomPresets),
+                           std::min(static_cast<size_t>(5), normalPresets.size()), gen);
+            }
+            
+            helperLog << ";YurianaWench example" << std::endl;
+            helperLog << "npcPluginFemale = YurianaWench.esp|";
+            for (size_t i = 0; i < randomPresets.size() && i < 2; i++) {
+                if (i > 0) helperLog << ",";
+                helperLog << randomPresets[i];
+            }
+            helperLog << "|" << std::endl;
+            helperLog << std::endl;
+            
+            helperLog << ";Immersive Wenches example" << std::endl;
+            helperLog << "npcPluginFemale = Immersive Wenches.esp|";
+            for (size_t i = 0; i < randomPresets.size() && i < 2; i++) {
+                if (i > 0) helperLog << ",";
+                helperLog << randomPresets[i];
+            }
+            helperLog << "|" << std::endl;
+            helperLog << std::endl;
+            
+            helperLog << "These two examples assign bodies to all NPCs in those plugins." << std::endl;
+            helperLog << "You can use 1 or multiple presets - OBody will randomly choose among them for assignment." << std::endl;
+            helperLog << std::endl;
+            helperLog << "Note: The elements at the end are only for advanced users who want sequences." << std::endl;
+            helperLog << "It's not necessary to apply anything - in fact, it's highly recommended to leave it empty." << std::endl;
+            helperLog << std::endl;
+            
+            helperLog << "----------------------------------------------------" << std::endl;
+            helperLog << "EXAMPLE 2: Assigning presets to entire races" << std::endl;
+            helperLog << "----------------------------------------------------" << std::endl;
+            helperLog << std::endl;
+            
+            helperLog << "Another very useful example is assigning a set of body presets to complete races." << std::endl;
+            helperLog << "Here's an example with your presets (minimum 5 random selections per race):" << std::endl;
+            helperLog << std::endl;
+            
+            const std::vector<std::string> races = {
+                "NordRace", "ImperialRace", "BretonRace", "RedguardRace", "DarkElfRace",
+                "HighElfRace", "WoodElfRace", "OrcRace", "KhajiitRace", "ArgonianRace", "ElderRace"
+            };
+            
+            for (const auto& race : races) {
+                std::vector<std::string> raceRandomPresets;
+
+                if (normalPresets.size() <= 5) {
+                    raceRandomPresets = normalPresets;
+                } else {
+                    std::sample(normalPresets.begin(), normalPresets.end(), std::back_inserter(raceRandomPresets),
+                               std::min(static_cast<size_t>(5), normalPresets.size()), gen);
+                }
+                
+                helperLog << ";" << race << std::endl;
+                helperLog << "raceFemale = " << race << "|";
+                
+                for (size_t i = 0; i < raceRandomPresets.size(); i++) {
+                    if (i > 0) helperLog << ",";
+                    helperLog << raceRandomPresets[i];
+                }
+                
+                helperLog << "|" << std::endl;
+                helperLog << std::endl;
+            }
+            
+            helperLog << "----------------------------------------------------" << std::endl;
+            helperLog << "AVAILABLE RACES (including vampire variants)" << std::endl;
+            helperLog << "----------------------------------------------------" << std::endl;
+            helperLog << std::endl;
+            
+            const std::vector<std::string> allRaces = {
+                "NordRace", "ImperialRace", "BretonRace", "RedguardRace", "DarkElfRace",
+                "HighElfRace", "WoodElfRace", "OrcRace", "KhajiitRace", "ArgonianRace", "ElderRace",
+                "NordRaceVampire", "ImperialRaceVampire", "BretonRaceVampire", "RedguardRaceVampire",
+                "DarkElfRaceVampire", "HighElfRaceVampire", "WoodElfRaceVampire", "OrcRaceVampire",
+                "KhajiitRaceVampire", "ArgonianRaceVampire", "ElderRaceVampire"
+            };
+            
+            for (const auto& race : allRaces) {
+                helperLog << race << std::endl;
+            }
+            
+            helperLog << std::endl;
+        } else {
+            helperLog << "Not enough presets installed to generate examples." << std::endl;
+            helperLog << "Install more BodySlide presets and run again." << std::endl;
+            helperLog << std::endl;
+        }
+        
+        helperLog << "----------------------------------------------------" << std::endl;
+        helperLog << "FINAL NOTES" << std::endl;
+        helperLog << "----------------------------------------------------" << std::endl;
+        helperLog << std::endl;
+        helperLog << "As you can see, it's not complicated and you can leave those rules in an INI file," << std::endl;
+        helperLog << "and the mod will read and preset them automatically." << std::endl;
+        helperLog << std::endl;
+        helperLog << "If you have UBE presets, the mod automatically places them in the blacklist to avoid errors," << std::endl;
+        helperLog << "and you can distribute them wherever you want. It also distributes them to all UBE NPCs randomly," << std::endl;
+        helperLog << "but you can use npcPluginFemale to apply UBE to particular NPCs." << std::endl;
+        helperLog << "You can also use FormIDs or NPC names, but the plugin method never fails." << std::endl;
+        helperLog << std::endl;
+        helperLog << "Remember when creating an INI, it must follow this format:" << std::endl;
+        helperLog << "OBodyNG_PDA_(mod_name).ini" << std::endl;
+        helperLog << std::endl;
+        helperLog << "When choosing a unique name for your INI, you can use the examples provided with the mod" << std::endl;
+        helperLog << "to avoid creating one from scratch. The name must use underscores (_) as separators" << std::endl;
+        helperLog << "to ensure proper search functionality." << std::endl;
+        helperLog << std::endl;
+        helperLog << "That's it! Thank you for using my mod, and I hope it serves you well. Good luck!" << std::endl;
+        helperLog << std::endl;
+        helperLog << "====================================================" << std::endl;
+        
+        RecordStreamWritten(helperLog);
+        
+        helperLog.close();
+        
+        if (helperLog.fail()) {
+            mainLogFile << "ERROR: Failed to write Helper Log file" << std::endl;
+        } else {
+            mainLogFile << "SUCCESS: Helper Log created successfully at: " << logHelperPath.string() << std::endl;
+        }
+        
+    } catch (const std::exception& e) {
+        mainLogFile << "ERROR in GenerateHelperLog: " << e.what() << std::endl;
+    } catch (...) {
+        mainLogFile << "ERROR in GenerateHelperLog: Unknown exception" << std::endl;
+    }
+}
+
+// ===== NEAR-DUPLICATE PRESET CLUSTERS =====
+
+// Squared Euclidean distance and dot product of two float vectors whose length is a multiple of 4
+// (the cluster matrix pads every row). Four lanes are summed in the same order on every path.
+float SquaredDistance(const float* a, const float* b, size_t count) {
+#if defined(OBODY_PDA_SSE2)
+    __m128 sum = _mm_setzero_ps();
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        sum = _mm_add_ps(sum, _mm_mul_ps(d, d));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+#elif defined(OBODY_PDA_NEON)
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < count; i += 4) {
+        float32x4_t d = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        sum = vaddq_f32(sum, vmulq_f32(d, d));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, sum);
+#else
+    float lanes[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i < count; i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            float d = a[i + lane] - b[i + lane];
+            lanes[lane] += d * d;
+        }
+    }
+#endif
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+float DotProduct(const float* a, const float* b, size_t count) {
+#if defined(OBODY_PDA_SSE2)
+    __m128 sum = _mm_setzero_ps();
+    for (size_t i = 0; i < count; i += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+#elif defined(OBODY_PDA_NEON)
+    float32x4_t sum = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < count; i += 4) {
+        sum = vaddq_f32(sum, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, sum);
+#else
+    float lanes[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i < count; i += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) lanes[lane] += a[i + lane] * b[i + lane];
+    }
+#endif
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+struct PresetClusterOptions {
+    float maxDistance = 25.0f;  // Euclidean, in slider percentage points over every small and big value
+    bool exhaustive = false;    // Compare every pair instead of LSH candidates (benchmark reference)
+};
+
+struct PresetClusterMember {
+    size_t entry = 0;
+    size_t preset = 0;
+    float distance = 0.0f;  // To the cluster's first member
+};
+
+struct PresetCluster {
+    std::string framework;
+    std::vector<PresetClusterMember> members;  // Catalog order; the first one is the one to keep
+};
+
+struct PresetClusterResult {
+    std::vector<PresetCluster> clusters;
+    size_t presetsCompared = 0;
+    size_t partitions = 0;
+    size_t sliderNames = 0;
+    size_t candidatePairs = 0;
+    size_t distanceChecks = 0;
+};
+
+// Locality-sensitive hashing for Euclidean distance: each band concatenates a few quantized random
+// projections, floor((a.v + b) / w). Presets within maxDistance share a band with high probability,
+// far-apart ones almost never, so only presets sharing a bucket are compared.
+static constexpr size_t CLUSTER_LSH_BANDS = 16;
+static constexpr size_t CLUSTER_LSH_PROJECTIONS_PER_BAND = 6;
+static constexpr float CLUSTER_LSH_WIDTH_FACTOR = 4.0f;
+static constexpr size_t CLUSTER_HASH_CHUNK_SIZE = 256;
+
+class PresetUnionFind {
+public:
+    explicit PresetUnionFind(size_t count) : parent_(count), size_(count, 1) {
+        for (size_t i = 0; i < count; ++i) parent_[i] = i;
+    }
+
+    size_t Find(size_t i) {
+        while (parent_[i] != i) {
+            parent_[i] = parent_[parent_[i]];
+            i = parent_[i];
+        }
+        return i;
+    }
+
+    void Union(size_t a, size_t b) {
+        a = Find(a);
+        b = Find(b);
+        if (a == b) return;
+        if (size_[a] < size_[b]) std::swap(a, b);
+        parent_[b] = a;
+        size_[a] += size_[b];
+    }
+
+private:
+    std::vector<size_t> parent_;
+    std::vector<size_t> size_;
+};
+
+// Deterministic standard normal samples (Box-Muller over splitmix64), so the buckets, and with
+// them the clusters, are the same on every run and thread count.
+class ClusterRandom {
+public:
+    explicit ClusterRandom(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t Next() {
+        std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    double Uniform() { return (static_cast<double>(Next() >> 11) + 0.5) * (1.0 / 9007199254740992.0); }
+
+    float Gaussian() {
+        double u1 = Uniform();
+        double u2 = Uniform();
+        return static_cast<float>(std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2));
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+// Presets are compared only within the same body framework combination: their slider sets differ,
+// and pruning a CBBE preset because a UBE one looks alike would be wrong. Exact duplicates are
+// already grouped by content hash and left out.
+PresetClusterResult ClusterPresetSliders(const PresetCatalog& catalog, const PresetClusterOptions& options,
+                                         ThreadPool* pool) {
+    PresetClusterResult result;
+    if (!catalog.sliderNames) return result;
+
+    std::vector<std::string> names = catalog.sliderNames->Names();
+    result.sliderNames = names.size();
+    std::vector<std::uint32_t> order(names.size());
+    for (std::uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) { return names[a] < names[b]; });
+    std::vector<std::uint32_t> rank(names.size());
+    for (std::uint32_t i = 0; i < order.size(); ++i) rank[order[i]] = i;
+
+    std::map<std::string, std::vector<std::pair<size_t, size_t>>> partitions;
+    for (size_t e = 0; e < catalog.entries.size(); ++e) {
+        const PresetCatalogEntry& entry = catalog.entries[e];
+        if (entry.duplicate) continue;
+        for (size_t p = 0; p < entry.presets.size(); ++p) {
+            const XmlPreset& preset = entry.presets[p];
+            if (preset.sliders.empty()) continue;
+            std::string key;
+            for (const auto& framework : preset.analysis.frameworks) key += (key.empty() ? "" : " + ") + framework;
+            partitions[key].emplace_back(e, p);
+        }
+    }
+    result.partitions = partitions.size();
+
+    const float maxSquared = options.maxDistance * options.maxDistance;
+    const float width = std::max(options.maxDistance, 0.001f) * CLUSTER_LSH_WIDTH_FACTOR;
+    const size_t projections = CLUSTER_LSH_BANDS * CLUSTER_LSH_PROJECTIONS_PER_BAND;
+
+    for (const auto& [framework, members] : partitions) {
+        size_t n = members.size();
+        result.presetsCompared += n;
+        if (n < 2) continue;
+
+        // Dense layout over the sliders this partition uses, in name order: [small, big] per slider
+        std::vector<std::uint32_t> used;
+        for (const auto& [e, p] : members) {
+            for (const auto& slider : catalog.entries[e].presets[p].sliders) used.push_back(rank[slider.id]);
+        }
+        std::sort(used.begin(), used.end());
+        used.erase(std::unique(used.begin(), used.end()), used.end());
+        std::unordered_map<std::uint32_t, size_t> column;
+        for (size_t i = 0; i < used.size(); ++i) column[used[i]] = i * 2;
+        size_t dims = (used.size() * 2 + 3) & ~static_cast<size_t>(3);
+
+        std::vector<float> vectors(n * dims, 0.0f);
+        for (size_t i = 0; i < n; ++i) {
+            float* row = &vectors[i * dims];
+            for (const auto& slider : catalog.entries[members[i].first].presets[members[i].second].sliders) {
+                size_t c = column[rank[slider.id]];
+                row[c] = slider.small;
+                row[c + 1] = slider.big;
+            }
+        }
+
+        PresetUnionFind sets(n);
+        auto tryPair = [&](size_t a, size_t b) {
+            result.candidatePairs++;
+            if (sets.Find(a) == sets.Find(b)) return;
+            result.distanceChecks++;
+            if (SquaredDistance(&vectors[a * dims], &vectors[b * dims], dims) <= maxSquared) sets.Union(a, b);
+        };
+
+        if (options.exhaustive) {
+            for (size_t a = 0; a < n; ++a) {
+                for (size_t b = a + 1; b < n; ++b) tryPair(a, b);
+            }
+        } else {
+            // Projections are drawn per slider name, so a slider keeps its direction in every partition
+            std::vector<float> planes(projections * dims, 0.0f);
+            for (size_t i = 0; i < used.size(); ++i) {
+                std::uint64_t seed = 0xCBF29CE484222325ULL;
+                for (unsigned char c : names[order[used[i]]]) seed = (seed ^ c) * 0x100000001B3ULL;
+                ClusterRandom random(seed);
+                for (size_t k = 0; k < projections; ++k) {
+                    planes[k * dims + i * 2] = random.Gaussian();
+                    planes[k * dims + i * 2 + 1] = random.Gaussian();
+                }
+            }
+            std::vector<float> offsets(projections);
+            ClusterRandom offsetRandom(0x534C4944ULL);
+            for (auto& offset : offsets) offset = static_cast<float>(offsetRandom.Uniform()) * width;
+
+            std::vector<std::uint64_t> keys(n * CLUSTER_LSH_BANDS);
+            ParallelForChunks(pool, n, CLUSTER_HASH_CHUNK_SIZE, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const float* row = &vectors[i * dims];
+                    for (size_t band = 0; band < CLUSTER_LSH_BANDS; ++band) {
+                        std::uint64_t key = 0xCBF29CE484222325ULL;
+                        for (size_t j = 0; j < CLUSTER_LSH_PROJECTIONS_PER_BAND; ++j) {
+                            size_t k = band * CLUSTER_LSH_PROJECTIONS_PER_BAND + j;
+                            float projected = (DotProduct(row, &planes[k * dims], dims) + offsets[k]) / width;
+                            auto bucket = static_cast<std::int64_t>(std::floor(projected));
+                            key = (key ^ static_cast<std::uint64_t>(bucket)) * 0x100000001B3ULL;
+                        }
+                        keys[i * CLUSTER_LSH_BANDS + band] = key;
+                    }
+                }
+            });
+
+            std::vector<std::pair<std::uint64_t, size_t>> buckets(n);
+            for (size_t band = 0; band < CLUSTER_LSH_BANDS; ++band) {
+                for (size_t i = 0; i < n; ++i) buckets[i] = {keys[i * CLUSTER_LSH_BANDS + band], i};
+                std::sort(buckets.begin(), buckets.end());
+                for (size_t start = 0; start < n;) {
+                    size_t end = start + 1;
+                    while (end < n && buckets[end].first == buckets[start].first) end++;
+                    for (size_t a = start; a < end; ++a) {
+                        for (size_t b = a + 1; b < end; ++b) tryPair(buckets[a].second, buckets[b].second);
+                    }
+                    start = end;
+                }
+            }
+        }
+
+        std::map<size_t, std::vector<size_t>> components;
+        for (size_t i = 0; i < n; ++i) components[sets.Find(i)].push_back(i);
+        std::vector<PresetCluster> clusters;
+        for (const auto& [root, indices] : components) {
+            if (indices.size() < 2) continue;
+            PresetCluster cluster;
+            cluster.framework = framework;
+            for (size_t i : indices) {
+                PresetClusterMember member;
+                member.entry = members[i].first;
+                member.preset = members[i].second;
+                member.distance = std::sqrt(SquaredDistance(&vectors[indices[0] * dims], &vectors[i * dims], dims));
+                cluster.members.push_back(member);
+            }
+            clusters.push_back(std::move(cluster));
+        }
+        // Members are already in catalog order; clusters follow their first member
+        std::sort(clusters.begin(), clusters.end(), [](const PresetCluster& a, const PresetCluster& b) {
+            return std::make_pair(a.members[0].entry, a.members[0].preset) <
+                   std::make_pair(b.members[0].entry, b.members[0].preset);
+        });
+        for (auto& cluster : clusters) result.clusters.push_back(std::move(cluster));
+    }
+
+    return result;
+}
+
+std::string ClusterMemberName(const PresetCatalog& catalog, const PresetClusterMember& member) {
+    const XmlPresetInfo& info = catalog.entries[member.entry].presets[member.preset].info;
+    return info.extractionSuccessful && !info.internalName.empty() ? info.internalName : info.filename;
+}
+
+PresetClusterOptions ClusterOptionsFromConfig(const ConfigSettings& config) {
+    PresetClusterOptions options;
+    options.maxDistance = static_cast<float>(config.clusterMaxDistance);
+    return options;
+}
+
+void GeneratePresetClustersLog(const PresetCatalog& catalog, const fs::path& logClustersPath,
+                               const PresetClusterOptions& options, ThreadPool* pool, std::ostream& mainLogFile) {
+    try {
+        mainLogFile << "Clustering near-duplicate presets..." << std::endl;
+
+        auto startTime = std::chrono::steady_clock::now();
+        PresetClusterResult result = ClusterPresetSliders(catalog, options, pool);
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                               startTime).count();
+
+        size_t clusteredPresets = 0;
+        for (const auto& cluster : result.clusters) clusteredPresets += cluster.members.size();
+
+        std::ofstream clustersLog(logClustersPath, std::ios::out | std::ios::trunc);
+        if (!clustersLog.is_open()) {
+            mainLogFile << "ERROR: Could not create Preset Clusters log file" << std::endl;
+            return;
+        }
+
+        clustersLog << "====================================================" << std::endl;
+        clustersLog << "OBody NG Preset Distribution Assistant NG - Preset Clusters" << std::endl;
+        clustersLog << "====================================================" << std::endl;
+        clustersLog << std::endl;
+        clustersLog << "Presets whose sliders are within a distance of " << options.maxDistance
+                    << " of another preset in the cluster" << std::endl;
+        clustersLog << "(Euclidean, in slider percentage points over every small and big value)." << std::endl;
+        clustersLog << "Presets are only compared within the same body framework; exact duplicate XMLs are" << std::endl;
+        clustersLog << "listed in the Doctor log instead." << std::endl;
+        clustersLog << std::endl;
+        clustersLog << "Presets compared: " << result.presetsCompared << " (" << result.partitions
+                    << " framework groups, " << result.sliderNames << " slider names)" << std::endl;
+        clustersLog << "Clusters: " << result.clusters.size() << " covering " << clusteredPresets << " presets"
+                    << std::endl;
+        if (!result.clusters.empty()) {
+            clustersLog << "Keeping one preset per cluster in NPC and faction lists would drop "
+                        << clusteredPresets - result.clusters.size() << " near-identical entries." << std::endl;
+        }
+
+        for (size_t c = 0; c < result.clusters.size(); ++c) {
+            const PresetCluster& cluster = result.clusters[c];
+            clustersLog << std::endl;
+            clustersLog << "Cluster " << c + 1 << " - "
+                        << (cluster.framework.empty() ? "no recognized body framework" : cluster.framework) << " ("
+                        << cluster.members.size() << " presets)" << std::endl;
+            for (size_t m = 0; m < cluster.members.size(); ++m) {
+                const PresetClusterMember& member = cluster.members[m];
+                clustersLog << "  " << ClusterMemberName(catalog, member) << " ("
+                            << catalog.entries[member.entry].xmlFilename << ")";
+                if (m == 0) {
+                    clustersLog << " [keep]";
+                } else {
+                    clustersLog << " distance " << std::fixed << std::setprecision(1) << member.distance
+                                << std::defaultfloat;
+                }
+                clustersLog << std::endl;
+            }
+        }
+
+        clustersLog << std::endl;
+        clustersLog << "====================================================" << std::endl;
+
+        RecordStreamWritten(clustersLog);
+        clustersLog.close();
+
+        if (clustersLog.fail()) {
+            mainLogFile << "ERROR: Failed to write Preset Clusters log file" << std::endl;
+        } else {
+            mainLogFile << "SUCCESS: Preset Clusters log created: " << result.clusters.size() << " clusters, "
+                        << clusteredPresets << " of " << result.presetsCompared << " presets (" << result.distanceChecks
+                        << " distance checks, " << elapsedMs << " ms)" << std::endl;
+        }
+
+    } catch (const std::exception& e) {
+        mainLogFile << "CRITICAL ERROR in GeneratePresetClustersLog: " << e.what() << std::endl;
+    } catch (...) {
+        mainLogFile << "CRITICAL ERROR in GeneratePresetClustersLog: Unknown exception" << std::endl;
+    }
+}
+
+// ===== SHAPE METRIC SELECTORS =====
+
+// A rule's preset list may hold selectors next to names: "@hips>0.7", "@bust:100>=1.2&waist<0.3",
+// "@butt=0.4..0.8". ":0" and ":100" pick the metric at weight 0 or 100; without it the mean of
+// both is used. A selector expands to every measured preset in range, in catalog order.
+enum ShapeWeight : size_t { SHAPE_WEIGHT_SMALL, SHAPE_WEIGHT_BIG, SHAPE_WEIGHT_MEAN, SHAPE_WEIGHT_COUNT };
+
+struct ShapeIndex {
+    std::vector<std::string> presetNames;  // Measured presets in catalog order, each name once
+    // Per metric and weight: (value, index into presetNames), sorted by value
+    std::array<std::vector<std::pair<float, std::uint32_t>>, SHAPE_METRIC_COUNT * SHAPE_WEIGHT_COUNT> sorted;
+    size_t unmeasured = 0;
+};
+
+ShapeIndex BuildShapeIndex(const PresetCatalog& catalog) {
+    ShapeIndex index;
+    std::unordered_map<std::string, std::uint32_t> seen;
+
+    for (const auto& entry : catalog.entries) {
+        if (entry.duplicate) continue;
+        for (const auto& preset : entry.presets) {
+            if (!preset.shape.measured) {
+                index.unmeasured++;
+                continue;
+            }
+            const XmlPresetInfo& info = preset.info;
+            std::string name =
+                info.extractionSuccessful && !info.internalName.empty() ? info.internalName : info.filename;
+            auto ordinal = static_cast<std::uint32_t>(index.presetNames.size());
+            if (!seen.emplace(name, ordinal).second) continue;
+            index.presetNames.push_back(std::move(name));
+
+            for (size_t m = 0; m < SHAPE_METRIC_COUNT; ++m) {
+                float small = preset.shape.small[m];
+                float big = preset.shape.big[m];
+                index.sorted[m * SHAPE_WEIGHT_COUNT + SHAPE_WEIGHT_SMALL].emplace_back(small, ordinal);
+                index.sorted[m * SHAPE_WEIGHT_COUNT + SHAPE_WEIGHT_BIG].emplace_back(big, ordinal);
+                index.sorted[m * SHAPE_WEIGHT_COUNT + SHAPE_WEIGHT_MEAN].emplace_back((small + big) / 2.0f, ordinal);
+            }
+        }
+    }
+
+    for (auto& column : index.sorted) std::sort(column.begin(), column.end());
+    return index;
+}
+
+struct ShapeCondition {
+    size_t column = 0;
+    float low = -std::numeric_limits<float>::infinity();
+    float high = std::numeric_limits<float>::infinity();
+    bool lowInclusive = true;
+    bool highInclusive = true;
+};
+
+bool ParseShapeNumber(const std::string& text, float& value) {
+    std::string trimmed = Trim(text);
+    if (trimmed.empty()) return false;
+    char* end = nullptr;
+    value = std::strtof(trimmed.c_str(), &end);
+    return end == trimmed.c_str() + trimmed.size() && std::isfinite(value);
+}
+
+// Parses a selector without its leading '@'. False if any condition is malformed.
+bool ParseShapeSelector(const std::string& selector, std::vector<ShapeCondition>& conditions) {
+    conditions.clear();
+    for (const auto& part : Split(selector, '&')) {
+        size_t pos = 0;
+        while (pos < part.size() && std::isalpha(static_cast<unsigned char>(part[pos]))) pos++;
+        std::string metricName = ToLowerCase(part.substr(0, pos));
+        size_t metric = 0;
+        while (metric < SHAPE_METRIC_COUNT && metricName != SHAPE_METRIC_NAMES[metric]) metric++;
+        if (metric == SHAPE_METRIC_COUNT) return false;
+
+        size_t weight = SHAPE_WEIGHT_MEAN;
+        if (pos < part.size() && part[pos] == ':') {
+            size_t digits = part.find_first_not_of("0123456789", pos + 1);
+            std::string weightText = part.substr(pos + 1, digits - pos - 1);
+            if (weightText == "0") {
+                weight = SHAPE_WEIGHT_SMALL;
+            } else if (weightText == "100") {
+                weight = SHAPE_WEIGHT_BIG;
+            } else {
+                return false;
+            }
+            pos = digits == std::string::npos ? part.size() : digits;
+        }
+        while (pos < part.size() && IsXmlSpace(part[pos])) pos++;
+
+        ShapeCondition condition;
+        condition.column = metric * SHAPE_WEIGHT_COUNT + weight;
+        std::string rest = part.substr(pos);
+        float value = 0.0f;
+        if (StartsWith(rest, ">=") && ParseShapeNumber(rest.substr(2), value)) {
+            condition.low = value;
+        } else if (StartsWith(rest, "<=") && ParseShapeNumber(rest.substr(2), value)) {
+            condition.high = value;
+        } else if (StartsWith(rest, ">") && ParseShapeNumber(rest.substr(1), value)) {
+            condition.low = value;
+            condition.lowInclusive = false;
+        } else if (StartsWith(rest, "<") && ParseShapeNumber(rest.substr(1), value)) {
+            condition.high = value;
+            condition.highInclusive = false;
+        } else if (StartsWith(rest, "=")) {
+            size_t range = rest.find("..");
+            float high = 0.0f;
+            if (range == std::string::npos) {
+                if (!ParseShapeNumber(rest.substr(1), value)) return false;
+                high = value;
+            } else if (!ParseShapeNumber(rest.substr(1, range - 1), value) ||
+                       !ParseShapeNumber(rest.substr(range + 2), high)) {
+                return false;
+            }
+            condition.low = std::min(value, high);
+            condition.high = std::max(value, high);
+        } else {
+            return false;
+        }
+        conditions.push_back(condition);
+    }
+    return !conditions.empty();
+}
+
+// Each condition is a binary-searched range of its sorted column; conditions are intersected.
+std::vector<std::string> ResolveShapeSelector(const ShapeIndex& index, const std::vector<ShapeCondition>& conditions) {
+    std::vector<std::uint32_t> matched;
+    for (size_t c = 0; c < conditions.size(); ++c) {
+        const ShapeCondition& condition = conditions[c];
+        const auto& column = index.sorted[condition.column];
+        auto begin = condition.lowInclusive
+                         ? std::lower_bound(column.begin(), column.end(), condition.low,
+                                            [](const auto& item, float value) { return item.first < value; })
+                         : std::upper_bound(column.begin(), column.end(), condition.low,
+                                            [](float value, const auto& item) { return value < item.first; });
+        auto end = condition.highInclusive
+                       ? std::upper_bound(begin, column.end(), condition.high,
+                                          [](float value, const auto& item) { return value < item.first; })
+                       : std::lower_bound(begin, column.end(), condition.high,
+                                          [](const auto& item, float value) { return item.first < value; });
+
+        std::vector<std::uint32_t> ordinals;
+        ordinals.reserve(static_cast<size_t>(std::distance(begin, end)));
+        for (auto it = begin; it != end; ++it) ordinals.push_back(it->second);
+        std::sort(ordinals.begin(), ordinals.end());
+
+        if (c == 0) {
+            matched = std::move(ordinals);
+        } else {
+            std::vector<std::uint32_t> both;
+            std::set_intersection(matched.begin(), matched.end(), ordinals.begin(), ordinals.end(),
+                                  std::back_inserter(both));
+            matched = std::move(both);
+        }
+        if (matched.empty()) break;
+    }
+
+    std::vector<std::string> names;
+    names.reserve(matched.size());
+    for (std::uint32_t ordinal : matched) names.push_back(index.presetNames[ordinal]);
+    return names;
+}
+
+bool IsShapeSelector(const std::string& preset) {
+    return StartsWith(preset, "@") || StartsWith(preset, "!@");
+}
+
+// Replaces each @selector of a rule's preset list (!@selector in removal rules) with the presets
+// it selects. resolved holds every selector already seen this run, so each resolves once.
+std::vector<std::string> ExpandShapeSelectors(const std::vector<std::string>& presets, const ShapeIndex& index,
+                                              std::map<std::string, std::vector<std::string>>& resolved,
+                                              std::ostream& logFile) {
+    std::vector<std::string> expanded;
+    expanded.reserve(presets.size());
+
+    for (const auto& preset : presets) {
+        if (!IsShapeSelector(preset)) {
+            expanded.push_back(preset);
+            continue;
+        }
+
+        bool negated = preset[0] == '!';
+        std::string selector = preset.substr(negated ? 1 : 0);
+        auto found = resolved.find(selector);
+        if (found == resolved.end()) {
+            std::vector<ShapeCondition> conditions;
+            std::vector<std::string> names;
+            if (ParseShapeSelector(selector.substr(1), conditions)) {
+                names = ResolveShapeSelector(index, conditions);
+                logFile << "  Shape selector " << selector << ": " << names.size() << " of "
+                        << index.presetNames.size() << " measured presets" << std::endl;
+            } else {
+                logFile << "  WARNING: Invalid shape selector '" << selector << "' - it selects no presets"
+                        << std::endl;
+            }
+            found = resolved.emplace(selector, std::move(names)).first;
+        }
+
+        for (const auto& name : found->second) expanded.push_back(negated ? "!" + name : name);
+    }
+    return expanded;
+}
+
+// ===== IMPROVED UBE XML PROCESSING FUNCTIONS =====
+
+struct UBEPresetInfo {
+    std::string presetName;
+    bool allowedInRaces;
+    bool hasConflict;
+    std::vector<std::string> conflictingGroups;
+};
+
+std::pair<std::vector<std::string>, std::vector<UBEPresetInfo>> ProcessUBEXmlPresets(
+    const PresetCatalog& catalog, std::ostream& logFile) {
+    
+    std::vector<std::string> allUBEPresetsForBlacklist;
+    std::vector<UBEPresetInfo> ubePresetsInfo;
+    std::vector<std::string> excludedFromRacesXmlFiles;
+    
+    try {
+        if (!catalog.folderFound) {
+            logFile << "WARNING: BodySlide presets folder not found: " << catalog.folder.string() << std::endl;
+            return {allUBEPresetsForBlacklist, ubePresetsInfo};
+        }
+        
+        logFile << std::endl;
+        logFile << "Scanning for UBE XML presets..." << std::endl;
+        logFile << "----------------------------------------------------" << std::endl;
+        
+        int totalXmlScanned = 0;
+        int totalUbeFound = 0;
+        int totalConflicting = 0;
+        int conflictingButNameHasUBE = 0;
+        int duplicatesSkipped = 0;
+        std::map<std::string, int> presetsPerFramework;
+        
+        for (const auto& entry : catalog.entries) {
+            totalXmlScanned++;
+            if (entry.duplicate) {
+                duplicatesSkipped++;
+                continue;
+            }
+            const std::string& filename = entry.xmlFilename;
+            
+            for (const auto& preset : entry.presets) {
+                try {
+                    const XmlAnalysisResult& analysis = preset.analysis;
+                    for (const auto& framework : analysis.frameworks) presetsPerFramework[framework]++;
+                
+                    if (analysis.hasUBE) {
+                        std::string presetName = (preset.info.extractionSuccessful && !preset.info.internalName.empty())
+                                                 ? preset.info.internalName
+                                                 : preset.info.filename;
+
+                        if (presetName.empty()) {
+                            logFile << "  WARNING: Could not extract preset name from: " << filename << std::endl;
+                            continue;
+                        }
+
+                        std::string lowerPresetName = presetName;
+                        std::transform(lowerPresetName.begin(), lowerPresetName.end(), 
+                                     lowerPresetName.begin(), ::tolower);
+                        bool filenameContainsUBE = (lowerPresetName.find("ube") != std::string::npos);
+
+                        if (analysis.hasConflictingGroups) {
+                            totalConflicting++;
+
+                            UBEPresetInfo info;
+                            info.presetName = presetName;
+                            info.hasConflict = true;
+                            info.conflictingGroups = analysis.conflictingGroupsFound;
+                            info.allowedInRaces = filenameContainsUBE;
+
+                            allUBEPresetsForBlacklist.push_back(presetName);
+
+                            if (filenameContainsUBE) {
+                                ubePresetsInfo.push_back(info);
+                                conflictingButNameHasUBE++;
+                                logFile << "  CONFLICT DETECTED (preset name has UBE, added to races): " << presetName << " (" << filename << ")" << std::endl;
+                            } else {
+                                if (excludedFromRacesXmlFiles.empty() || excludedFromRacesXmlFiles.back() != filename) {
+                                    excludedFromRacesXmlFiles.push_back(filename);
+                                }
+                                logFile << "  CONFLICT DETECTED (excluded from races): " << presetName << " (" << filename << ")" << std::endl;
+                            }
+
+                            logFile << "    Has UBE group but also contains: ";
+                            for (size_t i = 0; i < analysis.conflictingGroupsFound.size(); i++) {
+                                logFile << analysis.conflictingGroupsFound[i];
+                                if (i < analysis.conflictingGroupsFound.size() - 1) {
+                                    logFile << ", ";
+                                }
+                            }
+                            logFile << std::endl;
+                        } else {
+                            UBEPresetInfo info;
+                            info.presetName = presetName;
+                            info.hasConflict = false;
+                            info.allowedInRaces = true;
+
+                            allUBEPresetsForBlacklist.push_back(presetName);
+                            ubePresetsInfo.push_back(info);
+                            totalUbeFound++;
+                            logFile << "  Found UBE preset: " << presetName << " (" << filename << ")" << std::endl;
+                        }
+                    }
+                } catch (const std::exception& e) {
+                    logFile << "  [ERROR] Exception processing UBE in " << filename << ": " << e.what() << std::endl;
+                } catch (...) {
+                    logFile << "  [ERROR] Unknown exception processing UBE in " << filename << std::endl;
+                }
+            }
+        }
+
+        logFile << std::endl;
+        logFile << "UBE XML Scan Summary:" << std::endl;
+        logFile << "  Total XML files scanned: " << totalXmlScanned << std::endl;
+        logFile << "  Duplicate XML files skipped: " << duplicatesSkipped << std::endl;
+        logFile << "  Valid UBE presets found: " << totalUbeFound << std::endl;
+        logFile << "  Conflicting presets (UBE + 3BA/3BBB/CBBE): " << totalConflicting << std::endl;
+        logFile << "  Conflicting but preset name has UBE (added to races): " << conflictingButNameHasUBE << std::endl;
+        logFile << "  Total presets for blacklist: " << allUBEPresetsForBlacklist.size() << std::endl;
+        logFile << "  Total presets for UBE races: " << ubePresetsInfo.size() << std::endl;
+        if (!presetsPerFramework.empty()) {
+            logFile << "  Presets per body framework: ";
+            bool first = true;
+            for (const auto& [framework, count] : presetsPerFramework) {
+                logFile << (first ? "" : ", ") << framework << " " << count;
+                first = false;
+            }
+            logFile << std::endl;
+        }
+        
+        if (totalConflicting > 0) {
+            logFile << std::endl;
+            logFile << "WARNING: The following presets have both UBE and 3BA/3BBB/CBBE indicators:" << std::endl;
+            logFile << "All conflicting presets were added to blacklist." << std::endl;
+            logFile << "Presets with 'UBE' in name were also added to UBE races." << std::endl;
+            logFile << "Presets without 'UBE' in name were excluded from UBE races." << std::endl;
+            logFile << "You can manually add excluded presets via INI rules if needed." << std::endl;
+            logFile << std::endl;
+        }
+        
+        if (!excludedFromRacesXmlFiles.empty()) {
+            logFile << std::endl;
+            logFile << "XML FILES EXCLUDED FROM UBE RACES:" << std::endl;
+            logFile << "----------------------------------------------------" << std::endl;
+            logFile << "The following XML files contain UBE groups but were excluded from UBE races" << std::endl;
+            logFile << "because they also contain 3BA/3BBB/CBBE groups and don't have 'UBE' in the preset name." << std::endl;
+            logFile << "Please review these files to determine if they are intended for UBE." << std::endl;
+            logFile << std::endl;
+            
+            for (const auto& xmlFile : excludedFromRacesXmlFiles) {
+                logFile << "  - " << xmlFile << std::endl;
+            }
+            
+            logFile << std::endl;
+            logFile << "If any of these presets should be included in UBE races, you can:" << std::endl;
+            logFile << "  1. Rename the preset name inside XML to include 'UBE'" << std::endl;
+            logFile << "  2. Manually add them using INI rules in OBodyNG_PDA_*.ini files" << std::endl;
+            logFile << "  3. Contact the preset author to clarify the intended body type" << std::endl;
+            logFile << std::endl;
+        }
+        
+        logFile << std::endl;
+        
+    } catch (const std::exception& e) {
+        logFile << "ERROR scanning BodySlide presets: " << e.what() << std::endl;
+    } catch (...) {
+        logFile << "ERROR scanning BodySlide presets: Unknown exception" << std::endl;
+    }
+    
+    return {allUBEPresetsForBlacklist, ubePresetsInfo};
+}
+
+bool ApplyUBEPresetsToJson(std::map<std::string, OrderedPluginData>& processedData,
+                           const std::vector<std::string>& allPresetsForBlacklist,
+                           const std::vector<UBEPresetInfo>& presetsForRaces,
+                           std::ostream& logFile) {
+    if (allPresetsForBlacklist.empty()) {
+        logFile << "No UBE presets to apply (none found)" << std::endl;
+        return false;
+    }
+    
+    try {
+        logFile << "Applying UBE presets to JSON..." << std::endl;
+        logFile << "----------------------------------------------------" << std::endl;
+        
+        int presetsAddedToBlacklist = 0;
+        int racesCreatedOrUpdated = 0;
+        int totalPresetsAddedToRaces = 0;
+        int excludedPresetsCount = 0;
+        
+        auto& blacklistData = processedData["blacklistedPresetsFromRandomDistribution"];
+        
+        for (const auto& presetName : allPresetsForBlacklist) {
+            NameId presetId = InternName(presetName);
+            bool alreadyExists = false;
+            for (const auto& [plugin, presets] : blacklistData.orderedData) {
+                if (std::find(presets.begin(), presets.end(), presetId) != presets.end()) {
+                    alreadyExists = true;
+                    break;
+                }
+            }
+            
+            if (!alreadyExists) {
+                blacklistData.addPreset(InternName(""), presetId);
+                presetsAddedToBlacklist++;
+                logFile << "  Added to blacklist: " << presetName << std::endl;
+            }
+        }
+        
+        auto& raceFemaleData = processedData["raceFemale"];
+        
+        for (const auto& ubeRace : UBE_RACES) {
+            NameId raceId = InternName(ubeRace);
+            bool raceWasCreated = !raceFemaleData.hasPlugin(ubeRace);
+            int presetsAddedToThisRace = 0;
+            
+            for (const auto& presetInfo : presetsForRaces) {
+                if (!presetInfo.allowedInRaces) {
+                    continue;
+                }
+                
+                const std::string& presetName = presetInfo.presetName;
+                
+                bool isExcluded = std::find(EXCLUDED_FROM_UBE_RACES.begin(), EXCLUDED_FROM_UBE_RACES.end(), 
+                                           presetName) != EXCLUDED_FROM_UBE_RACES.end();
+                
+                if (isExcluded) {
+                    if (raceWasCreated && presetsAddedToThisRace == 0) {
+                        excludedPresetsCount++;
+                    }
+                    continue;
+                }
+                
+                NameId presetId = InternName(presetName);
+                bool presetExists = false;
+                for (const auto& [race, presets] : raceFemaleData.orderedData) {
+                    if (race == raceId) {
+                        if (std::find(presets.begin(), presets.end(), presetId) != presets.end()) {
+                            presetExists = true;
+                            break;
+                        }
+                    }
+                }
+                
+                if (!presetExists) {
+                    raceFemaleData.addPreset(raceId, presetId);
+                    presetsAddedToThisRace++;
+                    totalPresetsAddedToRaces++;
+                }
+            }
+            
+            if (raceWasCreated && presetsAddedToThisRace > 0) {
+                racesCreatedOrUpdated++;
+                logFile << "  Created race: " << ubeRace << " with " << presetsAddedToThisRace << " presets"
+                        << std::endl;
+            } else if (presetsAddedToThisRace > 0) {
+                logFile << "  Updated race: " << ubeRace << " (+" << presetsAddedToThisRace << " presets)"
+                        << std::endl;
+            }
+        }
+        
+        logFile << std::endl;
+        logFile << "UBE Application Summary:" << std::endl;
+        logFile << "  Presets added to blacklist: " << presetsAddedToBlacklist << std::endl;
+        logFile << "  UBE races created/updated: " << racesCreatedOrUpdated << std::endl;
+        logFile << "  Total presets added to races: " << totalPresetsAddedToRaces << std::endl;
+        if (excludedPresetsCount > 0) {
+            logFile << "  Presets excluded from UBE races (Zeroed Sliders variants): " 
+                    << excludedPresetsCount << std::endl;
+        }
+        logFile << std::endl;
+        
+        return (presetsAddedToBlacklist > 0 || totalPresetsAddedToRaces > 0);
+        
+    } catch (const std::exception& e) {
+        logFile << "ERROR in ApplyUBEPresetsToJson: " << e.what() << std::endl;
+        return false;
+    } catch (...) {
+        logFile << "ERROR in ApplyUBEPresetsToJson: Unknown exception" << std::endl;
+        return false;
+    }
+}
+
+
+// ===== JSON INDENTATION CORRECTION =====
+
+bool CorrectJsonIndentation(const fs::path& jsonPath, const fs::path& analysisDir, std::ostream& logFile) {
+    try {
+        logFile << "Checking and correcting JSON indentation hierarchy..." << std::endl;
+        logFile << "----------------------------------------------------" << std::endl;
+
+        if (!fs::exists(jsonPath)) {
+            logFile << "ERROR: JSON file does not exist for indentation correction" << std::endl;
+            return false;
+        }
+
+        std::string originalContent = ReadFileWithEncoding(jsonPath);
+        if (originalContent.empty()) {
+            logFile << "ERROR: JSON file is empty for indentation correction" << std::endl;
+            return false;
+        }
+
+        bool needsCorrection = false;
+        std::vector<std::string> lines;
+        std::stringstream ss(originalContent);
+        std::string line;
+
+        while (std::getline(ss, line)) {
+            lines.push_back(line);
+        }
+
+        for (const auto& currentLine : lines) {
+            if (currentLine.empty()) continue;
+            if (currentLine.find_first_not_of(" \t") == std::string::npos) continue;
+
+            size_t leadingSpaces = 0;
+            size_t leadingTabs = 0;
+            for (char c : currentLine) {
+                if (c == ' ')
+                    leadingSpaces++;
+                else if (c == '\t')
+                    leadingTabs++;
+                else
+                    break;
+            }
+
+            if (leadingTabs > 0 || (leadingSpaces > 0 && leadingSpaces % 4 != 0)) {
+                needsCorrection = true;
+                break;
+            }
+        }
+
+        if (!needsCorrection) {
+            for (size_t i = 0; i < lines.size() - 1; i++) {
+                std::string currentTrimmed = Trim(lines[i]);
+
+                if (EndsWith(currentTrimmed, "{") || EndsWith(currentTrimmed, "[")) {
+                    char openChar = currentTrimmed.back();
+                    char closeChar = (openChar == '{') ? '}' : ']';
+
+                    for (size_t j = i + 1; j < lines.size(); j++) {
+                        std::string nextTrimmed = Trim(lines[j]);
+
+                        if (nextTrimmed == std::string(1, closeChar) ||
+                            nextTrimmed == std::string(1, closeChar) + ",") {
+                            bool hasOnlyWhitespace = true;
+                            for (size_t k = i + 1; k < j; k++) {
+                                if (!Trim(lines[k]).empty()) {
+                                    hasOnlyWhitespace = false;
+                                    break;
+                                }
+                            }
+
+                            if (hasOnlyWhitespace) {
+                                needsCorrection = true;
+                                logFile << "DETECTED: Multi-line empty container found at lines " << (i + 1) << "-"
+                                        << (j + 1) << ", needs inline correction" << std::endl;
+                                break;
+                            }
+                        }
+
+                        if (!nextTrimmed.empty() && nextTrimmed != std::string(1, closeChar) &&
+                            nextTrimmed != std::string(1, closeChar) + ",") {
+                            break;
+                        }
+                    }
+
+                    if (needsCorrection) break;
+                }
+            }
+        }
+
+        if (!needsCorrection) {
+            logFile << "SUCCESS: JSON indentation is already correct (perfect 4-space hierarchy with inline empty "
+                       "containers)"
+                    << std::endl;
+            logFile << std::endl;
+            return true;
+        }
+
+        logFile << "DETECTED: JSON indentation needs correction - reformatting entire file with perfect 4-space "
+                   "hierarchy and inline empty containers..."
+                << std::endl;
+
+        std::ostringstream correctedJson;
+        int indentLevel = 0;
+        bool inString = false;
+        bool escape = false;
+
+        auto isEmptyBlock = [&originalContent](size_t startPos, char openChar, char closeChar) -> bool {
+            size_t pos = startPos + 1;
+            int depth = 1;
+            bool inStr = false;
+            bool esc = false;
+
+            while (pos < originalContent.length() && depth > 0) {
+                char c = originalContent[pos];
+
+                if (esc) {
+                    esc = false;
+                    pos++;
+                    continue;
+                }
+
+                if (c == '\\' && inStr) {
+                    esc = true;
+                    pos++;
+                    continue;
+                }
+
+                if (c == '"') {
+                    inStr = !inStr;
+                } else if (!inStr) {
+                    if (c == openChar) {
+                        depth++;
+                    } else if (c == closeChar) {
+                        depth--;
+                        if (depth == 0) {
+                            std::string between = originalContent.substr(startPos + 1, pos - startPos - 1);
+                            std::string trimmedBetween = Trim(between);
+                            return trimmedBetween.empty();
+                        }
+                    }
+                }
+                pos++;
+            }
+            return false;
+        };
+
+        for (size_t i = 0; i < originalContent.length(); i++) {
+            char c = originalContent[i];
+
+            if (escape) {
+                correctedJson << c;
+                escape = false;
+                continue;
+            }
+
+            if (c == '\\' && inString) {
+                correctedJson << c;
+                escape = true;
+                continue;
+            }
+
+            if (c == '"' && !escape) {
+                inString = !inString;
+                correctedJson << c;
+                continue;
+            }
+
+            if (inString) {
+                correctedJson << c;
+                continue;
+            }
+
+            switch (c) {
+                case '{':
+                case '[':
+                    if (isEmptyBlock(i, c, (c == '{') ? '}' : ']')) {
+                        size_t pos = i + 1;
+                        int depth = 1;
+                        bool inStr = false;
+                        bool esc = false;
+
+                        while (pos < originalContent.length() && depth > 0) {
+                            char nextChar = originalContent[pos];
+
+                            if (esc) {
+                                esc = false;
+                                pos++;
+                                continue;
+                            }
+
+                            if (nextChar == '\\' && inStr) {
+                                esc = true;
+                                pos++;
+                                continue;
+                            }
+
+                            if (nextChar == '"') {
+                                inStr = !inStr;
+                            } else if (!inStr) {
+                                if (nextChar == c) {
+                                    depth++;
+                                } else if (nextChar == ((c == '{') ? '}' : ']')) {
+                                    depth--;
+                                }
+                            }
+                            pos++;
+                        }
+
+                        correctedJson << c << ((c == '{') ? '}' : ']');
+                        i = pos - 1;
+
+                        if (i + 1 < originalContent.length()) {
+                            size_t nextNonSpace = i + 1;
+                            while (nextNonSpace < originalContent.length() &&
+                                   std::isspace(static_cast<unsigned char>(originalContent[nextNonSpace]))) {
+                                nextNonSpace++;
+                            }
+
+                            if (nextNonSpace < originalContent.length() && originalContent[nextNonSpace] != ',' &&
+                                originalContent[nextNonSpace] != '}' && originalContent[nextNonSpace] != ']') {
+                                correctedJson << '\n';
+                                for (int j = 0; j < indentLevel * 4; j++) {
+                                    correctedJson << ' ';
+                                }
+                            }
+                        }
+                    } else {
+                        correctedJson << c << '\n';
+                        indentLevel++;
+                        for (int j = 0; j < indentLevel * 4; j++) {
+                            correctedJson << ' ';
+                        }
+                    }
+                    break;
+
+                case '}':
+                case ']':
+                    correctedJson << '\n';
+                    indentLevel--;
+                    for (int j = 0; j < indentLevel * 4; j++) {
+                        correctedJson << ' ';
+                    }
+                    correctedJson << c;
+
+                    if (i + 1 < originalContent.length()) {
+                        size_t nextNonSpace = i + 1;
+                        while (nextNonSpace < originalContent.length() && std::isspace(static_cast<unsigned char>(originalContent[nextNonSpace]))) {
+                            nextNonSpace++;
+                        }
+
+                        if (nextNonSpace < originalContent.length() && originalContent[nextNonSpace] != ',' &&
+                            originalContent[nextNonSpace] != '}' && originalContent[nextNonSpace] != ']') {
+                            correctedJson << '\n';
+                            for (int j = 0; j < indentLevel * 4; j++) {
+                                correctedJson << ' ';
+                            }
+                        }
+                    }
+                    break;
+
+                case ',':
+                    correctedJson << c << '\n';
+                    for (int j = 0; j < indentLevel * 4; j++) {
+                        correctedJson << ' ';
+                    }
+                    break;
+
+                case ':':
+                    correctedJson << c << ' ';
+                    break;
+
+                case ' ':
+                case '\t':
+                case '\n':
+                case '\r':
+                    break;
+
+                default:
+                    correctedJson << c;
+                    break;
+            }
+        }
+
+        std::string correctedContent = correctedJson.str();
+
+        std::vector<std::string> finalLines;
+        std::stringstream finalSS(correctedContent);
+        std::string finalLine;
+
+        while (std::getline(finalSS, finalLine)) {
+            while (!finalLine.empty() && finalLine.back() == ' ') {
+                finalLine.pop_back();
+            }
+            finalLines.push_back(finalLine);
+        }
+
+        std::ostringstream finalJson;
+        for (size_t i = 0; i < finalLines.size(); i++) {
+            finalJson << finalLines[i];
+            if (i < finalLines.size() - 1) {
+                finalJson << '\n';
+            }
+        }
+
+        std::string finalContent = finalJson.str();
+
+        fs::path tempPath = jsonPath;
+        tempPath.replace_extension(".indent_corrected.tmp");
+
+        std::ofstream tempFile(tempPath, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!tempFile.is_open()) {
+            logFile << "ERROR: Could not create temporary file for indentation correction" << std::endl;
+            return false;
+        }
+
+        tempFile << finalContent;
+        RecordStreamWritten(tempFile);
+        tempFile.close();
+
+        if (tempFile.fail()) {
+            logFile << "ERROR: Failed to write corrected JSON to temporary file" << std::endl;
+            return false;
+        }
+
+        if (!PerformTripleValidation(tempPath, fs::path(), logFile)) {
+            logFile << "ERROR: Corrected JSON failed integrity check" << std::endl;
+            MoveCorruptedJsonToAnalysis(tempPath, analysisDir, logFile);
+            try {
+                fs::remove(tempPath);
+            } catch (...) {
             }
-            
-            helperLog << "----------------------------------------------------" << std::endl;
-            helperLog << "AVAILABLE RACES (including vampire variants)" << std::endl;
-            helperLog << "----------------------------------------------------" << std::endl;
-            helperLog << std::endl;
-            
-            const std::vector<std::string> allRaces = {
-                "NordRace", "ImperialRace", "BretonRace", "RedguardRace", "DarkElfRace",
-                "HighElfRace", "WoodElfRace", "OrcRace", "KhajiitRace", "ArgonianRace", "ElderRace",
-                "NordRaceVampire", "ImperialRaceVampire", "BretonRaceVampire", "RedguardRaceVampire",
-                "DarkElfRaceVampire", "HighElfRaceVampire", "WoodElfRaceVampire", "OrcRaceVampire",
-                "KhajiitRaceVampire", "ArgonianRaceVampire", "ElderRaceVampire"
-            };
-            
-            for (const auto& race : allRaces) {
-                helperLog << race << std::endl;
+            return false;
+        }
+
+        std::error_code ec;
+        fs::rename(tempPath, jsonPath, ec);
+
+        if (ec) {
+            logFile << "ERROR: Failed to replace original with corrected JSON: " << ec.message() << std::endl;
+            try {
+                fs::remove(tempPath);
+            } catch (...) {
             }
-            
-            helperLog << std::endl;
-        } else {
-            helperLog << "Not enough presets installed to generate examples." << std::endl;
-            helperLog << "Install more BodySlide presets and run again." << std::endl;
-            helperLog << std::endl;
+            return false;
         }
-        
-        helperLog << "----------------------------------------------------" << std::endl;
-        helperLog << "FINAL NOTES" << std::endl;
-        helperLog << "----------------------------------------------------" << std::endl;
-        helperLog << std::endl;
-        helperLog << "As you can see, it's not complicated and you can leave those rules in an INI file," << std::endl;
-        helperLog << "and the mod will read and preset them automatically." << std::endl;
-        helperLog << std::endl;
-        helperLog << "If you have UBE presets, the mod automatically places them in the blacklist to avoid errors," << std::endl;
-        helperLog << "and you can distribute them wherever you want. It also distributes them to all UBE NPCs randomly," << std::endl;
-        helperLog << "but you can use npcPluginFemale to apply UBE to particular NPCs." << std::endl;
-        helperLog << "You can also use FormIDs or NPC names, but the plugin method never fails." << std::endl;
-        helperLog << std::endl;
-        helperLog << "Remember when creating an INI, it must follow this format:" << std::endl;
-        helperLog << "OBodyNG_PDA_(mod_name).ini" << std::endl;
-        helperLog << std::endl;
-        helperLog << "When choosing a unique name for your INI, you can use the examples provided with the mod" << std::endl;
-        helperLog << "to avoid creating one from scratch. The name must use underscores (_) as separators" << std::endl;
-        helperLog << "to ensure proper search functionality." << std::endl;
-        helperLog << std::endl;
-        helperLog << "That's it! Thank you for using my mod, and I hope it serves you well. Good luck!" << std::endl;
-        helperLog << std::endl;
-        helperLog << "====================================================" << std::endl;
-        
-        helperLog.close();
-        
-        if (helperLog.fail()) {
-            mainLogFile << "ERROR: Failed to write Helper Log file" << std::endl;
+
+        if (PerformTripleValidation(jsonPath, fs::path(), logFile)) {
+            logFile << "SUCCESS: JSON indentation corrected successfully" << std::endl;
+            logFile << " Applied perfect 4-space hierarchy with inline empty containers (including multi-line empty "
+                       "detection)"
+                    << std::endl;
+            logFile << std::endl;
+            return true;
         } else {
-            mainLogFile << "SUCCESS: Helper Log created successfully at: " << logHelperPath.string() << std::endl;
+            logFile << "ERROR: Final corrected JSON failed integrity check" << std::endl;
+            return false;
         }
-        
+
     } catch (const std::exception& e) {
-        mainLogFile << "ERROR in GenerateHelperLog: " << e.what() << std::endl;
+        logFile << "ERROR in CorrectJsonIndentation: " << e.what() << std::endl;
+        return false;
     } catch (...) {
-        mainLogFile << "ERROR in GenerateHelperLog: Unknown exception" << std::endl;
+        logFile << "ERROR in CorrectJsonIndentation: Unknown exception" << std::endl;
+        return false;
     }
 }
 
-// ===== IMPROVED UBE XML PROCESSING FUNCTIONS =====
+// ===== JSON PARSING FUNCTIONS =====
 
-struct XmlAnalysisResult {
-    bool hasUBE = false;
-    bool hasConflictingGroups = false;
-    std::vector<std::string> conflictingGroupsFound;
-};
+std::vector<std::pair<std::string, std::vector<std::string>>> parseOrderedPlugins(const std::string& content) {
+    std::vector<std::pair<std::string, std::vector<std::string>>> result;
+    if (content.empty()) return result;
+
+    const char* str = content.c_str();
+    size_t len = content.length();
+    size_t pos = 0;
+    const size_t maxIters = 100000;
+    size_t iter = 0;
+
+    result.reserve(200);
 
-XmlAnalysisResult AnalyzeXmlGroups(const fs::path& xmlPath, std::ofstream& logFile) {
-    XmlAnalysisResult result;
-    
     try {
-        if (!fs::exists(xmlPath)) return result;
-        
-        std::string content = ReadFileWithEncoding(xmlPath);
-        if (content.empty()) return result;
-        
-        std::string lowerContent = content;
-        std::transform(lowerContent.begin(), lowerContent.end(), lowerContent.begin(), ::tolower);
-        
-        if (lowerContent.find("<group name=\"ube\"") != std::string::npos ||
-            lowerContent.find("<group name='ube'") != std::string::npos) {
-            result.hasUBE = true;
-        }
-        
-        const std::vector<std::string> conflictingPatterns = {
-            "3ba", "3bbb", "cbbe"
-        };
-        
-        size_t pos = 0;
-        while (pos < lowerContent.length()) {
-            size_t groupStart = lowerContent.find("<group name=", pos);
-            if (groupStart == std::string::npos) break;
-            
-            size_t nameStart = lowerContent.find_first_of("\"'", groupStart);
-            if (nameStart == std::string::npos) break;
-            
-            char quoteChar = lowerContent[nameStart];
-            size_t nameEnd = lowerContent.find(quoteChar, nameStart + 1);
-            if (nameEnd == std::string::npos) break;
-            
-            std::string groupName = lowerContent.substr(nameStart + 1, nameEnd - nameStart - 1);
-            
-            for (const auto& pattern : conflictingPatterns) {
-                if (groupName.find(pattern) != std::string::npos) {
-                    result.hasConflictingGroups = true;
-                    std::string originalGroupName = content.substr(nameStart + 1, nameEnd - nameStart - 1);
-                    if (std::find(result.conflictingGroupsFound.begin(), result.conflictingGroupsFound.end(), 
-                                 originalGroupName) == result.conflictingGroupsFound.end()) {
-                        result.conflictingGroupsFound.push_back(originalGroupName);
+        while (pos < len && iter++ < maxIters) {
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos >= len) break;
+
+            if (str[pos] != '"') {
+                ++pos;
+                continue;
+            }
+
+            size_t keyStart = pos + 1;
+            ++pos;
+
+            while (pos < len) {
+                if (str[pos] == '"') {
+                    size_t backslashCount = 0;
+                    size_t checkPos = pos - 1;
+                    while (checkPos > 0 && str[checkPos] == '\\') {
+                        backslashCount++;
+                        checkPos--;
                     }
-                    break;
+                    if (backslashCount % 2 == 0) break;
                 }
+                ++pos;
             }
-            
-            pos = nameEnd + 1;
-        }
-        
-        return result;
-        
-    } catch (...) {
-        logFile << "ERROR analyzing XML groups: " << xmlPath.string() << std::endl;
-        return result;
-    }
-}
 
-struct UBEPresetInfo {
-    std::string presetName;
-    bool allowedInRaces;
-    bool hasConflict;
-    std::vector<std::string> conflictingGroups;
-};
+            if (pos >= len) break;
 
-std::pair<std::vector<std::string>, std::vector<UBEPresetInfo>> ProcessUBEXmlPresets(
-    const fs::path& bodySlidePresetsPath, std::ofstream& logFile) {
-    
-    std::vector<std::string> allUBEPresetsForBlacklist;
-    std::vector<UBEPresetInfo> ubePresetsInfo;
-    std::vector<std::string> excludedFromRacesXmlFiles;
-    
-    try {
-        if (!fs::exists(bodySlidePresetsPath)) {
-            logFile << "WARNING: BodySlide presets folder not found: " << bodySlidePresetsPath.string() << std::endl;
-            return {allUBEPresetsForBlacklist, ubePresetsInfo};
-        }
-        
-        logFile << std::endl;
-        logFile << "Scanning for UBE XML presets..." << std::endl;
-        logFile << "----------------------------------------------------" << std::endl;
-        
-        int totalXmlScanned = 0;
-        int totalUbeFound = 0;
-        int totalConflicting = 0;
-        int conflictingButNameHasUBE = 0;
-        
-        for (const auto& entry : fs::directory_iterator(bodySlidePresetsPath)) {
-            try {
-                if (entry.is_regular_file()) {
-                    std::string filename;
-                    try {
-                        auto u8name = entry.path().filename().u8string();
-                        filename = std::string(u8name.begin(), u8name.end());
-                    } catch (...) {
-                        try {
-                            filename = entry.path().filename().string();
-                        } catch (...) {
-                            continue;
-                        }
-                    }
+            std::string plugin = content.substr(keyStart, pos - keyStart);
+            ++pos;
 
-                    if (EndsWith(filename, ".xml")) {
-                        totalXmlScanned++;
-                        
-                        try {
-                            XmlAnalysisResult analysis = AnalyzeXmlGroups(entry.path(), logFile);
-                            
-                            if (analysis.hasUBE) {
-                                std::string presetName = ExtractPresetNameFromXml(entry.path(), logFile);
-                                
-                                if (presetName.empty()) {
-                                    logFile << "  WARNING: Could not extract preset name from: " << filename << std::endl;
-                                    continue;
-                                }
-                                
-                                std::string lowerPresetName = presetName;
-                                std::transform(lowerPresetName.begin(), lowerPresetName.end(), 
-                                             lowerPresetName.begin(), ::tolower);
-                                bool filenameContainsUBE = (lowerPresetName.find("ube") != std::string::npos);
-                                
-                                if (analysis.hasConflictingGroups) {
-                                    totalConflicting++;
-                                    
-                                    UBEPresetInfo info;
-                                    info.presetName = presetName;
-                                    info.hasConflict = true;
-                                    info.conflictingGroups = analysis.conflictingGroupsFound;
-                                    info.allowedInRaces = filenameContainsUBE;
-                                    
-                                    allUBEPresetsForBlacklist.push_back(presetName);
-                                    
-                                    if (filenameContainsUBE) {
-                                        ubePresetsInfo.push_back(info);
-                                        conflictingButNameHasUBE++;
-                                        logFile << "  CONFLICT DETECTED (preset name has UBE, added to races): " << presetName << " (" << filename << ")" << std::endl;
-                                    } else {
-                                        excludedFromRacesXmlFiles.push_back(filename);
-                                        logFile << "  CONFLICT DETECTED (excluded from races): " << presetName << " (" << filename << ")" << std::endl;
-                                    }
-                                    
-                                    logFile << "    Has UBE group but also contains: ";
-                                    for (size_t i = 0; i < analysis.conflictingGroupsFound.size(); i++) {
-                                        logFile << analysis.conflictingGroupsFound[i];
-                                        if (i < analysis.conflictingGroupsFound.size() - 1) {
-                                            logFile << ", ";
-                                        }
-                                    }
-                                    logFile << std::endl;
-                                } else {
-                                    UBEPresetInfo info;
-                                    info.presetName = presetName;
-                                    info.hasConflict = false;
-                                    info.allowedInRaces = true;
-                                    
-                                    allUBEPresetsForBlacklist.push_back(presetName);
-                                    ubePresetsInfo.push_back(info);
-                                    totalUbeFound++;
-                                    logFile << "  Found UBE preset: " << presetName << " (" << filename << ")" << std::endl;
-                                }
-                            }
-                        } catch (const std::exception& e) {
-                            logFile << "  [ERROR] Exception processing UBE in " << filename << ": " << e.what() << std::endl;
-                        } catch (...) {
-                            logFile << "  [ERROR] Unknown exception processing UBE in " << filename << std::endl;
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos >= len || str[pos] != ':') {
+                ++pos;
+                continue;
+            }
+
+            ++pos;
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos >= len || str[pos] != '[') {
+                ++pos;
+                continue;
+            }
+
+            ++pos;
+
+            std::vector<std::string> presets;
+            presets.reserve(50);
+            size_t presetIter = 0;
+
+            while (pos < len && presetIter++ < maxIters) {
+                while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+                if (pos >= len) break;
+
+                if (str[pos] == ']') {
+                    ++pos;
+                    break;
+                }
+
+                if (str[pos] != '"') {
+                    ++pos;
+                    continue;
+                }
+
+                size_t presetStart = pos + 1;
+                ++pos;
+
+                while (pos < len) {
+                    if (str[pos] == '"') {
+                        size_t backslashCount = 0;
+                        size_t checkPos = pos - 1;
+                        while (checkPos > 0 && str[checkPos] == '\\') {
+                            backslashCount++;
+                            checkPos--;
                         }
+                        if (backslashCount % 2 == 0) break;
                     }
+                    ++pos;
+                }
+
+                if (pos >= len) break;
+
+                std::string preset = content.substr(presetStart, pos - presetStart);
+                presets.push_back(std::move(preset));
+                ++pos;
+
+                while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+                if (pos < len && str[pos] == ',') {
+                    ++pos;
+                    while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
                 }
-            } catch (const std::exception& e) {
-                logFile << "  [ERROR] Exception in UBE directory iteration: " << e.what() << std::endl;
-                continue;
-            } catch (...) {
-                logFile << "  [ERROR] Unknown exception in UBE directory iteration" << std::endl;
-                continue;
             }
-        }
 
-        logFile << std::endl;
-        logFile << "UBE XML Scan Summary:" << std::endl;
-        logFile << "  Total XML files scanned: " << totalXmlScanned << std::endl;
-        logFile << "  Valid UBE presets found: " << totalUbeFound << std::endl;
-        logFile << "  Conflicting presets (UBE + 3BA/3BBB/CBBE): " << totalConflicting << std::endl;
-        logFile << "  Conflicting but preset name has UBE (added to races): " << conflictingButNameHasUBE << std::endl;
-        logFile << "  Total presets for blacklist: " << allUBEPresetsForBlacklist.size() << std::endl;
-        logFile << "  Total presets for UBE races: " << ubePresetsInfo.size() << std::endl;
-        
-        if (totalConflicting > 0) {
-            logFile << std::endl;
-            logFile << "WARNING: The following presets have both UBE and 3BA/3BBB/CBBE indicators:" << std::endl;
-            logFile << "All conflicting presets were added to blacklist." << std::endl;
-            logFile << "Presets with 'UBE' in name were also added to UBE races." << std::endl;
-            logFile << "Presets without 'UBE' in name were excluded from UBE races." << std::endl;
-            logFile << "You can manually add excluded presets via INI rules if needed." << std::endl;
-            logFile << std::endl;
-        }
-        
-        if (!excludedFromRacesXmlFiles.empty()) {
-            logFile << std::endl;
-            logFile << "XML FILES EXCLUDED FROM UBE RACES:" << std::endl;
-            logFile << "----------------------------------------------------" << std::endl;
-            logFile << "The following XML files contain UBE groups but were excluded from UBE races" << std::endl;
-            logFile << "because they also contain 3BA/3BBB/CBBE groups and don't have 'UBE' in the preset name." << std::endl;
-            logFile << "Please review these files to determine if they are intended for UBE." << std::endl;
-            logFile << std::endl;
-            
-            for (const auto& xmlFile : excludedFromRacesXmlFiles) {
-                logFile << "  - " << xmlFile << std::endl;
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos < len && str[pos] == ',') ++pos;
+
+            if (!plugin.empty()) {
+                result.emplace_back(std::move(plugin), std::move(presets));
             }
-            
-            logFile << std::endl;
-            logFile << "If any of these presets should be included in UBE races, you can:" << std::endl;
-            logFile << "  1. Rename the preset name inside XML to include 'UBE'" << std::endl;
-            logFile << "  2. Manually add them using INI rules in OBodyNG_PDA_*.ini files" << std::endl;
-            logFile << "  3. Contact the preset author to clarify the intended body type" << std::endl;
-            logFile << std::endl;
         }
-        
-        logFile << std::endl;
-        
-    } catch (const std::exception& e) {
-        logFile << "ERROR scanning BodySlide presets: " << e.what() << std::endl;
     } catch (...) {
-        logFile << "ERROR scanning BodySlide presets: Unknown exception" << std::endl;
     }
-    
-    return {allUBEPresetsForBlacklist, ubePresetsInfo};
+
+    return result;
 }
 
-bool ApplyUBEPresetsToJson(std::map<std::string, OrderedPluginData>& processedData,
-                           const std::vector<std::string>& allPresetsForBlacklist,
-                           const std::vector<UBEPresetInfo>& presetsForRaces,
-                           std::ofstream& logFile) {
-    if (allPresetsForBlacklist.empty()) {
-        logFile << "No UBE presets to apply (none found)" << std::endl;
-        return false;
-    }
-    
+std::vector<std::string> parseArray(const std::string& content) {
+    std::vector<std::string> result;
+    if (content.empty()) return result;
+
+    const char* str = content.c_str();
+    size_t len = content.length();
+    size_t pos = 0;
+    const size_t maxIters = 100000;
+    size_t iter = 0;
+
+    result.reserve(100);
+
     try {
-        logFile << "Applying UBE presets to JSON..." << std::endl;
-        logFile << "----------------------------------------------------" << std::endl;
-        
-        int presetsAddedToBlacklist = 0;
-        int racesCreatedOrUpdated = 0;
-        int totalPresetsAddedToRaces = 0;
-        int excludedPresetsCount = 0;
-        
-        auto& blacklistData = processedData["blacklistedPresetsFromRandomDistribution"];
-        
-        for (const auto& presetName : allPresetsForBlacklist) {
-            bool alreadyExists = false;
-            for (const auto& [plugin, presets] : blacklistData.orderedData) {
-                if (std::find(presets.begin(), presets.end(), presetName) != presets.end()) {
-                    alreadyExists = true;
-                    break;
-                }
-            }
-            
-            if (!alreadyExists) {
-                blacklistData.addPreset("", presetName);
-                presetsAddedToBlacklist++;
-                logFile << "  Added to blacklist: " << presetName << std::endl;
+        while (pos < len && iter++ < maxIters) {
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos >= len) break;
+
+            if (str[pos] == ']') break;
+
+            if (str[pos] != '"') {
+                ++pos;
+                continue;
             }
-        }
-        
-        auto& raceFemaleData = processedData["raceFemale"];
-        
-        for (const auto& ubeRace : UBE_RACES) {
-            bool raceWasCreated = !raceFemaleData.hasPlugin(ubeRace);
-            int presetsAddedToThisRace = 0;
-            
-            for (const auto& presetInfo : presetsForRaces) {
-                if (!presetInfo.allowedInRaces) {
-                    continue;
-                }
-                
-                const std::string& presetName = presetInfo.presetName;
-                
-                bool isExcluded = std::find(EXCLUDED_FROM_UBE_RACES.begin(), EXCLUDED_FROM_UBE_RACES.end(), 
-                                           presetName) != EXCLUDED_FROM_UBE_RACES.end();
-                
-                if (isExcluded) {
-                    if (raceWasCreated && presetsAddedToThisRace == 0) {
-                        excludedPresetsCount++;
-                    }
-                    continue;
-                }
-                
-                bool presetExists = false;
-                for (const auto& [race, presets] : raceFemaleData.orderedData) {
-                    if (race == ubeRace) {
-                        if (std::find(presets.begin(), presets.end(), presetName) != presets.end()) {
-                            presetExists = true;
-                            break;
-                        }
+
+            size_t valueStart = pos + 1;
+            ++pos;
+
+            while (pos < len) {
+                if (str[pos] == '"') {
+                    size_t backslashCount = 0;
+                    size_t checkPos = pos - 1;
+                    while (checkPos > 0 && str[checkPos] == '\\') {
+                        backslashCount++;
+                        checkPos--;
                     }
+                    if (backslashCount % 2 == 0) break;
                 }
-                
-                if (!presetExists) {
-                    raceFemaleData.addPreset(ubeRace, presetName);
-                    presetsAddedToThisRace++;
-                    totalPresetsAddedToRaces++;
-                }
-            }
-            
-            if (raceWasCreated && presetsAddedToThisRace > 0) {
-                racesCreatedOrUpdated++;
-                logFile << "  Created race: " << ubeRace << " with " << presetsAddedToThisRace << " presets"
-                        << std::endl;
-            } else if (presetsAddedToThisRace > 0) {
-                logFile << "  Updated race: " << ubeRace << " (+" << presetsAddedToThisRace << " presets)"
-                        << std::endl;
+                ++pos;
             }
+
+            if (pos >= len) break;
+
+            std::string value = content.substr(valueStart, pos - valueStart);
+            result.push_back(std::move(value));
+            ++pos;
+
+            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
+            if (pos < len && str[pos] == ',') ++pos;
         }
-        
-        logFile << std::endl;
-        logFile << "UBE Application Summary:" << std::endl;
-        logFile << "  Presets added to blacklist: " << presetsAddedToBlacklist << std::endl;
-        logFile << "  UBE races created/updated: " << racesCreatedOrUpdated << std::endl;
-        logFile << "  Total presets added to races: " << totalPresetsAddedToRaces << std::endl;
-        if (excludedPresetsCount > 0) {
-            logFile << "  Presets excluded from UBE races (Zeroed Sliders variants): " 
-                    << excludedPresetsCount << std::endl;
-        }
-        logFile << std::endl;
-        
-        return (presetsAddedToBlacklist > 0 || totalPresetsAddedToRaces > 0);
-        
-    } catch (const std::exception& e) {
-        logFile << "ERROR in ApplyUBEPresetsToJson: " << e.what() << std::endl;
-        return false;
     } catch (...) {
-        logFile << "ERROR in ApplyUBEPresetsToJson: Unknown exception" << std::endl;
-        return false;
     }
+
+    return result;
+}
+
+bool parseBooleanValue(const std::string& content) {
+    std::string trimmed = Trim(content);
+    std::transform(trimmed.begin(), trimmed.end(), trimmed.begin(), ::tolower);
+    return (trimmed == "true");
 }
 
+// ===== JSON PRESERVE AND UPDATE FUNCTIONS =====
+
+std::string PreserveOriginalSections(const std::string& originalJson,
+                                      const std::map<std::string, OrderedPluginData>& processedData,
+                                      bool currentBlacklistedPresetsShowValue,
+                                      bool newBlacklistedPresetsShowValue,
+                                      std::ostream& logFile) {
+    try {
+        const std::set<std::string> validKeys = {"npcFormID",       "npc",           "factionFemale", "factionMale",
+                                                  "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+
+        const std::set<std::string> arrayKeys = {"blacklistedPresetsFromRandomDistribution", "blacklistedNpcs",
+                                                  "blacklistedNpcsPluginFemale", "blacklistedNpcsPluginMale",
+                                                  "blacklistedRacesFemale", "blacklistedRacesMale",
+                                                  "blacklistedOutfitsFromORefit", "blacklistedOutfitsFromORefitPlugin",
+                                                  "outfitsForceRefit"};
+
+        std::string result = originalJson;
+
+        for (const auto& [key, data] : processedData) {
+            if (validKeys.count(key) && !data.orderedData.empty()) {
+                std::string keyPattern = "\"" + key + "\"";
+                size_t keyPos = result.find(keyPattern);
+
+                if (keyPos != std::string::npos) {
+                    size_t colonPos = result.find(":", keyPos);
+                    if (colonPos != std::string::npos) {
+                        size_t valueStart = colonPos + 1;
+
+                        while (valueStart < result.length() && std::isspace(static_cast<unsigned char>(result[valueStart]))) {
+                            valueStart++;
+                        }
+
+                        size_t valueEnd = valueStart;
+                        if (valueStart < result.length() && result[valueStart] == '{') {
+                            int braceCount = 1;
+                            valueEnd = valueStart + 1;
+                            bool inString = false;
+                            bool escape = false;
+
+                            while (valueEnd < result.length() && braceCount > 0) {
+                                char c = result[valueEnd];
+
+                                if (c == '"' && !escape) {
+                                    inString = !inString;
+                                } else if (!inString) {
+                                    if (c == '{')
+                                        braceCount++;
+                                    else if (c == '}')
+                                        braceCount--;
+                                }
+
+                                escape = (c == '\\' && !escape);
+                                valueEnd++;
+                            }
 
-// ===== JSON INDENTATION CORRECTION =====
+                            std::ostringstream newValue;
+                            newValue << "{\n";
 
-bool CorrectJsonIndentation(const fs::path& jsonPath, const fs::path& analysisDir, std::ofstream& logFile) {
-    try {
-        logFile << "Checking and correcting JSON indentation hierarchy..." << std::endl;
-        logFile << "----------------------------------------------------" << std::endl;
+                            bool first = true;
+                            for (const auto& [plugin, presets] : data.orderedData) {
+                                if (!first) newValue << ",\n";
+                                first = false;
 
-        if (!fs::exists(jsonPath)) {
-            logFile << "ERROR: JSON file does not exist for indentation correction" << std::endl;
-            return false;
-        }
+                                newValue << "        \"" << EscapeJson(NameView(plugin)) << "\": [\n";
 
-        std::string originalContent = ReadFileWithEncoding(jsonPath);
-        if (originalContent.empty()) {
-            logFile << "ERROR: JSON file is empty for indentation correction" << std::endl;
-            return false;
-        }
+                                bool firstPreset = true;
+                                for (const auto& preset : presets) {
+                                    if (!firstPreset) newValue << ",\n";
+                                    firstPreset = false;
 
-        bool needsCorrection = false;
-        std::vector<std::string> lines;
-        std::stringstream ss(originalContent);
-        std::string line;
+                                    newValue << "            \"" << EscapeJson(NameView(preset)) << "\"";
+                                }
 
-        while (std::getline(ss, line)) {
-            lines.push_back(line);
-        }
+                                newValue << "\n        ]";
+                            }
 
-        for (const auto& currentLine : lines) {
-            if (currentLine.empty()) continue;
-            if (currentLine.find_first_not_of(" \t") == std::string::npos) continue;
+                            newValue << "\n    }";
 
-            size_t leadingSpaces = 0;
-            size_t leadingTabs = 0;
-            for (char c : currentLine) {
-                if (c == ' ')
-                    leadingSpaces++;
-                else if (c == '\t')
-                    leadingTabs++;
-                else
-                    break;
-            }
+                            result.replace(valueStart, valueEnd - valueStart, newValue.str());
+                            logFile << "INFO: Successfully updated key '" << key << "' with proper 4-space indentation"
+                                    << std::endl;
+                        }
+                    }
+                }
+            } else if (arrayKeys.count(key) && !data.orderedData.empty()) {
+                std::string keyPattern = "\"" + key + "\"";
+                size_t keyPos = result.find(keyPattern);
 
-            if (leadingTabs > 0 || (leadingSpaces > 0 && leadingSpaces % 4 != 0)) {
-                needsCorrection = true;
-                break;
-            }
-        }
+                if (keyPos != std::string::npos) {
+                    size_t colonPos = result.find(":", keyPos);
+                    if (colonPos != std::string::npos) {
+                        size_t valueStart = colonPos + 1;
 
-        if (!needsCorrection) {
-            for (size_t i = 0; i < lines.size() - 1; i++) {
-                std::string currentTrimmed = Trim(lines[i]);
+                        while (valueStart < result.length() && std::isspace(static_cast<unsigned char>(result[valueStart]))) {
+                            valueStart++;
+                        }
 
-                if (EndsWith(currentTrimmed, "{") || EndsWith(currentTrimmed, "[")) {
-                    char openChar = currentTrimmed.back();
-                    char closeChar = (openChar == '{') ? '}' : ']';
+                        size_t valueEnd = valueStart;
+                        if (valueStart < result.length() && result[valueStart] == '[') {
+                            int bracketCount = 1;
+                            valueEnd = valueStart + 1;
+                            bool inString = false;
+                            bool escape = false;
 
-                    for (size_t j = i + 1; j < lines.size(); j++) {
-                        std::string nextTrimmed = Trim(lines[j]);
+                            while (valueEnd < result.length() && bracketCount > 0) {
+                                char c = result[valueEnd];
 
-                        if (nextTrimmed == std::string(1, closeChar) ||
-                            nextTrimmed == std::string(1, closeChar) + ",") {
-                            bool hasOnlyWhitespace = true;
-                            for (size_t k = i + 1; k < j; k++) {
-                                if (!Trim(lines[k]).empty()) {
-                                    hasOnlyWhitespace = false;
-                                    break;
+                                if (c == '"' && !escape) {
+                                    inString = !inString;
+                                } else if (!inString) {
+                                    if (c == '[')
+                                        bracketCount++;
+                                    else if (c == ']')
+                                        bracketCount--;
                                 }
+
+                                escape = (c == '\\' && !escape);
+                                valueEnd++;
                             }
 
-                            if (hasOnlyWhitespace) {
-                                needsCorrection = true;
-                                logFile << "DETECTED: Multi-line empty container found at lines " << (i + 1) << "-"
-                                        << (j + 1) << ", needs inline correction" << std::endl;
-                                break;
+                            std::ostringstream newValue;
+                            newValue << "[\n";
+
+                            bool first = true;
+                            for (const auto& [plugin, presets] : data.orderedData) {
+                                for (const auto& preset : presets) {
+                                    if (!first) newValue << ",\n";
+                                    first = false;
+                                    newValue << "        \"" << EscapeJson(NameView(preset)) << "\"";
+                                }
                             }
-                        }
 
-                        if (!nextTrimmed.empty() && nextTrimmed != std::string(1, closeChar) &&
-                            nextTrimmed != std::string(1, closeChar) + ",") {
-                            break;
+                            newValue << "\n    ]";
+
+                            result.replace(valueStart, valueEnd - valueStart, newValue.str());
+                            logFile << "INFO: Successfully updated array key '" << key
+                                    << "' with proper 4-space indentation" << std::endl;
                         }
                     }
-
-                    if (needsCorrection) break;
                 }
             }
         }
 
-        if (!needsCorrection) {
-            logFile << "SUCCESS: JSON indentation is already correct (perfect 4-space hierarchy with inline empty "
-                       "containers)"
-                    << std::endl;
-            logFile << std::endl;
-            return true;
+        if (currentBlacklistedPresetsShowValue != newBlacklistedPresetsShowValue) {
+            std::string keyPattern = "\"blacklistedPresetsShowInOBodyMenu\"";
+            size_t keyPos = result.find(keyPattern);
+
+            if (keyPos != std::string::npos) {
+                size_t colonPos = result.find(":", keyPos);
+                if (colonPos != std::string::npos) {
+                    size_t valueStart = colonPos + 1;
+
+                    while (valueStart < result.length() && std::isspace(static_cast<unsigned char>(result[valueStart]))) {
+                        valueStart++;
+                    }
+
+                    size_t valueEnd = valueStart;
+                    while (valueEnd < result.length() && 
+                           (std::isalpha(static_cast<unsigned char>(result[valueEnd])) || result[valueEnd] == '_')) {
+                        valueEnd++;
+                    }
+
+                    std::string newBoolValue = newBlacklistedPresetsShowValue ? "true" : "false";
+                    result.replace(valueStart, valueEnd - valueStart, newBoolValue);
+                    logFile << "INFO: Updated blacklistedPresetsShowInOBodyMenu to " << newBoolValue << std::endl;
+                }
+            }
         }
 
-        logFile << "DETECTED: JSON indentation needs correction - reformatting entire file with perfect 4-space "
-                   "hierarchy and inline empty containers..."
-                << std::endl;
+        return result;
+    } catch (const std::exception& e) {
+        logFile << "ERROR in PreserveOriginalSections: " << e.what() << std::endl;
+        return originalJson;
+    } catch (...) {
+        logFile << "ERROR in PreserveOriginalSections: Unknown exception" << std::endl;
+        return originalJson;
+    }
+}
 
-        std::ostringstream correctedJson;
-        int indentLevel = 0;
-        bool inString = false;
-        bool escape = false;
+struct JsonSectionDiff {
+    std::string key;
+    size_t added = 0;
+    size_t removed = 0;
+    bool reordered = false;
+};
 
-        auto isEmptyBlock = [&originalContent](size_t startPos, char openChar, char closeChar) -> bool {
-            size_t pos = startPos + 1;
-            int depth = 1;
-            bool inStr = false;
-            bool esc = false;
+struct JsonModelDiff {
+    bool changed = false;
+    bool blacklistedPresetsShowChanged = false;
+    std::vector<JsonSectionDiff> sections;
+};
 
-            while (pos < originalContent.length() && depth > 0) {
-                char c = originalContent[pos];
+// Compares the processed model with the model parsed from the original JSON, using the same
+// rules as PreserveOriginalSections: only the sections it rewrites count, and an empty processed
+// section leaves the original text untouched. Order matters because it is preserved on write.
+JsonModelDiff CompareJsonModels(const std::map<std::string, OrderedPluginData>& originalData,
+                                const std::map<std::string, OrderedPluginData>& processedData,
+                                bool currentBlacklistedPresetsShowValue,
+                                bool newBlacklistedPresetsShowValue) {
+    const std::vector<std::string> validKeys = {"npcFormID", "npc", "factionFemale", "factionMale",
+                                                "npcPluginFemale", "npcPluginMale", "raceFemale", "raceMale"};
 
-                if (esc) {
-                    esc = false;
-                    pos++;
-                    continue;
-                }
+    const std::vector<std::string> arrayKeys = {"blacklistedPresetsFromRandomDistribution", "blacklistedNpcs",
+                                                "blacklistedNpcsPluginFemale", "blacklistedNpcsPluginMale",
+                                                "blacklistedRacesFemale", "blacklistedRacesMale",
+                                                "blacklistedOutfitsFromORefit", "blacklistedOutfitsFromORefitPlugin",
+                                                "outfitsForceRefit"};
 
-                if (c == '\\' && inStr) {
-                    esc = true;
-                    pos++;
-                    continue;
-                }
+    JsonModelDiff diff;
 
-                if (c == '"') {
-                    inStr = !inStr;
-                } else if (!inStr) {
-                    if (c == openChar) {
-                        depth++;
-                    } else if (c == closeChar) {
-                        depth--;
-                        if (depth == 0) {
-                            std::string between = originalContent.substr(startPos + 1, pos - startPos - 1);
-                            std::string trimmedBetween = Trim(between);
-                            return trimmedBetween.empty();
-                        }
-                    }
-                }
-                pos++;
+    if (currentBlacklistedPresetsShowValue != newBlacklistedPresetsShowValue) {
+        diff.changed = true;
+        diff.blacklistedPresetsShowChanged = true;
+    }
+
+    // Interning is one-to-one, so (plugin, preset) id pairs compare exactly like the names
+    auto flatten = [](const OrderedPluginData& data) {
+        std::vector<std::uint64_t> entries;
+        entries.reserve(data.getTotalPresetCount());
+        for (const auto& [plugin, presets] : data.orderedData) {
+            for (NameId preset : presets) {
+                entries.push_back(static_cast<std::uint64_t>(plugin) << 32 | preset);
             }
-            return false;
-        };
+        }
+        return entries;
+    };
 
-        for (size_t i = 0; i < originalContent.length(); i++) {
-            char c = originalContent[i];
+    auto compareSection = [&](const std::string& key) {
+        auto processedIt = processedData.find(key);
+        if (processedIt == processedData.end() || processedIt->second.orderedData.empty()) return;
 
-            if (escape) {
-                correctedJson << c;
-                escape = false;
-                continue;
-            }
+        static const OrderedPluginData emptyData;
+        auto originalIt = originalData.find(key);
+        const OrderedPluginData& original = originalIt != originalData.end() ? originalIt->second : emptyData;
+
+        if (original.orderedData == processedIt->second.orderedData) return;
+
+        std::vector<std::uint64_t> before = flatten(original);
+        std::vector<std::uint64_t> after = flatten(processedIt->second);
+
+        JsonSectionDiff section;
+        section.key = key;
+
+        std::vector<std::uint64_t> sortedBefore = before;
+        std::vector<std::uint64_t> sortedAfter = after;
+        std::sort(sortedBefore.begin(), sortedBefore.end());
+        std::sort(sortedAfter.begin(), sortedAfter.end());
+
+        std::vector<std::uint64_t> delta;
+        std::set_difference(sortedAfter.begin(), sortedAfter.end(), sortedBefore.begin(), sortedBefore.end(),
+                            std::back_inserter(delta));
+        section.added = delta.size();
+        delta.clear();
+        std::set_difference(sortedBefore.begin(), sortedBefore.end(), sortedAfter.begin(), sortedAfter.end(),
+                            std::back_inserter(delta));
+        section.removed = delta.size();
+
+        // Same entries but a different plugin grouping or order still changes the written text
+        section.reordered = section.added == 0 && section.removed == 0;
+
+        diff.changed = true;
+        diff.sections.push_back(std::move(section));
+    };
+
+    for (const auto& key : validKeys) compareSection(key);
+    for (const auto& key : arrayKeys) compareSection(key);
+
+    return diff;
+}
+
+std::tuple<bool, std::string, bool> ReadCompleteJson(const fs::path& jsonPath,
+                                                      std::map<std::string, OrderedPluginData>& processedData,
+                                                      std::ostream& logFile) {
+    try {
+        if (!fs::exists(jsonPath)) {
+            logFile << "ERROR: JSON file does not exist at: " << jsonPath.string() << std::endl;
+            return {false, "", true};
+        }
+
+        if (!PerformTripleValidation(jsonPath, fs::path(), logFile)) {
+            logFile << "ERROR: JSON integrity check failed" << std::endl;
+            return {false, "", true};
+        }
 
-            if (c == '\\' && inString) {
-                correctedJson << c;
-                escape = true;
-                continue;
-            }
+        logFile << "Reading existing JSON from: " << jsonPath.string() << std::endl;
 
-            if (c == '"' && !escape) {
-                inString = !inString;
-                correctedJson << c;
-                continue;
-            }
+        std::string jsonContent = ReadFileWithEncoding(jsonPath);
 
-            if (inString) {
-                correctedJson << c;
-                continue;
-            }
+        if (jsonContent.empty() || jsonContent.size() < 2) {
+            logFile << "ERROR: JSON file is empty or too small after reading" << std::endl;
+            return {false, "", true};
+        }
 
-            switch (c) {
-                case '{':
-                case '[':
-                    if (isEmptyBlock(i, c, (c == '{') ? '}' : ']')) {
-                        size_t pos = i + 1;
-                        int depth = 1;
-                        bool inStr = false;
-                        bool esc = false;
+        const std::vector<std::string> validKeys = {"npcFormID",       "npc",           "factionFemale", "factionMale",
+                                                    "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
 
-                        while (pos < originalContent.length() && depth > 0) {
-                            char nextChar = originalContent[pos];
+        const std::vector<std::string> arrayKeys = {"blacklistedPresetsFromRandomDistribution", "blacklistedNpcs",
+                                                     "blacklistedNpcsFormID", "blacklistedNpcsPluginFemale",
+                                                     "blacklistedNpcsPluginMale", "blacklistedRacesFemale",
+                                                     "blacklistedRacesMale", "blacklistedOutfitsFromORefitFormID",
+                                                     "blacklistedOutfitsFromORefit", "blacklistedOutfitsFromORefitPlugin",
+                                                     "outfitsForceRefitFormID", "outfitsForceRefit"};
 
-                            if (esc) {
-                                esc = false;
-                                pos++;
-                                continue;
-                            }
+        for (const auto& key : validKeys) {
+            processedData[key] = OrderedPluginData();
 
-                            if (nextChar == '\\' && inStr) {
-                                esc = true;
-                                pos++;
-                                continue;
-                            }
+            size_t keyPos = jsonContent.find("\"" + key + "\"");
+            if (keyPos != std::string::npos) {
+                size_t colonPos = jsonContent.find(":", keyPos);
+                if (colonPos != std::string::npos) {
+                    size_t openBrace = jsonContent.find("{", colonPos);
+                    if (openBrace != std::string::npos) {
+                        int braceCount = 1;
+                        size_t pos = openBrace + 1;
+                        size_t closeBrace = std::string::npos;
+                        bool inString = false;
+                        bool escape = false;
 
-                            if (nextChar == '"') {
-                                inStr = !inStr;
-                            } else if (!inStr) {
-                                if (nextChar == c) {
-                                    depth++;
-                                } else if (nextChar == ((c == '{') ? '}' : ']')) {
-                                    depth--;
+                        while (pos < jsonContent.length() && braceCount > 0) {
+                            char c = jsonContent[pos];
+
+                            if (c == '"' && !escape) {
+                                inString = !inString;
+                            } else if (!inString) {
+                                if (c == '{') {
+                                    braceCount++;
+                                } else if (c == '}') {
+                                    braceCount--;
+                                    if (braceCount == 0) {
+                                        closeBrace = pos;
+                                        break;
+                                    }
                                 }
                             }
+
+                            escape = (c == '\\' && !escape);
                             pos++;
                         }
 
-                        correctedJson << c << ((c == '{') ? '}' : ']');
-                        i = pos - 1;
-
-                        if (i + 1 < originalContent.length()) {
-                            size_t nextNonSpace = i + 1;
-                            while (nextNonSpace < originalContent.length() &&
-                                   std::isspace(static_cast<unsigned char>(originalContent[nextNonSpace]))) {
-                                nextNonSpace++;
-                            }
+                        if (closeBrace != std::string::npos) {
+                            std::string keyContent = jsonContent.substr(openBrace + 1, closeBrace - openBrace - 1);
+                            auto orderedPlugins = parseOrderedPlugins(keyContent);
 
-                            if (nextNonSpace < originalContent.length() && originalContent[nextNonSpace] != ',' &&
-                                originalContent[nextNonSpace] != '}' && originalContent[nextNonSpace] != ']') {
-                                correctedJson << '\n';
-                                for (int j = 0; j < indentLevel * 4; j++) {
-                                    correctedJson << ' ';
+                            for (const auto& p : orderedPlugins) {
+                                for (const auto& preset : p.second) {
+                                    processedData[key].addPreset(p.first, preset);
                                 }
                             }
                         }
-                    } else {
-                        correctedJson << c << '\n';
-                        indentLevel++;
-                        for (int j = 0; j < indentLevel * 4; j++) {
-                            correctedJson << ' ';
-                        }
                     }
-                    break;
+                }
+            }
+        }
 
-                case '}':
-                case ']':
-                    correctedJson << '\n';
-                    indentLevel--;
-                    for (int j = 0; j < indentLevel * 4; j++) {
-                        correctedJson << ' ';
-                    }
-                    correctedJson << c;
+        for (const auto& key : arrayKeys) {
+            processedData[key] = OrderedPluginData();
 
-                    if (i + 1 < originalContent.length()) {
-                        size_t nextNonSpace = i + 1;
-                        while (nextNonSpace < originalContent.length() && std::isspace(static_cast<unsigned char>(originalContent[nextNonSpace]))) {
-                            nextNonSpace++;
-                        }
+            size_t keyPos = jsonContent.find("\"" + key + "\"");
+            if (keyPos != std::string::npos) {
+                size_t colonPos = jsonContent.find(":", keyPos);
+                if (colonPos != std::string::npos) {
+                    size_t openBracket = jsonContent.find("[", colonPos);
+                    if (openBracket != std::string::npos) {
+                        int bracketCount = 1;
+                        size_t pos = openBracket + 1;
+                        size_t closeBracket = std::string::npos;
+                        bool inString = false;
+                        bool escape = false;
 
-                        if (nextNonSpace < originalContent.length() && originalContent[nextNonSpace] != ',' &&
-                            originalContent[nextNonSpace] != '}' && originalContent[nextNonSpace] != ']') {
-                            correctedJson << '\n';
-                            for (int j = 0; j < indentLevel * 4; j++) {
-                                correctedJson << ' ';
-                            }
-                        }
-                    }
-                    break;
+                        while (pos < jsonContent.length() && bracketCount > 0) {
+                            char c = jsonContent[pos];
 
-                case ',':
-                    correctedJson << c << '\n';
-                    for (int j = 0; j < indentLevel * 4; j++) {
-                        correctedJson << ' ';
-                    }
-                    break;
+                            if (c == '"' && !escape) {
+                                inString = !inString;
+                            } else if (!inString) {
+                                if (c == '[') {
+                                    bracketCount++;
+                                } else if (c == ']') {
+                                    bracketCount--;
+                                    if (bracketCount == 0) {
+                                        closeBracket = pos;
+                                        break;
+                                    }
+                                }
+                            }
 
-                case ':':
-                    correctedJson << c << ' ';
-                    break;
+                            escape = (c == '\\' && !escape);
+                            pos++;
+                        }
 
-                case ' ':
-                case '\t':
-                case '\n':
-                case '\r':
-                    break;
+                        if (closeBracket != std::string::npos) {
+                            std::string keyContent = jsonContent.substr(openBracket + 1, closeBracket - openBracket - 1);
+                            auto arrayValues = parseArray(keyContent);
 
-                default:
-                    correctedJson << c;
-                    break;
+                            for (const auto& value : arrayValues) {
+                                processedData[key].addPreset("", value);
+                            }
+                        }
+                    }
+                }
             }
         }
 
-        std::string correctedContent = correctedJson.str();
+        bool blacklistedPresetsShowValue = true;
+        std::string boolKey = "\"blacklistedPresetsShowInOBodyMenu\"";
+        size_t boolKeyPos = jsonContent.find(boolKey);
+        if (boolKeyPos != std::string::npos) {
+            size_t colonPos = jsonContent.find(":", boolKeyPos);
+            if (colonPos != std::string::npos) {
+                size_t valueStart = colonPos + 1;
+                while (valueStart < jsonContent.length() && std::isspace(static_cast<unsigned char>(jsonContent[valueStart]))) {
+                    valueStart++;
+                }
 
-        std::vector<std::string> finalLines;
-        std::stringstream finalSS(correctedContent);
-        std::string finalLine;
+                size_t valueEnd = valueStart;
+                while (valueEnd < jsonContent.length() && 
+                       (std::isalpha(static_cast<unsigned char>(jsonContent[valueEnd])) || jsonContent[valueEnd] == '_')) {
+                    valueEnd++;
+                }
 
-        while (std::getline(finalSS, finalLine)) {
-            while (!finalLine.empty() && finalLine.back() == ' ') {
-                finalLine.pop_back();
+                std::string boolValue = jsonContent.substr(valueStart, valueEnd - valueStart);
+                blacklistedPresetsShowValue = parseBooleanValue(boolValue);
+                logFile << "Read blacklistedPresetsShowInOBodyMenu: " << (blacklistedPresetsShowValue ? "true" : "false") << std::endl;
             }
-            finalLines.push_back(finalLine);
         }
 
-        std::ostringstream finalJson;
-        for (size_t i = 0; i < finalLines.size(); i++) {
-            finalJson << finalLines[i];
-            if (i < finalLines.size() - 1) {
-                finalJson << '\n';
+        logFile << "Loaded existing data from JSON:" << std::endl;
+        for (const auto& [key, data] : processedData) {
+            size_t count = data.getTotalPresetCount();
+            if (count > 0) {
+                logFile << "  " << key << ": " << data.getPluginCount() << " plugins, " << count << " presets"
+                        << std::endl;
             }
         }
+        logFile << std::endl;
 
-        std::string finalContent = finalJson.str();
+        return {true, jsonContent, blacklistedPresetsShowValue};
+    } catch (const std::exception& e) {
+        logFile << "ERROR in ReadCompleteJson: " << e.what() << std::endl;
+        return {false, "", true};
+    } catch (...) {
+        logFile << "ERROR in ReadCompleteJson: Unknown exception occurred" << std::endl;
+        return {false, "", true};
+    }
+}
 
+bool WriteJsonAtomically(const fs::path& jsonPath, const std::string& content, const fs::path& analysisDir,
+                         std::ostream& logFile) {
+    try {
         fs::path tempPath = jsonPath;
-        tempPath.replace_extension(".indent_corrected.tmp");
+        tempPath.replace_extension(".tmp");
 
         std::ofstream tempFile(tempPath, std::ios::out | std::ios::trunc | std::ios::binary);
         if (!tempFile.is_open()) {
-            logFile << "ERROR: Could not create temporary file for indentation correction" << std::endl;
+            logFile << "ERROR: Could not create temporary JSON file" << std::endl;
             return false;
         }
 
-        tempFile << finalContent;
+        tempFile << content;
+        RecordStreamWritten(tempFile);
         tempFile.close();
 
         if (tempFile.fail()) {
-            logFile << "ERROR: Failed to write corrected JSON to temporary file" << std::endl;
+            logFile << "ERROR: Failed to write to temporary JSON file" << std::endl;
             return false;
         }
 
         if (!PerformTripleValidation(tempPath, fs::path(), logFile)) {
-            logFile << "ERROR: Corrected JSON failed integrity check" << std::endl;
+            logFile << "ERROR: Temporary JSON file failed integrity check" << std::endl;
             MoveCorruptedJsonToAnalysis(tempPath, analysisDir, logFile);
             try {
                 fs::remove(tempPath);
@@ -3089,7 +7366,7 @@ bool CorrectJsonIndentation(const fs::path& jsonPath, const fs::path& analysisDi
         fs::rename(tempPath, jsonPath, ec);
 
         if (ec) {
-            logFile << "ERROR: Failed to replace original with corrected JSON: " << ec.message() << std::endl;
+            logFile << "ERROR: Failed to move temporary file to final location: " << ec.message() << std::endl;
             try {
                 fs::remove(tempPath);
             } catch (...) {
@@ -3098,1271 +7375,2578 @@ bool CorrectJsonIndentation(const fs::path& jsonPath, const fs::path& analysisDi
         }
 
         if (PerformTripleValidation(jsonPath, fs::path(), logFile)) {
-            logFile << "SUCCESS: JSON indentation corrected successfully" << std::endl;
-            logFile << " Applied perfect 4-space hierarchy with inline empty containers (including multi-line empty "
-                       "detection)"
-                    << std::endl;
-            logFile << std::endl;
+            logFile << "SUCCESS: JSON file written atomically and verified" << std::endl;
             return true;
         } else {
-            logFile << "ERROR: Final corrected JSON failed integrity check" << std::endl;
+            logFile << "ERROR: Final JSON file failed integrity check" << std::endl;
+            MoveCorruptedJsonToAnalysis(jsonPath, analysisDir, logFile);
             return false;
         }
 
     } catch (const std::exception& e) {
-        logFile << "ERROR in CorrectJsonIndentation: " << e.what() << std::endl;
+        logFile << "ERROR in WriteJsonAtomically: " << e.what() << std::endl;
         return false;
     } catch (...) {
-        logFile << "ERROR in CorrectJsonIndentation: Unknown exception" << std::endl;
+        logFile << "ERROR in WriteJsonAtomically: Unknown exception" << std::endl;
         return false;
     }
 }
 
-// ===== JSON PARSING FUNCTIONS =====
+// Applies every counter change of one rule file with a single read and write. Updates are
+// applied in rule order, each to the first line still matching its original text, exactly as
+// rewriting the file once per rule did.
+void UpdateIniRuleCounts(const fs::path& iniPath, const std::vector<std::pair<std::string, int>>& updates) {
+    try {
+        std::string content = ReadFileWithEncoding(iniPath);
+        if (content.empty()) return;
 
-std::vector<std::pair<std::string, std::vector<std::string>>> parseOrderedPlugins(const std::string& content) {
-    std::vector<std::pair<std::string, std::vector<std::string>>> result;
-    if (content.empty()) return result;
+        std::stringstream ss(content);
+        std::vector<std::string> lines;
+        std::string line;
+        lines.reserve(200);
 
-    const char* str = content.c_str();
-    size_t len = content.length();
-    size_t pos = 0;
-    const size_t maxIters = 100000;
-    size_t iter = 0;
+        while (std::getline(ss, line)) {
+            lines.push_back(line);
+        }
 
-    result.reserve(200);
+        for (const auto& [originalLine, newCount] : updates) {
+            std::string originalLineClean = Trim(originalLine);
 
-    try {
-        while (pos < len && iter++ < maxIters) {
-            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
-            if (pos >= len) break;
+            for (auto& fileLine : lines) {
+                std::string cleanLine = fileLine;
 
-            if (str[pos] != '"') {
-                ++pos;
-                continue;
-            }
+                size_t commentPos = cleanLine.find(';');
+                if (commentPos != std::string::npos) {
+                    cleanLine = cleanLine.substr(0, commentPos);
+                }
 
-            size_t keyStart = pos + 1;
-            ++pos;
+                commentPos = cleanLine.find('#');
+                if (commentPos != std::string::npos) {
+                    cleanLine = cleanLine.substr(0, commentPos);
+                }
 
-            while (pos < len) {
-                if (str[pos] == '"') {
-                    size_t backslashCount = 0;
-                    size_t checkPos = pos - 1;
-                    while (checkPos > 0 && str[checkPos] == '\\') {
-                        backslashCount++;
-                        checkPos--;
+                cleanLine = Trim(cleanLine);
+
+                if (cleanLine == originalLineClean) {
+                    size_t lastPipe = fileLine.rfind('|');
+                    if (lastPipe != std::string::npos) {
+                        std::string beforePipe = fileLine.substr(0, lastPipe + 1);
+                        fileLine = beforePipe + std::to_string(newCount);
                     }
-                    if (backslashCount % 2 == 0) break;
+                    break;
                 }
-                ++pos;
             }
+        }
 
-            if (pos >= len) break;
+        std::ofstream outFile(iniPath, std::ios::out | std::ios::trunc);
+        if (outFile.is_open()) {
+            for (const auto& outputLine : lines) {
+                outFile << outputLine << std::endl;
+            }
+            RecordStreamWritten(outFile);
+            outFile.close();
+        }
 
-            std::string plugin = content.substr(keyStart, pos - keyStart);
-            ++pos;
+    } catch (...) {
+    }
+}
 
-            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
-            if (pos >= len || str[pos] != ':') {
-                ++pos;
-                continue;
-            }
+// ===== DISTRIBUTION PIPELINE =====
+
+PipelinePaths BuildExplicitPipelinePaths(const fs::path& dataPath, const fs::path& jsonPath, const fs::path& iniPath,
+                                         const fs::path& logPath) {
+    PipelinePaths paths;
+    paths.dataPath = dataPath;
+    paths.sksePluginsPath = jsonPath.parent_path();
+
+    fs::path logDir = logPath.parent_path();
+    std::string logStem = logPath.stem().string();
+    paths.logFilePath = logPath;
+    paths.logDoctorPath = logDir / (logStem + "_Doctor.log");
+    paths.logClustersPath = logDir / (logStem + "_Preset_Clusters.log");
+    paths.logSmartCleaningPath = logDir / (logStem + "_Smart_Cleaning.log");
+    paths.logHelperPath = logDir / (logStem + "_List-Helper.log");
+    paths.logMetricsPath = logDir / (logStem + "_Metrics.json");
+    paths.logMetricsHistoryPath = logDir / (logStem + "_Metrics_History.csv");
+
+    fs::path backupDir = paths.sksePluginsPath / "Backup_OBody_DPA";
+    paths.configIniPath = iniPath;
+    paths.frameworkTablePath = iniPath.parent_path() / (iniPath.stem().string() + "_Frameworks.ini");
+    paths.jsonOutputPath = jsonPath;
+    paths.backupJsonPath = backupDir / jsonPath.filename();
+    paths.analysisDir = backupDir / "Analysis";
+    paths.bodySlidePresetsPath = paths.dataPath / "CalienteTools" / "BodySlide" / "SliderPresets";
+    paths.presetCatalogCachePath = backupDir / "PresetCatalog.cache";
+    paths.inputFingerprintPath = backupDir / "InputFingerprint.dat";
+    return paths;
+}
 
-            ++pos;
-            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
-            if (pos >= len || str[pos] != '[') {
-                ++pos;
-                continue;
-            }
+PipelinePaths BuildPipelinePaths(const std::string& documentsPath, const std::string& gamePath) {
+    fs::path dataPath = fs::path(gamePath) / "Data";
+    fs::path sksePluginsPath = dataPath / "SKSE" / "Plugins";
+    fs::path skseLogDir = fs::path(documentsPath) / "My Games" / "Skyrim Special Edition" / "SKSE";
 
-            ++pos;
+    return BuildExplicitPipelinePaths(dataPath, sksePluginsPath / "OBody_presetDistributionConfig.json",
+                                      sksePluginsPath / "OBody_NG_Preset_Distribution_Assistant_NG.ini",
+                                      skseLogDir / "OBody_NG_Preset_Distribution_Assistant-NG.log");
+}
 
-            std::vector<std::string> presets;
-            presets.reserve(50);
-            size_t presetIter = 0;
+void WriteLogHeader(std::ostream& logFile) {
+    auto now = std::chrono::system_clock::now();
+    std::time_t in_time_t = std::chrono::system_clock::to_time_t(now);
+    std::tm buf = LocalTime(in_time_t);
 
-            while (pos < len && presetIter++ < maxIters) {
-                while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
-                if (pos >= len) break;
+    logFile << "====================================================" << std::endl;
+    logFile << "OBody NG Preset Distribution Assistant NG v" << PLUGIN_VERSION << std::endl;
+    logFile << "Log created on: " << std::put_time(&buf, "%Y-%m-%d %H:%M:%S") << std::endl;
+    logFile << "====================================================" << std::endl << std::endl;
+}
 
-                if (str[pos] == ']') {
-                    ++pos;
-                    break;
-                }
+// ===== INPUT FINGERPRINT (NO-OP FAST PATH) =====
 
-                if (str[pos] != '"') {
-                    ++pos;
-                    continue;
-                }
+// FNV-1a 64 over everything the pipeline reads: the OBody JSON, the main INI, every
+// OBodyNG_PDA_*.ini and a SliderPresets manifest (names, sizes, mtimes). It is taken after a
+// successful run, so a launch that finds the same value would only reproduce the same files.
+const char* const INPUT_FINGERPRINT_HEADER = "OBODY_PDA_INPUT_FINGERPRINT v1";
 
-                size_t presetStart = pos + 1;
-                ++pos;
+struct InputFingerprint {
+    std::uint64_t hash = 14695981039346656037ULL;
+    bool valid = true;
 
-                while (pos < len) {
-                    if (str[pos] == '"') {
-                        size_t backslashCount = 0;
-                        size_t checkPos = pos - 1;
-                        while (checkPos > 0 && str[checkPos] == '\\') {
-                            backslashCount++;
-                            checkPos--;
-                        }
-                        if (backslashCount % 2 == 0) break;
-                    }
-                    ++pos;
-                }
+    void Add(const char* data, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+    }
 
-                if (pos >= len) break;
+    void Add(const std::string& str) {
+        Add(str.data(), str.size());
+        Add("\0", 1);
+    }
 
-                std::string preset = content.substr(presetStart, pos - presetStart);
-                presets.push_back(std::move(preset));
-                ++pos;
+    void Add(std::uint64_t value) { Add(std::to_string(value)); }
+};
 
-                while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
-                if (pos < len && str[pos] == ',') {
-                    ++pos;
-                    while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
-                }
-            }
+void AddFileToFingerprint(InputFingerprint& fingerprint, const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        fingerprint.Add(std::string("<missing>"));
+        return;
+    }
+    RecordFileOpened();
+
+    char buffer[65536];
+    std::uint64_t total = 0;
+    while (file) {
+        file.read(buffer, sizeof(buffer));
+        std::streamsize got = file.gcount();
+        if (got <= 0) break;
+        fingerprint.Add(buffer, static_cast<size_t>(got));
+        total += static_cast<std::uint64_t>(got);
+    }
+    if (file.bad()) fingerprint.valid = false;
+    RecordBytesRead(total);
+    fingerprint.Add(total);
+}
 
-            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
-            if (pos < len && str[pos] == ',') ++pos;
+InputFingerprint ComputeInputFingerprint(const PipelinePaths& paths) {
+    InputFingerprint fingerprint;
 
-            if (!plugin.empty()) {
-                result.emplace_back(std::move(plugin), std::move(presets));
+    try {
+        fingerprint.Add(std::string(PLUGIN_VERSION));
+
+        fingerprint.Add(std::string("json"));
+        AddFileToFingerprint(fingerprint, paths.jsonOutputPath);
+
+        fingerprint.Add(std::string("config"));
+        AddFileToFingerprint(fingerprint, paths.configIniPath);
+
+        fingerprint.Add(std::string("frameworks"));
+        AddFileToFingerprint(fingerprint, paths.frameworkTablePath);
+
+        std::error_code enumerateError;
+        std::vector<DirectoryEntry> ruleFiles =
+            EnumerateDirectory(paths.dataPath, "OBodyNG_PDA_", ".ini", enumerateError);
+        if (enumerateError) throw fs::filesystem_error("directory enumeration", paths.dataPath, enumerateError);
+        std::sort(ruleFiles.begin(), ruleFiles.end(),
+                  [](const DirectoryEntry& a, const DirectoryEntry& b) { return a.path < b.path; });
+        for (const auto& ruleFile : ruleFiles) {
+            fingerprint.Add(ruleFile.path.filename().string());
+            AddFileToFingerprint(fingerprint, ruleFile.path);
+        }
+
+        fingerprint.Add(std::string("presets"));
+        if (fs::exists(paths.bodySlidePresetsPath)) {
+            std::vector<std::tuple<std::string, std::uint64_t, long long>> manifest;
+            std::vector<DirectoryEntry> xmlFiles =
+                EnumerateDirectory(paths.bodySlidePresetsPath, "", ".xml", enumerateError);
+            if (enumerateError) {
+                throw fs::filesystem_error("directory enumeration", paths.bodySlidePresetsPath, enumerateError);
+            }
+            for (const auto& entry : xmlFiles) {
+                manifest.emplace_back(entry.name, static_cast<std::uint64_t>(entry.stamp.size), entry.stamp.mtime);
             }
+            std::sort(manifest.begin(), manifest.end());
+            for (const auto& [filename, size, mtime] : manifest) {
+                fingerprint.Add(filename);
+                fingerprint.Add(size);
+                fingerprint.Add(std::to_string(mtime));
+            }
+        }
+    } catch (...) {
+        fingerprint.valid = false;
+    }
+
+    return fingerprint;
+}
+
+std::string FormatFingerprint(std::uint64_t hash) {
+    std::ostringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return ss.str();
+}
+
+std::string ReadStoredFingerprint(const fs::path& fingerprintPath) {
+    try {
+        std::ifstream file(fingerprintPath);
+        if (!file.is_open()) return "";
+
+        std::string header;
+        std::string value;
+        if (!std::getline(file, header) || Trim(header) != INPUT_FINGERPRINT_HEADER) return "";
+        if (!std::getline(file, value)) return "";
+        return Trim(value);
+    } catch (...) {
+        return "";
+    }
+}
+
+void StoreFingerprint(const fs::path& fingerprintPath, const std::string& value, std::ostream& logFile) {
+    try {
+        CreateDirectoryIfNotExists(fingerprintPath.parent_path());
+        std::ofstream file(fingerprintPath, std::ios::out | std::ios::trunc);
+        if (!file.is_open()) {
+            logFile << "WARNING: Could not store input fingerprint" << std::endl;
+            return;
         }
+        file << INPUT_FINGERPRINT_HEADER << std::endl << value << std::endl;
+        RecordStreamWritten(file);
     } catch (...) {
+        logFile << "WARNING: Could not store input fingerprint" << std::endl;
+    }
+}
+
+void ClearStoredFingerprint(const fs::path& fingerprintPath) {
+    std::error_code ec;
+    fs::remove(fingerprintPath, ec);
+}
+
+// True when a fingerprint is stored and the inputs still hash to it.
+bool InputFingerprintUnchanged(const PipelinePaths& paths) {
+    std::string storedFingerprint = ReadStoredFingerprint(paths.inputFingerprintPath);
+    if (storedFingerprint.empty()) return false;
+    InputFingerprint fingerprint = ComputeInputFingerprint(paths);
+    return fingerprint.valid && FormatFingerprint(fingerprint.hash) == storedFingerprint;
+}
+
+// ===== CATALOG BENCHMARK HOOKS =====
+
+CatalogBenchResult BenchBuildPresetCatalog(const fs::path& dataPath, int workerThreads, ReadBackend readBackend) {
+    std::ostringstream catalogLog;
+    PresetCatalog catalog =
+        BuildPresetCatalog(dataPath / "CalienteTools" / "BodySlide" / "SliderPresets", fs::path(),
+                           DefaultFrameworkClassifier(), catalogLog,
+                           AcquireWorkerPool(ResolveWorkerThreads(workerThreads)), readBackend);
+
+    InputFingerprint digest;
+    for (const auto& entry : catalog.entries) {
+        digest.Add(entry.xmlFilename);
+        digest.Add(entry.contentHash);
+        for (const auto& preset : entry.presets) {
+            digest.Add(preset.info.internalName);
+            digest.Add(preset.info.setName);
+            digest.Add(static_cast<std::uint64_t>(preset.info.extractionSuccessful));
+            for (const auto& group : preset.analysis.groupNames) digest.Add(group);
+        }
     }
+    digest.Add(catalogLog.str());
 
+    CatalogBenchResult result;
+    for (const auto& entry : catalog.entries) result.presets += entry.presets.size();
+    result.filesOpened = catalog.xmlFilesOpened;
+    result.digest = digest.hash;
     return result;
 }
 
-std::vector<std::string> parseArray(const std::string& content) {
-    std::vector<std::string> result;
-    if (content.empty()) return result;
+ClusterBenchResult BenchClusterPresets(const fs::path& dataPath, int workerThreads, double maxDistance,
+                                       bool exhaustive) {
+    std::ostringstream catalogLog;
+    ThreadPool* pool = AcquireWorkerPool(ResolveWorkerThreads(workerThreads));
+    PresetCatalog catalog = BuildPresetCatalog(dataPath / "CalienteTools" / "BodySlide" / "SliderPresets", fs::path(),
+                                               DefaultFrameworkClassifier(), catalogLog, pool, ReadBackend::Auto, true);
+
+    PresetClusterOptions options;
+    options.maxDistance = static_cast<float>(maxDistance);
+    options.exhaustive = exhaustive;
+
+    auto startTime = std::chrono::steady_clock::now();
+    PresetClusterResult clusters = ClusterPresetSliders(catalog, options, pool);
+    ClusterBenchResult result;
+    result.clusterMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    InputFingerprint digest;
+    for (const auto& cluster : clusters.clusters) {
+        digest.Add(cluster.framework);
+        for (const auto& member : cluster.members) {
+            digest.Add(catalog.entries[member.entry].xmlFilename);
+            digest.Add(static_cast<std::uint64_t>(member.preset));
+        }
+        result.clusteredPresets += cluster.members.size();
+    }
+    result.presets = clusters.presetsCompared;
+    result.sliderNames = clusters.sliderNames;
+    result.clusters = clusters.clusters.size();
+    result.distanceChecks = clusters.distanceChecks;
+    result.digest = digest.hash;
+    return result;
+}
 
-    const char* str = content.c_str();
-    size_t len = content.length();
-    size_t pos = 0;
-    const size_t maxIters = 100000;
-    size_t iter = 0;
+std::vector<SliderPresetRecord> BenchTokenizeSliderPresets(const std::string& xml, const std::string& filename) {
+    std::ostringstream discardedLog;
+    std::vector<SliderPresetRecord> records;
+    for (auto& preset :
+         TokenizeSliderPresets(xml.data(), xml.size(), filename, DefaultFrameworkClassifier(), discardedLog)) {
+        SliderPresetRecord record;
+        record.name = std::move(preset.info.internalName);
+        record.set = std::move(preset.info.setName);
+        record.groups = std::move(preset.analysis.groupNames);
+        record.extracted = preset.info.extractionSuccessful;
+        records.push_back(std::move(record));
+    }
+    return records;
+}
 
-    result.reserve(100);
+// Heap bytes currently allocated, for benchmarks that compare data structure footprints. 0 where
+// the C runtime cannot report it.
+std::uint64_t HeapBytesInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return static_cast<std::uint64_t>(mallinfo2().uordblks);
+#else
+    return 0;
+#endif
+}
 
-    try {
-        while (pos < len && iter++ < maxIters) {
-            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
-            if (pos >= len) break;
+PresetLookupBenchResult BenchPresetLookup(const std::vector<std::pair<std::string, std::string>>& presets,
+                                          const std::vector<std::string>& references) {
+    PresetCatalog catalog;
+    catalog.folderFound = true;
+    catalog.entries.reserve(presets.size());
+    for (const auto& [filename, internalName] : presets) {
+        PresetCatalogEntry entry;
+        entry.xmlFilename = filename + ".xml";
+        XmlPreset preset;
+        preset.info.filename = filename;
+        preset.info.internalName = internalName.empty() ? filename : internalName;
+        preset.info.extractionSuccessful = !internalName.empty();
+        entry.presets.push_back(std::move(preset));
+        catalog.entries.push_back(std::move(entry));
+    }
 
-            if (str[pos] == ']') break;
+    PresetLookupBenchResult result;
+    std::ostream discardedLog(nullptr);  // No buffer, so logging allocates nothing during the measurement
+    std::uint64_t heapBefore = HeapBytesInUse();
+    auto startTime = std::chrono::steady_clock::now();
+    PresetMapData presetData = BuildPresetNameMap(catalog, discardedLog);
+    auto builtTime = std::chrono::steady_clock::now();
+    std::uint64_t heapAfter = HeapBytesInUse();
+    result.mapBytes = heapAfter > heapBefore ? heapAfter - heapBefore : 0;
+    result.internedNames = InternedNames().Size();
+
+    result.matchLevels.reserve(references.size());
+    result.resolvedNames.reserve(references.size());
+    for (const auto& reference : references) {
+        PresetMatchResult match = FindPresetMatch(reference, presetData, discardedLog);
+        result.matchLevels.push_back(match.found ? match.matchLevel : 0);
+        result.resolvedNames.push_back(std::move(match.actualPresetName));
+    }
+    auto finishTime = std::chrono::steady_clock::now();
+
+    // What Smart Cleaning does with the references that failed every level
+    PresetSuggestionIndex suggestionIndex;
+    suggestionIndex.Build(presetData.presetNames, presetData.filenameMappings);
+    auto suggestionsBuiltTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < references.size(); ++i) {
+        if (result.matchLevels[i] != 0) continue;
+        result.suggestionQueries++;
+        if (!suggestionIndex.Suggest(references[i], 3).empty()) result.suggested++;
+    }
+    auto suggestedTime = std::chrono::steady_clock::now();
 
-            if (str[pos] != '"') {
-                ++pos;
-                continue;
+    result.buildMs = std::chrono::duration<double, std::milli>(builtTime - startTime).count();
+    result.lookupMs = std::chrono::duration<double, std::milli>(finishTime - builtTime).count();
+    result.suggestionBuildMs = std::chrono::duration<double, std::milli>(suggestionsBuiltTime - finishTime).count();
+    result.suggestionMs = std::chrono::duration<double, std::milli>(suggestedTime - suggestionsBuiltTime).count();
+    return result;
+}
+
+// ===== RUN METRICS =====
+
+class StageTimer {
+public:
+    StageTimer(std::vector<StageMetric>& stages, const char* name, const char* thread = "pipeline")
+        : stages_(stages), name_(name), thread_(thread), start_(std::chrono::steady_clock::now()),
+          startCounters_(t_ioCounters) {}
+
+    ~StageTimer() { Stop(); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    void Stop() {
+        if (stopped_) return;
+        stopped_ = true;
+
+        StageMetric metric;
+        metric.name = name_;
+        metric.thread = thread_;
+        metric.wallMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+        metric.bytesRead = t_ioCounters.bytesRead - startCounters_.bytesRead;
+        metric.bytesWritten = t_ioCounters.bytesWritten - startCounters_.bytesWritten;
+        metric.filesOpened = t_ioCounters.filesOpened - startCounters_.filesOpened;
+        stages_.push_back(std::move(metric));
+    }
+
+private:
+    std::vector<StageMetric>& stages_;
+    const char* name_;
+    const char* thread_;
+    std::chrono::steady_clock::time_point start_;
+    IoCounters startCounters_;
+    bool stopped_ = false;
+};
+
+struct RunMetrics {
+    std::vector<StageMetric> stages;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    bool skippedUnchanged = false;
+    size_t xmlPresets = 0;
+    size_t ruleFiles = 0;
+    size_t presetReferences = 0;        // Resolved by Smart Cleaning, protected presets excluded
+    size_t uniquePresetReferences = 0;  // Distinct names among them, each resolved once
+};
+
+// ===== TASK GRAPH =====
+
+// Stages with explicit dependencies. Every node writes its main-log output into its own buffer;
+// Collect() replays the buffers and stage metrics in declaration order, so the log is the same
+// for any thread count as long as nodes are declared in the old sequential order.
+class TaskGraph {
+public:
+    explicit TaskGraph(const char* thread) : thread_(thread) {}
+
+    size_t Add(const char* name, std::function<void(std::ostream&)> work, std::vector<size_t> dependsOn = {}) {
+        auto node = std::make_unique<Node>();
+        node->name = name;
+        node->work = std::move(work);
+        node->dependencyCount = dependsOn.size();
+        size_t index = nodes_.size();
+        for (size_t dependency : dependsOn) {
+            nodes_[dependency]->dependents.push_back(index);
+        }
+        nodes_.push_back(std::move(node));
+        return index;
+    }
+
+    // Blocks until every node has run or was skipped because a dependency failed.
+    void Run(ThreadPool* pool) {
+        if (!pool) {
+            for (size_t i = 0; i < nodes_.size(); ++i) {
+                Visit(i);
             }
+            return;
+        }
 
-            size_t valueStart = pos + 1;
-            ++pos;
+        for (auto& node : nodes_) {
+            node->remaining = node->dependencyCount;
+        }
+        size_t finished = 0;
+        std::mutex doneMutex;
+        std::condition_variable done;
 
-            while (pos < len) {
-                if (str[pos] == '"') {
-                    size_t backslashCount = 0;
-                    size_t checkPos = pos - 1;
-                    while (checkPos > 0 && str[checkPos] == '\\') {
-                        backslashCount++;
-                        checkPos--;
-                    }
-                    if (backslashCount % 2 == 0) break;
+        std::function<void(size_t)> schedule = [&](size_t index) {
+            pool->Submit([&, index]() {
+                Visit(index);
+                for (size_t dependent : nodes_[index]->dependents) {
+                    if (--nodes_[dependent]->remaining == 0) schedule(dependent);
                 }
-                ++pos;
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (++finished == nodes_.size()) done.notify_all();
+            });
+        };
+
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            if (nodes_[i]->dependencyCount == 0) schedule(i);
+        }
+
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [&]() { return finished == nodes_.size(); });
+    }
+
+    // Flushes node logs and metrics up to and including the first failed node, then rethrows its error.
+    void Collect(std::ostream& logFile, std::vector<StageMetric>& stages) {
+        for (auto& node : nodes_) {
+            if (node->skipped) continue;
+            logFile << node->log.str();
+            stages.insert(stages.end(), node->stages.begin(), node->stages.end());
+            if (node->error) std::rethrow_exception(node->error);
+        }
+    }
+
+private:
+    struct Node {
+        const char* name = "";
+        std::function<void(std::ostream&)> work;
+        std::vector<size_t> dependents;
+        size_t dependencyCount = 0;
+        std::atomic<size_t> remaining{0};
+        std::ostringstream log;
+        std::vector<StageMetric> stages;
+        std::exception_ptr error;
+        std::atomic<bool> skipped{false};
+    };
+
+    // A failed or skipped node skips all of its dependents. The flag is set before the
+    // dependents' counters are released, so they always see it.
+    void Visit(size_t index) {
+        Node& node = *nodes_[index];
+        if (!node.skipped) {
+            StageTimer timer(node.stages, node.name, thread_);
+            try {
+                node.work(node.log);
+            } catch (...) {
+                node.error = std::current_exception();
+            }
+        }
+        if (node.skipped || node.error) {
+            for (size_t dependent : node.dependents) {
+                nodes_[dependent]->skipped = true;
             }
+        }
+    }
+
+    const char* thread_;
+    std::vector<std::unique_ptr<Node>> nodes_;
+};
+
+// ===== STARTUP BUDGET AND DEFERRED STAGES =====
+
+struct DataLoadedClock {
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point time;
+    bool seen = false;
+};
+
+DataLoadedClock g_dataLoaded;
+
+void MarkDataLoaded() {
+    std::lock_guard<std::mutex> lock(g_dataLoaded.mutex);
+    g_dataLoaded.time = std::chrono::steady_clock::now();
+    g_dataLoaded.seen = true;
+}
+
+bool GetDataLoadedTime(std::chrono::steady_clock::time_point& time) {
+    std::lock_guard<std::mutex> lock(g_dataLoaded.mutex);
+    time = g_dataLoaded.time;
+    return g_dataLoaded.seen;
+}
+
+// The budget counts from kDataLoaded: work finished while the engine was still loading is free.
+bool StartupBudgetSpent(int budgetMs, long long& elapsedMs) {
+    elapsedMs = 0;
+    std::chrono::steady_clock::time_point dataLoadedTime;
+    if (budgetMs <= 0 || !GetDataLoadedTime(dataLoadedTime)) return false;
+
+    elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                      dataLoadedTime)
+                    .count();
+    return elapsedMs >= budgetMs;
+}
+
+// Report-only stages (Doctor, Smart Cleaning and Helper logs, UBE conflict report). JSON repair,
+// rule application, Smart Cleaning itself and the JSON commit are never deferred.
+struct DeferredStage {
+    const char* name;
+    std::function<void(std::ostream&)> work;
+};
+
+struct DeferredStageQueue {
+    std::mutex mutex;
+    std::vector<DeferredStage> stages;
+    fs::path logPath;
+    int budgetMs = 0;
+};
+
+DeferredStageQueue g_deferredStages;
+
+// Deferred stages and watch updates both append to the main log after the pipeline closed it
+std::mutex g_mainLogAppendMutex;
 
-            if (pos >= len) break;
+void QueueDeferredStages(std::vector<DeferredStage> stages, const fs::path& logPath, int budgetMs) {
+    std::lock_guard<std::mutex> lock(g_deferredStages.mutex);
+    g_deferredStages.stages = std::move(stages);
+    g_deferredStages.logPath = logPath;
+    g_deferredStages.budgetMs = budgetMs;
+}
 
-            std::string value = content.substr(valueStart, pos - valueStart);
-            result.push_back(std::move(value));
-            ++pos;
+void RunDeferredStages(std::vector<StageMetric>* stageMetrics) {
+    // Taken before the queue, so a watch update that ran the queue first never sees a batch that
+    // was dequeued but not yet written
+    std::lock_guard<std::mutex> logLock(g_mainLogAppendMutex);
+    std::vector<DeferredStage> stages;
+    fs::path logPath;
+    int budgetMs = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_deferredStages.mutex);
+        stages = std::move(g_deferredStages.stages);
+        g_deferredStages.stages.clear();
+        logPath = g_deferredStages.logPath;
+        budgetMs = g_deferredStages.budgetMs;
+    }
+    if (stages.empty()) return;
 
-            while (pos < len && std::isspace(static_cast<unsigned char>(str[pos]))) ++pos;
-            if (pos < len && str[pos] == ',') ++pos;
+    std::ofstream logFile(logPath, std::ios::out | std::ios::app);
+    if (!logFile.is_open()) return;
+    RecordFileOpened();
+
+    logFile << std::endl;
+    logFile << "====================================================" << std::endl;
+    logFile << "DEFERRED STAGES (Startup_Budget_Ms = " << budgetMs << ")" << std::endl;
+    logFile << "====================================================" << std::endl;
+
+    std::vector<StageMetric> metrics;
+    for (const auto& stage : stages) {
+        std::ostringstream stageLog;
+        {
+            StageTimer timer(metrics, stage.name, "deferred");
+            try {
+                stage.work(stageLog);
+            } catch (const std::exception& e) {
+                stageLog << "ERROR in deferred stage " << stage.name << ": " << e.what() << std::endl;
+            } catch (...) {
+                stageLog << "ERROR in deferred stage " << stage.name << ": Unknown exception" << std::endl;
+            }
         }
-    } catch (...) {
+        logFile << stageLog.str();
+        logFile << "Deferred stage " << stage.name << " finished in " << std::fixed << std::setprecision(1)
+                << metrics.back().wallMs << " ms" << std::endl;
     }
 
-    return result;
-}
+    double totalMs = 0.0;
+    for (const auto& metric : metrics) {
+        totalMs += metric.wallMs;
+    }
+    logFile << "All deferred stages finished in " << std::fixed << std::setprecision(1) << totalMs << " ms"
+            << std::endl;
+    RecordStreamWritten(logFile);
+    logFile.close();
 
-bool parseBooleanValue(const std::string& content) {
-    std::string trimmed = Trim(content);
-    std::transform(trimmed.begin(), trimmed.end(), trimmed.begin(), ::tolower);
-    return (trimmed == "true");
+    if (stageMetrics) *stageMetrics = std::move(metrics);
 }
 
-// ===== JSON PRESERVE AND UPDATE FUNCTIONS =====
-
-std::string PreserveOriginalSections(const std::string& originalJson,
-                                      const std::map<std::string, OrderedPluginData>& processedData,
-                                      bool currentBlacklistedPresetsShowValue,
-                                      bool newBlacklistedPresetsShowValue,
-                                      std::ofstream& logFile) {
-    try {
-        const std::set<std::string> validKeys = {"npcFormID",       "npc",           "factionFemale", "factionMale",
-                                                  "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+// ===== EARLY PRESCAN (OVERLAPS ENGINE LOADING) =====
 
-        const std::set<std::string> arrayKeys = {"blacklistedPresetsFromRandomDistribution", "blacklistedNpcs",
-                                                  "blacklistedNpcsPluginFemale", "blacklistedNpcsPluginMale",
-                                                  "blacklistedRacesFemale", "blacklistedRacesMale",
-                                                  "blacklistedOutfitsFromORefit", "blacklistedOutfitsFromORefitPlugin",
-                                                  "outfitsForceRefit"};
+// Rule lines are kept with the original text so UpdateIniRuleCounts can still locate them.
+struct RuleFileScan {
+    fs::path path;
+    std::string filename;
+    bool readFailed = false;
+    std::vector<std::pair<std::string, ParsedRule>> rules;
+    std::uintmax_t size = 0;  // Taken before the read, so a concurrent edit is seen as a change
+    long long mtime = 0;
+};
 
-        std::string result = originalJson;
+// Everything here only needs the file system, never game forms, so it can start at
+// SKSEPlugin_Load and run while the engine is still loading ESPs. Main-log output is
+// buffered per stage and flushed by the pipeline at the point where the stage used to run.
+struct PreScanResult {
+    std::ostringstream catalogLog;
+    std::ostringstream doctorLog;
+    std::ostringstream clustersLog;
+    std::ostringstream presetMapLog;
+    std::ostringstream ubeScanLog;
+    std::ostringstream ruleScanLog;
+
+    FrameworkClassifier frameworks;
+    PresetCatalog catalog;
+    PresetMapData presetMap;
+    ShapeIndex shapeIndex;
+    PresetSuggestionIndex presetSuggestions;  // Only built when some Smart Cleaning option is on
+    std::vector<std::string> ubePresetsForBlacklist;
+    std::vector<UBEPresetInfo> ubePresetsForRaces;
+    std::vector<RuleFileScan> ruleFiles;
+    std::vector<StageMetric> stageMetrics;
+    bool doctorLogDeferred = false;
+    bool clustersLogDeferred = false;
+    bool ubeReportDeferred = false;
+    bool reportLogsCurrent = false;  // Watch updates that left the preset map alone skip its report logs
+
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point finishTime;
+};
 
-        for (const auto& [key, data] : processedData) {
-            if (validKeys.count(key) && !data.orderedData.empty()) {
-                std::string keyPattern = "\"" + key + "\"";
-                size_t keyPos = result.find(keyPattern);
+bool IsRuleFileName(const std::string& filename) {
+    return StartsWith(filename, "OBodyNG_PDA_") && EndsWith(filename, ".ini");
+}
 
-                if (keyPos != std::string::npos) {
-                    size_t colonPos = result.find(":", keyPos);
-                    if (colonPos != std::string::npos) {
-                        size_t valueStart = colonPos + 1;
+RuleFileScan ScanRuleFile(const fs::path& path, const FileStamp& stamp) {
+    static const std::set<std::string> validKeys = {"npcFormID",   "npc",           "factionFemale",
+                                                    "factionMale", "npcPluginFemale", "npcPluginMale",
+                                                    "raceFemale",  "raceMale"};
 
-                        while (valueStart < result.length() && std::isspace(static_cast<unsigned char>(result[valueStart]))) {
-                            valueStart++;
-                        }
+    RuleFileScan scan;
+    scan.path = path;
+    scan.filename = path.filename().string();
 
-                        size_t valueEnd = valueStart;
-                        if (valueStart < result.length() && result[valueStart] == '{') {
-                            int braceCount = 1;
-                            valueEnd = valueStart + 1;
-                            bool inString = false;
-                            bool escape = false;
+    scan.size = stamp.size;
+    scan.mtime = stamp.mtime;
 
-                            while (valueEnd < result.length() && braceCount > 0) {
-                                char c = result[valueEnd];
+    std::string iniContent = ReadFileWithEncoding(path);
+    if (iniContent.empty()) {
+        scan.readFailed = true;
+        return scan;
+    }
 
-                                if (c == '"' && !escape) {
-                                    inString = !inString;
-                                } else if (!inString) {
-                                    if (c == '{')
-                                        braceCount++;
-                                    else if (c == '}')
-                                        braceCount--;
-                                }
+    std::stringstream iniStream(iniContent);
+    std::string line;
+    scan.rules.reserve(100);
 
-                                escape = (c == '\\' && !escape);
-                                valueEnd++;
-                            }
+    while (std::getline(iniStream, line)) {
+        std::string originalLine = line;
 
-                            std::ostringstream newValue;
-                            newValue << "{\n";
+        size_t commentPos = line.find(';');
+        if (commentPos != std::string::npos) {
+            line = line.substr(0, commentPos);
+        }
 
-                            bool first = true;
-                            for (const auto& [plugin, presets] : data.orderedData) {
-                                if (!first) newValue << ",\n";
-                                first = false;
+        commentPos = line.find('#');
+        if (commentPos != std::string::npos) {
+            line = line.substr(0, commentPos);
+        }
 
-                                newValue << "        \"" << EscapeJson(plugin) << "\": [\n";
+        size_t equalPos = line.find('=');
+        if (equalPos == std::string::npos) continue;
 
-                                bool firstPreset = true;
-                                for (const auto& preset : presets) {
-                                    if (!firstPreset) newValue << ",\n";
-                                    firstPreset = false;
+        std::string key = Trim(line.substr(0, equalPos));
+        std::string value = Trim(line.substr(equalPos + 1));
 
-                                    newValue << "            \"" << EscapeJson(preset) << "\"";
-                                }
+        if (validKeys.count(key) && !value.empty()) {
+            ParsedRule rule = ParseRuleLine(key, value);
+            if (!rule.plugin.empty() && !rule.presets.empty()) {
+                scan.rules.emplace_back(originalLine, std::move(rule));
+            }
+        }
+    }
 
-                                newValue << "\n        ]";
-                            }
+    return scan;
+}
 
-                            newValue << "\n    }";
+RuleFileScan ScanRuleFile(const fs::path& path) {
+    return ScanRuleFile(path, StatFile(path));
+}
 
-                            result.replace(valueStart, valueEnd - valueStart, newValue.str());
-                            logFile << "INFO: Successfully updated key '" << key << "' with proper 4-space indentation"
-                                    << std::endl;
-                        }
-                    }
-                }
-            } else if (arrayKeys.count(key) && !data.orderedData.empty()) {
-                std::string keyPattern = "\"" + key + "\"";
-                size_t keyPos = result.find(keyPattern);
+std::vector<RuleFileScan> ScanRuleFiles(const fs::path& dataPath, std::ostream& logFile) {
+    std::vector<RuleFileScan> ruleFiles;
 
-                if (keyPos != std::string::npos) {
-                    size_t colonPos = result.find(":", keyPos);
-                    if (colonPos != std::string::npos) {
-                        size_t valueStart = colonPos + 1;
+    try {
+        std::error_code enumerateError;
+        for (const auto& entry : EnumerateDirectory(dataPath, "OBodyNG_PDA_", ".ini", enumerateError)) {
+            ruleFiles.push_back(ScanRuleFile(entry.path, entry.stamp));
+        }
+        if (enumerateError) throw fs::filesystem_error("directory enumeration", dataPath, enumerateError);
+    } catch (const std::exception& e) {
+        logFile << "ERROR scanning directory: " << e.what() << std::endl;
+    }
 
-                        while (valueStart < result.length() && std::isspace(static_cast<unsigned char>(result[valueStart]))) {
-                            valueStart++;
-                        }
+    return ruleFiles;
+}
 
-                        size_t valueEnd = valueStart;
-                        if (valueStart < result.length() && result[valueStart] == '[') {
-                            int bracketCount = 1;
-                            valueEnd = valueStart + 1;
-                            bool inString = false;
-                            bool escape = false;
+// Catalog and rule files are independent; the Doctor log, preset map and UBE scan only need the
+// catalog. Each stage writes its own PreScanResult buffer, so the graph's node logs stay empty.
+// The Doctor log and the UBE report are left to the deferred phase if this runs past the budget.
+std::shared_ptr<PreScanResult> RunPreScan(const PipelinePaths& paths, const ConfigSettings& config) {
+    auto result = std::make_shared<PreScanResult>();
+    result->startTime = std::chrono::steady_clock::now();
 
-                            while (valueEnd < result.length() && bracketCount > 0) {
-                                char c = result[valueEnd];
+    try {
+        PreScanResult& r = *result;
+        ThreadPool* workerPool = AcquireWorkerPool(ResolveWorkerThreads(config.workerThreads));
+        TaskGraph graph("prescan");
+
+        size_t catalog = graph.Add("preset_catalog", [&](std::ostream&) {
+            r.frameworks = LoadFrameworkTable(paths.frameworkTablePath, r.catalogLog);
+            r.catalogLog << "Preset XML reads: " << ReadBackendDescription(config.readBackend) << std::endl;
+            r.catalog = BuildPresetCatalog(paths.bodySlidePresetsPath, paths.presetCatalogCachePath, r.frameworks,
+                                           r.catalogLog, workerPool, config.readBackend, config.presetClusters);
+        });
+        graph.Add("doctor_log", [&](std::ostream&) {
+            long long elapsedMs = 0;
+            r.doctorLogDeferred = StartupBudgetSpent(config.startupBudgetMs, elapsedMs);
+            if (!r.doctorLogDeferred) GenerateDoctorLog(r.catalog, paths.logDoctorPath, r.doctorLog);
+        }, {catalog});
+        if (config.presetClusters) {
+            graph.Add("preset_clusters", [&](std::ostream&) {
+                long long elapsedMs = 0;
+                r.clustersLogDeferred = StartupBudgetSpent(config.startupBudgetMs, elapsedMs);
+                if (!r.clustersLogDeferred) {
+                    GeneratePresetClustersLog(r.catalog, paths.logClustersPath, ClusterOptionsFromConfig(config),
+                                              workerPool, r.clustersLog);
+                }
+            }, {catalog});
+        }
+        size_t presetMap = graph.Add(
+            "preset_map", [&](std::ostream&) { r.presetMap = BuildPresetNameMap(r.catalog, r.presetMapLog); },
+            {catalog});
+        if (SmartCleaningEnabled(config)) {
+            graph.Add("preset_suggestions", [&](std::ostream&) {
+                r.presetSuggestions.Build(r.presetMap.presetNames, r.presetMap.filenameMappings);
+            }, {presetMap});
+        }
+        graph.Add("shape_index", [&](std::ostream&) { r.shapeIndex = BuildShapeIndex(r.catalog); }, {catalog});
+        graph.Add("rule_file_scan", [&](std::ostream&) { r.ruleFiles = ScanRuleFiles(paths.dataPath, r.ruleScanLog); });
+        graph.Add("ube_scan", [&](std::ostream&) {
+            long long elapsedMs = 0;
+            r.ubeReportDeferred = StartupBudgetSpent(config.startupBudgetMs, elapsedMs);
+            std::ostream discardedReport(nullptr);
+            auto [ubeBlacklist, ubeRaces] =
+                ProcessUBEXmlPresets(r.catalog, r.ubeReportDeferred ? discardedReport : r.ubeScanLog);
+            r.ubePresetsForBlacklist = std::move(ubeBlacklist);
+            r.ubePresetsForRaces = std::move(ubeRaces);
+        }, {catalog});
+
+        graph.Run(workerPool);
+        graph.Collect(r.ruleScanLog, r.stageMetrics);
+    } catch (const std::exception& e) {
+        result->ruleScanLog << "ERROR in early prescan: " << e.what() << std::endl;
+    } catch (...) {
+        result->ruleScanLog << "ERROR in early prescan: Unknown exception" << std::endl;
+    }
 
-                                if (c == '"' && !escape) {
-                                    inString = !inString;
-                                } else if (!inString) {
-                                    if (c == '[')
-                                        bracketCount++;
-                                    else if (c == ']')
-                                        bracketCount--;
-                                }
+    result->finishTime = std::chrono::steady_clock::now();
+    return result;
+}
 
-                                escape = (c == '\\' && !escape);
-                                valueEnd++;
-                            }
+struct EarlyPreScan {
+    std::mutex mutex;
+    bool started = false;
+    std::shared_future<std::shared_ptr<PreScanResult>> future;
+};
 
-                            std::ostringstream newValue;
-                            newValue << "[\n";
+EarlyPreScan g_earlyPreScan;
 
-                            bool first = true;
-                            for (const auto& [plugin, presets] : data.orderedData) {
-                                for (const auto& preset : presets) {
-                                    if (!first) newValue << ",\n";
-                                    first = false;
-                                    newValue << "        \"" << EscapeJson(preset) << "\"";
-                                }
-                            }
+void StartEarlyPreScan(const PipelinePaths& paths) {
+    std::lock_guard<std::mutex> lock(g_earlyPreScan.mutex);
+    if (g_earlyPreScan.started) return;
 
-                            newValue << "\n    ]";
+    auto promise = std::make_shared<std::promise<std::shared_ptr<PreScanResult>>>();
+    g_earlyPreScan.future = promise->get_future().share();
+    g_earlyPreScan.started = true;
 
-                            result.replace(valueStart, valueEnd - valueStart, newValue.str());
-                            logFile << "INFO: Successfully updated array key '" << key
-                                    << "' with proper 4-space indentation" << std::endl;
-                        }
-                    }
-                }
-            }
+    std::thread worker([paths, promise]() {
+        // Only Worker_Threads, Startup_Budget_Ms, Read_Backend, Skip_Unchanged_Runs and the
+        // Preset_Clusters settings matter this early; the config is read (and logged) again at kDataLoaded
+        ConfigSettings config;
+        if (fs::exists(paths.configIniPath)) {
+            std::ostringstream discardedLog;
+            config = ReadConfigFromIni(paths.configIniPath, discardedLog);
+        }
+        // An unchanged launch is skipped at kDataLoaded, so the prescan would only rewrite the Doctor
+        // and clusters logs. No result: AcquirePreScan scans then if the inputs changed meanwhile.
+        if (config.skipUnchangedRuns && InputFingerprintUnchanged(paths)) {
+            promise->set_value(nullptr);
+            return;
         }
+        promise->set_value(RunPreScan(paths, config));
+    });
+    worker.detach();
+}
 
-        if (currentBlacklistedPresetsShowValue != newBlacklistedPresetsShowValue) {
-            std::string keyPattern = "\"blacklistedPresetsShowInOBodyMenu\"";
-            size_t keyPos = result.find(keyPattern);
+// Prescan state the last pipeline run worked from. Watch mode derives each update from it and
+// replaces it; stages still holding the previous one (deferred reports) keep a consistent copy.
+std::mutex g_livePreScanMutex;
+std::shared_ptr<PreScanResult> g_livePreScan;
 
-            if (keyPos != std::string::npos) {
-                size_t colonPos = result.find(":", keyPos);
-                if (colonPos != std::string::npos) {
-                    size_t valueStart = colonPos + 1;
+void SetLivePreScan(std::shared_ptr<PreScanResult> preScan) {
+    std::lock_guard<std::mutex> lock(g_livePreScanMutex);
+    g_livePreScan = std::move(preScan);
+}
 
-                    while (valueStart < result.length() && std::isspace(static_cast<unsigned char>(result[valueStart]))) {
-                        valueStart++;
-                    }
+std::shared_ptr<PreScanResult> GetLivePreScan() {
+    std::lock_guard<std::mutex> lock(g_livePreScanMutex);
+    return g_livePreScan;
+}
 
-                    size_t valueEnd = valueStart;
-                    while (valueEnd < result.length() && 
-                           (std::isalpha(static_cast<unsigned char>(result[valueEnd])) || result[valueEnd] == '_')) {
-                        valueEnd++;
-                    }
+// Joins the early prescan, or runs it inline if it never started (paths were unavailable at load)
+// or was skipped because the inputs were unchanged at load.
+std::shared_ptr<PreScanResult> AcquirePreScan(const PipelinePaths& paths, const ConfigSettings& config,
+                                              std::ostream& logFile) {
+    std::shared_future<std::shared_ptr<PreScanResult>> future;
+    bool started = false;
+    {
+        std::lock_guard<std::mutex> lock(g_earlyPreScan.mutex);
+        started = g_earlyPreScan.started;
+        future = g_earlyPreScan.future;
+    }
+    std::chrono::steady_clock::time_point dataLoadedTime;
+    bool dataLoadedSeen = GetDataLoadedTime(dataLoadedTime);
 
-                    std::string newBoolValue = newBlacklistedPresetsShowValue ? "true" : "false";
-                    result.replace(valueStart, valueEnd - valueStart, newBoolValue);
-                    logFile << "INFO: Updated blacklistedPresetsShowInOBodyMenu to " << newBoolValue << std::endl;
-                }
-            }
-        }
+    if (!started) {
+        logFile << "Early prescan was not started at plugin load, scanning now..." << std::endl;
+        return RunPreScan(paths, config);
+    }
 
-        return result;
-    } catch (const std::exception& e) {
-        logFile << "ERROR in PreserveOriginalSections: " << e.what() << std::endl;
-        return originalJson;
-    } catch (...) {
-        logFile << "ERROR in PreserveOriginalSections: Unknown exception" << std::endl;
-        return originalJson;
+    auto joinStart = std::chrono::steady_clock::now();
+    std::shared_ptr<PreScanResult> result = future.get();
+    auto joinEnd = std::chrono::steady_clock::now();
+
+    if (!result) {
+        logFile << "Early prescan was skipped (inputs unchanged at plugin load), scanning now..." << std::endl;
+        return RunPreScan(paths, config);
     }
+
+    auto toMs = [](std::chrono::steady_clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+    };
+
+    auto hiddenUntil = dataLoadedSeen ? std::min(result->finishTime, dataLoadedTime) : result->startTime;
+    if (hiddenUntil < result->startTime) hiddenUntil = result->startTime;
+
+    logFile << "Early prescan (SliderPresets catalog, UBE scan, OBodyNG_PDA_*.ini parsing):" << std::endl;
+    logFile << "  Prescan wall time: " << toMs(result->finishTime - result->startTime) << " ms" << std::endl;
+    logFile << "  Hidden behind engine loading: " << toMs(hiddenUntil - result->startTime) << " ms" << std::endl;
+    logFile << "  Waited at join: " << toMs(joinEnd - joinStart) << " ms" << std::endl;
+    logFile << std::endl;
+
+    return result;
 }
 
-bool CheckIfChangesNeeded(const std::string& originalJson,
-                         const std::map<std::string, OrderedPluginData>& processedData,
-                         bool currentBlacklistedPresetsShowValue,
-                         bool newBlacklistedPresetsShowValue) {
-    const std::vector<std::string> validKeys = {"npcFormID", "npc", "factionFemale", "factionMale",
-                                                "npcPluginFemale", "npcPluginMale", "raceFemale", "raceMale"};
+// Everything after the config read: integrity check, backup, JSON read, logs, INI rules,
+// Smart Cleaning, UBE and the final JSON commit. Safe to run off the main thread, it touches
+// no game forms and reports back only through the log and the returned outcome.
+// Watch updates pass the prescan state they patched; it replaces the early prescan, and the
+// fingerprint stages are skipped since the update already knows what changed.
+DistributionOutcome RunDistributionPipeline(const PipelinePaths& paths, const ConfigSettings& config,
+                                            std::ostream& logFile, RunMetrics& metrics,
+                                            std::shared_ptr<PreScanResult> watchPreScan = nullptr) {
+    const bool watchUpdate = watchPreScan != nullptr;
+    const fs::path& configIniPath = paths.configIniPath;
+    const fs::path& jsonOutputPath = paths.jsonOutputPath;
+    const fs::path& backupJsonPath = paths.backupJsonPath;
+    const fs::path& analysisDir = paths.analysisDir;
 
-    const std::vector<std::string> arrayKeys = {"blacklistedPresetsFromRandomDistribution", "blacklistedNpcs",
-                                                "blacklistedNpcsPluginFemale", "blacklistedNpcsPluginMale",
-                                                "blacklistedRacesFemale", "blacklistedRacesMale",
-                                                "blacklistedOutfitsFromORefit", "blacklistedOutfitsFromORefitPlugin",
-                                                "outfitsForceRefit"};
+    logFile << std::endl;
+    StageTimer integrityTimer(metrics.stages, "integrity_check");
+    if (!PerformSimpleJsonIntegrityCheck(jsonOutputPath, logFile)) {
+        logFile << std::endl;
+        logFile << "CRITICAL: JSON failed simple integrity check at startup - Attempting to restore "
+                   "from backup..."
+                << std::endl;
 
-    if (currentBlacklistedPresetsShowValue != newBlacklistedPresetsShowValue) {
-        return true;
+        if (RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
+            logFile << "SUCCESS: JSON restored from backup. Proceeding with the normal process."
+                    << std::endl;
+        } else {
+            logFile << std::endl;
+            logFile << "CRITICAL ERROR: Could not restore from backup. The JSON file is likely "
+                       "corrupted and no valid backup is available."
+                    << std::endl;
+            logFile << "Process terminated to prevent further damage." << std::endl;
+            logFile << std::endl;
+            logFile << "RECOMMENDED ACTIONS:" << std::endl;
+            logFile << "1. Check the analysis folder for the corrupted file: " << analysisDir.string()
+                    << std::endl;
+            logFile << "2. Manually check for any older backups or reinstall the mod providing the "
+                       "base JSON file."
+                    << std::endl;
+            logFile << "3. Contact the mod author if the problem persists." << std::endl;
+            logFile << "====================================================" << std::endl;
+
+            return {false,
+                    "CRITICAL ERROR: OBody JSON is corrupted and could not be restored - Check the log file "
+                    "for details."};
+        }
+    }
+    integrityTimer.Stop();
+
+    if (config.skipUnchangedRuns && !watchUpdate) {
+        StageTimer fingerprintTimer(metrics.stages, "fingerprint_check");
+        std::string storedFingerprint = ReadStoredFingerprint(paths.inputFingerprintPath);
+        if (!storedFingerprint.empty()) {
+            InputFingerprint fingerprint = ComputeInputFingerprint(paths);
+            std::string currentFingerprint = FormatFingerprint(fingerprint.hash);
+
+            if (fingerprint.valid && currentFingerprint == storedFingerprint) {
+                logFile << std::endl;
+                logFile << "Input fingerprint unchanged since last successful run (" << currentFingerprint << ")"
+                        << std::endl;
+                logFile << "JSON, config INI, OBodyNG_PDA_*.ini files and SliderPresets are identical - "
+                           "skipping distribution (Skip_Unchanged_Runs = true)"
+                        << std::endl;
+                logFile << "====================================================" << std::endl;
+                metrics.skippedUnchanged = true;
+                return {true, "OBody Assistant: No changes since last run - distribution skipped"};
+            }
+
+            logFile << "Input fingerprint changed (" << storedFingerprint << " -> " << currentFingerprint
+                    << "), running full distribution" << std::endl;
+        }
     }
 
+    logFile << "JSON passed initial integrity check or was restored - proceeding with normal process..."
+            << std::endl;
+    logFile << std::endl;
+
+    const std::set<std::string> validKeys = {
+        "npcFormID",       "npc",           "factionFemale", "factionMale",
+        "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+
+    std::map<std::string, OrderedPluginData> processedData;
     for (const auto& key : validKeys) {
-        auto it = processedData.find(key);
-        if (it != processedData.end() && !it->second.orderedData.empty()) {
-            return true;
-        }
+        processedData[key] = OrderedPluginData();
     }
+    processedData["blacklistedPresetsFromRandomDistribution"] = OrderedPluginData();
+    processedData["blacklistedNpcs"] = OrderedPluginData();
+    processedData["blacklistedNpcsFormID"] = OrderedPluginData();
+    processedData["blacklistedNpcsPluginFemale"] = OrderedPluginData();
+    processedData["blacklistedNpcsPluginMale"] = OrderedPluginData();
+    processedData["blacklistedRacesFemale"] = OrderedPluginData();
+    processedData["blacklistedRacesMale"] = OrderedPluginData();
+    processedData["blacklistedOutfitsFromORefitFormID"] = OrderedPluginData();
+    processedData["blacklistedOutfitsFromORefit"] = OrderedPluginData();
+    processedData["blacklistedOutfitsFromORefitPlugin"] = OrderedPluginData();
+    processedData["outfitsForceRefitFormID"] = OrderedPluginData();
+    processedData["outfitsForceRefit"] = OrderedPluginData();
+
+    bool backupPerformed = false;
+    StageTimer backupTimer(metrics.stages, "backup");
+
+    if (config.backupValue == 1 || config.backupValue == 2) {
+        if (config.backupValue == 2) {
+            logFile << "Backup enabled (Backup = true), performing LITERAL backup always..."
+                    << std::endl;
+        } else {
+            logFile << "Backup enabled (Backup = 1), performing LITERAL backup..." << std::endl;
+        }
 
-    for (const auto& key : arrayKeys) {
-        auto it = processedData.find(key);
-        if (it != processedData.end() && !it->second.orderedData.empty()) {
-            return true;
+        if (PerformLiteralJsonBackup(jsonOutputPath, backupJsonPath, logFile)) {
+            backupPerformed = true;
+            if (config.backupValue != 2) {
+                UpdateBackupConfigInIni(configIniPath, logFile, config.backupValue);
+            }
+        } else {
+            logFile << "ERROR: LITERAL backup failed, continuing with normal process..." << std::endl;
         }
+
+    } else {
+        logFile << "Backup disabled (Backup = 0), skipping backup" << std::endl;
     }
+    backupTimer.Stop();
 
-    return false;
-}
+    logFile << std::endl;
 
-std::tuple<bool, std::string, bool> ReadCompleteJson(const fs::path& jsonPath,
-                                                      std::map<std::string, OrderedPluginData>& processedData,
-                                                      std::ofstream& logFile) {
-    try {
-        if (!fs::exists(jsonPath)) {
-            logFile << "ERROR: JSON file does not exist at: " << jsonPath.string() << std::endl;
-            return {false, "", true};
+    StageTimer readTimer(metrics.stages, "read_json");
+    auto [readSuccess, originalJsonContent, currentBlacklistedPresetsShow] = 
+        ReadCompleteJson(jsonOutputPath, processedData, logFile);
+
+    if (!readSuccess) {
+        logFile << "JSON read failed, attempting to restore from backup..." << std::endl;
+        if (fs::exists(backupJsonPath) &&
+            RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
+            logFile << "Backup restoration successful, retrying JSON read..." << std::endl;
+            auto retryResult = ReadCompleteJson(jsonOutputPath, processedData, logFile);
+            readSuccess = std::get<0>(retryResult);
+            originalJsonContent = std::get<1>(retryResult);
+            currentBlacklistedPresetsShow = std::get<2>(retryResult);
         }
 
-        if (!PerformTripleValidation(jsonPath, fs::path(), logFile)) {
-            logFile << "ERROR: JSON integrity check failed" << std::endl;
-            return {false, "", true};
+        if (!readSuccess) {
+            logFile
+                << "Process truncated due to JSON read error. No INI processing or updates performed."
+                << std::endl;
+            logFile << "====================================================" << std::endl;
+
+            return {false, "ERROR: JSON READ FAILED - CONTACT MODDER OR REINSTALL"};
+        } else {
+            logFile << "JSON read successful after restoration" << std::endl;
         }
+    }
+    readTimer.Stop();
 
-        logFile << "Reading existing JSON from: " << jsonPath.string() << std::endl;
+    const std::map<std::string, OrderedPluginData> originalData = processedData;
 
-        std::string jsonContent = ReadFileWithEncoding(jsonPath);
+    ThreadPool* workerPool = AcquireWorkerPool(ResolveWorkerThreads(config.workerThreads));
 
-        if (jsonContent.empty() || jsonContent.size() < 2) {
-            logFile << "ERROR: JSON file is empty or too small after reading" << std::endl;
-            return {false, "", true};
+    std::shared_ptr<PreScanResult> preScan = watchPreScan;
+    if (!preScan) {
+        StageTimer prescanJoinTimer(metrics.stages, "prescan_join");
+        preScan = AcquirePreScan(paths, config, logFile);
+    }
+    SetLivePreScan(preScan);
+    metrics.stages.insert(metrics.stages.end(), preScan->stageMetrics.begin(), preScan->stageMetrics.end());
+    metrics.xmlPresets = preScan->catalog.entries.size();
+    metrics.ruleFiles = preScan->ruleFiles.size();
+
+    logFile << preScan->catalogLog.str();
+    logFile << preScan->doctorLog.str();
+    logFile << preScan->clustersLog.str();
+
+    logFile << preScan->presetMapLog.str();
+
+    // Past the budget, the report stages are queued (in their usual order) for after the main menu
+    long long startupElapsedMs = 0;
+    bool deferReportLogs = !watchUpdate && StartupBudgetSpent(config.startupBudgetMs, startupElapsedMs);
+    std::vector<DeferredStage> deferredStages;
+
+    if (preScan->doctorLogDeferred) {
+        deferredStages.push_back({"doctor_log", [preScan, paths](std::ostream& log) {
+                                      GenerateDoctorLog(preScan->catalog, paths.logDoctorPath, log);
+                                  }});
+    }
+    if (preScan->clustersLogDeferred) {
+        deferredStages.push_back({"preset_clusters", [preScan, paths, config, workerPool](std::ostream& log) {
+                                      GeneratePresetClustersLog(preScan->catalog, paths.logClustersPath,
+                                                                ClusterOptionsFromConfig(config), workerPool, log);
+                                  }});
+    }
+    if (deferReportLogs) {
+        deferredStages.push_back({"smart_cleaning_log", [preScan, paths](std::ostream& log) {
+                                      GenerateSmartCleaningLog(preScan->presetMap, paths.logSmartCleaningPath, log);
+                                  }});
+        deferredStages.push_back({"helper_log", [preScan, paths](std::ostream& log) {
+                                      GenerateHelperLog(preScan->presetMap, paths.logHelperPath, log);
+                                  }});
+    }
+    if (preScan->ubeReportDeferred) {
+        deferredStages.push_back({"ube_conflict_report", [preScan](std::ostream& log) {
+                                      ProcessUBEXmlPresets(preScan->catalog, log);
+                                  }});
+    }
+
+    if (!deferredStages.empty()) {
+        logFile << "Startup budget of " << config.startupBudgetMs << " ms spent (" << startupElapsedMs
+                << " ms since kDataLoaded) - deferred until after the main menu:";
+        for (const auto& stage : deferredStages) {
+            logFile << " " << stage.name;
         }
+        logFile << std::endl;
+        logFile << "JSON repair, INI rules, Smart Cleaning and UBE distribution still finish now." << std::endl;
+        logFile << std::endl;
+    }
+    if (!watchUpdate) QueueDeferredStages(std::move(deferredStages), paths.logFilePath, config.startupBudgetMs);
 
-        const std::vector<std::string> validKeys = {"npcFormID",       "npc",           "factionFemale", "factionMale",
-                                                    "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+    int totalRulesProcessed = 0;
+    int totalRulesApplied = 0;
+    int totalRulesSkipped = 0;
+    int totalPresetsRemoved = 0;
+    int totalPluginsRemoved = 0;
+    int totalFilesProcessed = 0;
+
+    // Counter rewrites are collected per file and written by their own stage, off the path of
+    // Smart Cleaning and UBE, which only need the JSON model.
+    std::vector<std::pair<fs::path, std::vector<std::pair<std::string, int>>>> pendingCounterUpdates;
+    std::vector<std::string> missingPresetsFromIni;
+    bool ubeChangesApplied = false;
+    const auto& allPresetsForBlacklist = preScan->ubePresetsForBlacklist;
+    const auto& presetsForRaces = preScan->ubePresetsForRaces;
+
+    // Declared in the old sequential order; only the JSON model stages are chained.
+    TaskGraph graph("pipeline");
+    if (!deferReportLogs && !preScan->reportLogsCurrent) {
+        graph.Add("smart_cleaning_log", [&](std::ostream& log) {
+            GenerateSmartCleaningLog(preScan->presetMap, paths.logSmartCleaningPath, log);
+        });
+        graph.Add("helper_log", [&](std::ostream& log) {
+            GenerateHelperLog(preScan->presetMap, paths.logHelperPath, log);
+        });
+    }
+    size_t ruleLoop = graph.Add("ini_rule_loop", [&](std::ostream& log) {
+        log << "Scanning for OBodyNG_PDA_*.ini files..." << std::endl;
+        log << "----------------------------------------------------" << std::endl;
+        log << preScan->ruleScanLog.str();
 
-        const std::vector<std::string> arrayKeys = {"blacklistedPresetsFromRandomDistribution", "blacklistedNpcs",
-                                                     "blacklistedNpcsFormID", "blacklistedNpcsPluginFemale",
-                                                     "blacklistedNpcsPluginMale", "blacklistedRacesFemale",
-                                                     "blacklistedRacesMale", "blacklistedOutfitsFromORefitFormID",
-                                                     "blacklistedOutfitsFromORefit", "blacklistedOutfitsFromORefitPlugin",
-                                                     "outfitsForceRefitFormID", "outfitsForceRefit"};
+        try {
+            std::map<std::string, std::vector<std::string>> resolvedSelectors;
+            for (const auto& ruleFile : preScan->ruleFiles) {
+                log << std::endl << "Processing file: " << ruleFile.filename << std::endl;
+                totalFilesProcessed++;
 
-        for (const auto& key : validKeys) {
-            processedData[key] = OrderedPluginData();
+                if (ruleFile.readFailed) {
+                    log << "  ERROR: Could not read file" << std::endl;
+                    continue;
+                }
 
-            size_t keyPos = jsonContent.find("\"" + key + "\"");
-            if (keyPos != std::string::npos) {
-                size_t colonPos = jsonContent.find(":", keyPos);
-                if (colonPos != std::string::npos) {
-                    size_t openBrace = jsonContent.find("{", colonPos);
-                    if (openBrace != std::string::npos) {
-                        int braceCount = 1;
-                        size_t pos = openBrace + 1;
-                        size_t closeBrace = std::string::npos;
-                        bool inString = false;
-                        bool escape = false;
+                std::vector<std::pair<std::string, int>> counterUpdates;
+                int rulesInFile = 0;
+                int rulesAppliedInFile = 0;
+                int rulesSkippedInFile = 0;
+                int presetsRemovedInFile = 0;
+                int pluginsRemovedInFile = 0;
+                counterUpdates.reserve(100);
+
+                for (const auto& [originalLine, parsedRule] : ruleFile.rules) {
+                    ParsedRule rule = parsedRule;
+                    const std::string& key = rule.key;
+                    if (std::any_of(rule.presets.begin(), rule.presets.end(), IsShapeSelector)) {
+                        rule.presets =
+                            ExpandShapeSelectors(rule.presets, preScan->shapeIndex, resolvedSelectors, log);
+                    }
 
-                        while (pos < jsonContent.length() && braceCount > 0) {
-                            char c = jsonContent[pos];
+                    rulesInFile++;
+                    totalRulesProcessed++;
+
+                    bool shouldApply = false;
+                    bool needsUpdate = false;
+                    int newCount = rule.applyCount;
+
+                    if (rule.applyCount == -1 || rule.applyCount == -2 ||
+                        rule.applyCount == -3 || rule.applyCount == -4 ||
+                        rule.applyCount == -5 || rule.applyCount > 0) {
+                        shouldApply = true;
+                        if (rule.applyCount > 0) {
+                            needsUpdate = true;
+                            newCount = rule.applyCount - 1;
+                        } else if (rule.applyCount == -2 || rule.applyCount == -3) {
+                            needsUpdate = true;
+                            newCount = 0;
+                        }
 
-                            if (c == '"' && !escape) {
-                                inString = !inString;
-                            } else if (!inString) {
-                                if (c == '{') {
-                                    braceCount++;
-                                } else if (c == '}') {
-                                    braceCount--;
-                                    if (braceCount == 0) {
-                                        closeBrace = pos;
-                                        break;
-                                    }
+                    } else {
+                        shouldApply = false;
+                        rulesSkippedInFile++;
+                        totalRulesSkipped++;
+
+                        if (rule.extra != "0") {
+                            needsUpdate = true;
+                            newCount = 0;
+                            rule.applyCount = newCount;
+                            counterUpdates.emplace_back(originalLine, newCount);
+                            log << "  Skipped (invalid mode detected in extra '"
+                                    << rule.extra << "', setting to 0): " << key
+                                    << " -> Plugin: " << rule.plugin << std::endl;
+                        } else {
+                            log << "  Skipped (count=0): " << key
+                                    << " -> Plugin: " << rule.plugin << std::endl;
+                        }
+                    }
+
+                    if (shouldApply) {
+                        auto& data = processedData[key];
+
+                        if (rule.applyCount == -1) {
+                            int presetsAdded = 0;
+                            for (const auto& preset : rule.presets) {
+                                size_t beforeCount = data.getTotalPresetCount();
+                                data.addPreset(rule.plugin, preset);
+                                if (data.getTotalPresetCount() > beforeCount) {
+                                    presetsAdded++;
                                 }
                             }
 
-                            escape = (c == '\\' && !escape);
-                            pos++;
-                        }
+                            if (presetsAdded > 0) {
+                                rulesAppliedInFile++;
+                                totalRulesApplied++;
+                                log << "  Applied: " << key
+                                        << " -> Plugin: " << rule.plugin << " -> Added "
+                                        << presetsAdded << " new presets";
+                                if (!rule.extra.empty()) {
+                                    log << " (mode: " << rule.extra << ")";
+                                }
+                                log << std::endl;
+                            } else {
+                                log
+                                    << "  No new presets added (all already exist): "
+                                    << key << " -> Plugin: " << rule.plugin
+                                    << std::endl;
+                            }
 
-                        if (closeBrace != std::string::npos) {
-                            std::string keyContent = jsonContent.substr(openBrace + 1, closeBrace - openBrace - 1);
-                            auto orderedPlugins = parseOrderedPlugins(keyContent);
+                        } else if (rule.applyCount == -4 || rule.applyCount == -2) {
+                            int presetsRemoved = 0;
+                            for (const auto& preset : rule.presets) {
+                                std::string targetPreset = preset;
+                                if (!targetPreset.empty() && targetPreset[0] == '!') {
+                                    targetPreset = targetPreset.substr(1);
+                                }
 
-                            for (const auto& p : orderedPlugins) {
-                                for (const auto& preset : p.second) {
-                                    processedData[key].addPreset(p.first, preset);
+                                size_t beforeCount = data.getTotalPresetCount();
+                                data.removePreset(rule.plugin, targetPreset);
+                                if (data.getTotalPresetCount() < beforeCount) {
+                                    presetsRemoved++;
                                 }
                             }
-                        }
-                    }
-                }
-            }
-        }
 
-        for (const auto& key : arrayKeys) {
-            processedData[key] = OrderedPluginData();
+                            if (presetsRemoved > 0) {
+                                rulesAppliedInFile++;
+                                totalRulesApplied++;
+                                totalPresetsRemoved += presetsRemoved;
+                                presetsRemovedInFile += presetsRemoved;
+                                log << "  Applied: " << key
+                                        << " -> Plugin: " << rule.plugin
+                                        << " -> Removed " << presetsRemoved
+                                        << " presets";
+                                if (!rule.extra.empty()) {
+                                    log << " (mode: " << rule.extra << ")";
+                                }
+                                log << std::endl;
 
-            size_t keyPos = jsonContent.find("\"" + key + "\"");
-            if (keyPos != std::string::npos) {
-                size_t colonPos = jsonContent.find(":", keyPos);
-                if (colonPos != std::string::npos) {
-                    size_t openBracket = jsonContent.find("[", colonPos);
-                    if (openBracket != std::string::npos) {
-                        int bracketCount = 1;
-                        size_t pos = openBracket + 1;
-                        size_t closeBracket = std::string::npos;
-                        bool inString = false;
-                        bool escape = false;
+                                if (rule.applyCount == -2) {
+                                    needsUpdate = true;
+                                    newCount = 0;
+                                }
+                            } else {
+                                log << "  No presets removed (not found): " << key
+                                        << " -> Plugin: " << rule.plugin << std::endl;
+                            }
 
-                        while (pos < jsonContent.length() && bracketCount > 0) {
-                            char c = jsonContent[pos];
+                        } else if (rule.applyCount == -5 || rule.applyCount == -3) {
+                            if (data.hasPlugin(rule.plugin)) {
+                                data.removePlugin(rule.plugin);
+                                rulesAppliedInFile++;
+                                totalRulesApplied++;
+                                totalPluginsRemoved++;
+                                pluginsRemovedInFile++;
+                                log << "  Applied: " << key
+                                        << " -> Plugin: " << rule.plugin
+                                        << " -> REMOVED ENTIRE PLUGIN";
+                                if (!rule.extra.empty()) {
+                                    log << " (mode: " << rule.extra << ")";
+                                }
+                                log << std::endl;
 
-                            if (c == '"' && !escape) {
-                                inString = !inString;
-                            } else if (!inString) {
-                                if (c == '[') {
-                                    bracketCount++;
-                                } else if (c == ']') {
-                                    bracketCount--;
-                                    if (bracketCount == 0) {
-                                        closeBracket = pos;
-                                        break;
-                                    }
+                                if (rule.applyCount == -3) {
+                                    needsUpdate = true;
+                                    newCount = 0;
                                 }
+                            } else {
+                                log << "  No plugin removed (not found): " << key
+                                        << " -> Plugin: " << rule.plugin << std::endl;
                             }
 
-                            escape = (c == '\\' && !escape);
-                            pos++;
-                        }
-
-                        if (closeBracket != std::string::npos) {
-                            std::string keyContent = jsonContent.substr(openBracket + 1, closeBracket - openBracket - 1);
-                            auto arrayValues = parseArray(keyContent);
+                        } else if (rule.applyCount > 0) {
+                            int presetsAdded = 0;
+                            for (const auto& preset : rule.presets) {
+                                size_t beforeCount = data.getTotalPresetCount();
+                                data.addPreset(rule.plugin, preset);
+                                if (data.getTotalPresetCount() > beforeCount) {
+                                    presetsAdded++;
+                                }
+                            }
 
-                            for (const auto& value : arrayValues) {
-                                processedData[key].addPreset("", value);
+                            if (presetsAdded > 0) {
+                                rulesAppliedInFile++;
+                                totalRulesApplied++;
+                                log << "  Applied: " << key
+                                        << " -> Plugin: " << rule.plugin << " -> Added "
+                                        << presetsAdded
+                                        << " new presets (remaining count: " << newCount
+                                        << ")";
+                                if (!rule.extra.empty()) {
+                                    log << " (mode: " << rule.extra << ")";
+                                }
+                                log << std::endl;
+                            } else {
+                                log
+                                    << "  No new presets added (all already exist): "
+                                    << key << " -> Plugin: " << rule.plugin
+                                    << " (remaining count: " << newCount << ")"
+                                    << std::endl;
                             }
                         }
+
+                        if (needsUpdate) {
+                            rule.applyCount = newCount;
+                            counterUpdates.emplace_back(originalLine, newCount);
+                        }
                     }
                 }
-            }
-        }
 
-        bool blacklistedPresetsShowValue = true;
-        std::string boolKey = "\"blacklistedPresetsShowInOBodyMenu\"";
-        size_t boolKeyPos = jsonContent.find(boolKey);
-        if (boolKeyPos != std::string::npos) {
-            size_t colonPos = jsonContent.find(":", boolKeyPos);
-            if (colonPos != std::string::npos) {
-                size_t valueStart = colonPos + 1;
-                while (valueStart < jsonContent.length() && std::isspace(static_cast<unsigned char>(jsonContent[valueStart]))) {
-                    valueStart++;
+                if (!counterUpdates.empty()) {
+                    pendingCounterUpdates.emplace_back(ruleFile.path, std::move(counterUpdates));
                 }
 
-                size_t valueEnd = valueStart;
-                while (valueEnd < jsonContent.length() && 
-                       (std::isalpha(static_cast<unsigned char>(jsonContent[valueEnd])) || jsonContent[valueEnd] == '_')) {
-                    valueEnd++;
+                log << "  Rules in file: " << rulesInFile
+                        << " | Applied: " << rulesAppliedInFile
+                        << " | Skipped: " << rulesSkippedInFile
+                        << " | Presets removed: " << presetsRemovedInFile
+                        << " | Plugins removed: " << pluginsRemovedInFile << std::endl;
+            }
+        } catch (const std::exception& e) {
+            log << "ERROR scanning directory: " << e.what() << std::endl;
+        }
+    });
+    graph.Add("ini_counter_update", [&](std::ostream&) {
+        for (const auto& [iniPath, updates] : pendingCounterUpdates) {
+            UpdateIniRuleCounts(iniPath, updates);
+        }
+        // Watch mode applies later edits on top of these rules, so they must carry the new counts
+        if (config.watchMode) {
+            for (auto& ruleFile : preScan->ruleFiles) {
+                for (const auto& [iniPath, updates] : pendingCounterUpdates) {
+                    if (ruleFile.path == iniPath) ruleFile = ScanRuleFile(iniPath);
                 }
-
-                std::string boolValue = jsonContent.substr(valueStart, valueEnd - valueStart);
-                blacklistedPresetsShowValue = parseBooleanValue(boolValue);
-                logFile << "Read blacklistedPresetsShowInOBodyMenu: " << (blacklistedPresetsShowValue ? "true" : "false") << std::endl;
             }
         }
+    }, {ruleLoop});
+    size_t smartCleaning = graph.Add("smart_cleaning", [&](std::ostream& log) {
+        SmartCleaningCounts counts = PerformSmartCleaning(processedData, config, preScan->presetMap,
+                                                          preScan->presetSuggestions, workerPool, log,
+                                                          missingPresetsFromIni);
+        metrics.presetReferences = counts.references;
+        metrics.uniquePresetReferences = counts.uniqueNames;
+    }, {ruleLoop});
+    graph.Add("ube_apply", [&](std::ostream& log) {
+        log << preScan->ubeScanLog.str();
+        ubeChangesApplied = ApplyUBEPresetsToJson(processedData, allPresetsForBlacklist, presetsForRaces, log);
+    }, {smartCleaning});
+
+    graph.Run(workerPool);
+    graph.Collect(logFile, metrics.stages);
 
-        logFile << "Loaded existing data from JSON:" << std::endl;
-        for (const auto& [key, data] : processedData) {
-            size_t count = data.getTotalPresetCount();
-            if (count > 0) {
-                logFile << "  " << key << ": " << data.getPluginCount() << " plugins, " << count << " presets"
-                        << std::endl;
-            }
+    logFile << std::endl;
+    logFile << "====================================================" << std::endl;
+    logFile << "SUMMARY:" << std::endl;
+
+    if (backupPerformed) {
+        try {
+            auto backupSize = fs::file_size(backupJsonPath);
+            logFile << "Original JSON backup: SUCCESS (" << backupSize << " bytes)" << std::endl;
+        } catch (...) {
+            logFile << "Original JSON backup: SUCCESS (size verification failed)" << std::endl;
         }
-        logFile << std::endl;
 
-        return {true, jsonContent, blacklistedPresetsShowValue};
-    } catch (const std::exception& e) {
-        logFile << "ERROR in ReadCompleteJson: " << e.what() << std::endl;
-        return {false, "", true};
-    } catch (...) {
-        logFile << "ERROR in ReadCompleteJson: Unknown exception occurred" << std::endl;
-        return {false, "", true};
+    } else {
+        logFile << "Original JSON backup: SKIPPED" << std::endl;
     }
-}
 
-bool WriteJsonAtomically(const fs::path& jsonPath, const std::string& content, const fs::path& analysisDir,
-                         std::ofstream& logFile) {
+    logFile << "Total .ini files processed: " << totalFilesProcessed << std::endl;
+    logFile << "Total rules processed: " << totalRulesProcessed << std::endl;
+    logFile << "Total rules applied: " << totalRulesApplied << std::endl;
+    logFile << "Total rules skipped (count=0): " << totalRulesSkipped << std::endl;
+    logFile << "Total presets removed (-): " << totalPresetsRemoved << std::endl;
+    logFile << "Total plugins removed (*): " << totalPluginsRemoved << std::endl;
+    logFile << "UBE XML presets found: " << allPresetsForBlacklist.size() << std::endl;
+    logFile << "UBE presets added to races: " << presetsForRaces.size() << std::endl;
+    logFile << "UBE changes applied: " << (ubeChangesApplied ? "YES" : "NO") << std::endl;
+    logFile << "SliderPresets XML files opened (single catalog pass): " << preScan->catalog.xmlFilesOpened << std::endl;
+    logFile << "Preset catalog cache hits/misses/evictions: " << preScan->catalog.cacheHits << "/"
+            << preScan->catalog.cacheMisses << "/" << preScan->catalog.cacheEvictions << std::endl;
+    logFile << "Files opened this run (all stages): " << g_filesOpened.load() << std::endl;
+    logFile << "Smart Cleaning enabled (any): " << (SmartCleaningEnabled(config) ? "YES" : "NO") << std::endl;
+    logFile << "Current blacklistedPresetsShowInOBodyMenu: " << (currentBlacklistedPresetsShow ? "true" : "false") << std::endl;
+    logFile << "Target blacklistedPresetsShowInOBodyMenu (ModeUBE): " << (config.modeUBE ? "true" : "false") << std::endl;
+    logFile << std::endl << "Final data in JSON:" << std::endl;
+
+    for (const auto& [key, data] : processedData) {
+        size_t count = data.getTotalPresetCount();
+        if (count > 0) {
+            logFile << "  " << key << ": " << data.getPluginCount() << " plugins, " << count
+                    << " total presets" << std::endl;
+        }
+    }
+
+    logFile << "====================================================" << std::endl << std::endl;
+
+    logFile << "Updating JSON at: " << jsonOutputPath.string() << std::endl;
+
+    bool jsonStateVerified = false;
+
     try {
-        fs::path tempPath = jsonPath;
-        tempPath.replace_extension(".tmp");
+        JsonModelDiff modelDiff =
+            CompareJsonModels(originalData, processedData, currentBlacklistedPresetsShow, config.modeUBE);
+
+        if (modelDiff.changed) {
+            logFile << "Changes detected (INI rules, UBE XML, Smart Cleaning, or ModeUBE):" << std::endl;
+            for (const auto& section : modelDiff.sections) {
+                logFile << "  " << section.key << ": +" << section.added << " added, -" << section.removed
+                        << " removed" << (section.reordered ? ", order changed" : "") << std::endl;
+            }
+            if (modelDiff.blacklistedPresetsShowChanged) {
+                logFile << "  blacklistedPresetsShowInOBodyMenu: " << (currentBlacklistedPresetsShow ? "true" : "false")
+                        << " -> " << (config.modeUBE ? "true" : "false") << std::endl;
+            }
+            logFile << "Proceeding with atomic write..." << std::endl;
 
-        std::ofstream tempFile(tempPath, std::ios::out | std::ios::trunc | std::ios::binary);
-        if (!tempFile.is_open()) {
-            logFile << "ERROR: Could not create temporary JSON file" << std::endl;
-            return false;
+            StageTimer writeTimer(metrics.stages, "json_write");
+            std::string updatedJsonContent = PreserveOriginalSections(
+                originalJsonContent, processedData, currentBlacklistedPresetsShow, config.modeUBE, logFile);
+            bool written = WriteJsonAtomically(jsonOutputPath, updatedJsonContent, analysisDir, logFile);
+            writeTimer.Stop();
+
+            if (written) {
+                logFile << "SUCCESS: JSON updated successfully with proper 4-space indentation hierarchy"
+                        << std::endl;
+
+                logFile << std::endl;
+                StageTimer reformatTimer(metrics.stages, "json_reformat");
+                bool reformatted = CorrectJsonIndentation(jsonOutputPath, analysisDir, logFile);
+                reformatTimer.Stop();
+                if (reformatted) {
+                    logFile << "SUCCESS: JSON indentation verification and correction completed"
+                            << std::endl;
+                    jsonStateVerified = true;
+                } else {
+                    logFile << "ERROR: JSON indentation correction failed" << std::endl;
+                    logFile << "Attempting to restore from backup due to indentation failure..."
+                            << std::endl;
+                    if (fs::exists(backupJsonPath) &&
+                        RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
+                        logFile << "SUCCESS: JSON restored from backup after indentation failure"
+                                << std::endl;
+                    } else {
+                        logFile << "CRITICAL ERROR: Could not restore JSON from backup" << std::endl;
+                    }
+                }
+            } else {
+                logFile << "ERROR: Failed to write JSON safely" << std::endl;
+                logFile << "Attempting to restore from backup due to write failure..." << std::endl;
+                if (fs::exists(backupJsonPath) &&
+                    RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
+                    logFile << "SUCCESS: JSON restored from backup after write failure" << std::endl;
+                } else {
+                    logFile << "CRITICAL ERROR: Could not restore JSON from backup" << std::endl;
+                }
+            }
+        } else {
+            // The original already passed the triple validation in ReadCompleteJson, so there is
+            // nothing to write and nothing to re-indent.
+            logFile << "No changes detected: processed data matches the existing JSON section by section." << std::endl;
+            logFile << "Skipping atomic write and indentation pass." << std::endl;
+            jsonStateVerified = true;
         }
 
-        tempFile << content;
-        tempFile.close();
+    } catch (const std::exception& e) {
+        logFile << "ERROR in JSON update process: " << e.what() << std::endl;
+        logFile << "Attempting to restore from backup due to update failure..." << std::endl;
+        if (fs::exists(backupJsonPath) &&
+            RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
+            logFile << "SUCCESS: JSON restored from backup after update failure" << std::endl;
+        } else {
+            logFile << "CRITICAL ERROR: Could not restore JSON from backup" << std::endl;
+        }
 
-        if (tempFile.fail()) {
-            logFile << "ERROR: Failed to write to temporary JSON file" << std::endl;
-            return false;
+    } catch (...) {
+        logFile << "ERROR in JSON update process: Unknown exception" << std::endl;
+        logFile << "Attempting to restore from backup due to unknown failure..." << std::endl;
+        if (fs::exists(backupJsonPath) &&
+            RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
+            logFile << "SUCCESS: JSON restored from backup after unknown failure" << std::endl;
+        } else {
+            logFile << "CRITICAL ERROR: Could not restore JSON from backup" << std::endl;
         }
+    }
 
-        if (!PerformTripleValidation(tempPath, fs::path(), logFile)) {
-            logFile << "ERROR: Temporary JSON file failed integrity check" << std::endl;
-            MoveCorruptedJsonToAnalysis(tempPath, analysisDir, logFile);
-            try {
-                fs::remove(tempPath);
-            } catch (...) {
+    // Taken after the write and the INI counter updates (one-shot rules are already at 0),
+    // so it describes exactly the state the next launch will see.
+    if (config.skipUnchangedRuns && watchUpdate) {
+        // Storing one would take the full SliderPresets manifest; the next launch simply runs
+        ClearStoredFingerprint(paths.inputFingerprintPath);
+    } else if (config.skipUnchangedRuns) {
+        StageTimer fingerprintTimer(metrics.stages, "fingerprint_store");
+        if (!jsonStateVerified) {
+            ClearStoredFingerprint(paths.inputFingerprintPath);
+            logFile << "Input fingerprint not stored: JSON update did not complete cleanly" << std::endl;
+        } else {
+            InputFingerprint fingerprint = ComputeInputFingerprint(paths);
+            if (fingerprint.valid) {
+                StoreFingerprint(paths.inputFingerprintPath, FormatFingerprint(fingerprint.hash), logFile);
+                logFile << "Input fingerprint stored: " << FormatFingerprint(fingerprint.hash) << std::endl;
+            } else {
+                ClearStoredFingerprint(paths.inputFingerprintPath);
+                logFile << "Input fingerprint not stored: inputs could not be fully read" << std::endl;
             }
-            return false;
         }
+    }
 
-        std::error_code ec;
-        fs::rename(tempPath, jsonPath, ec);
+    logFile << std::endl
+            << "Process completed successfully with perfect 4-space JSON formatting."
+            << std::endl;
 
-        if (ec) {
-            logFile << "ERROR: Failed to move temporary file to final location: " << ec.message() << std::endl;
-            try {
-                fs::remove(tempPath);
-            } catch (...) {
+    return {true, "OBody Assistant: Process completed successfully"};
+}
+
+// ===== RUN METRICS REPORT =====
+
+static constexpr size_t METRICS_HISTORY_MAX_ROWS = 200;
+
+std::uint64_t GetPeakWorkingSetBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    counters.cb = sizeof(counters);
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<std::uint64_t>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    // Peak resident set size; Linux reports ru_maxrss in kilobytes
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+    }
+    return 0;
+#endif
+}
+
+// Totals are process-wide, so they include the early prescan that ran before kDataLoaded.
+void WriteRunMetrics(const PipelinePaths& paths, const RunMetrics& metrics, const DistributionOutcome& outcome,
+                     bool ranInBackground, std::ostream& logFile) {
+    try {
+        double totalMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - metrics.startTime).count();
+        std::uint64_t bytesRead = g_bytesRead.load();
+        std::uint64_t bytesWritten = g_bytesWritten.load();
+        size_t filesOpened = g_filesOpened.load();
+        std::uint64_t peakWorkingSet = GetPeakWorkingSetBytes();
+        std::uint64_t xmlBytesMapped = g_xmlBytesMapped.load();
+        std::uint64_t xmlBytesTouched = g_xmlBytesTouched.load();
+        double uniqueReferenceRatio =
+            metrics.presetReferences ? double(metrics.uniquePresetReferences) / metrics.presetReferences : 0.0;
+
+        auto now = std::chrono::system_clock::now();
+        std::time_t in_time_t = std::chrono::system_clock::to_time_t(now);
+        std::tm buf = LocalTime(in_time_t);
+        std::ostringstream timestamp;
+        timestamp << std::put_time(&buf, "%Y-%m-%d %H:%M:%S");
+
+        std::ofstream metricsFile(paths.logMetricsPath, std::ios::out | std::ios::trunc);
+        if (!metricsFile.is_open()) {
+            logFile << "WARNING: Could not write metrics file: " << paths.logMetricsPath.string() << std::endl;
+            return;
+        }
+
+        metricsFile << std::fixed << std::setprecision(3);
+        metricsFile << "{\n";
+        metricsFile << "    \"pluginVersion\": \"" << PLUGIN_VERSION << "\",\n";
+        metricsFile << "    \"timestamp\": \"" << timestamp.str() << "\",\n";
+        metricsFile << "    \"success\": " << (outcome.success ? "true" : "false") << ",\n";
+        metricsFile << "    \"message\": \"" << EscapeJson(outcome.consoleMessage) << "\",\n";
+        metricsFile << "    \"ranInBackground\": " << (ranInBackground ? "true" : "false") << ",\n";
+        metricsFile << "    \"skippedUnchanged\": " << (metrics.skippedUnchanged ? "true" : "false") << ",\n";
+        metricsFile << "    \"totalWallMs\": " << totalMs << ",\n";
+        metricsFile << "    \"bytesRead\": " << bytesRead << ",\n";
+        metricsFile << "    \"bytesWritten\": " << bytesWritten << ",\n";
+        metricsFile << "    \"filesOpened\": " << filesOpened << ",\n";
+        metricsFile << "    \"peakWorkingSetBytes\": " << peakWorkingSet << ",\n";
+        metricsFile << "    \"xmlPresets\": " << metrics.xmlPresets << ",\n";
+        metricsFile << "    \"xmlBytesMapped\": " << xmlBytesMapped << ",\n";
+        metricsFile << "    \"xmlBytesTouched\": " << xmlBytesTouched << ",\n";
+        metricsFile << "    \"ruleFiles\": " << metrics.ruleFiles << ",\n";
+        metricsFile << "    \"presetReferences\": " << metrics.presetReferences << ",\n";
+        metricsFile << "    \"uniquePresetReferences\": " << metrics.uniquePresetReferences << ",\n";
+        metricsFile << "    \"uniquePresetReferenceRatio\": " << uniqueReferenceRatio << ",\n";
+        metricsFile << "    \"stages\": [";
+
+        bool first = true;
+        for (const auto& stage : metrics.stages) {
+            metricsFile << (first ? "\n" : ",\n");
+            first = false;
+            metricsFile << "        {\n";
+            metricsFile << "            \"name\": \"" << EscapeJson(stage.name) << "\",\n";
+            metricsFile << "            \"thread\": \"" << EscapeJson(stage.thread) << "\",\n";
+            metricsFile << "            \"wallMs\": " << stage.wallMs << ",\n";
+            metricsFile << "            \"bytesRead\": " << stage.bytesRead << ",\n";
+            metricsFile << "            \"bytesWritten\": " << stage.bytesWritten << ",\n";
+            metricsFile << "            \"filesOpened\": " << stage.filesOpened << "\n";
+            metricsFile << "        }";
+        }
+        metricsFile << (first ? "]\n" : "\n    ]\n");
+        metricsFile << "}\n";
+        metricsFile.close();
+
+        double prescanMs = 0.0;
+        for (const auto& stage : metrics.stages) {
+            if (stage.thread == "prescan") prescanMs += stage.wallMs;
+        }
+
+        const std::string historyHeader =
+            "timestamp,version,success,skipped_unchanged,background,total_ms,prescan_ms,bytes_read,bytes_written,"
+            "files_opened,peak_working_set_bytes,xml_presets,xml_bytes_mapped,xml_bytes_touched,rule_files,"
+            "preset_references,unique_preset_references";
+
+        std::vector<std::string> rows;
+        if (fs::exists(paths.logMetricsHistoryPath)) {
+            std::ifstream historyIn(paths.logMetricsHistoryPath);
+            std::string line;
+            bool headerLine = true;
+            while (std::getline(historyIn, line)) {
+                if (headerLine) {
+                    headerLine = false;
+                    if (line != historyHeader) break;  // Columns changed: start a fresh history
+                    continue;
+                }
+                if (!line.empty()) rows.push_back(line);
             }
-            return false;
         }
 
-        if (PerformTripleValidation(jsonPath, fs::path(), logFile)) {
-            logFile << "SUCCESS: JSON file written atomically and verified" << std::endl;
-            return true;
-        } else {
-            logFile << "ERROR: Final JSON file failed integrity check" << std::endl;
-            MoveCorruptedJsonToAnalysis(jsonPath, analysisDir, logFile);
-            return false;
+        std::ostringstream row;
+        row << std::fixed << std::setprecision(3);
+        row << timestamp.str() << "," << PLUGIN_VERSION << "," << (outcome.success ? 1 : 0) << ","
+            << (metrics.skippedUnchanged ? 1 : 0) << "," << (ranInBackground ? 1 : 0) << "," << totalMs << ","
+            << prescanMs << "," << bytesRead << "," << bytesWritten << "," << filesOpened << "," << peakWorkingSet
+            << "," << metrics.xmlPresets << "," << xmlBytesMapped << "," << xmlBytesTouched << ","
+            << metrics.ruleFiles << "," << metrics.presetReferences << "," << metrics.uniquePresetReferences;
+        rows.push_back(row.str());
+
+        size_t firstRow = rows.size() > METRICS_HISTORY_MAX_ROWS ? rows.size() - METRICS_HISTORY_MAX_ROWS : 0;
+
+        std::ofstream historyOut(paths.logMetricsHistoryPath, std::ios::out | std::ios::trunc);
+        if (!historyOut.is_open()) {
+            logFile << "WARNING: Could not write metrics history: " << paths.logMetricsHistoryPath.string()
+                    << std::endl;
+            return;
+        }
+        historyOut << historyHeader << "\n";
+        for (size_t i = firstRow; i < rows.size(); ++i) {
+            historyOut << rows[i] << "\n";
         }
+        historyOut.close();
+
+        logFile << "Metrics written to: " << paths.logMetricsPath.string() << " (" << std::fixed
+                << std::setprecision(1) << totalMs << " ms, peak working set " << (peakWorkingSet / (1024 * 1024))
+                << " MB)" << std::endl;
+        logFile << std::defaultfloat;
 
     } catch (const std::exception& e) {
-        logFile << "ERROR in WriteJsonAtomically: " << e.what() << std::endl;
-        return false;
+        logFile << "WARNING: Could not write metrics: " << e.what() << std::endl;
     } catch (...) {
-        logFile << "ERROR in WriteJsonAtomically: Unknown exception" << std::endl;
-        return false;
+        logFile << "WARNING: Could not write metrics: Unknown exception" << std::endl;
     }
 }
 
-void UpdateIniRuleCount(const fs::path& iniPath, const std::string& originalLine, int newCount) {
+DistributionOutcome RunDistributionPipelineGuarded(const PipelinePaths& paths, const ConfigSettings& config,
+                                                   std::ostream& logFile, bool ranInBackground,
+                                                   std::vector<StageMetric>* stageMetrics) {
+    RunMetrics metrics;
+    DistributionOutcome outcome;
+
     try {
-        std::string content = ReadFileWithEncoding(iniPath);
-        if (content.empty()) return;
+        outcome = RunDistributionPipeline(paths, config, logFile, metrics);
+    } catch (const std::exception& e) {
+        logFile << "ERROR in OBody Assistant main process: " << e.what() << std::endl;
+        outcome = {false, "ERROR in OBody Assistant main process"};
+    } catch (...) {
+        logFile << "CRITICAL ERROR in OBody Assistant: Unknown exception" << std::endl;
+        outcome = {false, "CRITICAL ERROR in OBody Assistant"};
+    }
 
-        std::stringstream ss(content);
-        std::vector<std::string> lines;
-        std::string line;
-        lines.reserve(200);
+    WriteRunMetrics(paths, metrics, outcome, ranInBackground, logFile);
+    if (stageMetrics) *stageMetrics = metrics.stages;
+    return outcome;
+}
 
-        while (std::getline(ss, line)) {
-            lines.push_back(line);
-        }
+// ===== WATCH MODE (LIVE CATALOG UPDATES) =====
 
-        for (auto& fileLine : lines) {
-            std::string cleanLine = fileLine;
+// Players regenerate presets in BodySlide with the game running. Watch_Mode keeps the prescan
+// state of the last run and patches it: an XML change re-reads that one XML and re-runs the preset
+// map, UBE scan and Doctor log over the patched catalog; a rule file change re-reads that file
+// only. Either way the JSON stages run again on the result. Nothing else is re-read.
 
-            size_t commentPos = cleanLine.find(';');
-            if (commentPos != std::string::npos) {
-                cleanLine = cleanLine.substr(0, commentPos);
-            }
+static constexpr int WATCH_MAX_BATCH_DELAY_MS = 10000;  // A steady stream of events still flushes
 
-            commentPos = cleanLine.find('#');
-            if (commentPos != std::string::npos) {
-                cleanLine = cleanLine.substr(0, commentPos);
-            }
+enum class WatchedFolder { Presets, Rules };
 
-            cleanLine = Trim(cleanLine);
-            std::string originalLineClean = Trim(originalLine);
+// An empty filename means events were lost: reconcile the folder against the stored stamps.
+struct WatchEvent {
+    WatchedFolder folder;
+    std::string filename;
+};
+
+// One notification handle per folder (inotify on Linux, ReadDirectoryChangesW on Windows), plus a
+// wake-up handle so StopWatchMode can interrupt a blocking Wait.
+class DirectoryWatcher {
+public:
+    DirectoryWatcher() = default;
+    ~DirectoryWatcher() { Close(); }
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    bool Open(const fs::path& presetsFolder, const fs::path& rulesFolder, std::ostream& logFile) {
+#if defined(_WIN32)
+        stopEvent_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!stopEvent_) return false;
+        AddFolder(presetsFolder, WatchedFolder::Presets, logFile);
+        AddFolder(rulesFolder, WatchedFolder::Rules, logFile);
+        return !folders_.empty();
+#elif defined(__linux__)
+        inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd_ < 0 || ::pipe(wakePipe_) != 0) {
+            logFile << "WARNING: Watch mode unavailable: could not initialize inotify" << std::endl;
+            return false;
+        }
+        ::fcntl(wakePipe_[0], F_SETFL, O_NONBLOCK);
+        AddFolder(presetsFolder, WatchedFolder::Presets, logFile);
+        AddFolder(rulesFolder, WatchedFolder::Rules, logFile);
+        return !folders_.empty();
+#else
+        (void)presetsFolder;
+        (void)rulesFolder;
+        logFile << "WARNING: Watch mode is not supported on this platform" << std::endl;
+        return false;
+#endif
+    }
 
-            if (cleanLine == originalLineClean) {
-                size_t lastPipe = fileLine.rfind('|');
-                if (lastPipe != std::string::npos) {
-                    std::string beforePipe = fileLine.substr(0, lastPipe + 1);
-                    fileLine = beforePipe + std::to_string(newCount);
+    // Appends what arrives within timeoutMs (-1 = until something does). Returns false once
+    // Interrupt has been called.
+    bool Wait(int timeoutMs, std::vector<WatchEvent>& events) {
+#if defined(_WIN32)
+        std::vector<HANDLE> handles{stopEvent_};
+        for (const auto& folder : folders_) handles.push_back(folder->overlapped.hEvent);
+
+        DWORD result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE,
+                                              timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs));
+        if (result == WAIT_OBJECT_0) return false;
+        if (result == WAIT_TIMEOUT) return true;
+        if (result < WAIT_OBJECT_0 + 1 || result >= WAIT_OBJECT_0 + handles.size()) return false;
+
+        Folder& folder = *folders_[result - WAIT_OBJECT_0 - 1];
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(folder.handle, &folder.overlapped, &bytes, FALSE) || bytes == 0) {
+            // The buffer overflowed (or the read failed): what changed is unknown
+            events.push_back({folder.kind, std::string()});
+        } else {
+            const char* cursor = reinterpret_cast<const char*>(folder.buffer.data());
+            while (true) {
+                const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+                std::wstring name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+                auto u8name = fs::path(name).u8string();
+                events.push_back({folder.kind, std::string(u8name.begin(), u8name.end())});
+                if (info->NextEntryOffset == 0) break;
+                cursor += info->NextEntryOffset;
+            }
+        }
+        if (!IssueRead(folder)) events.push_back({folder.kind, std::string()});
+        return true;
+#elif defined(__linux__)
+        pollfd fds[2] = {{wakePipe_[0], POLLIN, 0}, {inotifyFd_, POLLIN, 0}};
+        int ready = ::poll(fds, 2, timeoutMs);
+        if (ready < 0) return errno == EINTR;
+        if (fds[0].revents) return false;
+        if (!(fds[1].revents & POLLIN)) return true;
+
+        alignas(inotify_event) char buffer[16384];
+        while (true) {
+            ssize_t length = ::read(inotifyFd_, buffer, sizeof(buffer));
+            if (length <= 0) break;
+            for (char* cursor = buffer; cursor < buffer + length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+                cursor += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    for (const auto& folder : folders_) events.push_back({folder.kind, std::string()});
+                    continue;
+                }
+                if (event->len == 0) continue;
+                for (const auto& folder : folders_) {
+                    if (folder.wd == event->wd) events.push_back({folder.kind, std::string(event->name)});
                 }
-                break;
             }
         }
+        return true;
+#else
+        (void)timeoutMs;
+        (void)events;
+        return false;
+#endif
+    }
 
-        std::ofstream outFile(iniPath, std::ios::out | std::ios::trunc);
-        if (outFile.is_open()) {
-            for (const auto& outputLine : lines) {
-                outFile << outputLine << std::endl;
-            }
-            outFile.close();
+    void Interrupt() {
+#if defined(_WIN32)
+        if (stopEvent_) SetEvent(stopEvent_);
+#elif defined(__linux__)
+        if (wakePipe_[1] >= 0) {
+            char wake = 1;
+            ssize_t written = ::write(wakePipe_[1], &wake, 1);
+            (void)written;
         }
+#endif
+    }
 
-    } catch (...) {
+    void Close() {
+#if defined(_WIN32)
+        for (auto& folder : folders_) {
+            CancelIoEx(folder->handle, &folder->overlapped);
+            DWORD bytes = 0;
+            GetOverlappedResult(folder->handle, &folder->overlapped, &bytes, TRUE);
+            CloseHandle(folder->overlapped.hEvent);
+            CloseHandle(folder->handle);
+        }
+        folders_.clear();
+        if (stopEvent_) CloseHandle(stopEvent_);
+        stopEvent_ = nullptr;
+#elif defined(__linux__)
+        folders_.clear();
+        for (int* fd : {&inotifyFd_, &wakePipe_[0], &wakePipe_[1]}) {
+            if (*fd >= 0) ::close(*fd);
+            *fd = -1;
+        }
+#endif
+    }
+
+private:
+#if defined(_WIN32)
+    struct Folder {
+        WatchedFolder kind;
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped{};
+        std::vector<DWORD> buffer = std::vector<DWORD>(16384);  // DWORD-aligned, as the API requires
+    };
+
+    bool IssueRead(Folder& folder) {
+        ResetEvent(folder.overlapped.hEvent);
+        return ReadDirectoryChangesW(folder.handle, folder.buffer.data(),
+                                     static_cast<DWORD>(folder.buffer.size() * sizeof(DWORD)), FALSE,
+                                     FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE |
+                                         FILE_NOTIFY_CHANGE_SIZE,
+                                     nullptr, &folder.overlapped, nullptr) != FALSE;
+    }
+
+    void AddFolder(const fs::path& path, WatchedFolder kind, std::ostream& logFile) {
+        auto folder = std::make_unique<Folder>();
+        folder->kind = kind;
+        folder->handle = CreateFileW(path.c_str(), FILE_LIST_DIRECTORY,
+                                     FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                     FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        folder->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (folder->handle == INVALID_HANDLE_VALUE || !folder->overlapped.hEvent || !IssueRead(*folder)) {
+            logFile << "WARNING: Could not watch folder: " << path.string() << std::endl;
+            if (folder->overlapped.hEvent) CloseHandle(folder->overlapped.hEvent);
+            if (folder->handle != INVALID_HANDLE_VALUE) CloseHandle(folder->handle);
+            return;
+        }
+        folders_.push_back(std::move(folder));
+    }
+
+    HANDLE stopEvent_ = nullptr;
+    std::vector<std::unique_ptr<Folder>> folders_;
+#elif defined(__linux__)
+    struct Folder {
+        WatchedFolder kind;
+        int wd = -1;
+    };
+
+    void AddFolder(const fs::path& path, WatchedFolder kind, std::ostream& logFile) {
+        int wd = inotify_add_watch(inotifyFd_, path.c_str(),
+                                   IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+        if (wd < 0) {
+            logFile << "WARNING: Could not watch folder: " << path.string() << std::endl;
+            return;
+        }
+        folders_.push_back({kind, wd});
+    }
+
+    int inotifyFd_ = -1;
+    int wakePipe_[2] = {-1, -1};
+    std::vector<Folder> folders_;
+#endif
+};
+
+// Names whose stamp differs from what the state holds. Used after lost events and once at start
+// (edits made while the game was loading); only the directory is read, never an unchanged file.
+std::set<std::string> ReconcilePresetFolder(const PresetCatalog& catalog, const fs::path& folder) {
+    std::set<std::string> changed;
+    std::set<std::string> onDisk;
+    std::error_code error;
+    for (const auto& file : EnumerateDirectory(folder, "", ".xml", error)) {
+        const std::string& filename = file.name;
+        onDisk.insert(filename);
+
+        auto entry = std::lower_bound(
+            catalog.entries.begin(), catalog.entries.end(), filename,
+            [](const PresetCatalogEntry& e, const std::string& name) { return e.xmlFilename < name; });
+        if (entry == catalog.entries.end() || entry->xmlFilename != filename || entry->size != file.stamp.size ||
+            entry->mtime != file.stamp.mtime) {
+            changed.insert(filename);
+        }
     }
+    if (error) return changed;
+    for (const auto& entry : catalog.entries) {
+        if (!onDisk.count(entry.xmlFilename)) changed.insert(entry.xmlFilename);
+    }
+    return changed;
 }
 
-// ===== MAIN PLUGIN FUNCTION =====
+std::set<std::string> ReconcileRuleFolder(const std::vector<RuleFileScan>& ruleFiles, const fs::path& dataPath) {
+    std::set<std::string> changed;
+    std::set<std::string> onDisk;
+    std::error_code error;
+    for (const auto& file : EnumerateDirectory(dataPath, "OBodyNG_PDA_", ".ini", error)) {
+        std::string filename = file.path.filename().string();
+        onDisk.insert(filename);
 
-extern "C" __declspec(dllexport) bool SKSEPlugin_Load(const SKSE::LoadInterface* skse) {
-    try {
-        SKSE::Init(skse);
+        auto scan = std::find_if(ruleFiles.begin(), ruleFiles.end(),
+                                 [&](const RuleFileScan& r) { return r.filename == filename; });
+        if (scan == ruleFiles.end() || scan->size != file.stamp.size || scan->mtime != file.stamp.mtime) {
+            changed.insert(filename);
+        }
+    }
+    if (error) return changed;
+    for (const auto& scan : ruleFiles) {
+        if (!onDisk.count(scan.filename)) changed.insert(scan.filename);
+    }
+    return changed;
+}
 
-        SKSE::GetMessagingInterface()->RegisterListener([](SKSE::MessagingInterface::Message* message) {
-            try {
-                if (message->type == SKSE::MessagingInterface::kDataLoaded) {
-                    std::string documentsPath;
-                    std::string gamePath;
+// Re-reads the named XMLs into the catalog. Returns false if none of them really changed (the
+// event was an echo, or the file was rewritten with the same size and time).
+bool PatchPresetCatalog(PresetCatalog& catalog, const fs::path& folder, const std::set<std::string>& filenames,
+                        const FrameworkClassifier& frameworks, std::ostream& logFile) {
+    bool changed = false;
+    for (const auto& filename : filenames) {
+        if (!EndsWith(filename, ".xml")) continue;
+
+        fs::path path = folder / fs::u8path(filename);
+        FileStamp stamp = StatFile(path);
+        auto entry = std::lower_bound(
+            catalog.entries.begin(), catalog.entries.end(), filename,
+            [](const PresetCatalogEntry& e, const std::string& name) { return e.xmlFilename < name; });
+        bool known = entry != catalog.entries.end() && entry->xmlFilename == filename;
+
+        if (!stamp.exists) {
+            if (known) {
+                catalog.entries.erase(entry);
+                logFile << "  Removed preset XML: " << filename << std::endl;
+                changed = true;
+            }
+            continue;
+        }
+        if (known && entry->size == stamp.size && entry->mtime == stamp.mtime) continue;
+
+        PresetCatalogEntry updated;
+        updated.xmlFilename = filename;
+        updated.path = path;
+        updated.size = stamp.size;
+        updated.mtime = stamp.mtime;
+        std::string stem = path.stem().string();
+        bool opened = false;
+        bool readable = false;
+        try {
+            updated.presets = ReadSliderPresets(path, stem, frameworks, logFile, opened, readable,
+                                                updated.contentHash, catalog.sliderNames.get());
+        } catch (const std::exception& e) {
+            logFile << "  [ERROR] Exception reading " << filename << ": " << e.what() << std::endl;
+        } catch (...) {
+            logFile << "  [ERROR] Unknown exception reading " << filename << std::endl;
+        }
+        if (updated.presets.empty()) updated.presets = TokenizeSliderPresets(nullptr, 0, stem, frameworks, logFile);
+        if (opened) catalog.xmlFilesOpened++;
 
-                    try {
-                        documentsPath = GetDocumentsPath();
-                        gamePath = GetGamePath();
-                    } catch (...) {
-                        RE::ConsoleLog::GetSingleton()->Print("OBody Assistant: Error getting paths - using defaults");
-                        documentsPath = "C:\\Users\\Default\\Documents";
-                        gamePath = "";
-                    }
+        logFile << "  " << (known ? "Updated" : "Added") << " preset XML: " << filename << " ("
+                << updated.presets.size() << " preset" << (updated.presets.size() == 1 ? "" : "s") << ")"
+                << std::endl;
+        if (known) {
+            *entry = std::move(updated);
+        } else {
+            catalog.entries.insert(entry, std::move(updated));
+        }
+        changed = true;
+    }
+    // Indices shift on insert and erase, and an edit can make or break a duplicate
+    if (changed) GroupDuplicateEntries(catalog);
+    return changed;
+}
 
-                    if (gamePath.empty() || documentsPath.empty()) {
-                        RE::ConsoleLog::GetSingleton()->Print(
-                            "OBody Assistant: Could not find Game or Documents path.");
-                        return;
-                    }
+// Re-reads the named rule files. New files go last, as they would have been scanned after the
+// existing ones; replaced files keep their place, so rule order is unchanged.
+bool PatchRuleFiles(std::vector<RuleFileScan>& ruleFiles, const fs::path& dataPath,
+                    const std::set<std::string>& filenames, std::ostream& logFile) {
+    bool changed = false;
+    for (const auto& filename : filenames) {
+        if (!IsRuleFileName(filename)) continue;
+
+        fs::path path = dataPath / filename;
+        FileStamp stamp = StatFile(path);
+        auto scan = std::find_if(ruleFiles.begin(), ruleFiles.end(),
+                                 [&](const RuleFileScan& r) { return r.filename == filename; });
+        bool known = scan != ruleFiles.end();
+
+        if (!stamp.exists) {
+            if (known) {
+                ruleFiles.erase(scan);
+                logFile << "  Removed rule file: " << filename << std::endl;
+                changed = true;
+            }
+            continue;
+        }
+        if (known && scan->size == stamp.size && scan->mtime == stamp.mtime) continue;
 
-                    fs::path dataPath = fs::path(gamePath) / "Data";
-                    fs::path sksePluginsPath = dataPath / "SKSE" / "Plugins";
-                    CreateDirectoryIfNotExists(sksePluginsPath);
+        RuleFileScan updated = ScanRuleFile(path);
+        logFile << "  " << (known ? "Updated" : "Added") << " rule file: " << filename << " ("
+                << updated.rules.size() << " rules)" << std::endl;
+        if (known) {
+            *scan = std::move(updated);
+        } else {
+            ruleFiles.push_back(std::move(updated));
+        }
+        changed = true;
+    }
+    return changed;
+}
 
-                    fs::path logFilePath = fs::path(documentsPath) / "My Games" / "Skyrim Special Edition" / "SKSE" /
-                                           "OBody_NG_Preset_Distribution_Assistant-NG.log";
-                    CreateDirectoryIfNotExists(logFilePath.parent_path());
+struct WatchState {
+    std::mutex mutex;
+    std::shared_ptr<DirectoryWatcher> watcher;
+    std::shared_future<void> finished;
+};
 
-                    std::ofstream logFile(logFilePath, std::ios::out | std::ios::trunc);
+WatchState g_watch;
+
+// Builds the next prescan state from the live one and re-runs what the changes reach. Returns
+// false when every event turned out to be an echo, so nothing ran.
+bool ApplyWatchUpdate(const PipelinePaths& paths, const ConfigSettings& startupConfig,
+                      const std::set<std::string>& presetNames, const std::set<std::string>& ruleNames,
+                      DistributionOutcome& outcome) {
+    std::shared_ptr<PreScanResult> current = GetLivePreScan();
+    if (!current) return false;
+
+    auto next = std::make_shared<PreScanResult>();
+    next->startTime = std::chrono::steady_clock::now();
+    next->frameworks = current->frameworks;
+    next->catalog = current->catalog;
+    next->catalog.xmlFilesOpened = 0;
+    next->catalog.cacheHits = next->catalog.cacheMisses = next->catalog.cacheEvictions = 0;
+    next->ruleFiles = current->ruleFiles;
+
+    std::ostringstream changeLog;
+    std::vector<StageMetric> stages;
+    bool catalogChanged = false;
+    bool rulesChanged = false;
+    {
+        StageTimer timer(stages, "watch_catalog_patch", "watch");
+        catalogChanged = PatchPresetCatalog(next->catalog, paths.bodySlidePresetsPath, presetNames,
+                                            next->frameworks, changeLog);
+    }
+    {
+        StageTimer timer(stages, "watch_rule_patch", "watch");
+        rulesChanged = PatchRuleFiles(next->ruleFiles, paths.dataPath, ruleNames, changeLog);
+    }
+    if (!catalogChanged && !rulesChanged) return false;
+
+    // Deferred stages still pending from startup write the same Doctor log with the old catalog:
+    // finish them first, then hold their log mutex while the report logs are regenerated
+    RunDeferredStages();
+    std::lock_guard<std::mutex> logLock(g_mainLogAppendMutex);
+
+    if (catalogChanged) {
+        {
+            StageTimer timer(stages, "preset_map", "watch");
+            next->presetMap = BuildPresetNameMap(next->catalog, next->presetMapLog);
+        }
+        {
+            StageTimer timer(stages, "shape_index", "watch");
+            next->shapeIndex = BuildShapeIndex(next->catalog);
+        }
+        if (SmartCleaningEnabled(startupConfig)) {
+            StageTimer timer(stages, "preset_suggestions", "watch");
+            next->presetSuggestions.Build(next->presetMap.presetNames, next->presetMap.filenameMappings);
+        }
+        {
+            StageTimer timer(stages, "ube_scan", "watch");
+            auto [ubeBlacklist, ubeRaces] = ProcessUBEXmlPresets(next->catalog, next->ubeScanLog);
+            next->ubePresetsForBlacklist = std::move(ubeBlacklist);
+            next->ubePresetsForRaces = std::move(ubeRaces);
+        }
+        {
+            StageTimer timer(stages, "doctor_log", "watch");
+            GenerateDoctorLog(next->catalog, paths.logDoctorPath, next->doctorLog);
+        }
+        if (next->catalog.sliderNames) {
+            StageTimer timer(stages, "preset_clusters", "watch");
+            GeneratePresetClustersLog(next->catalog, paths.logClustersPath, ClusterOptionsFromConfig(startupConfig),
+                                      AcquireWorkerPool(ResolveWorkerThreads(startupConfig.workerThreads)),
+                                      next->clustersLog);
+        }
+    } else {
+        next->presetMap = current->presetMap;
+        next->shapeIndex = current->shapeIndex;
+        next->presetSuggestions = current->presetSuggestions;
+        next->ubePresetsForBlacklist = current->ubePresetsForBlacklist;
+        next->ubePresetsForRaces = current->ubePresetsForRaces;
+        next->reportLogsCurrent = true;
+    }
+    next->finishTime = std::chrono::steady_clock::now();
 
-                    auto now = std::chrono::system_clock::now();
-                    std::time_t in_time_t = std::chrono::system_clock::to_time_t(now);
-                    std::tm buf;
-                    localtime_s(&buf, &in_time_t);
+    // Backup = 1 flips to 0 after the first run, so the INI is read again rather than reused
+    std::ostringstream discardedLog;
+    ConfigSettings config = ReadConfigFromIni(paths.configIniPath, discardedLog);
+    config.watchMode = true;
+    config.watchDebounceMs = startupConfig.watchDebounceMs;
 
-                    logFile << "====================================================" << std::endl;
-                    logFile << "OBody NG Preset Distribution Assistant NG v" << PLUGIN_VERSION << std::endl;
-                    logFile << "Log created on: " << std::put_time(&buf, "%Y-%m-%d %H:%M:%S") << std::endl;
-                    logFile << "====================================================" << std::endl << std::endl;
+    std::ofstream logFile(paths.logFilePath, std::ios::out | std::ios::app);
+    RecordFileOpened();
 
-                    fs::path configIniPath = sksePluginsPath / "OBody_NG_Preset_Distribution_Assistant_NG.ini";
-                    fs::path jsonOutputPath = sksePluginsPath / "OBody_presetDistributionConfig.json";
-                    fs::path backupJsonPath =
-                        sksePluginsPath / "Backup_OBody_DPA" / "OBody_presetDistributionConfig.json";
-                    fs::path analysisDir = sksePluginsPath / "Backup_OBody_DPA" / "Analysis";
-                    fs::path bodySlidePresetsPath = dataPath / "CalienteTools" / "BodySlide" / "SliderPresets";
+    logFile << std::endl;
+    logFile << "====================================================" << std::endl;
+    const char* changedInputs = catalogChanged && rulesChanged ? "SliderPresets and OBodyNG_PDA_*.ini"
+                                : catalogChanged                ? "SliderPresets"
+                                                                : "OBodyNG_PDA_*.ini";
+    logFile << "WATCH UPDATE (" << changedInputs << " changed)" << std::endl;
+    logFile << "====================================================" << std::endl;
+    logFile << changeLog.str();
+    if (catalogChanged) {
+        logFile << "Preset catalog: " << next->catalog.entries.size() << " XML files cataloged, "
+                << next->catalog.xmlFilesOpened << " files opened" << std::endl;
+        logFile << "Re-ran: preset map, shape index"
+                << (SmartCleaningEnabled(startupConfig) ? ", preset suggestions" : "") << ", UBE scan, Doctor log"
+                << (next->catalog.sliderNames ? ", preset clusters" : "") << std::endl;
+    }
 
-                    logFile << "Reading configuration..." << std::endl;
-                    logFile << "----------------------------------------------------" << std::endl;
-                    ConfigSettings config = ReadConfigFromIni(configIniPath, logFile);
+    auto startTime = std::chrono::steady_clock::now();
+    RunMetrics metrics;
+    metrics.stages = std::move(stages);
+    try {
+        outcome = RunDistributionPipeline(paths, config, logFile, metrics, next);
+    } catch (const std::exception& e) {
+        logFile << "ERROR in watch update: " << e.what() << std::endl;
+        outcome = {false, "ERROR in OBody Assistant watch update"};
+    } catch (...) {
+        logFile << "ERROR in watch update: Unknown exception" << std::endl;
+        outcome = {false, "ERROR in OBody Assistant watch update"};
+    }
 
-                    logFile << std::endl;
-                    if (!PerformSimpleJsonIntegrityCheck(jsonOutputPath, logFile)) {
-                        logFile << std::endl;
-                        logFile << "CRITICAL: JSON failed simple integrity check at startup - Attempting to restore "
-                                   "from backup..."
-                                << std::endl;
+    double totalMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    logFile << "Watch update finished in " << std::fixed << std::setprecision(1) << totalMs << " ms ("
+            << (outcome.success ? "SUCCESS" : "FAILED") << "), stages:";
+    for (const auto& stage : metrics.stages) logFile << " " << stage.name;
+    logFile << std::endl;
+    RecordStreamWritten(logFile);
+    return true;
+}
 
-                        if (RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
-                            logFile << "SUCCESS: JSON restored from backup. Proceeding with the normal process."
-                                    << std::endl;
-                        } else {
-                            logFile << std::endl;
-                            logFile << "CRITICAL ERROR: Could not restore from backup. The JSON file is likely "
-                                       "corrupted and no valid backup is available."
-                                    << std::endl;
-                            logFile << "Process terminated to prevent further damage." << std::endl;
-                            logFile << std::endl;
-                            logFile << "RECOMMENDED ACTIONS:" << std::endl;
-                            logFile << "1. Check the analysis folder for the corrupted file: " << analysisDir.string()
-                                    << std::endl;
-                            logFile << "2. Manually check for any older backups or reinstall the mod providing the "
-                                       "base JSON file."
-                                    << std::endl;
-                            logFile << "3. Contact the mod author if the problem persists." << std::endl;
-                            logFile << "====================================================" << std::endl;
-                            logFile.close();
+void RunWatchLoop(PipelinePaths paths, ConfigSettings config, std::shared_ptr<DirectoryWatcher> watcher,
+                  std::function<void(const DistributionOutcome&)> onUpdate) {
+    // Edits made between the prescan and now produced no events
+    std::set<std::string> presetNames;
+    std::set<std::string> ruleNames;
+    if (auto live = GetLivePreScan()) {
+        presetNames = ReconcilePresetFolder(live->catalog, paths.bodySlidePresetsPath);
+        ruleNames = ReconcileRuleFolder(live->ruleFiles, paths.dataPath);
+    }
 
-                            RE::ConsoleLog::GetSingleton()->Print(
-                                "CRITICAL ERROR: OBody JSON is corrupted and could not be restored - Check the log file "
-                                "for details.");
-                            return;
-                        }
-                    }
+    while (true) {
+        if (!presetNames.empty() || !ruleNames.empty()) {
+            DistributionOutcome outcome;
+            try {
+                if (ApplyWatchUpdate(paths, config, presetNames, ruleNames, outcome) && onUpdate) onUpdate(outcome);
+            } catch (...) {
+            }
+            presetNames.clear();
+            ruleNames.clear();
+        }
+
+        std::vector<WatchEvent> events;
+        if (!watcher->Wait(-1, events)) return;
+        if (events.empty()) continue;
+
+        // Debounce: BodySlide writes a batch of XMLs back to back, so wait for a quiet period
+        auto firstEvent = std::chrono::steady_clock::now();
+        auto lastEvent = firstEvent;
+        while (true) {
+            auto now = std::chrono::steady_clock::now();
+            auto quietLeft = std::chrono::milliseconds(config.watchDebounceMs) - (now - lastEvent);
+            auto batchLeft = std::chrono::milliseconds(WATCH_MAX_BATCH_DELAY_MS) - (now - firstEvent);
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(std::min(quietLeft, batchLeft));
+            if (wait.count() <= 0) break;
+
+            size_t before = events.size();
+            if (!watcher->Wait(static_cast<int>(wait.count()), events)) return;
+            if (events.size() > before) lastEvent = std::chrono::steady_clock::now();
+        }
+
+        std::shared_ptr<PreScanResult> live = GetLivePreScan();
+        for (const auto& event : events) {
+            auto& names = event.folder == WatchedFolder::Presets ? presetNames : ruleNames;
+            if (!event.filename.empty()) {
+                names.insert(event.filename);
+            } else if (live && event.folder == WatchedFolder::Presets) {
+                auto reconciled = ReconcilePresetFolder(live->catalog, paths.bodySlidePresetsPath);
+                names.insert(reconciled.begin(), reconciled.end());
+            } else if (live) {
+                auto reconciled = ReconcileRuleFolder(live->ruleFiles, paths.dataPath);
+                names.insert(reconciled.begin(), reconciled.end());
+            }
+        }
+    }
+}
 
-                    logFile << "JSON passed initial integrity check or was restored - proceeding with normal process..."
-                            << std::endl;
-                    logFile << std::endl;
+void StartWatchMode(const PipelinePaths& paths, const ConfigSettings& config,
+                    std::function<void(const DistributionOutcome&)> onUpdate) {
+    std::lock_guard<std::mutex> lock(g_watch.mutex);
+    if (g_watch.watcher) return;
 
-                    const std::set<std::string> validKeys = {
-                        "npcFormID",       "npc",           "factionFemale", "factionMale",
-                        "npcPluginFemale", "npcPluginMale", "raceFemale",    "raceMale"};
+    // A run skipped by the fingerprint never joined the prescan, and the early one was skipped too
+    if (!GetLivePreScan()) {
+        std::ostringstream discardedLog;
+        SetLivePreScan(AcquirePreScan(paths, config, discardedLog));
+    }
 
-                    std::map<std::string, OrderedPluginData> processedData;
-                    for (const auto& key : validKeys) {
-                        processedData[key] = OrderedPluginData();
-                    }
-                    processedData["blacklistedPresetsFromRandomDistribution"] = OrderedPluginData();
-                    processedData["blacklistedNpcs"] = OrderedPluginData();
-                    processedData["blacklistedNpcsFormID"] = OrderedPluginData();
-                    processedData["blacklistedNpcsPluginFemale"] = OrderedPluginData();
-                    processedData["blacklistedNpcsPluginMale"] = OrderedPluginData();
-                    processedData["blacklistedRacesFemale"] = OrderedPluginData();
-                    processedData["blacklistedRacesMale"] = OrderedPluginData();
-                    processedData["blacklistedOutfitsFromORefitFormID"] = OrderedPluginData();
-                    processedData["blacklistedOutfitsFromORefit"] = OrderedPluginData();
-                    processedData["blacklistedOutfitsFromORefitPlugin"] = OrderedPluginData();
-                    processedData["outfitsForceRefitFormID"] = OrderedPluginData();
-                    processedData["outfitsForceRefit"] = OrderedPluginData();
-
-                    bool backupPerformed = false;
-
-                    if (config.backupValue == 1 || config.backupValue == 2) {
-                        if (config.backupValue == 2) {
-                            logFile << "Backup enabled (Backup = true), performing LITERAL backup always..."
-                                    << std::endl;
-                        } else {
-                            logFile << "Backup enabled (Backup = 1), performing LITERAL backup..." << std::endl;
-                        }
+    std::ostringstream watchLog;
+    auto watcher = std::make_shared<DirectoryWatcher>();
+    bool opened = watcher->Open(paths.bodySlidePresetsPath, paths.dataPath, watchLog);
+    if (opened) {
+        watchLog << "Watch mode: watching " << paths.bodySlidePresetsPath.string() << " and "
+                 << (paths.dataPath / "OBodyNG_PDA_*.ini").string() << " (debounce " << config.watchDebounceMs
+                 << " ms)" << std::endl;
+    }
+    {
+        std::lock_guard<std::mutex> logLock(g_mainLogAppendMutex);
+        std::ofstream logFile(paths.logFilePath, std::ios::out | std::ios::app);
+        logFile << std::endl << watchLog.str();
+    }
+    if (!opened) return;
 
-                        if (PerformLiteralJsonBackup(jsonOutputPath, backupJsonPath, logFile)) {
-                            backupPerformed = true;
-                            if (config.backupValue != 2) {
-                                UpdateBackupConfigInIni(configIniPath, logFile, config.backupValue);
-                            }
-                        } else {
-                            logFile << "ERROR: LITERAL backup failed, continuing with normal process..." << std::endl;
-                        }
+    // Detached so a game exit without StopWatchMode does not terminate on a joinable thread
+    auto done = std::make_shared<std::promise<void>>();
+    g_watch.finished = done->get_future().share();
+    g_watch.watcher = watcher;
+    std::thread([paths, config, watcher, onUpdate = std::move(onUpdate), done]() {
+        try {
+            RunWatchLoop(paths, config, watcher, onUpdate);
+        } catch (...) {
+        }
+        done->set_value();
+    }).detach();
+}
 
-                    } else {
-                        logFile << "Backup disabled (Backup = 0), skipping backup" << std::endl;
-                    }
+void StopWatchMode() {
+    std::shared_ptr<DirectoryWatcher> watcher;
+    std::shared_future<void> finished;
+    {
+        std::lock_guard<std::mutex> lock(g_watch.mutex);
+        watcher = std::move(g_watch.watcher);
+        finished = g_watch.finished;
+        g_watch.watcher.reset();
+    }
+    if (!watcher) return;
+    watcher->Interrupt();
+    finished.wait();
+}
 
-                    logFile << std::endl;
+#ifndef OBODY_PDA_HEADLESS
 
-                    auto [readSuccess, originalJsonContent, currentBlacklistedPresetsShow] = 
-                        ReadCompleteJson(jsonOutputPath, processedData, logFile);
+// ===== BACKGROUND EXECUTION AND COMPLETION BARRIER =====
 
-                    if (!readSuccess) {
-                        logFile << "JSON read failed, attempting to restore from backup..." << std::endl;
-                        if (fs::exists(backupJsonPath) &&
-                            RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
-                            logFile << "Backup restoration successful, retrying JSON read..." << std::endl;
-                            auto retryResult = ReadCompleteJson(jsonOutputPath, processedData, logFile);
-                            readSuccess = std::get<0>(retryResult);
-                            originalJsonContent = std::get<1>(retryResult);
-                            currentBlacklistedPresetsShow = std::get<2>(retryResult);
-                        }
+// Messages broadcast to every plugin listening to "OBody_NG_Preset_Distribution_Assistant_NG".
+// Both carry a DistributionMessageData payload. They are always sent from the main thread.
+static constexpr std::uint32_t kMessage_DistributionCompleted = 0x4F504401;
+static constexpr std::uint32_t kMessage_DistributionFailed = 0x4F504402;
 
-                        if (!readSuccess) {
-                            logFile
-                                << "Process truncated due to JSON read error. No INI processing or updates performed."
-                                << std::endl;
-                            logFile << "====================================================" << std::endl;
-                            logFile.close();
+struct DistributionMessageData {
+    std::uint32_t version = 1;
+    bool success = false;
+    bool ranInBackground = false;
+    std::uint32_t elapsedMs = 0;
+};
 
-                            RE::ConsoleLog::GetSingleton()->Print(
-                                "ERROR: JSON READ FAILED - CONTACT MODDER OR REINSTALL");
-                            return;
-                        } else {
-                            logFile << "JSON read successful after restoration" << std::endl;
-                        }
-                    }
+static constexpr auto DISTRIBUTION_BARRIER_TIMEOUT = std::chrono::minutes(5);
+
+struct DistributionBarrier {
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool pending = false;
+    bool success = false;
 
-                    fs::path logDoctorPath = fs::path(documentsPath) / "My Games" / "Skyrim Special Edition" / "SKSE" /
-                                             "OBody_NG_Preset_Distribution_Assistant-NG_Doctor.log";
-                    GenerateDoctorLog(bodySlidePresetsPath, logDoctorPath, logFile);
+    void Arm() {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = true;
+        success = false;
+    }
 
-                    PresetMapData presetMapForCleaning = BuildPresetNameMap(bodySlidePresetsPath, logFile);
+    void Signal(bool result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = false;
+            success = result;
+        }
+        finished.notify_all();
+    }
 
-                    fs::path logSmartCleaningPath = fs::path(documentsPath) / "My Games" / "Skyrim Special Edition" / "SKSE" /
-                                                    "OBody_NG_Preset_Distribution_Assistant-NG_Smart_Cleaning.log";
-                    GenerateSmartCleaningLog(presetMapForCleaning, logSmartCleaningPath, logFile);
+    // Returns false only if the worker is still running after the timeout.
+    bool Wait(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return finished.wait_for(lock, timeout, [this] { return !pending; });
+    }
+};
 
-                    fs::path logHelperPath = fs::path(documentsPath) / "My Games" / "Skyrim Special Edition" / "SKSE" /
-                                             "OBody_NG_Preset_Distribution_Assistant-NG_List-Helper.log";
-                    PresetMapData presetMapForHelper = BuildPresetNameMap(bodySlidePresetsPath, logFile);
-                    GenerateHelperLog(presetMapForHelper, logHelperPath, logFile);
+DistributionBarrier g_distributionBarrier;
+
+void PublishDistributionOutcome(const DistributionOutcome& outcome, bool ranInBackground, std::uint32_t elapsedMs) {
+    auto publish = [outcome, ranInBackground, elapsedMs]() {
+        RE::ConsoleLog::GetSingleton()->Print("%s", outcome.consoleMessage.c_str());
+
+        DistributionMessageData data;
+        data.success = outcome.success;
+        data.ranInBackground = ranInBackground;
+        data.elapsedMs = elapsedMs;
+        SKSE::GetMessagingInterface()->Dispatch(
+            outcome.success ? kMessage_DistributionCompleted : kMessage_DistributionFailed, &data,
+            static_cast<std::uint32_t>(sizeof(data)), nullptr);
+    };
+
+    if (ranInBackground) {
+        SKSE::GetTaskInterface()->AddTask(publish);
+    } else {
+        publish();
+    }
+}
 
-                    int totalRulesProcessed = 0;
-                    int totalRulesApplied = 0;
-                    int totalRulesSkipped = 0;
-                    int totalPresetsRemoved = 0;
-                    int totalPluginsRemoved = 0;
-                    int totalFilesProcessed = 0;
+// Live updates only reach the JSON on disk; the console line tells the player a reload picks them up.
+void StartWatchModeInGame(const PipelinePaths& paths, const ConfigSettings& config) {
+    if (!config.watchMode) return;
+    StartWatchMode(paths, config, [](const DistributionOutcome& outcome) {
+        std::string message = outcome.consoleMessage + " (live update)";
+        SKSE::GetTaskInterface()->AddTask(
+            [message]() { RE::ConsoleLog::GetSingleton()->Print("%s", message.c_str()); });
+    });
+}
 
-                    logFile << "Scanning for OBodyNG_PDA_*.ini files..." << std::endl;
-                    logFile << "----------------------------------------------------" << std::endl;
+void StartDistributionWorker(PipelinePaths paths, ConfigSettings config, std::ofstream logFile) {
+    g_distributionBarrier.Arm();
+
+    std::thread worker([paths = std::move(paths), config, logFile = std::move(logFile)]() mutable {
+        auto startTime = std::chrono::steady_clock::now();
+        DistributionOutcome outcome = RunDistributionPipelineGuarded(paths, config, logFile, true);
+        auto elapsedMs = static_cast<std::uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime)
+                .count());
+
+        logFile << "Background distribution finished in " << elapsedMs << " ms ("
+                << (outcome.success ? "SUCCESS" : "FAILED") << ")" << std::endl;
+        logFile.close();
+
+        g_distributionBarrier.Signal(outcome.success);
+        PublishDistributionOutcome(outcome, true, elapsedMs);
+        StartWatchModeInGame(paths, config);
+    });
+    worker.detach();
+}
 
-                    try {
-                        for (const auto& entry : fs::directory_iterator(dataPath)) {
-                            if (entry.is_regular_file()) {
-                                std::string filename = entry.path().filename().string();
-                                if (StartsWith(filename, "OBodyNG_PDA_") && EndsWith(filename, ".ini")) {
-                                    logFile << std::endl << "Processing file: " << filename << std::endl;
-                                    totalFilesProcessed++;
-
-                                    std::string iniContent = ReadFileWithEncoding(entry.path());
-                                    if (iniContent.empty()) {
-                                        logFile << "  ERROR: Could not read file" << std::endl;
-                                        continue;
-                                    }
+void WaitForDistributionWorker() {
+    if (!g_distributionBarrier.Wait(DISTRIBUTION_BARRIER_TIMEOUT)) {
+        RE::ConsoleLog::GetSingleton()->Print(
+            "OBody Assistant: WARNING - distribution still running, continuing without waiting");
+    }
+}
 
-                                    std::stringstream iniStream(iniContent);
-                                    std::vector<std::pair<std::string, ParsedRule>> fileLinesAndRules;
-                                    std::string line;
-                                    int rulesInFile = 0;
-                                    int rulesAppliedInFile = 0;
-                                    int rulesSkippedInFile = 0;
-                                    int presetsRemovedInFile = 0;
-                                    int pluginsRemovedInFile = 0;
-                                    fileLinesAndRules.reserve(100);
-
-                                    while (std::getline(iniStream, line)) {
-                                        std::string originalLine = line;
-
-                                        size_t commentPos = line.find(';');
-                                        if (commentPos != std::string::npos) {
-                                            line = line.substr(0, commentPos);
-                                        }
-
-                                        commentPos = line.find('#');
-                                        if (commentPos != std::string::npos) {
-                                            line = line.substr(0, commentPos);
-                                        }
-
-                                        size_t equalPos = line.find('=');
-                                        if (equalPos != std::string::npos) {
-                                            std::string key = Trim(line.substr(0, equalPos));
-                                            std::string value = Trim(line.substr(equalPos + 1));
-
-                                            if (validKeys.count(key) && !value.empty()) {
-                                                ParsedRule rule = ParseRuleLine(key, value);
-
-                                                if (!rule.plugin.empty() && !rule.presets.empty()) {
-                                                    rulesInFile++;
-                                                    totalRulesProcessed++;
-
-                                                    bool shouldApply = false;
-                                                    bool needsUpdate = false;
-                                                    int newCount = rule.applyCount;
-
-                                                    if (rule.applyCount == -1 || rule.applyCount == -2 ||
-                                                        rule.applyCount == -3 || rule.applyCount == -4 ||
-                                                        rule.applyCount == -5 || rule.applyCount > 0) {
-                                                        shouldApply = true;
-                                                        if (rule.applyCount > 0) {
-                                                            needsUpdate = true;
-                                                            newCount = rule.applyCount - 1;
-                                                        } else if (rule.applyCount == -2 || rule.applyCount == -3) {
-                                                            needsUpdate = true;
-                                                            newCount = 0;
-                                                        }
-
-                                                    } else {
-                                                        shouldApply = false;
-                                                        rulesSkippedInFile++;
-                                                        totalRulesSkipped++;
-
-                                                        if (rule.extra != "0") {
-                                                            needsUpdate = true;
-                                                            newCount = 0;
-                                                            rule.applyCount = newCount;
-                                                            fileLinesAndRules.emplace_back(originalLine, rule);
-                                                            logFile << "  Skipped (invalid mode detected in extra '"
-                                                                    << rule.extra << "', setting to 0): " << key
-                                                                    << " -> Plugin: " << rule.plugin << std::endl;
-                                                        } else {
-                                                            logFile << "  Skipped (count=0): " << key
-                                                                    << " -> Plugin: " << rule.plugin << std::endl;
-                                                        }
-                                                    }
-
-                                                    if (shouldApply) {
-                                                        auto& data = processedData[key];
-
-                                                        if (rule.applyCount == -1) {
-                                                            int presetsAdded = 0;
-                                                            for (const auto& preset : rule.presets) {
-                                                                size_t beforeCount = data.getTotalPresetCount();
-                                                                data.addPreset(rule.plugin, preset);
-                                                                if (data.getTotalPresetCount() > beforeCount) {
-                                                                    presetsAdded++;
-                                                                }
-                                                            }
-
-                                                            if (presetsAdded > 0) {
-                                                                rulesAppliedInFile++;
-                                                                totalRulesApplied++;
-                                                                logFile << "  Applied: " << key
-                                                                        << " -> Plugin: " << rule.plugin << " -> Added "
-                                                                        << presetsAdded << " new presets";
-                                                                if (!rule.extra.empty()) {
-                                                                    logFile << " (mode: " << rule.extra << ")";
-                                                                }
-                                                                logFile << std::endl;
-                                                            } else {
-                                                                logFile
-                                                                    << "  No new presets added (all already exist): "
-                                                                    << key << " -> Plugin: " << rule.plugin
-                                                                    << std::endl;
-                                                            }
-
-                                                        } else if (rule.applyCount == -4 || rule.applyCount == -2) {
-                                                            int presetsRemoved = 0;
-                                                            for (const auto& preset : rule.presets) {
-                                                                std::string targetPreset = preset;
-                                                                if (!targetPreset.empty() && targetPreset[0] == '!') {
-                                                                    targetPreset = targetPreset.substr(1);
-                                                                }
-
-                                                                size_t beforeCount = data.getTotalPresetCount();
-                                                                data.removePreset(rule.plugin, targetPreset);
-                                                                if (data.getTotalPresetCount() < beforeCount) {
-                                                                    presetsRemoved++;
-                                                                }
-                                                            }
-
-                                                            if (presetsRemoved > 0) {
-                                                                rulesAppliedInFile++;
-                                                                totalRulesApplied++;
-                                                                totalPresetsRemoved += presetsRemoved;
-                                                                presetsRemovedInFile += presetsRemoved;
-                                                                logFile << "  Applied: " << key
-                                                                        << " -> Plugin: " << rule.plugin
-                                                                        << " -> Removed " << presetsRemoved
-                                                                        << " presets";
-                                                                if (!rule.extra.empty()) {
-                                                                    logFile << " (mode: " << rule.extra << ")";
-                                                                }
-                                                                logFile << std::endl;
-
-                                                                if (rule.applyCount == -2) {
-                                                                    needsUpdate = true;
-                                                                    newCount = 0;
-                                                                }
-                                                            } else {
-                                                                logFile << "  No presets removed (not found): " << key
-                                                                        << " -> Plugin: " << rule.plugin << std::endl;
-                                                            }
-
-                                                        } else if (rule.applyCount == -5 || rule.applyCount == -3) {
-                                                            if (data.hasPlugin(rule.plugin)) {
-                                                                data.removePlugin(rule.plugin);
-                                                                rulesAppliedInFile++;
-                                                                totalRulesApplied++;
-                                                                totalPluginsRemoved++;
-                                                                pluginsRemovedInFile++;
-                                                                logFile << "  Applied: " << key
-                                                                        << " -> Plugin: " << rule.plugin
-                                                                        << " -> REMOVED ENTIRE PLUGIN";
-                                                                if (!rule.extra.empty()) {
-                                                                    logFile << " (mode: " << rule.extra << ")";
-                                                                }
-                                                                logFile << std::endl;
-
-                                                                if (rule.applyCount == -3) {
-                                                                    needsUpdate = true;
-                                                                    newCount = 0;
-                                                                }
-                                                            } else {
-                                                                logFile << "  No plugin removed (not found): " << key
-                                                                        << " -> Plugin: " << rule.plugin << std::endl;
-                                                            }
-
-                                                        } else if (rule.applyCount > 0) {
-                                                            int presetsAdded = 0;
-                                                            for (const auto& preset : rule.presets) {
-                                                                size_t beforeCount = data.getTotalPresetCount();
-                                                                data.addPreset(rule.plugin, preset);
-                                                                if (data.getTotalPresetCount() > beforeCount) {
-                                                                    presetsAdded++;
-                                                                }
-                                                            }
-
-                                                            if (presetsAdded > 0) {
-                                                                rulesAppliedInFile++;
-                                                                totalRulesApplied++;
-                                                                logFile << "  Applied: " << key
-                                                                        << " -> Plugin: " << rule.plugin << " -> Added "
-                                                                        << presetsAdded
-                                                                        << " new presets (remaining count: " << newCount
-                                                                        << ")";
-                                                                if (!rule.extra.empty()) {
-                                                                    logFile << " (mode: " << rule.extra << ")";
-                                                                }
-                                                                logFile << std::endl;
-                                                            } else {
-                                                                logFile
-                                                                    << "  No new presets added (all already exist): "
-                                                                    << key << " -> Plugin: " << rule.plugin
-                                                                    << " (remaining count: " << newCount << ")"
-                                                                    << std::endl;
-                                                            }
-                                                        }
-
-                                                        if (needsUpdate) {
-                                                            rule.applyCount = newCount;
-                                                            fileLinesAndRules.emplace_back(originalLine, rule);
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                    }
+// ===== DEFERRED STAGES AFTER THE MAIN MENU =====
 
-                                    for (const auto& [originalLine, rule] : fileLinesAndRules) {
-                                        UpdateIniRuleCount(entry.path(), originalLine, rule.applyCount);
-                                    }
+void StartDeferredStagesWorker() {
+    std::thread worker([]() {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+        // With Background_Processing the pipeline may still own the main log
+        if (!g_distributionBarrier.Wait(DISTRIBUTION_BARRIER_TIMEOUT)) return;
+        RunDeferredStages();
+    });
+    worker.detach();
+}
 
-                                    logFile << "  Rules in file: " << rulesInFile
-                                            << " | Applied: " << rulesAppliedInFile
-                                            << " | Skipped: " << rulesSkippedInFile
-                                            << " | Presets removed: " << presetsRemovedInFile
-                                            << " | Plugins removed: " << pluginsRemovedInFile << std::endl;
-                                }
-                            }
-                        }
-                    } catch (const std::exception& e) {
-                        logFile << "ERROR scanning directory: " << e.what() << std::endl;
-                    }
+class MainMenuWatcher : public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+public:
+    static MainMenuWatcher* GetSingleton() {
+        static MainMenuWatcher singleton;
+        return &singleton;
+    }
 
-                    std::vector<std::string> missingPresetsFromIni;
-                    PerformSmartCleaning(processedData, config, bodySlidePresetsPath, logFile, missingPresetsFromIni);
+    RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* event,
+                                          RE::BSTEventSource<RE::MenuOpenCloseEvent>*) override {
+        if (event && event->opening && event->menuName == RE::MainMenu::MENU_NAME && !started_.exchange(true)) {
+            StartDeferredStagesWorker();
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
 
-                    auto [allPresetsForBlacklist, presetsForRaces] = ProcessUBEXmlPresets(bodySlidePresetsPath, logFile);
-                    bool ubeChangesApplied = ApplyUBEPresetsToJson(processedData, allPresetsForBlacklist, presetsForRaces, logFile);
+private:
+    std::atomic<bool> started_{false};
+};
 
-                    logFile << std::endl;
-                    logFile << "====================================================" << std::endl;
-                    logFile << "SUMMARY:" << std::endl;
+// ===== MAIN PLUGIN FUNCTION =====
 
-                    if (backupPerformed) {
-                        try {
-                            auto backupSize = fs::file_size(backupJsonPath);
-                            logFile << "Original JSON backup: SUCCESS (" << backupSize << " bytes)" << std::endl;
-                        } catch (...) {
-                            logFile << "Original JSON backup: SUCCESS (size verification failed)" << std::endl;
-                        }
+extern "C" __declspec(dllexport) bool SKSEPlugin_Load(const SKSE::LoadInterface* skse) {
+    try {
+        SKSE::Init(skse);
 
-                    } else {
-                        logFile << "Original JSON backup: SKIPPED" << std::endl;
-                    }
+        try {
+            std::string documentsPath = GetDocumentsPath();
+            std::string gamePath = GetGamePath();
+            if (!gamePath.empty() && !documentsPath.empty()) {
+                PipelinePaths paths = BuildPipelinePaths(documentsPath, gamePath);
+                CreateDirectoryIfNotExists(paths.logDoctorPath.parent_path());
+                StartEarlyPreScan(paths);
+            }
+        } catch (...) {
+        }
 
-                    logFile << "Total .ini files processed: " << totalFilesProcessed << std::endl;
-                    logFile << "Total rules processed: " << totalRulesProcessed << std::endl;
-                    logFile << "Total rules applied: " << totalRulesApplied << std::endl;
-                    logFile << "Total rules skipped (count=0): " << totalRulesSkipped << std::endl;
-                    logFile << "Total presets removed (-): " << totalPresetsRemoved << std::endl;
-                    logFile << "Total plugins removed (*): " << totalPluginsRemoved << std::endl;
-                    logFile << "UBE XML presets found: " << allPresetsForBlacklist.size() << std::endl;
-                    logFile << "UBE presets added to races: " << presetsForRaces.size() << std::endl;
-                    logFile << "UBE changes applied: " << (ubeChangesApplied ? "YES" : "NO") << std::endl;
-                    logFile << "Smart Cleaning enabled (any): " << ((config.presetsSmartCleaning || config.blacklistedPresetsSmartCleaningFromRandomDistribution || config.blacklistedPresetsSmartCleaningFromAll || config.outfitsForceReSmartCleaning) ? "YES" : "NO") << std::endl;
-                    logFile << "Current blacklistedPresetsShowInOBodyMenu: " << (currentBlacklistedPresetsShow ? "true" : "false") << std::endl;
-                    logFile << "Target blacklistedPresetsShowInOBodyMenu (ModeUBE): " << (config.modeUBE ? "true" : "false") << std::endl;
-                    logFile << std::endl << "Final data in JSON:" << std::endl;
-
-                    for (const auto& [key, data] : processedData) {
-                        size_t count = data.getTotalPresetCount();
-                        if (count > 0) {
-                            logFile << "  " << key << ": " << data.getPluginCount() << " plugins, " << count
-                                    << " total presets" << std::endl;
-                        }
-                    }
+        SKSE::GetMessagingInterface()->RegisterListener([](SKSE::MessagingInterface::Message* message) {
+            try {
+                if (message->type == SKSE::MessagingInterface::kDataLoaded) {
+                    MarkDataLoaded();
 
-                    logFile << "====================================================" << std::endl << std::endl;
+                    if (auto* ui = RE::UI::GetSingleton()) {
+                        ui->AddEventSink<RE::MenuOpenCloseEvent>(MainMenuWatcher::GetSingleton());
+                    }
 
-                    logFile << "Updating JSON at: " << jsonOutputPath.string() << std::endl;
+                    std::string documentsPath;
+                    std::string gamePath;
 
                     try {
-                        std::string updatedJsonContent =
-                            PreserveOriginalSections(originalJsonContent, processedData, 
-                                                    currentBlacklistedPresetsShow, config.modeUBE, logFile);
+                        documentsPath = GetDocumentsPath();
+                        gamePath = GetGamePath();
+                    } catch (...) {
+                        RE::ConsoleLog::GetSingleton()->Print("OBody Assistant: Error getting paths - using defaults");
+                        documentsPath = "C:\\Users\\Default\\Documents";
+                        gamePath = "";
+                    }
 
-                        if (CheckIfChangesNeeded(originalJsonContent, processedData, 
-                                                currentBlacklistedPresetsShow, config.modeUBE)) {
-                            logFile << "Changes detected (INI rules, UBE XML, Smart Cleaning, or ModeUBE). Proceeding with atomic write..." << std::endl;
+                    if (gamePath.empty() || documentsPath.empty()) {
+                        RE::ConsoleLog::GetSingleton()->Print(
+                            "OBody Assistant: Could not find Game or Documents path.");
+                        return;
+                    }
 
-                            if (WriteJsonAtomically(jsonOutputPath, updatedJsonContent, analysisDir, logFile)) {
-                                logFile << "SUCCESS: JSON updated successfully with proper 4-space indentation hierarchy"
-                                        << std::endl;
+                    PipelinePaths paths = BuildPipelinePaths(documentsPath, gamePath);
+                    CreateDirectoryIfNotExists(paths.sksePluginsPath);
+                    CreateDirectoryIfNotExists(paths.logFilePath.parent_path());
 
-                                logFile << std::endl;
-                                if (CorrectJsonIndentation(jsonOutputPath, analysisDir, logFile)) {
-                                    logFile << "SUCCESS: JSON indentation verification and correction completed"
-                                            << std::endl;
-                                } else {
-                                    logFile << "ERROR: JSON indentation correction failed" << std::endl;
-                                    logFile << "Attempting to restore from backup due to indentation failure..."
-                                            << std::endl;
-                                    if (fs::exists(backupJsonPath) &&
-                                        RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
-                                        logFile << "SUCCESS: JSON restored from backup after indentation failure"
-                                                << std::endl;
-                                    } else {
-                                        logFile << "CRITICAL ERROR: Could not restore JSON from backup" << std::endl;
-                                    }
-                                }
-                            } else {
-                                logFile << "ERROR: Failed to write JSON safely" << std::endl;
-                                logFile << "Attempting to restore from backup due to write failure..." << std::endl;
-                                if (fs::exists(backupJsonPath) &&
-                                    RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
-                                    logFile << "SUCCESS: JSON restored from backup after write failure" << std::endl;
-                                } else {
-                                    logFile << "CRITICAL ERROR: Could not restore JSON from backup" << std::endl;
-                                }
-                            }
-                        } else {
-                            logFile << "No changes detected. Skipping redundant atomic write." << std::endl;
+                    std::ofstream logFile(paths.logFilePath, std::ios::out | std::ios::trunc);
 
-                            if (CorrectJsonIndentation(jsonOutputPath, analysisDir, logFile)) {
-                                logFile << "JSON indentation is already perfect or has been corrected." << std::endl;
-                            } else {
-                                logFile << "ERROR: JSON indentation correction failed" << std::endl;
-                                logFile << "Attempting to restore from backup due to indentation failure..."
-                                        << std::endl;
-                                if (fs::exists(backupJsonPath) &&
-                                    RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
-                                    logFile << "SUCCESS: JSON restored from backup after indentation failure"
-                                            << std::endl;
-                                } else {
-                                    logFile << "CRITICAL ERROR: Could not restore JSON from backup" << std::endl;
-                                }
-                            }
-                        }
+                    WriteLogHeader(logFile);
 
-                    } catch (const std::exception& e) {
-                        logFile << "ERROR in JSON update process: " << e.what() << std::endl;
-                        logFile << "Attempting to restore from backup due to update failure..." << std::endl;
-                        if (fs::exists(backupJsonPath) &&
-                            RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
-                            logFile << "SUCCESS: JSON restored from backup after update failure" << std::endl;
-                        } else {
-                            logFile << "CRITICAL ERROR: Could not restore JSON from backup" << std::endl;
-                        }
+                    logFile << "Reading configuration..." << std::endl;
+                    logFile << "----------------------------------------------------" << std::endl;
+                    ConfigSettings config = ReadConfigFromIni(paths.configIniPath, logFile);
 
-                    } catch (...) {
-                        logFile << "ERROR in JSON update process: Unknown exception" << std::endl;
-                        logFile << "Attempting to restore from backup due to unknown failure..." << std::endl;
-                        if (fs::exists(backupJsonPath) &&
-                            RestoreJsonFromBackup(backupJsonPath, jsonOutputPath, analysisDir, logFile)) {
-                            logFile << "SUCCESS: JSON restored from backup after unknown failure" << std::endl;
-                        } else {
-                            logFile << "CRITICAL ERROR: Could not restore JSON from backup" << std::endl;
-                        }
+                    if (config.backgroundProcessing) {
+                        logFile << std::endl;
+                        logFile << "Background processing enabled - distribution runs on a worker thread." << std::endl;
+                        logFile << "Game loading waits for it to finish before any save or new game starts." << std::endl;
+                        StartDistributionWorker(std::move(paths), config, std::move(logFile));
+                        return;
                     }
 
-                    logFile << std::endl
-                            << "Process completed successfully with perfect 4-space JSON formatting."
-                            << std::endl;
+                    auto startTime = std::chrono::steady_clock::now();
+                    DistributionOutcome outcome = RunDistributionPipelineGuarded(paths, config, logFile, false);
+                    auto elapsedMs = static_cast<std::uint32_t>(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                              startTime)
+                            .count());
                     logFile.close();
 
-                    RE::ConsoleLog::GetSingleton()->Print("OBody Assistant: Process completed successfully");
+                    PublishDistributionOutcome(outcome, false, elapsedMs);
+                    StartWatchModeInGame(paths, config);
+
+                } else if (message->type == SKSE::MessagingInterface::kPreLoadGame ||
+                           message->type == SKSE::MessagingInterface::kNewGame) {
+                    WaitForDistributionWorker();
                 }
 
             } catch (const std::exception& e) {
@@ -4380,4 +9964,6 @@ extern "C" __declspec(dllexport) bool SKSEPlugin_Load(const SKSE::LoadInterface*
         RE::ConsoleLog::GetSingleton()->Print("CRITICAL ERROR loading OBody Assistant plugin");
         return false;
     }
-}
\ No newline at end of file
+}
+
+#endif  // OBODY_PDA_HEADLESS